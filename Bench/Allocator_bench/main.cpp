@@ -9,6 +9,8 @@
 #include <CoreFoundation/CoreFoundation.h>
 
 #include "utilities/timer.hpp"
+#include "json/utility/arena_allocator.hpp"
+#include "json/utility/pool_allocator.hpp"
 //#include "Allocators/dl_malloc.h"
 
 #include <vector>
@@ -172,15 +174,168 @@ static void test3(const int N, const int S)
 
 
 
+static void test4(const int N, const int S) 
+{
+    typedef std::vector<void*> pointer_vector;
+    
+    printf("-------------------------------------------------------------------\n"
+           "                     SysArena \n"
+           " Allocating and destryoing %d objects with size %d\n"
+           "-------------------------------------------------------------------\n",
+           N, S);
+    
+    json::utility::SysArena arena;
+    
+    pointer_vector pv;
+    pv.reserve(N);
+    
+    timer tc;
+    tc.start();
+    for (int i = 0; i < N; ++i) {
+        pv.push_back(0);
+    }
+    tc.stop();
+    pv.clear();
+    pv.reserve(N);
+    
+    timer t;
+    t.start();
+    for (int i = 0; i < N; ++i) {
+        void* p = arena.allocate(S);
+        pv.push_back(p);
+    }
+    t.stop();
+    
+    double ta = t.seconds() - tc.seconds();
+    
+    // An arena releases its objects all at once:
+    timer td;
+    td.start();
+    arena.clear();
+    td.stop();
+    
+    printf("Allocate: %.3fms", ta*1.0e3);
+    printf("\nDestroy:  %.3fms\n\n", td.seconds()*1.0e3);
+}
+
+
+static void test5(const int N, const int S) 
+{
+    typedef std::vector<void*> pointer_vector;
+    typedef json::utility::SlabPool pool;
+    
+    printf("-------------------------------------------------------------------\n"
+           "                     SlabPool \n"
+           " Allocating and destryoing %d objects with size %d\n"
+           "-------------------------------------------------------------------\n",
+           N, S);
+    
+    pointer_vector pv;
+    pv.reserve(N);
+    
+    timer tc;
+    tc.start();
+    for (int i = 0; i < N; ++i) {
+        pv.push_back(0);
+    }
+    tc.stop();
+    pv.clear();
+    pv.reserve(N);
+    
+    timer t;
+    t.start();
+    for (int i = 0; i < N; ++i) {
+        void* p = pool::allocate(S);
+        pv.push_back(p);
+    }
+    t.stop();
+    
+    double ta = t.seconds() - tc.seconds();
+    
+    timer td;
+    td.start();
+    
+    pointer_vector::iterator first = pv.begin();
+    pointer_vector::iterator last = pv.end();
+    while (first != last) {
+        pool::deallocate(*first++, S);
+    }
+    td.stop();
+    
+    printf("Allocate: %.3fms", ta*1.0e3);
+    printf("\nDestroy:  %.3fms\n\n", td.seconds()*1.0e3);
+}
+
+
+// Simulates a mutable DOM: repeatedly frees a random object and allocates
+// a new one, with sizes alternating between S and 2*S.
+template <typename Alloc, typename Free>
+static double churn(const int N, const int S, Alloc alloc, Free dealloc) 
+{
+    std::vector<std::pair<void*, int>> pv;
+    pv.reserve(N);
+    for (int i = 0; i < N; ++i) {
+        const int size = S * (1 + i % 2);
+        pv.push_back(std::make_pair(alloc(size), size));
+    }
+    unsigned int r = 1;
+    timer t;
+    t.start();
+    for (int i = 0; i < 10*N; ++i) {
+        r = r * 1103515245u + 12345u;
+        std::pair<void*, int>& e = pv[(r >> 8) % N];
+        dealloc(e.first, e.second);
+        e.second = S * (1 + (r >> 4) % 2);
+        e.first = alloc(e.second);
+    }
+    t.stop();
+    for (int i = 0; i < N; ++i) {
+        dealloc(pv[i].first, pv[i].second);
+    }
+    return t.seconds();
+}
+
+
+static void test6(const int N, const int S) 
+{
+    printf("-------------------------------------------------------------------\n"
+           "                     Mutable DOM: malloc, CFAllocator, SlabPool \n"
+           " Replacing %d times one of %d objects with size %d or %d\n"
+           "-------------------------------------------------------------------\n",
+           10*N, N, S, 2*S);
+    
+    double tm = churn(N, S, 
+                      [](int size) { return malloc(size); }, 
+                      [](void* p, int) { free(p); });
+    double tcf = churn(N, S, 
+                      [](int size) { return CFAllocatorAllocate(CFAllocatorGetDefault(), size, 0); }, 
+                      [](void* p, int) { CFAllocatorDeallocate(CFAllocatorGetDefault(), p); });
+    double tp = churn(N, S, 
+                      [](int size) { return json::utility::SlabPool::allocate(size); }, 
+                      [](void* p, int size) { json::utility::SlabPool::deallocate(p, size); });
+    
+    printf("malloc:      %.3fms", tm*1.0e3);
+    printf("\nCFAllocator: %.3fms", tcf*1.0e3);
+    printf("\nSlabPool:    %.3fms\n\n", tp*1.0e3);
+}
+
+
+
 int main (int argc, const char * argv[])
 {
     test1(100000, 48);
     test2(100000, 48);
     test3(100000, 48);
+    test4(100000, 48);
+    test5(100000, 48);
     
     test1(100000, 48);
     test2(100000, 48);
     test3(100000, 48);
+    test4(100000, 48);
+    test5(100000, 48);
+    
+    test6(100000, 48);
     
     return 0;
 }
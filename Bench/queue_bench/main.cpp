@@ -9,15 +9,20 @@
 #include <iostream>
 #include "json/utility/producer_consumer_queue2.hpp"
 #include "json/utility/synchronous_queue.hpp"
-#include "json/objc/mutex.hpp"
-#include "json/objc/semaphore.hpp"
+#include "json/utility/ring_queue.hpp"
+#include "json/utility/mutex.hpp"
+#include "json/utility/semaphore.hpp"
 #include <dispatch/dispatch.h>
 #include "utilities/timer.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
 
 
 using json::utility::producer_consumer_queue;
-using json::objc::gcd::mutex;
-using json::objc::gcd::semaphore;
+using json::utility::mutex;
+using json::utility::semaphore;
 using utilities::timer;
 
 
@@ -289,6 +294,137 @@ namespace {
     }
     
     
+    void test6() 
+    {
+        std::cout << "--------------------------------------------------------\n";
+        std::cout << "                  buffer handoff latency                \n";
+        std::cout << "--------------------------------------------------------\n";
+        std::cout << std::endl;
+        
+        // A producer hands off N buffers to a consumer, one at a time, which
+        // is what the parser's input queue does. The elapsed time divided
+        // by N is the latency of one handoff, including the wakeup of the
+        // consumer and the acknowledgement to the producer.
+        
+        const int N = 200000;
+        typedef std::vector<char>* buffer_t;
+        std::vector<char> buffer(4096, 'x');
+        
+        // synchronous_queue, using json::utility::semaphore:
+        {
+            typedef json::utility::synchronous_queue<buffer_t> queue_t;
+            queue_t queue;
+            size_t total = 0;
+            timer t;
+            t.start();
+            std::thread consumer([&]() {
+                while (true) {
+                    buffer_t b = queue.get();
+                    if (b == NULL)
+                        break;
+                    total += b->size();
+                }
+            });
+            for (int i = 0; i < N; ++i) {
+                queue.put(&buffer);
+            }
+            queue.put(NULL);
+            consumer.join();
+            t.stop();
+            std::cout << "synchronous_queue:                  " 
+                << t.seconds() * 1e9 / N << " ns per handoff (" << total << " bytes)" << std::endl;
+        }
+        
+        // ring_queue, with the producer up to 8 buffers ahead:
+        {
+            typedef json::utility::ring_queue<buffer_t> queue_t;
+            queue_t queue(8);
+            size_t total = 0;
+            timer t;
+            t.start();
+            std::thread consumer([&]() {
+                while (true) {
+                    buffer_t b = queue.get();
+                    if (b == NULL)
+                        break;
+                    total += b->size();
+                }
+            });
+            for (int i = 0; i < N; ++i) {
+                queue.put(&buffer);
+            }
+            queue.put(NULL);
+            consumer.join();
+            t.stop();
+            std::cout << "ring_queue (capacity 8):            " 
+                << t.seconds() * 1e9 / N << " ns per handoff (" << total << " bytes)" << std::endl;
+        }
+        
+        // Ping-pong using two json::utility::semaphores:
+        {
+            semaphore send(1);
+            semaphore recv(0);
+            buffer_t slot = NULL;
+            size_t total = 0;
+            timer t;
+            t.start();
+            std::thread consumer([&]() {
+                while (true) {
+                    recv.wait();
+                    buffer_t b = slot;
+                    send.signal();
+                    if (b == NULL)
+                        break;
+                    total += b->size();
+                }
+            });
+            for (int i = 0; i <= N; ++i) {
+                send.wait();
+                slot = i < N ? &buffer : NULL;
+                recv.signal();
+            }
+            consumer.join();
+            t.stop();
+            std::cout << "json::utility::semaphore:           " 
+                << t.seconds() * 1e9 / N << " ns per handoff (" << total << " bytes)" << std::endl;
+        }
+        
+        // The same with std::mutex and std::condition_variable, for
+        // comparison:
+        {
+            std::mutex m;
+            std::condition_variable cond;
+            bool full = false;
+            buffer_t slot = NULL;
+            size_t total = 0;
+            timer t;
+            t.start();
+            std::thread consumer([&]() {
+                while (true) {
+                    std::unique_lock<std::mutex> lock(m);
+                    cond.wait(lock, [&]() { return full; });
+                    buffer_t b = slot;
+                    full = false;
+                    cond.notify_one();
+                    if (b == NULL)
+                        break;
+                    total += b->size();
+                }
+            });
+            for (int i = 0; i <= N; ++i) {
+                std::unique_lock<std::mutex> lock(m);
+                cond.wait(lock, [&]() { return not full; });
+                slot = i < N ? &buffer : NULL;
+                full = true;
+                cond.notify_one();
+            }
+            consumer.join();
+            t.stop();
+            std::cout << "std::mutex/std::condition_variable: " 
+                << t.seconds() * 1e9 / N << " ns per handoff (" << total << " bytes)" << std::endl;
+        }
+    }
+    
 
         
 } // namespace 
@@ -301,5 +437,6 @@ int main (int argc, const char * argv[])
     //test3();
     test4();
     //test5();
+    test6();
 }
 
@@ -173,11 +173,12 @@ namespace {
         BENCH_JP_SAFE =         1 << 0, 
         BENCH_JP_UNSAFE =       1 << 1,
         BENCH_ICU =             1 << 2,
-        BENCH_JP =              BENCH_JP_SAFE | BENCH_JP_UNSAFE, 
-        BENCH_ALL =             BENCH_ICU | BENCH_JP_SAFE | BENCH_JP_UNSAFE
+        BENCH_JP_BULK =         1 << 3,
+        BENCH_JP =              BENCH_JP_SAFE | BENCH_JP_UNSAFE | BENCH_JP_BULK, 
+        BENCH_ALL =             BENCH_ICU | BENCH_JP_SAFE | BENCH_JP_UNSAFE | BENCH_JP_BULK
     };
     
-    const int kBenchFlags =  BENCH_JP_SAFE | BENCH_ICU;
+    const int kBenchFlags =  BENCH_JP_SAFE | BENCH_JP_BULK | BENCH_ICU;
     //const int kBenchFlags = BENCH_JP;
     
 
@@ -539,6 +540,72 @@ namespace {
     }
     
     
+    // Same as bench_JP, except that input and output are pointers, which
+    // selects the bulk transcoding kernels for the well-formed input. 
+    // (bench_JP uses std::vector iterators and thus the character-wise
+    // converters.)
+    template <typename InputEncodingT, typename OutputEncodingT>
+    MinMaxAvgTime 
+    __attribute__((noinline))    
+    bench_JP_bulk(InputEncodingT inputEncoding, OutputEncodingT outputEncoding,
+                  std::size_t N, std::size_t K, Distribution d, bool randomize = true)
+    {
+        using unicode::add_endianness;
+        using unicode::encoding_traits;
+        using utilities::timer;
+        
+        typedef typename add_endianness<InputEncodingT>::type      from_encoding_t;        
+        typedef typename add_endianness<OutputEncodingT>::type     to_encoding_t;        
+        
+        typedef typename encoding_traits<from_encoding_t>::code_unit_type input_char_t;
+        typedef typename encoding_traits<to_encoding_t>::code_unit_type output_char_t;
+        
+        typedef std::vector<input_char_t> input_buffer_t;        
+        typedef std::vector<output_char_t> output_buffer_t;        
+        
+        input_buffer_t source_buffer = create_utf_source(from_encoding_t(), N, d, randomize);
+        
+        size_t target_buffer_size = (size_t)(N*4/sizeof(output_char_t));
+        output_buffer_t target_buffer(target_buffer_size, 0);    
+        
+        size_t consumed = 0;
+        size_t produced = 0;
+        
+        timer t0;
+        MinMaxAvgTime result;
+        int error = 0;
+        for (std::size_t i = 0; i < K; i++) 
+        {
+            const input_char_t* first = source_buffer.data();
+            const input_char_t* last = first + source_buffer.size();
+            output_char_t* dest = target_buffer.data();
+            
+            t0.start();
+            error = unicode::convert(first, last, from_encoding_t(), 
+                                     dest, to_encoding_t());
+            t0.stop();
+            result.set(t0.seconds());
+            t0.reset();
+            consumed = (size_t)(first - source_buffer.data());
+            produced = (size_t)(dest - target_buffer.data());
+            if (produced > target_buffer_size) {
+                std::cout << "ERROR: target buffer was too small!" << std::endl;
+                abort();
+            }
+        }        
+        if (error < 0) {
+            std::cout << "Error during conversion: "<< error << std::endl;
+        }        
+#if defined (LOGDEBUG)        
+        std::cout << "source buffer size (code units): " <<  source_buffer.size() <<  std::endl;
+        std::cout << "target buffer size (code units): " <<  target_buffer_size <<  std::endl;
+        std::cout << "consumed code units from source: " <<  consumed <<  std::endl;
+        std::cout << "produced code units into target: " <<  produced <<  std::endl;
+#endif        
+        return result;
+    }
+    
+    
     
 #pragma mark - ICU
     
@@ -1173,6 +1240,11 @@ namespace {
             print_result("JP(unsafe)", elapsedTime, elapsedTime.min());
         }
         
+        if (kBenchFlags & BENCH_JP_BULK) {
+            elapsedTime = bench_JP_bulk(InputEncoding(), OutputEncoding(), N, K, d);
+            print_result("JP(bulk)", elapsedTime, elapsedTime.min());
+        }
+        
 
         if (kBenchFlags & BENCH_ICU) {
             elapsedTime = bench_ICU(InputEncoding(), OutputEncoding(), N, K, d);
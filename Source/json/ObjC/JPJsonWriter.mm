@@ -57,7 +57,8 @@ namespace {
     using json::unicode::UTF_32BE_encoding_tag;
     using json::unicode::UTF_32LE_encoding_tag;    
     using json::generator_internal::copyBOM;
-    using json::generator_internal::escape_convert_unsafe;
+    using json::generator_internal::encode_string;
+    using json::generator_internal::string_encoder_base;
     
     using json::unicode::to_host_endianness;
     using json::unicode::encoding_traits;
@@ -600,6 +601,7 @@ namespace {
                    NSStringEncoding outEncoding,
                    bool             escapeSolidus)
     {
+        const unsigned int options = escapeSolidus ? string_encoder_base::EscapeSolidus : 0;
         switch (inEncoding) {
             case NSUTF8StringEncoding: 
                 switch (outEncoding) {
@@ -607,10 +609,9 @@ namespace {
                         const char* first = static_cast<const char*>(start);
                         const char* last = static_cast<const char*>(end);
                         
-                        // TODO: use class json::generator_internal::string_encoder
-                        // escape_convert_unsafe() returns unicode::NO_ERROR on success, otherwise a 
+                        // encode_string() returns unicode::NO_ERROR on success, otherwise a 
                         // negative number indicating an error code as decribed in unicode::ErrorT.
-                        int result = escape_convert_unsafe(first, last, UTF_8_encoding_tag(), dest, UTF_8_encoding_tag(), escapeSolidus);
+                        int result = encode_string(first, last, UTF_8_encoding_tag(), dest, UTF_8_encoding_tag(), options);
                         return result; // returns a json:unicode::ErrorT
                     }
                         break;
@@ -622,10 +623,9 @@ namespace {
                     case NSUTF8StringEncoding: {
                         const uint16_t* first = static_cast<const uint16_t*>(start);
                         const uint16_t* last = static_cast<const uint16_t*>(end);
-                        // TODO: use class json::generator_internal::string_encoder
-                        // escape_convert_unsafe() returns unicode::NO_ERROR on success, otherwise a 
+                        // encode_string() returns unicode::NO_ERROR on success, otherwise a 
                         // negative number indicating an error code as decribed in unicode::ErrorT.
-                        int result = escape_convert_unsafe(first, last, UTF_16BE_encoding_tag(), dest, UTF_8_encoding_tag(), escapeSolidus);
+                        int result = encode_string(first, last, UTF_16BE_encoding_tag(), dest, UTF_8_encoding_tag(), options);
                         return result;
                     }
                         break;
@@ -637,10 +637,9 @@ namespace {
                     case NSUTF8StringEncoding: {
                         const uint16_t* first = static_cast<const uint16_t*>(start);
                         const uint16_t* last = static_cast<const uint16_t*>(end);
-                        // TODO: use class json::generator_internal::string_encoder
-                        // escape_convert_unsafe() returns unicode::NO_ERROR on success, otherwise a 
+                        // encode_string() returns unicode::NO_ERROR on success, otherwise a 
                         // negative number indicating an error code as decribed in unicode::ErrorT.
-                        int result =  escape_convert_unsafe(first, last, UTF_16LE_encoding_tag(), dest, UTF_8_encoding_tag(), escapeSolidus);
+                        int result = encode_string(first, last, UTF_16LE_encoding_tag(), dest, UTF_8_encoding_tag(), options);
                         return result;
                     }
                         break;
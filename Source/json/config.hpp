@@ -74,6 +74,24 @@
 
 
 
+/**
+ If JSON_NO_THREAD_LOCAL is defined, json::parse_context does not provide a 
+ thread-local default context. Define it for toolchains which do not support 
+ the thread_local storage class specifier.
+ */
+//#define JSON_NO_THREAD_LOCAL
+
+
+
+/**
+ If JSON_NO_STD_PMR is defined, json::pmr does not use the memory resources
+ from header <memory_resource>, even if the standard library provides them,
+ and uses its own implementation instead.
+ */
+//#define JSON_NO_STD_PMR
+
+
+
 /**
  JSON Path - not yet implemented
 */
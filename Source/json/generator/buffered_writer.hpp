@@ -0,0 +1,557 @@
+//
+//  buffered_writer.hpp
+//
+//
+//  Created by agent on 10/18/26.
+//
+//
+
+#ifndef JSON_GENERATOR_BUFFERED_WRITER_HPP
+#define JSON_GENERATOR_BUFFERED_WRITER_HPP
+
+#include "json/config.hpp"
+#include "json/utility/number_to_string.hpp"
+#include "json/unicode/unicode_traits.hpp"
+#include "json/simd/escape_scan.hpp"
+#include "generate.hpp"
+#include "token_traits.hpp"
+#include "write_value.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+#include <system_error>
+#include <cstring>
+#include <algorithm>
+#include <cassert>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <errno.h>
+
+
+
+#pragma mark - Sinks
+
+namespace json {
+
+    //
+    //  Sinks
+    //
+    //  A sink receives the content of an output_buffer when it will be flushed.
+    //  A sink shall provide a member function
+    //
+    //      void write(const CharT* p, std::size_t n);
+    //
+    //  which consumes n code units starting at p. Errors shall be signaled by
+    //  throwing an exception.
+    //
+    //  A sink may additionally provide vectored output with
+    //
+    //      void writev(struct iovec* iov, int count);
+    //
+    //  which will be used by writers that produce several buffers at once.
+    //
+
+    // Appends to a std::basic_string.
+    template <typename CharT>
+    class basic_string_sink
+    {
+    public:
+        explicit basic_string_sink(std::basic_string<CharT>& s) : s_(s) {}
+        void write(const CharT* p, std::size_t n) { s_.append(p, n); }
+    private:
+        std::basic_string<CharT>& s_;
+    };
+
+    // Appends to a std::vector.
+    template <typename CharT>
+    class basic_vector_sink
+    {
+    public:
+        explicit basic_vector_sink(std::vector<CharT>& v) : v_(v) {}
+        void write(const CharT* p, std::size_t n) { v_.insert(v_.end(), p, p + n); }
+    private:
+        std::vector<CharT>& v_;
+    };
+
+    // Calls a user supplied function.
+    template <typename CharT>
+    class basic_callback_sink
+    {
+    public:
+        typedef std::function<void(const CharT*, std::size_t)> callback_t;
+        explicit basic_callback_sink(callback_t f) : f_(std::move(f)) {}
+        void write(const CharT* p, std::size_t n) { f_(p, n); }
+    private:
+        callback_t f_;
+    };
+
+    // Writes to a file descriptor. Throws std::system_error if write(2) fails.
+    // The file descriptor will not be closed.
+    class fd_sink
+    {
+    public:
+        explicit fd_sink(int fd) : fd_(fd) {}
+
+        void write(const char* p, std::size_t n)
+        {
+            while (n > 0) {
+                ssize_t result = ::write(fd_, p, n);
+                if (result < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    throw std::system_error(errno, std::system_category(), "json::fd_sink");
+                }
+                p += result;
+                n -= static_cast<std::size_t>(result);
+            }
+        }
+
+        // Vectored output: writes the buffers in order with writev(2).
+        // Modifies the array in case of partial writes.
+        void writev(struct iovec* iov, int count)
+        {
+            while (count > 0) {
+                ssize_t result = ::writev(fd_, iov, count);
+                if (result < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    throw std::system_error(errno, std::system_category(), "json::fd_sink");
+                }
+                std::size_t n = static_cast<std::size_t>(result);
+                while (count > 0 and n >= iov->iov_len) {
+                    n -= iov->iov_len;
+                    ++iov;
+                    --count;
+                }
+                if (count > 0) {
+                    iov->iov_base = static_cast<char*>(iov->iov_base) + n;
+                    iov->iov_len -= n;
+                }
+            }
+        }
+    private:
+        int fd_;
+    };
+
+    typedef basic_string_sink<char>     string_sink;
+    typedef basic_vector_sink<char>     vector_sink;
+    typedef basic_callback_sink<char>   callback_sink;
+
+}
+
+
+#pragma mark - output_buffer
+
+namespace json {
+
+    //
+    //  class output_buffer
+    //
+    //  A contiguous buffer of fixed capacity which will be flushed to a sink
+    //  when it is full. Writes larger than the capacity bypass the buffer.
+    //
+    //  The buffer will not be flushed when it is destroyed - flush() shall be
+    //  called explicitly.
+    //
+    //  The capacity will be at least min_capacity code units.
+    //
+    template <typename CharT, typename Sink>
+    class output_buffer
+    {
+    public:
+        static constexpr std::size_t default_capacity = 4096;
+        static constexpr std::size_t min_capacity = 64;
+
+        explicit output_buffer(Sink& sink, std::size_t capacity = default_capacity)
+        :   sink_(sink),
+            start_(new CharT[std::max(capacity, min_capacity)]),
+            pos_(start_.get()),
+            end_(start_.get() + std::max(capacity, min_capacity))
+        {
+        }
+
+        output_buffer(const output_buffer&) = delete;
+        output_buffer& operator=(const output_buffer&) = delete;
+
+        std::size_t capacity() const    { return end_ - start_.get(); }
+        std::size_t size() const        { return pos_ - start_.get(); }
+        std::size_t avail() const       { return end_ - pos_; }
+
+        void put(CharT c)
+        {
+            if (__builtin_expect(pos_ == end_, 0)) {
+                flush();
+            }
+            *pos_++ = c;
+        }
+
+        void write(const CharT* p, std::size_t n)
+        {
+            if (__builtin_expect(n <= avail(), 1)) {
+                std::memcpy(pos_, p, n*sizeof(CharT));
+                pos_ += n;
+            }
+            else {
+                flush();
+                if (n >= capacity()) {
+                    sink_.write(p, n);
+                } else {
+                    std::memcpy(pos_, p, n*sizeof(CharT));
+                    pos_ += n;
+                }
+            }
+        }
+
+        // Returns a pointer to a contiguous region of at least n code units,
+        // where n shall not be greater than capacity(). After writing into
+        // the region, commit() shall be called with the end of the written
+        // range.
+        CharT* reserve(std::size_t n)
+        {
+            assert(n <= capacity());
+            if (__builtin_expect(n > avail(), 0)) {
+                flush();
+            }
+            return pos_;
+        }
+
+        void commit(CharT* end)
+        {
+            assert(end >= pos_ and end <= end_);
+            pos_ = end;
+        }
+
+        void flush()
+        {
+            if (pos_ != start_.get()) {
+                sink_.write(start_.get(), size());
+                pos_ = start_.get();
+            }
+        }
+
+    private:
+        Sink&                       sink_;
+        std::unique_ptr<CharT[]>    start_;
+        CharT*                      pos_;
+        CharT*                      end_;
+    };
+
+    template <typename CharT, typename Sink>
+    constexpr std::size_t output_buffer<CharT, Sink>::default_capacity;
+    template <typename CharT, typename Sink>
+    constexpr std::size_t output_buffer<CharT, Sink>::min_capacity;
+
+}
+
+
+#pragma mark - String Output
+
+namespace json { namespace detail {
+
+    // An output iterator which appends to an output buffer. Used by the
+    // generic string encoder.
+    template <typename Buffer, typename CharT>
+    struct output_buffer_iterator
+    {
+        typedef std::output_iterator_tag   iterator_category;
+        typedef void                        value_type;
+        typedef void                        difference_type;
+        typedef void                        pointer;
+        typedef void                        reference;
+
+        explicit output_buffer_iterator(Buffer& buffer) : buffer_(&buffer) {}
+        output_buffer_iterator& operator=(CharT c) { buffer_->put(c); return *this; }
+        output_buffer_iterator& operator*()        { return *this; }
+        output_buffer_iterator& operator++()       { return *this; }
+        output_buffer_iterator& operator++(int)    { return *this; }
+    private:
+        Buffer* buffer_;
+    };
+
+
+    template <typename Buffer>
+    inline void
+    write_escaped(Buffer& buffer, unsigned int ch)
+    {
+        static const char hex_digits[] = "0123456789ABCDEF";
+        char* p = buffer.reserve(6);
+        *p++ = '\\';
+        switch (ch) {
+            case '"':   *p++ = '"'; break;
+            case '\\':  *p++ = '\\'; break;
+            case '/':   *p++ = '/'; break;
+            case '\b':  *p++ = 'b'; break;
+            case '\f':  *p++ = 'f'; break;
+            case '\n':  *p++ = 'n'; break;
+            case '\r':  *p++ = 'r'; break;
+            case '\t':  *p++ = 't'; break;
+            default:
+                *p++ = 'u';
+                *p++ = '0';
+                *p++ = '0';
+                *p++ = hex_digits[ch >> 4];
+                *p++ = hex_digits[ch & 0x0Fu];
+        }
+        buffer.commit(p);
+    }
+
+
+    //
+    //  void write_string(Buffer& buffer, const CharT* first, const CharT* last,
+    //                    InEncoding, OutEncoding, bool escapeSolidus)
+    //
+    //  Writes the string [first, last) as a quoted and escaped JSON string
+    //  into the output buffer.
+    //
+    //  Fast path: UTF-8 to UTF-8. Runs of characters which need no escaping
+    //  will be found with json::simd::find_escape() and copied as a whole.
+    //  Non-ASCII characters are copied unchanged, since the input is
+    //  required to be well-formed.
+    //
+    template <typename Buffer>
+    inline void
+    write_string(Buffer& buffer, const char* first, const char* last,
+                 json::unicode::UTF_8_encoding_tag, json::unicode::UTF_8_encoding_tag,
+                 bool escapeSolidus)
+    {
+        buffer.put('"');
+        while (first != last) {
+            const char* q = json::simd::find_escape(first, last, escapeSolidus);
+            buffer.write(first, q - first);
+            if (q == last)
+                break;
+            write_escaped(buffer, static_cast<unsigned char>(*q));
+            first = q + 1;
+        }
+        buffer.put('"');
+    }
+
+    // Generic path: uses the string encoder.
+    template <typename Buffer, typename CharT, typename InEncoding, typename OutEncoding>
+    inline void
+    write_string(Buffer& buffer, const CharT* first, const CharT* last,
+                 InEncoding, OutEncoding, bool escapeSolidus)
+    {
+        using json::generator_internal::encode_string;
+
+        typedef typename std::conditional<std::is_same<
+            json::unicode::escaped_unicode_encoding_t, OutEncoding>::value,
+            json::unicode::UTF_8_encoding_tag,
+        OutEncoding>::type                              out_encoding_type;
+        typedef typename encoding_traits<out_encoding_type>::code_unit_type char_type;
+        typedef json::token_traits<out_encoding_type>   TokenTraits;
+
+        buffer.write(TokenTraits::quote_token.data(), 1);
+        output_buffer_iterator<Buffer, char_type> dest(buffer);
+        const unsigned int options = escapeSolidus ? generator_internal::string_encoder_base::EscapeSolidus : 0;
+#if !defined (NDEBUG)
+        int cvt_result =
+#endif
+        encode_string(first, last, InEncoding(), dest, OutEncoding(), options);
+        assert(cvt_result == 0);
+        buffer.write(TokenTraits::quote_token.data(), 1);
+    }
+
+}}  // namespace json::detail
+
+
+#pragma mark - buffered_writer
+
+namespace json {
+
+    //
+    //  class buffered_writer
+    //
+    //  Serializes a JSON value into an internal output buffer which will be
+    //  flushed to a sink. Other than detail::writer, the buffered writer walks
+    //  the value by const reference, and writes tokens and strings in chunks
+    //  into a contiguous buffer. Serialization does not allocate memory,
+    //  except possibly when the sink does.
+    //
+    //  Template parameter `Value` specifies the type of the JSON representation.
+    //  `Sink` is one of the sinks above, or any other class which models the
+    //  sink concept. `Encoding` specifies the encoding of the output; the
+    //  character type of the sink shall match its code unit.
+    //
+    //  The output is identical to what json::write_value() produces.
+    //
+    template <typename Value, typename Sink, typename OutEncoding = json::unicode::UTF_8_encoding_tag>
+    class buffered_writer : public writer_base
+    {
+        static_assert(std::is_same<json::unicode::escaped_unicode_encoding_t, OutEncoding>::value
+                      or std::is_base_of<json::unicode::utf_encoding_tag, OutEncoding>::value, "");
+
+        typedef typename std::conditional<std::is_same<
+            json::unicode::escaped_unicode_encoding_t, OutEncoding>::value,
+            json::unicode::UTF_8_encoding_tag,
+        OutEncoding>::type                              out_encoding_type;
+
+        typedef typename encoding_traits<out_encoding_type>::code_unit_type char_type;
+
+        using TokenTraits = typename json::token_traits<out_encoding_type>;
+
+    public:
+        typedef void result_type;
+
+        typedef typename Value::integral_number_type    IntNumber;
+        typedef typename Value::float_number_type       FloatNumber;
+        typedef typename Value::null_type               Null;
+        typedef typename Value::boolean_type            Boolean;
+        typedef typename Value::string_type             String;
+        typedef typename Value::array_type              Array;
+        typedef typename Value::object_type             Object;
+        typedef typename Value::key_type                Key;
+
+        typedef output_buffer<char_type, Sink>          buffer_type;
+
+    private:
+        typedef typename detail::map_char_type_to_unicode_encoding<typename String::value_type>::encoding string_encoding_type;
+        typedef typename detail::map_char_type_to_unicode_encoding<typename Key::value_type>::encoding key_encoding_type;
+
+    public:
+
+        buffered_writer(Sink& sink, fmtflags flags = 0, std::size_t buffer_size = buffer_type::default_capacity)
+        : writer_base(flags), buffer_(sink, buffer_size)
+        {}
+
+        // Serializes the value into the buffer. flush() shall be called in
+        // order to pass the remaining output to the sink.
+        void write(const Value& value) {
+            value.apply_visitor(*this, 0);
+        }
+
+        void flush() {
+            buffer_.flush();
+        }
+
+
+        void operator()(const Null&, int) {
+            put(TokenTraits::null_token);
+        }
+
+        void operator()(const Boolean& v, int) {
+            if (v)
+                put(TokenTraits::true_token);
+            else
+                put(TokenTraits::false_token);
+        }
+
+        void operator()(const IntNumber& v, int) {
+            char_type* p = buffer_.reserve(max_number_length);
+            buffer_.commit(json::utility::write_number(static_cast<long long>(v), p));
+        }
+
+        void operator()(const FloatNumber& v, int) {
+            char_type* p = buffer_.reserve(max_number_length);
+            buffer_.commit(json::utility::write_number(static_cast<long double>(v), p));
+        }
+
+        void operator()(const String& str, int) {
+            write_string(str, string_encoding_type(), OutEncoding());
+        }
+
+        void operator()(const Array& array, int level)
+        {
+            put(TokenTraits::array_open_token);
+            ++level;
+            bool first = true;
+            for (const Value& x : array) {
+                if (not first) {
+                    put(TokenTraits::comma_token);
+                }
+                first = false;
+                indent(level);
+                x.apply_visitor(*this, level);
+            }
+            --level;
+            if (array.size()) {
+                indent(level);
+            }
+            put(TokenTraits::array_close_token);
+        }
+
+        void operator()(const Object& obj, int level)
+        {
+            put(TokenTraits::object_open_token);
+            ++level;
+            bool first = true;
+            for (const auto& kv : obj) {
+                if (not first) {
+                    put(TokenTraits::comma_token);
+                }
+                first = false;
+                indent(level);
+                // Like write_value(), keys are never written as escaped Unicode:
+                write_string(kv.first, key_encoding_type(), out_encoding_type());
+                if ((flags()&pretty_print) != 0) {
+                    put(TokenTraits::space_token);
+                    put(TokenTraits::colon_token);
+                    put(TokenTraits::space_token);
+                }
+                else {
+                    put(TokenTraits::colon_token);
+                }
+                kv.second.apply_visitor(*this, level);
+            }
+            --level;
+            if (obj.size()) {
+                indent(level);
+            }
+            put(TokenTraits::object_close_token);
+        }
+
+    private:
+        static constexpr std::size_t max_number_length = buffer_type::min_capacity;
+
+        template <std::size_t N>
+        void put(const std::array<char_type, N>& token) {
+            buffer_.write(token.data(), N);
+        }
+
+        void indent(int level) {
+            if ((flags()&pretty_print) != 0) {
+                buffer_.put(TokenTraits::newline_token[0]);
+                for (int i = 0; i < level; ++i) {
+                    buffer_.put(TokenTraits::tab_token[0]);
+                }
+            }
+        }
+
+        template <typename S, typename InEncoding, typename Encoding>
+        void write_string(const S& str, InEncoding, Encoding) {
+            const auto first = str.data();
+            detail::write_string(buffer_, first, first + str.size(), InEncoding(), Encoding(), (flags()&escape_solidus) != 0);
+        }
+
+    private:
+        buffer_type buffer_;
+    };
+
+
+    //
+    //  void write_buffered(const Value& value, Sink& sink, unsigned int fmtflags, Encoding encoding)
+    //
+    //  Serializes the value through a buffered_writer into the given sink, and
+    //  flushes the output buffer.
+    //
+    //  Example:
+    //
+    //      std::string s;
+    //      json::string_sink sink(s);
+    //      json::write_buffered(value, sink, json::writer_base::pretty_print);
+    //
+    template <typename Value, typename Sink, typename Encoding = json::unicode::UTF_8_encoding_tag>
+    inline void
+    write_buffered(const Value& value, Sink& sink, unsigned int fmtflags = 0, Encoding = json::unicode::UTF_8_encoding)
+    {
+        buffered_writer<Value, Sink, Encoding> w(sink, fmtflags);
+        w.write(value);
+        w.flush();
+    }
+
+} // namespace json
+
+
+
+#endif // JSON_GENERATOR_BUFFERED_WRITER_HPP
@@ -26,7 +26,9 @@
 #include "json/unicode/unicode_utilities.hpp"
 #include "json/unicode/unicode_converter.hpp"
 #include "json/endian/byte_swap.hpp"
+#include "json/simd/escape_scan.hpp"
 #include <algorithm>
+#include <iterator>
 #include <cassert>
 #include <type_traits>
 
@@ -118,6 +120,11 @@ namespace json { namespace generator_internal {
     // Requirements:
     // The Unicode sequence starting with first shall be valid Unicode. Other-
     // wise the behavior is undefined.
+    //
+    // If the input is UTF-8 and InIteratorT is a pointer, the encoder scans 
+    // ahead for the next character which needs to be escaped or converted
+    // (see json::simd::find_escape()) and copies the characters before it in
+    // bulk. Only the remaining characters take the slow path.
     
     // TODO: implement feature "Escape Non-ASCII" 
     
@@ -162,6 +169,42 @@ namespace json { namespace generator_internal {
             *dest++ = swap(encoding_traits<UTF_8_encoding_tag>::to_uint(ch));
         }
         
+        // True, if the input can be scanned ahead with find_escape():
+        typedef std::integral_constant<bool,
+            std::is_pointer<InIteratorT>::value
+            and sizeof(typename std::iterator_traits<InIteratorT>::value_type) == 1
+            and std::is_same<InEncodingT, UTF_8_encoding_tag>::value
+        > is_scannable;
+        
+        // Non-ASCII characters need a conversion unless the output is UTF-8, 
+        // too. In this case, they will be copied unchanged.
+        static constexpr bool copy_non_ascii = std::is_same<OutEncodingT, UTF_8_encoding_tag>::value;
+        
+        // Returns the position of the first character in [first, last) which
+        // requires to be escaped or converted.
+        static InIteratorT scan(InIteratorT first, InIteratorT last, unsigned int options, std::true_type) {
+            const char* p = reinterpret_cast<const char*>(first);
+            const char* q = json::simd::find_escape(p, reinterpret_cast<const char*>(last), 
+                                                    (options & EscapeSolidus) != 0, not copy_non_ascii);
+            return first + (q - p);
+        }
+        
+        static InIteratorT scan(InIteratorT first, InIteratorT, unsigned int, std::false_type) {
+            return first;
+        }
+        
+        // Copies a run of characters which require neither escaping nor
+        // conversion.
+        void write_run(InIteratorT first, InIteratorT last, OutIteratorT& dest, std::true_type) const {
+            dest = std::copy(first, last, dest);
+        }
+        
+        void write_run(InIteratorT first, InIteratorT last, OutIteratorT& dest, std::false_type) const {
+            while (first != last) {
+                *dest++ = swap(encoding_traits<UTF_8_encoding_tag>::to_uint(*first++));
+            }
+        }
+        
     public:
         
         
@@ -178,6 +221,16 @@ namespace json { namespace generator_internal {
             
             while (first != last) 
             {
+                if (is_scannable::value) {
+                    InIteratorT run_end = scan(first, last, options, is_scannable());
+                    if (run_end != first) {
+                        write_run(first, run_end, dest, 
+                                  std::integral_constant<bool, sizeof(out_char_type) == 1>());
+                        first = run_end;
+                        if (first == last)
+                            break;
+                    }
+                }
                 unsigned int ch = encoding_traits<InEncodingT>::to_uint(*first); // ch in platform endianness
                 if (__builtin_expect(ch < 0x80, 1))  // ASCII character inclusive Unicode NULL and control codes
                 {
@@ -202,12 +255,12 @@ namespace json { namespace generator_internal {
                         default:
                             if (ch < 0x20u) {
                                 // escape a control character
-                                buffer[0] = '\n';
+                                buffer[0] = '\\';
                                 buffer[1] = 'u';
                                 buffer[2] = '0';
                                 buffer[3] = '0';
-                                buffer[4] = ((ch >> 4)+'0');
-                                buffer[5] = ((ch & 0x0Fu)+'0');
+                                buffer[4] = "0123456789ABCDEF"[ch >> 4];
+                                buffer[5] = "0123456789ABCDEF"[ch & 0x0Fu];
                                 endBuffer = &buffer[6];
                             }
                             else {
@@ -328,12 +381,12 @@ namespace json { namespace generator_internal {
             default:
                 if (ch < 0x20u) {
                     // escape a control character
-                    *endEscaped++ = '\n';
+                    *endEscaped++ = '\\';
                     *endEscaped++ = 'u';
                     *endEscaped++ = '0';
                     *endEscaped++ = '0';
-                    *endEscaped++ = ((ch >> 4)+'0');
-                    *endEscaped++ = ((ch & 0x0Fu)+'0');
+                    *endEscaped++ = "0123456789ABCDEF"[ch >> 4];
+                    *endEscaped++ = "0123456789ABCDEF"[ch & 0x0Fu];
                 }
                 else {
                     // unescaped
@@ -0,0 +1,574 @@
+//
+//  parallel_writer.hpp
+//
+//
+//  Created by agent on 10/18/26.
+//
+//
+
+#ifndef JSON_GENERATOR_PARALLEL_WRITER_HPP
+#define JSON_GENERATOR_PARALLEL_WRITER_HPP
+
+#include "json/config.hpp"
+#include "json/unicode/unicode_traits.hpp"
+#include "generate.hpp"
+#include "token_traits.hpp"
+#include "write_value.hpp"
+#include "buffered_writer.hpp"
+#include <vector>
+#include <memory>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+#include <type_traits>
+#include <cassert>
+#include <sys/uio.h>
+
+
+
+namespace json { namespace detail {
+
+    // Detects whether a sink provides vectored output:
+    //   void writev(struct iovec* iov, int count);
+    template <typename Sink>
+    struct has_writev
+    {
+    private:
+        template <typename S>
+        static auto test(int) -> decltype(std::declval<S&>().writev(static_cast<struct iovec*>(nullptr), 0), std::true_type());
+        template <typename>
+        static std::false_type test(...);
+    public:
+        static constexpr bool value = decltype(test<Sink>(0))::value;
+    };
+
+}}
+
+
+namespace json {
+
+    //
+    //  struct parallel_write_options
+    //
+    //  threads:        The number of worker threads. Zero selects the number
+    //                  of hardware threads.
+    //
+    //  min_range:      Arrays and objects with at least twice as many elements
+    //                  are divided into ranges of at least min_range elements,
+    //                  which will be serialized concurrently.
+    //
+    //  max_depth:      Smaller arrays and objects up to this nesting level are
+    //                  looked into in order to find large containers. Beyond
+    //                  this level, a container will be serialized as a whole.
+    //
+    struct parallel_write_options
+    {
+        parallel_write_options()
+        : threads(0), min_range(256), max_depth(2)
+        {}
+
+        unsigned int    threads;
+        std::size_t     min_range;
+        int             max_depth;
+    };
+
+
+    //
+    //  class parallel_writer
+    //
+    //  Serializes a JSON value using a pool of worker threads.
+    //
+    //  First, the writer divides the value into an ordered sequence of
+    //  segments: large arrays and objects are divided into element ranges,
+    //  each of which will be serialized by a worker into its own buffer,
+    //  while the text between them (brackets, separators, indentation, and
+    //  the keys and scalars of small containers) is generated in place.
+    //  Then, the workers serialize the ranges, and the calling thread passes
+    //  the finished segments in order to the sink - using vectored output if
+    //  the sink supports it.
+    //
+    //  The worker threads are started by the first write() which needs them,
+    //  and they are kept until the writer is destroyed. Thus, a writer which
+    //  serializes many documents creates its threads only once.
+    //
+    //  The output is identical to what json::write_value() produces.
+    //
+    //  `OutEncoding` specifies the encoding of the output; the character type
+    //  of the sink shall match its code unit.
+    //
+    template <typename Value, typename Sink, typename OutEncoding = json::unicode::UTF_8_encoding_tag>
+    class parallel_writer : public writer_base
+    {
+        static_assert(std::is_same<json::unicode::escaped_unicode_encoding_t, OutEncoding>::value
+                      or std::is_base_of<json::unicode::utf_encoding_tag, OutEncoding>::value, "");
+
+        typedef typename std::conditional<std::is_same<
+            json::unicode::escaped_unicode_encoding_t, OutEncoding>::value,
+            json::unicode::UTF_8_encoding_tag,
+        OutEncoding>::type                              out_encoding_type;
+
+        typedef typename encoding_traits<out_encoding_type>::code_unit_type char_type;
+
+        using TokenTraits = typename json::token_traits<out_encoding_type>;
+
+        typedef std::vector<char_type>                  buffer_type;
+        typedef std::back_insert_iterator<buffer_type>  iterator;
+        typedef detail::writer<Value, iterator, OutEncoding> writer_type;
+
+    public:
+        typedef typename Value::array_type              Array;
+        typedef typename Value::object_type             Object;
+        typedef typename Value::key_type                Key;
+
+    private:
+        typedef typename detail::map_char_type_to_unicode_encoding<typename Key::value_type>::encoding key_encoding_type;
+
+        struct segment
+        {
+            segment() : ready(false) {}
+            std::function<void(buffer_type&)>   job;
+            buffer_type                         buffer;
+            std::exception_ptr                  error;
+            bool                                ready;
+        };
+
+        typedef std::vector<std::unique_ptr<segment>> segments_type;
+
+    public:
+
+        parallel_writer(Sink& sink, fmtflags flags = 0, parallel_write_options options = parallel_write_options())
+        : writer_base(flags), sink_(sink), options_(options)
+        {
+            if (options_.threads == 0) {
+                options_.threads = std::max(1u, std::thread::hardware_concurrency());
+            }
+            options_.min_range = std::max(options_.min_range, std::size_t(1));
+        }
+
+        ~parallel_writer()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            work_cond_.notify_all();
+            for (std::thread& t : workers_) {
+                t.join();
+            }
+        }
+
+        parallel_writer(const parallel_writer&) = delete;
+        parallel_writer& operator=(const parallel_writer&) = delete;
+
+        // Serializes the value and passes the complete output to the sink.
+        void write(const Value& value)
+        {
+            segments_.clear();
+            jobs_.clear();
+            plan(value, 0, 0);
+            run();
+            segments_.clear();
+            jobs_.clear();
+        }
+
+    private:
+
+        // Planning
+
+        void plan(const Value& value, int level, int depth)
+        {
+            if (value.is_array()) {
+                const Array& array = value.template as<Array>();
+                if (array.size() >= 2 * options_.min_range) {
+                    split(array, level);
+                    return;
+                }
+                if (depth < options_.max_depth) {
+                    plan_array(array, level, depth);
+                    return;
+                }
+            }
+            else if (value.is_object()) {
+                const Object& obj = value.template as<Object>();
+                if (obj.size() >= 2 * options_.min_range) {
+                    split(obj, level);
+                    return;
+                }
+                if (depth < options_.max_depth) {
+                    plan_object(obj, level, depth);
+                    return;
+                }
+            }
+            else {
+                // Scalars are generated in place.
+                write_element(literal(), value, level);
+                return;
+            }
+            add_job([this, &value, level](buffer_type& buffer) {
+                write_element(buffer, value, level);
+            });
+        }
+
+        void plan_array(const Array& array, int level, int depth)
+        {
+            put(literal(), TokenTraits::array_open_token);
+            std::size_t count = array.size();
+            for (const Value& x : array) {
+                indent(literal(), level + 1);
+                plan(x, level + 1, depth + 1);
+                if (--count > 0) {
+                    put(literal(), TokenTraits::comma_token);
+                }
+            }
+            if (array.size()) {
+                indent(literal(), level);
+            }
+            put(literal(), TokenTraits::array_close_token);
+        }
+
+        void plan_object(const Object& obj, int level, int depth)
+        {
+            put(literal(), TokenTraits::object_open_token);
+            std::size_t count = obj.size();
+            for (const auto& kv : obj) {
+                indent(literal(), level + 1);
+                write_key(literal(), kv.first);
+                plan(kv.second, level + 1, depth + 1);
+                if (--count > 0) {
+                    put(literal(), TokenTraits::comma_token);
+                }
+            }
+            if (obj.size()) {
+                indent(literal(), level);
+            }
+            put(literal(), TokenTraits::object_close_token);
+        }
+
+        // Divides a large container into ranges of elements, each of which
+        // will be serialized by a job.
+        template <typename Container>
+        void split(const Container& c, int level)
+        {
+            typedef typename Container::const_iterator const_iterator;
+            const std::size_t count = c.size();
+            const std::size_t range = std::max(options_.min_range, count / (8 * options_.threads) + 1);
+            const bool is_object = std::is_same<Container, Object>::value;
+
+            if (is_object)
+                put(literal(), TokenTraits::object_open_token);
+            else
+                put(literal(), TokenTraits::array_open_token);
+
+            const_iterator first = c.begin();
+            std::size_t index = 0;
+            while (index < count) {
+                const std::size_t n = std::min(range, count - index);
+                const_iterator last = first;
+                std::advance(last, n);
+                const bool is_last = index + n == count;
+                add_job([this, first, last, level, is_last](buffer_type& buffer) {
+                    write_range(buffer, first, last, level + 1, is_last);
+                });
+                first = last;
+                index += n;
+            }
+
+            indent(literal(), level);
+            if (is_object)
+                put(literal(), TokenTraits::object_close_token);
+            else
+                put(literal(), TokenTraits::array_close_token);
+        }
+
+        // Returns the buffer of the current literal segment, which will be
+        // created if the last segment is a job.
+        buffer_type& literal()
+        {
+            if (segments_.empty() or segments_.back()->job) {
+                segments_.emplace_back(new segment);
+                segments_.back()->ready = true;
+            }
+            return segments_.back()->buffer;
+        }
+
+        void add_job(std::function<void(buffer_type&)> job)
+        {
+            segments_.emplace_back(new segment);
+            segments_.back()->job = std::move(job);
+            jobs_.push_back(segments_.back().get());
+        }
+
+
+        // Serialization
+
+        template <std::size_t N>
+        static void put(buffer_type& buffer, const std::array<char_type, N>& token) {
+            buffer.insert(buffer.end(), token.begin(), token.end());
+        }
+
+        void indent(buffer_type& buffer, int level) const {
+            if ((flags()&pretty_print) != 0) {
+                buffer.push_back(TokenTraits::newline_token[0]);
+                buffer.insert(buffer.end(), level, TokenTraits::tab_token[0]);
+            }
+        }
+
+        // Writes the key of an object member and the name separator, exactly
+        // as detail::writer does.
+        void write_key(buffer_type& buffer, const Key& key) const
+        {
+            using json::generator_internal::encode_string;
+
+            put(buffer, TokenTraits::quote_token);
+            auto first = key.data();
+            auto last = first + key.size();
+            iterator dest(buffer);
+            const unsigned int options = (flags()&escape_solidus) ? generator_internal::string_encoder_base::EscapeSolidus : 0;
+#if !defined (NDEBUG)
+            int cvt_result =
+#endif
+            encode_string(first, last, key_encoding_type(), dest, out_encoding_type(), options);
+            assert(cvt_result == 0);
+            put(buffer, TokenTraits::quote_token);
+            if ((flags()&pretty_print) != 0) {
+                put(buffer, TokenTraits::space_token);
+                put(buffer, TokenTraits::colon_token);
+                put(buffer, TokenTraits::space_token);
+            }
+            else {
+                put(buffer, TokenTraits::colon_token);
+            }
+        }
+
+        void write_element(buffer_type& buffer, const Value& value, int level) const
+        {
+            writer_type w(flags());
+            value.apply_visitor(w, iterator(buffer), level);
+        }
+
+        void write_member(buffer_type& buffer, const Value& value, int level) const {
+            write_element(buffer, value, level);
+        }
+
+        template <typename Pair>
+        void write_member(buffer_type& buffer, const Pair& kv, int level) const {
+            write_key(buffer, kv.first);
+            write_element(buffer, kv.second, level);
+        }
+
+        // Writes the elements of a range, each preceded by its indentation
+        // and followed by a separator - unless it is the last element of
+        // the container.
+        template <typename Iterator>
+        void write_range(buffer_type& buffer, Iterator first, Iterator last, int level, bool is_last) const
+        {
+            while (first != last) {
+                indent(buffer, level);
+                write_member(buffer, *first, level);
+                ++first;
+                if (first != last or not is_last) {
+                    put(buffer, TokenTraits::comma_token);
+                }
+            }
+        }
+
+
+        // Execution
+
+        void run()
+        {
+            if (jobs_.empty()) {
+                emit_all();
+                return;
+            }
+            const std::size_t nthreads = std::min(static_cast<std::size_t>(options_.threads), jobs_.size());
+            if (nthreads <= 1) {
+                for (segment* s : jobs_) {
+                    s->job(s->buffer);
+                    s->ready = true;
+                }
+                emit_all();
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                while (workers_.size() < nthreads) {
+                    const std::size_t generation = generation_;
+                    workers_.emplace_back([this, generation]() { worker_main(generation); });
+                }
+                next_job_ = 0;
+                canceled_ = false;
+                busy_ = workers_.size();
+                ++generation_;
+            }
+            work_cond_.notify_all();
+            try {
+                emit_all();
+            }
+            catch (...) {
+                canceled_ = true;
+                wait_idle();
+                throw;
+            }
+            wait_idle();
+        }
+
+        // Waits until all workers have finished the jobs of the current
+        // write(), so that the segments can be released.
+        void wait_idle()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [this]() { return busy_ == 0; });
+        }
+
+        // The loop of a worker thread: runs the jobs of each write().
+        void worker_main(std::size_t generation)
+        {
+            for (;;) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    work_cond_.wait(lock, [&]() { return stop_ or generation_ != generation; });
+                    if (stop_)
+                        return;
+                    generation = generation_;
+                }
+                work();
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    --busy_;
+                }
+                cond_.notify_all();
+            }
+        }
+
+        // Runs on a worker thread.
+        void work()
+        {
+            while (not canceled_) {
+                const std::size_t i = next_job_++;
+                if (i >= jobs_.size())
+                    break;
+                segment* s = jobs_[i];
+                try {
+                    s->job(s->buffer);
+                }
+                catch (...) {
+                    s->error = std::current_exception();
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    s->ready = true;
+                }
+                cond_.notify_all();
+            }
+        }
+
+        // Passes the segments in order to the sink, as soon as they are
+        // ready. Consecutive ready segments will be written at once.
+        void emit_all()
+        {
+            const std::size_t count = segments_.size();
+            std::size_t i = 0;
+            while (i < count) {
+                std::size_t last = i;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cond_.wait(lock, [&]() { return segments_[i]->ready; });
+                    while (last < count and segments_[last]->ready and last - i < max_batch) {
+                        ++last;
+                    }
+                }
+                for (std::size_t k = i; k < last; ++k) {
+                    if (segments_[k]->error) {
+                        std::rethrow_exception(segments_[k]->error);
+                    }
+                }
+                emit(i, last, std::integral_constant<bool, detail::has_writev<Sink>::value and sizeof(char_type) == 1>());
+                for (std::size_t k = i; k < last; ++k) {
+                    buffer_type().swap(segments_[k]->buffer);
+                }
+                i = last;
+            }
+        }
+
+        void emit(std::size_t first, std::size_t last, std::false_type)
+        {
+            for (; first != last; ++first) {
+                const buffer_type& buffer = segments_[first]->buffer;
+                if (not buffer.empty()) {
+                    sink_.write(buffer.data(), buffer.size());
+                }
+            }
+        }
+
+        void emit(std::size_t first, std::size_t last, std::true_type)
+        {
+            struct iovec iov[max_batch];
+            int count = 0;
+            for (; first != last; ++first) {
+                buffer_type& buffer = segments_[first]->buffer;
+                if (not buffer.empty()) {
+                    iov[count].iov_base = buffer.data();
+                    iov[count].iov_len = buffer.size();
+                    ++count;
+                }
+            }
+            if (count) {
+                sink_.writev(iov, count);
+            }
+        }
+
+    private:
+        static constexpr std::size_t max_batch = 64;
+
+        Sink&                       sink_;
+        parallel_write_options      options_;
+        segments_type               segments_;
+        std::vector<segment*>       jobs_;
+        std::atomic<std::size_t>    next_job_;
+        std::atomic<bool>           canceled_;
+        std::mutex                  mutex_;
+        std::condition_variable     cond_;          // a segment is ready, or a worker is idle
+        std::condition_variable     work_cond_;     // a write() has jobs, or the writer stops
+        std::vector<std::thread>    workers_;
+        std::size_t                 generation_ = 0;    // the number of write() calls with workers
+        std::size_t                 busy_ = 0;          // workers in the current write()
+        bool                        stop_ = false;
+    };
+
+    template <typename Value, typename Sink, typename OutEncoding>
+    constexpr std::size_t parallel_writer<Value, Sink, OutEncoding>::max_batch;
+
+
+    //
+    //  void write_parallel(const Value& value, Sink& sink, unsigned int fmtflags,
+    //                      Encoding encoding, parallel_write_options options)
+    //
+    //  Serializes the value through a parallel_writer into the given sink.
+    //
+    //  Example:
+    //
+    //      json::fd_sink sink(fd);
+    //      json::write_parallel(document, sink, json::writer_base::pretty_print);
+    //
+    template <typename Value, typename Sink, typename Encoding = json::unicode::UTF_8_encoding_tag>
+    inline void
+    write_parallel(const Value& value, Sink& sink, unsigned int fmtflags = 0,
+                   Encoding = json::unicode::UTF_8_encoding,
+                   parallel_write_options options = parallel_write_options())
+    {
+        parallel_writer<Value, Sink, Encoding> w(sink, fmtflags, options);
+        w.write(value);
+    }
+
+} // namespace json
+
+
+
+#endif // JSON_GENERATOR_PARALLEL_WRITER_HPP
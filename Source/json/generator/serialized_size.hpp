@@ -0,0 +1,387 @@
+//
+//  serialized_size.hpp
+//
+//
+//  Created by agent on 10/18/26.
+//
+//
+
+#ifndef JSON_GENERATOR_SERIALIZED_SIZE_HPP
+#define JSON_GENERATOR_SERIALIZED_SIZE_HPP
+
+#include "json/config.hpp"
+#include "json/utility/number_to_string.hpp"
+#include "json/unicode/unicode_traits.hpp"
+#include "json/simd/escape_scan.hpp"
+#include "generate.hpp"
+#include "token_traits.hpp"
+#include "write_value.hpp"
+#include <string>
+#include <unordered_map>
+#include <iterator>
+#include <cstddef>
+#include <cassert>
+
+
+
+namespace json { namespace detail {
+
+    //
+    //  An output iterator which counts the number of code units assigned to it.
+    //
+    template <typename CharT>
+    struct counting_iterator
+    {
+        typedef std::output_iterator_tag   iterator_category;
+        typedef void                        value_type;
+        typedef void                        difference_type;
+        typedef void                        pointer;
+        typedef void                        reference;
+
+        explicit counting_iterator(std::size_t& count) : count_(&count) {}
+        counting_iterator& operator=(CharT) { ++*count_; return *this; }
+        counting_iterator& operator*()      { return *this; }
+        counting_iterator& operator++()     { return *this; }
+        counting_iterator& operator++(int)  { return *this; }
+    private:
+        std::size_t* count_;
+    };
+
+
+    //
+    //  The size of a serialized subtree, independent of its level of
+    //  indentation. When pretty printing, the actual size of a subtree at
+    //  level `n` equals `length + lines * n`, where `lines` is the number of
+    //  indented line breaks within the subtree.
+    //
+    struct size_measure
+    {
+        std::size_t length;
+        std::size_t lines;
+
+        std::size_t at_level(std::size_t level) const { return length + lines * level; }
+    };
+
+
+    template <typename Value, typename Encoding>
+    struct size_counter;
+
+}}
+
+
+
+namespace json {
+
+    //
+    //  class serialized_size_cache
+    //
+    //  Remembers the measured sizes of arrays and objects with at least
+    //  `threshold` elements, so that measuring a large document repeatedly
+    //  only visits the parts which are not cached.
+    //
+    //  The entries are keyed by the address of the array or object. Thus,
+    //  the entry of a container - and the entries of all containers enclosing
+    //  it - shall be erased when it has been modified or destroyed. A cache
+    //  is bound to the format flags and encoding it has been used with last;
+    //  using it with different flags or a different encoding clears it.
+    //
+    class serialized_size_cache
+    {
+        template <typename Value, typename Encoding> friend struct detail::size_counter;
+
+    public:
+        static constexpr std::size_t default_threshold = 64;
+
+        explicit serialized_size_cache(std::size_t threshold = default_threshold)
+        : threshold_(threshold), flags_(0), encoding_(nullptr)
+        {}
+
+        std::size_t threshold() const   { return threshold_; }
+        std::size_t size() const        { return map_.size(); }
+
+        void clear() { map_.clear(); }
+        void erase(const void* container) { map_.erase(container); }
+
+    private:
+        void bind(unsigned int flags, const void* encoding) {
+            if (flags != flags_ or encoding != encoding_) {
+                map_.clear();
+                flags_ = flags;
+                encoding_ = encoding;
+            }
+        }
+
+        const detail::size_measure* find(const void* container) const {
+            auto iter = map_.find(container);
+            return iter == map_.end() ? nullptr : &iter->second;
+        }
+
+        void insert(const void* container, const detail::size_measure& m) {
+            map_[container] = m;
+        }
+
+    private:
+        std::unordered_map<const void*, detail::size_measure> map_;
+        std::size_t     threshold_;
+        unsigned int    flags_;
+        const void*     encoding_;
+    };
+
+    constexpr std::size_t serialized_size_cache::default_threshold;
+
+}
+
+
+
+namespace json { namespace detail {
+
+    //
+    //  struct size_counter
+    //
+    //  A visitor which computes the exact number of code units which
+    //  detail::writer produces for a value. Strings and numbers are measured
+    //  with the same routines the writer uses to generate them; the layout
+    //  of arrays and objects mirrors the writer's.
+    //
+    template <typename Value, typename OutEncoding>
+    struct size_counter : writer_base
+    {
+        typedef typename std::conditional<std::is_same<
+            json::unicode::escaped_unicode_encoding_t, OutEncoding>::value,
+            json::unicode::UTF_8_encoding_tag,
+        OutEncoding>::type                              out_encoding_type;
+
+        typedef typename encoding_traits<out_encoding_type>::code_unit_type char_type;
+
+    public:
+        typedef size_measure result_type;
+
+        typedef typename Value::integral_number_type    IntNumber;
+        typedef typename Value::float_number_type       FloatNumber;
+        typedef typename Value::null_type               Null;
+        typedef typename Value::boolean_type            Boolean;
+        typedef typename Value::string_type             String;
+        typedef typename Value::array_type              Array;
+        typedef typename Value::object_type             Object;
+        typedef typename Value::key_type                Key;
+
+        typedef typename map_char_type_to_unicode_encoding<typename String::value_type>::encoding string_encoding_type;
+        typedef typename map_char_type_to_unicode_encoding<typename Key::value_type>::encoding key_encoding_type;
+
+
+        size_counter(unsigned int flags, serialized_size_cache* cache)
+        : writer_base(flags), cache_(cache)
+        {
+            if (cache_) {
+                static const char encoding_id = 0;
+                cache_->bind(flags, &encoding_id);
+            }
+        }
+
+        size_measure operator()(const Null&) {
+            return scalar(4);
+        }
+
+        size_measure operator()(const Boolean& v) {
+            return scalar(v ? 4 : 5);
+        }
+
+        size_measure operator()(const IntNumber& v) {
+            char buffer[64];
+            return scalar(json::utility::write_number(static_cast<long long>(v), buffer) - buffer);
+        }
+
+        size_measure operator()(const FloatNumber& v) {
+            char buffer[64];
+            return scalar(json::utility::write_number(static_cast<long double>(v), buffer) - buffer);
+        }
+
+        size_measure operator()(const String& str) {
+            return scalar(2 + string_length(str, string_encoding_type(), OutEncoding()));
+        }
+
+        size_measure operator()(const Array& array)
+        {
+            const std::size_t count = array.size();
+            const bool use_cache = cache_ and count >= cache_->threshold();
+            if (use_cache) {
+                if (const size_measure* m = cache_->find(&array))
+                    return *m;
+            }
+            const bool pretty = (flags()&pretty_print) != 0;
+            size_measure result = {2, 0};
+            for (const Value& x : array) {
+                add_child(result, x.apply_visitor(*this));
+            }
+            if (count) {
+                result.length += count - 1;     // commas
+                if (pretty) {
+                    // A line break and indentation per element and before the
+                    // closing bracket.
+                    result.length += 2 * count + 1;
+                    result.lines += count + 1;
+                }
+            }
+            if (use_cache) {
+                cache_->insert(&array, result);
+            }
+            return result;
+        }
+
+        size_measure operator()(const Object& obj)
+        {
+            const std::size_t count = obj.size();
+            const bool use_cache = cache_ and count >= cache_->threshold();
+            if (use_cache) {
+                if (const size_measure* m = cache_->find(&obj))
+                    return *m;
+            }
+            const bool pretty = (flags()&pretty_print) != 0;
+            size_measure result = {2, 0};
+            for (const auto& iter : obj) {
+                // Note: the writer encodes keys to out_encoding_type.
+                result.length += 2 + string_length(iter.first, key_encoding_type(), out_encoding_type());
+                result.length += pretty ? 3 : 1;
+                add_child(result, iter.second.apply_visitor(*this));
+            }
+            if (count) {
+                result.length += count - 1;
+                if (pretty) {
+                    result.length += 2 * count + 1;
+                    result.lines += count + 1;
+                }
+            }
+            if (use_cache) {
+                cache_->insert(&obj, result);
+            }
+            return result;
+        }
+
+    private:
+        static size_measure scalar(std::size_t n) {
+            size_measure result = {n, 0};
+            return result;
+        }
+
+        // Adds the size of an element which is one level deeper.
+        static void add_child(size_measure& m, const size_measure& child) {
+            m.length += child.at_level(1);
+            m.lines += child.lines;
+        }
+
+        // Fast path: UTF-8 to UTF-8. Counts the escape sequences which the
+        // string encoder generates.
+        template <typename S>
+        typename std::enable_if<std::is_same<typename S::value_type, char>::value, std::size_t>::type
+        string_length(const S& str, json::unicode::UTF_8_encoding_tag, json::unicode::UTF_8_encoding_tag)
+        {
+            const bool escapeSolidus = (flags()&escape_solidus) != 0;
+            const char* first = str.data();
+            const char* last = first + str.size();
+            std::size_t result = str.size();
+            while (first != last) {
+                first = json::simd::find_escape(first, last, escapeSolidus);
+                if (first == last)
+                    break;
+                switch (*first) {
+                    case '"': case '\\': case '/':
+                    case '\b': case '\f': case '\n': case '\r': case '\t':
+                        result += 1;
+                        break;
+                    default:
+                        result += 5;
+                }
+                ++first;
+            }
+            return result;
+        }
+
+        // Generic path: runs the string encoder on a counting iterator.
+        template <typename S, typename InEncoding, typename Encoding>
+        std::size_t string_length(const S& str, InEncoding, Encoding)
+        {
+            using json::generator_internal::encode_string;
+
+            std::size_t result = 0;
+            auto first = str.data();
+            auto last = first + str.size();
+            counting_iterator<char_type> dest(result);
+            const unsigned int options = (flags()&escape_solidus) ? generator_internal::string_encoder_base::EscapeSolidus : 0;
+#if !defined (NDEBUG)
+            int cvt_result =
+#endif
+            encode_string(first, last, InEncoding(), dest, Encoding(), options);
+            assert(cvt_result == 0);
+            return result;
+        }
+
+    private:
+        serialized_size_cache* cache_;
+    };
+
+}}
+
+
+
+namespace json {
+
+    //
+    //  std::size_t serialized_size(const Value& value, unsigned int fmtflags,
+    //                              Encoding encoding, serialized_size_cache* cache)
+    //
+    //  Returns the exact number of code units which json::write_value()
+    //  generates for the value with the given format flags and encoding.
+    //
+    //  If a cache is given, the sizes of large arrays and objects will be
+    //  looked up in respectively stored into the cache.
+    //
+    template <typename Value, typename Encoding = json::unicode::UTF_8_encoding_tag>
+    inline std::size_t
+    serialized_size(const Value& value, unsigned int fmtflags = 0,
+                    Encoding = json::unicode::UTF_8_encoding,
+                    serialized_size_cache* cache = nullptr)
+    {
+        detail::size_counter<Value, Encoding> counter(fmtflags, cache);
+        return value.apply_visitor(counter).length;
+    }
+
+
+    //
+    //  void write_value_exact(const Value& value, std::basic_string<CharT>& s,
+    //                         unsigned int fmtflags, Encoding encoding)
+    //
+    //  Appends the serialized value to the string. The string will be resized
+    //  once to its final size, and the output will be written through a
+    //  pointer - without the checks and reallocations of a back insert
+    //  iterator.
+    //
+    //  The size is measured without a serialized_size_cache: a stale cached
+    //  size would let the writer overrun the string.
+    //
+    //  The character type of the string shall match the code unit of the
+    //  encoding.
+    //
+    template <typename Value, typename CharT, typename Encoding = json::unicode::UTF_8_encoding_tag>
+    inline void
+    write_value_exact(const Value& value, std::basic_string<CharT>& s,
+                      unsigned int fmtflags = 0,
+                      Encoding encoding = json::unicode::UTF_8_encoding)
+    {
+        const std::size_t n = serialized_size(value, fmtflags, encoding);
+        if (n == 0)
+            return;
+        const std::size_t offset = s.size();
+        s.resize(offset + n);
+        CharT* first = &s[offset];
+#if !defined (NDEBUG)
+        CharT* last =
+#endif
+        write_value(value, first, fmtflags, encoding);
+        assert(last == first + n);
+    }
+
+} // namespace json
+
+
+
+#endif // JSON_GENERATOR_SERIALIZED_SIZE_HPP
@@ -0,0 +1,308 @@
+//
+//  stream_writer.hpp
+//
+//
+//  Created by agent on 10/18/26.
+//
+//
+
+#ifndef JSON_GENERATOR_STREAM_WRITER_HPP
+#define JSON_GENERATOR_STREAM_WRITER_HPP
+
+#include "json/config.hpp"
+#include "json/utility/number_to_string.hpp"
+#include "json/unicode/unicode_traits.hpp"
+#include "token_traits.hpp"
+#include "write_value.hpp"
+#include "buffered_writer.hpp"
+#include <string>
+#include <vector>
+#include <cstring>
+#include <type_traits>
+#include <cassert>
+
+
+
+namespace json {
+
+    //
+    //  class stream_writer
+    //
+    //  A "SAX-style" writer which generates JSON text from a sequence of calls,
+    //  without the need to build a json::value first:
+    //
+    //      std::string s;
+    //      json::string_sink sink(s);
+    //      json::stream_writer<json::string_sink> w(sink);
+    //      w.begin_object();
+    //      w.key("id").value(1);
+    //      w.key("tags").begin_array().value("a").value("b").end_array();
+    //      w.end_object();
+    //      w.flush();
+    //
+    //  The output will be written into an internal output_buffer which will be
+    //  flushed to the sink. The buffer will not be flushed when the writer is
+    //  destroyed - flush() shall be called explicitly.
+    //
+    //  Strings passed to key() and value() shall be UTF-8 encoded. They will be
+    //  escaped exactly as json::write_value() does. The output of a sequence of
+    //  calls equals the output of json::write_value() for the equivalent
+    //  json::value - provided the same format flags are used and the keys of
+    //  objects are written in the same order.
+    //
+    //  raw() writes a value verbatim, which shall be valid JSON text.
+    //
+    //  The writer tracks the nesting of arrays and objects. In debug builds it
+    //  asserts that the sequence of calls is valid, that is, keys are only
+    //  written within objects and are followed by exactly one value, end_array()
+    //  and end_object() match their begin counterparts, and no more than one
+    //  top level value will be written.
+    //
+    //  `OutEncoding` shall be either UTF-8 or the "escaped unicode" encoding
+    //  which escapes all non-ASCII characters.
+    //
+    template <typename Sink, typename OutEncoding = json::unicode::UTF_8_encoding_tag>
+    class stream_writer : public writer_base
+    {
+        static_assert(std::is_same<json::unicode::escaped_unicode_encoding_t, OutEncoding>::value
+                      or std::is_same<json::unicode::UTF_8_encoding_tag, OutEncoding>::value, "");
+
+        typedef json::unicode::UTF_8_encoding_tag       out_encoding_type;
+        typedef char                                    char_type;
+        typedef json::token_traits<out_encoding_type>   TokenTraits;
+
+    public:
+        typedef output_buffer<char_type, Sink>          buffer_type;
+
+        stream_writer(Sink& sink, fmtflags flags = 0, std::size_t buffer_size = buffer_type::default_capacity)
+        : writer_base(flags), buffer_(sink, buffer_size), expect_value_(false), complete_(false)
+        {}
+
+        stream_writer(const stream_writer&) = delete;
+        stream_writer& operator=(const stream_writer&) = delete;
+
+
+        stream_writer& begin_object() {
+            begin_value();
+            put(TokenTraits::object_open_token);
+            frames_.push_back(frame(object_frame));
+            return *this;
+        }
+
+        stream_writer& end_object() {
+            assert(not frames_.empty() and frames_.back().kind == object_frame and "end_object() without matching begin_object()");
+            assert(not expect_value_ and "key without value");
+            end_container(TokenTraits::object_close_token);
+            return *this;
+        }
+
+        stream_writer& begin_array() {
+            begin_value();
+            put(TokenTraits::array_open_token);
+            frames_.push_back(frame(array_frame));
+            return *this;
+        }
+
+        stream_writer& end_array() {
+            assert(not frames_.empty() and frames_.back().kind == array_frame and "end_array() without matching begin_array()");
+            end_container(TokenTraits::array_close_token);
+            return *this;
+        }
+
+
+        stream_writer& key(const char* s, std::size_t len)
+        {
+            assert(not frames_.empty() and frames_.back().kind == object_frame and "key() outside of an object");
+            assert(not expect_value_ and "key without value");
+            next_element();
+            // Like write_value(), keys are never written as escaped Unicode:
+            write_string(s, len, out_encoding_type());
+            if ((flags()&pretty_print) != 0) {
+                put(TokenTraits::space_token);
+                put(TokenTraits::colon_token);
+                put(TokenTraits::space_token);
+            }
+            else {
+                put(TokenTraits::colon_token);
+            }
+            expect_value_ = true;
+            return *this;
+        }
+
+        stream_writer& key(const char* s) {
+            return key(s, std::strlen(s));
+        }
+
+        stream_writer& key(const std::string& s) {
+            return key(s.data(), s.size());
+        }
+
+
+        stream_writer& null() {
+            begin_value();
+            put(TokenTraits::null_token);
+            end_value();
+            return *this;
+        }
+
+        stream_writer& value(bool v) {
+            begin_value();
+            if (v)
+                put(TokenTraits::true_token);
+            else
+                put(TokenTraits::false_token);
+            end_value();
+            return *this;
+        }
+
+        // Integral numbers, except bool.
+        template <typename T>
+        typename std::enable_if<
+            std::is_integral<T>::value and not std::is_same<T, bool>::value,
+            stream_writer&
+        >::type
+        value(T v) {
+            typedef typename std::conditional<std::is_signed<T>::value, long long, unsigned long long>::type number_type;
+            begin_value();
+            char_type* p = buffer_.reserve(max_number_length);
+            buffer_.commit(json::utility::write_number(static_cast<number_type>(v), p));
+            end_value();
+            return *this;
+        }
+
+        template <typename T>
+        typename std::enable_if<std::is_floating_point<T>::value, stream_writer&>::type
+        value(T v) {
+            begin_value();
+            char_type* p = buffer_.reserve(max_number_length);
+            buffer_.commit(json::utility::write_number(static_cast<long double>(v), p));
+            end_value();
+            return *this;
+        }
+
+        stream_writer& value(const char* s, std::size_t len) {
+            begin_value();
+            write_string(s, len);
+            end_value();
+            return *this;
+        }
+
+        stream_writer& value(const char* s) {
+            return value(s, std::strlen(s));
+        }
+
+        stream_writer& value(const std::string& s) {
+            return value(s.data(), s.size());
+        }
+
+
+        // Writes the JSON text [s, s+len) verbatim as a value.
+        stream_writer& raw(const char* s, std::size_t len) {
+            begin_value();
+            buffer_.write(s, len);
+            end_value();
+            return *this;
+        }
+
+        stream_writer& raw(const std::string& s) {
+            return raw(s.data(), s.size());
+        }
+
+
+        // Passes the buffered output to the sink.
+        void flush() {
+            buffer_.flush();
+        }
+
+        // Returns the number of open arrays and objects.
+        std::size_t depth() const { return frames_.size(); }
+
+        // Returns true if a complete top level value has been written.
+        bool complete() const { return complete_; }
+
+    private:
+        enum frame_kind { array_frame, object_frame };
+
+        struct frame {
+            explicit frame(frame_kind k) : kind(k), empty(true) {}
+            frame_kind kind;
+            bool empty;
+        };
+
+        static constexpr std::size_t max_number_length = buffer_type::min_capacity;
+
+        template <std::size_t N>
+        void put(const std::array<char_type, N>& token) {
+            buffer_.write(token.data(), N);
+        }
+
+        void indent(std::size_t level) {
+            if ((flags()&pretty_print) != 0) {
+                buffer_.put(TokenTraits::newline_token[0]);
+                for (std::size_t i = 0; i < level; ++i) {
+                    buffer_.put(TokenTraits::tab_token[0]);
+                }
+            }
+        }
+
+        // Writes the separator and indentation for the next element of the
+        // current array or object.
+        void next_element() {
+            frame& f = frames_.back();
+            if (not f.empty) {
+                put(TokenTraits::comma_token);
+            }
+            f.empty = false;
+            indent(frames_.size());
+        }
+
+        void begin_value() {
+            if (frames_.empty()) {
+                assert(not complete_ and "more than one top level value");
+            }
+            else if (frames_.back().kind == object_frame) {
+                assert(expect_value_ and "value within an object without key");
+                expect_value_ = false;
+            }
+            else {
+                next_element();
+            }
+        }
+
+        void end_value() {
+            if (frames_.empty()) {
+                complete_ = true;
+            }
+        }
+
+        template <std::size_t N>
+        void end_container(const std::array<char_type, N>& token) {
+            const bool empty = frames_.back().empty;
+            frames_.pop_back();
+            if (not empty) {
+                indent(frames_.size());
+            }
+            put(token);
+            end_value();
+        }
+
+        template <typename Encoding = OutEncoding>
+        void write_string(const char* s, std::size_t len, Encoding = Encoding()) {
+            detail::write_string(buffer_, s, s + len, json::unicode::UTF_8_encoding_tag(), Encoding(), (flags()&escape_solidus) != 0);
+        }
+
+    private:
+        buffer_type         buffer_;
+        std::vector<frame>  frames_;
+        bool                expect_value_;
+        bool                complete_;
+    };
+
+    template <typename Sink, typename OutEncoding>
+    constexpr std::size_t stream_writer<Sink, OutEncoding>::max_number_length;
+
+} // namespace json
+
+
+
+#endif // JSON_GENERATOR_STREAM_WRITER_HPP
@@ -201,9 +201,9 @@ namespace json { namespace detail {
         {
             using json::generator_internal::encode_string;
             
-            std::copy(TokenTraits::quote_token.cbegin(), TokenTraits::quote_token.cend(), dest);
-            auto first = str.begin();
-            auto last = str.end();
+            dest = std::copy(TokenTraits::quote_token.cbegin(), TokenTraits::quote_token.cend(), dest);
+            auto first = str.data();
+            auto last = first + str.size();
             const unsigned int options = (flags()&escape_solidus) ? generator_internal::string_encoder_base::EscapeSolidus : 0;
 #if !defined (NDEBUG)
             int cvt_result =
@@ -220,7 +220,7 @@ namespace json { namespace detail {
             OutputIterator result = std::copy(TokenTraits::array_open_token.cbegin(), TokenTraits::array_open_token.cend(), dest);
             ++level;
             std::size_t count = array.size();
-            for (Value x : array) {
+            for (const Value& x : array) {
                 if ((flags()&pretty_print) != 0) {
                     result = std::fill_n(result, 1, TokenTraits::newline_token[0]);
                     result = std::fill_n(result, level, TokenTraits::tab_token[0]);
@@ -245,14 +245,14 @@ namespace json { namespace detail {
             OutputIterator result = std::copy(TokenTraits::object_open_token.cbegin(), TokenTraits::object_open_token.cend(), dest);
             ++level;
             std::size_t count = obj.size();
-            for (auto iter : obj) {
+            for (const auto& iter : obj) {
                 if ((flags()&pretty_print) != 0) {
                     result = std::fill_n(result, 1, TokenTraits::newline_token[0]);
                     result = std::fill_n(result, level, TokenTraits::tab_token[0]);
                 }
-                std::copy(TokenTraits::quote_token.cbegin(), TokenTraits::quote_token.cend(), dest);
-                auto first = iter.first.begin();
-                auto last = iter.first.end();
+                result = std::copy(TokenTraits::quote_token.cbegin(), TokenTraits::quote_token.cend(), result);
+                auto first = iter.first.data();
+                auto last = first + iter.first.size();
                 const unsigned int options = (flags()&escape_solidus) ? generator_internal::string_encoder_base::EscapeSolidus : 0;
 #if !defined (NDEBUG)
                 int cvt_result =
@@ -0,0 +1,271 @@
+//
+//  path_stack.hpp
+//
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#ifndef JSON_JSON_PATH_PATH_STACK_HPP
+#define JSON_JSON_PATH_PATH_STACK_HPP
+
+
+#include "json/config.hpp"
+#include "json/unicode/unicode_traits.hpp"
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace json { namespace json_internal {
+
+    using json::unicode::encoding_traits;
+
+
+    //
+    //  class path_stack
+    //
+    //  The path of the current value while parsing: a stack of keys and
+    //  indices, starting at the root. The code units of the keys are stored
+    //  contiguously in a single buffer, and each component refers to its key
+    //  by offset and length. Thus, once the buffers have grown to the depth
+    //  and key lengths of the documents, pushing and popping a component
+    //  neither allocates nor copies anything but the key itself.
+    //
+    //  Along with each component, the stack maintains a rolling hash of the
+    //  path up to and including that component. The hash of a path can be
+    //  computed in advance with root_hash(), combine_key() and
+    //  combine_index(), so that a consumer can route values with a hash
+    //  lookup instead of comparing paths:
+    //
+    //      typedef path_stack<UTF_8_encoding_tag> path_t;
+    //      path_t::hash_type h = path_t::combine_index(path_t::combine_key(path_t::root_hash(), "items", 5), 0);
+    //      ...
+    //      if (path.hash() == h and path.level() == 2) ...
+    //
+    //  Hashes of different paths may collide, so a match should be verified
+    //  with the components if that matters.
+    //
+    template <typename EncodingT, typename IndexT = std::size_t>
+    class path_stack
+    {
+    public:
+        typedef EncodingT                                               encoding_type;
+        typedef typename encoding_traits<EncodingT>::code_unit_type     char_type;
+        typedef IndexT                                                  index_type;
+        typedef std::uint64_t                                           hash_type;
+        typedef std::pair<const char_type*, std::size_t>                key_type;
+
+    private:
+        static const std::size_t npos = static_cast<std::size_t>(-1);
+
+        struct component_t {
+            std::size_t     key_offset;     // npos for an index
+            std::size_t     key_size;       // or the index
+            hash_type       hash;           // of the path up to and including this component
+        };
+
+        // FNV-1a, 64 bit
+        static hash_type mix(hash_type h, std::uint64_t v) {
+            return (h ^ v) * 1099511628211ULL;
+        }
+
+        // Distinguishes a key from an index with the same code units.
+        enum { KeyTag = 1, IndexTag = 2 };
+
+    public:
+        path_stack() {}
+
+        // The hash of the root.
+        static hash_type root_hash() { return 14695981039346656037ULL; }
+
+        // The hash of the path h followed by the key [s, s + size).
+        static hash_type combine_key(hash_type h, const char_type* s, std::size_t size) {
+            h = mix(h, KeyTag);
+            for (std::size_t i = 0; i < size; ++i) {
+                h = mix(h, static_cast<typename std::make_unsigned<char_type>::type>(s[i]));
+            }
+            return mix(h, size);
+        }
+
+        // The hash of the path h followed by the index.
+        static hash_type combine_index(hash_type h, index_type index) {
+            return mix(mix(h, IndexTag), static_cast<std::uint64_t>(index));
+        }
+
+        // Appends the key. The key is copied.
+        void push_key(const char_type* s, std::size_t size) {
+            component_t c = { keys_.size(), size, combine_key(hash(), s, size) };
+            keys_.insert(keys_.end(), s, s + size);
+            components_.push_back(c);
+        }
+
+        // Appends the index.
+        void push_index(index_type index) {
+            component_t c = { npos, static_cast<std::size_t>(index), combine_index(hash(), index) };
+            components_.push_back(c);
+        }
+
+        // Removes the last component.
+        void pop() {
+            assert(not components_.empty());
+            if (components_.back().key_offset != npos)
+                keys_.resize(components_.back().key_offset);
+            components_.pop_back();
+        }
+
+        // Removes all components, the path becomes the root.
+        void clear() {
+            components_.clear();
+            keys_.clear();
+        }
+
+        // The number of components, zero for the root.
+        std::size_t level() const               { return components_.size(); }
+        bool empty() const                      { return components_.empty(); }
+
+        // The hash of the path.
+        hash_type hash() const {
+            return components_.empty() ? root_hash() : components_.back().hash;
+        }
+
+        // The hash of the first n components of the path.
+        hash_type hash(std::size_t n) const {
+            assert(n <= components_.size());
+            return n == 0 ? root_hash() : components_[n - 1].hash;
+        }
+
+        // Returns true if the component at position pos is a key, otherwise
+        // it is an index.
+        bool is_key(std::size_t pos) const {
+            assert(pos < components_.size());
+            return components_[pos].key_offset != npos;
+        }
+
+        // Returns the key at position pos. The key is valid until the
+        // component is popped.
+        key_type key(std::size_t pos) const {
+            assert(is_key(pos));
+            return key_type(keys_.data() + components_[pos].key_offset, components_[pos].key_size);
+        }
+
+        // Returns the index at position pos.
+        index_type index(std::size_t pos) const {
+            assert(not is_key(pos));
+            return static_cast<index_type>(components_[pos].key_size);
+        }
+
+        // Returns true if both paths have the same components. The hashes are
+        // compared first, so that a mismatch is usually cheap.
+        bool equal(const path_stack& other) const {
+            if (level() != other.level() or hash() != other.hash())
+                return false;
+            for (std::size_t i = 0; i < components_.size(); ++i) {
+                if (is_key(i) != other.is_key(i))
+                    return false;
+                if (is_key(i)) {
+                    key_type k0 = key(i);
+                    key_type k1 = other.key(i);
+                    if (k0.second != k1.second or not std::equal(k0.first, k0.first + k0.second, k1.first))
+                        return false;
+                } else if (index(i) != other.index(i)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Appends the components of a path of the form `$.key[0]['key']`,
+        // where a key in brackets may also be enclosed in double quotes. 
+        // Keys are copied byte by byte into code units, so they should be 
+        // ASCII unless the encoding is UTF-8. Returns false if the path is 
+        // malformed; then the components are unspecified.
+        bool parse(const std::string& expression) {
+            std::string::const_iterator p = expression.begin();
+            const std::string::const_iterator last = expression.end();
+            if (p == last or *p++ != '$')
+                return false;
+            std::basic_string<char_type> k;
+            while (p != last) {
+                if (*p == '.') {
+                    std::string::const_iterator first = ++p;
+                    while (p != last and *p != '.' and *p != '[')
+                        ++p;
+                    if (p == first)
+                        return false;
+                    k.assign(first, p);
+                    push_key(k.data(), k.size());
+                } else if (*p == '[') {
+                    if (++p == last)
+                        return false;
+                    if (*p == '\'' or *p == '"') {
+                        const char quote = *p++;
+                        std::string::const_iterator first = p;
+                        while (p != last and *p != quote)
+                            ++p;
+                        if (p == last)
+                            return false;
+                        k.assign(first, p++);
+                        push_key(k.data(), k.size());
+                    } else {
+                        if (*p < '0' or *p > '9')
+                            return false;
+                        index_type index = 0;
+                        while (p != last and *p >= '0' and *p <= '9')
+                            index = index * 10 + static_cast<index_type>(*p++ - '0');
+                        push_index(index);
+                    }
+                    if (p == last or *p++ != ']')
+                        return false;
+                } else {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Writes the path in the form `$['key'][0]`. Keys are written code
+        // unit by code unit, as is.
+        void write(std::ostream& os) const {
+            os << '$';
+            for (std::size_t i = 0; i < components_.size(); ++i) {
+                if (is_key(i)) {
+                    key_type k = key(i);
+                    os << "['";
+                    for (std::size_t j = 0; j < k.second; ++j)
+                        os << static_cast<char>(k.first[j]);
+                    os << "']";
+                } else {
+                    os << '[' << index(i) << ']';
+                }
+            }
+        }
+
+    private:
+        std::vector<component_t>    components_;
+        std::vector<char_type>      keys_;
+    };
+
+
+}}  // namespace json::json_internal
+
+
+#endif  // JSON_JSON_PATH_PATH_STACK_HPP
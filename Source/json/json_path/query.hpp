@@ -0,0 +1,1340 @@
+//
+//  query.hpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#ifndef JSON_JSON_PATH_QUERY_HPP
+#define JSON_JSON_PATH_QUERY_HPP
+
+
+#include "json/config.hpp"
+#include "json/parser/semantic_actions_base.hpp"
+#include "json/value/value.hpp"
+#include "json/utility/arena_allocator.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+//
+//  JSONPath Queries
+//
+//  A json::jsonpath::query is compiled from a JSONPath expression and then
+//  evaluated by a query_generator while the parser runs. Only the values
+//  which match the query are created - the document itself is never built.
+//
+//  Example:
+//
+//      json::jsonpath::query q("$.store.book[?(@.price < 10)].title");
+//      json::jsonpath::query_generator<> sa(q, [](const json::value<>& v) {
+//          std::cout << v << std::endl;
+//      });
+//      json::parse(first, last, sa);
+//
+//  Supported syntax:
+//
+//      $                   the root
+//      .name  ['name']     child with the given key
+//      ['a','b']           union of keys
+//      [0]  [0,2]          array element(s)
+//      [start:end:step]    array slice, each part optional
+//      .*  [*]             all children
+//      ..name  ..*  ..[]   recursive descent
+//      [?(filter)]         children for which the filter holds
+//
+//  A filter is a sequence of conditions combined with && and ||, where a
+//  condition is either `@path` (the path exists) or `@path op literal` with
+//  op one of ==, !=, <, <=, >, >= and literal a number, a quoted string,
+//  true, false or null. `@path` is relative to the child, e.g. `@.price`,
+//  `@['name']`, `@[0]` or just `@`.
+//
+//  Since the length of an array is not known until its end, negative
+//  indices are not supported.
+//
+//  Many queries can be evaluated in a single pass with a query_set, which
+//  merges them into one automaton. The match handler receives the ids of
+//  all queries (subscriptions) a value matches:
+//
+//      json::jsonpath::query_set queries;
+//      std::size_t id = queries.add("$.orders[*].id");
+//      ...
+//      json::jsonpath::query_set_generator<> sa(queries,
+//          [](const std::vector<std::size_t>& ids, const json::value<>& v) {
+//              ...
+//          });
+//      json::parse(first, last, sa);
+//
+
+
+namespace json { namespace jsonpath {
+
+
+    // Thrown when a JSONPath expression is malformed or not supported.
+    class query_error : public std::runtime_error
+    {
+    public:
+        query_error(const std::string& what, std::size_t position)
+        : std::runtime_error(what), position_(position)
+        {}
+
+        // The position in the expression where the error has been detected.
+        std::size_t position() const { return position_; }
+
+    private:
+        std::size_t position_;
+    };
+
+
+    namespace query_detail {
+
+        // A component of a relative path in a filter, e.g. `.price` or `[0]`.
+        struct component
+        {
+            bool            is_index;
+            std::string     name;
+            std::size_t     index;
+        };
+
+        enum op_type {
+            OpExists,
+            OpEqual,
+            OpNotEqual,
+            OpLess,
+            OpLessEqual,
+            OpGreater,
+            OpGreaterEqual
+        };
+
+        struct literal
+        {
+            enum kind_type { Number, String, True, False, Null };
+
+            kind_type       kind;
+            double          number;
+            std::string     string;
+        };
+
+        struct condition
+        {
+            std::vector<component>  path;
+            op_type                 op;
+            literal                 value;
+        };
+
+        // A filter is a disjunction of conjunctions of conditions.
+        typedef std::vector<condition>      conjunction;
+        typedef std::vector<conjunction>    filter;
+
+
+        struct slice
+        {
+            std::size_t start;
+            std::size_t end;
+            std::size_t step;
+
+            bool contains(std::size_t i) const {
+                return i >= start and i < end and (i - start) % step == 0;
+            }
+        };
+
+
+        //
+        //  A step of the query selects children of the current node. A step
+        //  with a filter selects every child, and the filter decides later -
+        //  once the child is complete.
+        //
+        struct step
+        {
+            step() : descendant(false), wildcard(false) {}
+
+            bool is_filter() const { return not filter.empty(); }
+
+            bool matches(const char* key, std::size_t len) const
+            {
+                if (wildcard)
+                    return true;
+                for (const std::string& name : names) {
+                    if (name.size() == len and std::memcmp(name.data(), key, len) == 0)
+                        return true;
+                }
+                return false;
+            }
+
+            bool matches(std::size_t index) const
+            {
+                if (wildcard)
+                    return true;
+                if (std::find(indices.begin(), indices.end(), index) != indices.end())
+                    return true;
+                for (const slice& s : slices) {
+                    if (s.contains(index))
+                        return true;
+                }
+                return false;
+            }
+
+            bool                        descendant;  // preceded by ".."
+            bool                        wildcard;
+            std::vector<std::string>    names;
+            std::vector<std::size_t>    indices;
+            std::vector<slice>          slices;
+            query_detail::filter        filter;
+            std::string                 text;        // the step in the expression
+        };
+
+
+        //
+        //  Recursive descent compiler for JSONPath expressions.
+        //
+        class compiler
+        {
+        public:
+            explicit compiler(const std::string& expression)
+            : s_(expression), p_(0)
+            {}
+
+            std::vector<step> compile()
+            {
+                std::vector<step> steps;
+                skip_whitespaces();
+                expect('$');
+                while (skip_whitespaces(), p_ < s_.size()) {
+                    const std::size_t start = p_;
+                    step st;
+                    if (consume(".")) {
+                        if (consume(".")) {
+                            st.descendant = true;
+                            if (peek() == '[') {
+                                bracket(st);
+                            } else {
+                                dot_name(st);
+                            }
+                        } else {
+                            dot_name(st);
+                        }
+                    } else if (peek() == '[') {
+                        bracket(st);
+                    } else {
+                        fail("expected '.' or '['");
+                    }
+                    st.text = s_.substr(start, p_ - start);
+                    steps.push_back(std::move(st));
+                }
+                return steps;
+            }
+
+        private:
+            char peek() const { return p_ < s_.size() ? s_[p_] : '\0'; }
+
+            bool consume(const char* token) {
+                const std::size_t len = std::strlen(token);
+                if (s_.compare(p_, len, token) == 0) {
+                    p_ += len;
+                    return true;
+                }
+                return false;
+            }
+
+            void expect(char c) {
+                if (peek() != c)
+                    fail(std::string("expected '") + c + "'");
+                ++p_;
+            }
+
+            void skip_whitespaces() {
+                while (p_ < s_.size() and (s_[p_] == ' ' or s_[p_] == '\t' or s_[p_] == '\n' or s_[p_] == '\r'))
+                    ++p_;
+            }
+
+            void fail(const std::string& message) const {
+                throw query_error("json::jsonpath::query: " + message + " at position "
+                                  + std::to_string(p_) + " in '" + s_ + "'", p_);
+            }
+
+            // .name or .*
+            void dot_name(step& st) {
+                if (consume("*")) {
+                    st.wildcard = true;
+                    return;
+                }
+                // Keys containing any of these characters require the bracket notation:
+                const char* const delimiters = ".[]()&|=!<>, \t\n\r";
+                const std::size_t first = p_;
+                while (p_ < s_.size() and std::strchr(delimiters, s_[p_]) == nullptr)
+                    ++p_;
+                if (p_ == first)
+                    fail("expected a name");
+                st.names.push_back(s_.substr(first, p_ - first));
+            }
+
+            // [*], [?(...)], or a union of names, indices and slices.
+            void bracket(step& st) {
+                expect('[');
+                skip_whitespaces();
+                if (consume("*")) {
+                    st.wildcard = true;
+                } else if (consume("?")) {
+                    skip_whitespaces();
+                    const bool paren = consume("(");
+                    st.filter = parse_filter();
+                    skip_whitespaces();
+                    if (paren)
+                        expect(')');
+                } else {
+                    do {
+                        skip_whitespaces();
+                        if (peek() == '\'' or peek() == '"') {
+                            st.names.push_back(quoted());
+                        } else {
+                            index_or_slice(st);
+                        }
+                        skip_whitespaces();
+                    } while (consume(","));
+                }
+                skip_whitespaces();
+                expect(']');
+            }
+
+            std::string quoted() {
+                const char quote = s_[p_++];
+                std::string result;
+                while (p_ < s_.size() and s_[p_] != quote) {
+                    if (s_[p_] == '\\' and p_ + 1 < s_.size())
+                        ++p_;
+                    result.push_back(s_[p_++]);
+                }
+                expect(quote);
+                return result;
+            }
+
+            bool integer(std::size_t& result) {
+                if (peek() == '-')
+                    fail("negative indices are not supported");
+                const std::size_t first = p_;
+                std::size_t n = 0;
+                while (p_ < s_.size() and s_[p_] >= '0' and s_[p_] <= '9') {
+                    n = n * 10 + static_cast<std::size_t>(s_[p_] - '0');
+                    ++p_;
+                }
+                if (p_ == first)
+                    return false;
+                result = n;
+                return true;
+            }
+
+            void index_or_slice(step& st) {
+                slice sl = { 0, std::numeric_limits<std::size_t>::max(), 1 };
+                const bool has_start = integer(sl.start);
+                skip_whitespaces();
+                if (not consume(":")) {
+                    if (not has_start)
+                        fail("expected an index, a slice or a quoted name");
+                    st.indices.push_back(sl.start);
+                    return;
+                }
+                skip_whitespaces();
+                integer(sl.end);
+                skip_whitespaces();
+                if (consume(":")) {
+                    skip_whitespaces();
+                    if (integer(sl.step) and sl.step == 0)
+                        fail("slice step shall not be zero");
+                }
+                st.slices.push_back(sl);
+            }
+
+            filter parse_filter() {
+                filter result;
+                do {
+                    conjunction c;
+                    do {
+                        skip_whitespaces();
+                        c.push_back(parse_condition());
+                        skip_whitespaces();
+                    } while (consume("&&"));
+                    result.push_back(std::move(c));
+                } while (consume("||"));
+                return result;
+            }
+
+            condition parse_condition() {
+                condition c;
+                expect('@');
+                while (true) {
+                    component comp;
+                    comp.is_index = false;
+                    comp.index = 0;
+                    if (peek() == '.' and p_ + 1 < s_.size() and s_[p_ + 1] != '.') {
+                        ++p_;
+                        step st;
+                        dot_name(st);
+                        if (st.wildcard)
+                            fail("wildcards are not supported in filters");
+                        comp.name = st.names.front();
+                    } else if (peek() == '[') {
+                        ++p_;
+                        skip_whitespaces();
+                        if (peek() == '\'' or peek() == '"') {
+                            comp.name = quoted();
+                        } else {
+                            comp.is_index = true;
+                            if (not integer(comp.index))
+                                fail("expected an index or a quoted name");
+                        }
+                        skip_whitespaces();
+                        expect(']');
+                    } else {
+                        break;
+                    }
+                    c.path.push_back(std::move(comp));
+                }
+                skip_whitespaces();
+                if      (consume("==")) c.op = OpEqual;
+                else if (consume("!=")) c.op = OpNotEqual;
+                else if (consume("<=")) c.op = OpLessEqual;
+                else if (consume(">=")) c.op = OpGreaterEqual;
+                else if (consume("<"))  c.op = OpLess;
+                else if (consume(">"))  c.op = OpGreater;
+                else {
+                    c.op = OpExists;
+                    return c;
+                }
+                skip_whitespaces();
+                c.value = parse_literal();
+                return c;
+            }
+
+            literal parse_literal() {
+                literal result;
+                result.number = 0;
+                if (peek() == '\'' or peek() == '"') {
+                    result.kind = literal::String;
+                    result.string = quoted();
+                } else if (consume("true")) {
+                    result.kind = literal::True;
+                } else if (consume("false")) {
+                    result.kind = literal::False;
+                } else if (consume("null")) {
+                    result.kind = literal::Null;
+                } else {
+                    const char* first = s_.c_str() + p_;
+                    char* last;
+                    result.kind = literal::Number;
+                    result.number = std::strtod(first, &last);
+                    if (last == first)
+                        fail("expected a literal");
+                    p_ += static_cast<std::size_t>(last - first);
+                }
+                return result;
+            }
+
+        private:
+            const std::string&  s_;
+            std::size_t         p_;
+        };
+
+
+        //
+        //  Evaluation of filters and steps on complete values
+        //
+
+        template <typename StringT>
+        inline bool equal_string(const StringT& s, const std::string& str) {
+            return s.size() == str.size() and std::equal(s.begin(), s.end(), str.begin());
+        }
+
+        template <typename Value>
+        const Value* resolve(const Value& v, const std::vector<component>& path)
+        {
+            typedef typename Value::object_type Object;
+            typedef typename Value::array_type  Array;
+
+            const Value* p = &v;
+            for (const component& c : path) {
+                if (c.is_index) {
+                    if (not p->is_array() or c.index >= p->template as<Array>().size())
+                        return nullptr;
+                    p = &p->template as<Array>()[c.index];
+                } else {
+                    if (not p->is_object())
+                        return nullptr;
+                    const Object& o = p->template as<Object>();
+                    const Value* child = nullptr;
+                    for (const auto& kv : o) {
+                        if (equal_string(kv.first, c.name)) {
+                            child = &kv.second;
+                            break;
+                        }
+                    }
+                    if (child == nullptr)
+                        return nullptr;
+                    p = child;
+                }
+            }
+            return p;
+        }
+
+        template <typename T>
+        inline bool compare(const T& a, const T& b, op_type op) {
+            switch (op) {
+                case OpEqual:           return a == b;
+                case OpNotEqual:        return not (a == b);
+                case OpLess:            return a < b;
+                case OpLessEqual:       return a < b or a == b;
+                case OpGreater:         return b < a;
+                case OpGreaterEqual:    return b < a or a == b;
+                default:                return true;
+            }
+        }
+
+        template <typename Value>
+        bool test(const condition& c, const Value& v)
+        {
+            typedef typename Value::string_type             String;
+            typedef typename Value::integral_number_type    IntNumber;
+            typedef typename Value::float_number_type       FloatNumber;
+            typedef typename Value::boolean_type            Boolean;
+
+            const Value* p = resolve(v, c.path);
+            if (c.op == OpExists)
+                return p != nullptr;
+            if (p == nullptr)
+                return c.op == OpNotEqual;
+
+            switch (c.value.kind) {
+                case literal::Number: {
+                    double d;
+                    if (p->is_integral_number())
+                        d = static_cast<double>(p->template as<IntNumber>());
+                    else if (p->is_float_number())
+                        d = static_cast<double>(p->template as<FloatNumber>());
+                    else
+                        return c.op == OpNotEqual;
+                    return compare(d, c.value.number, c.op);
+                }
+                case literal::String: {
+                    if (not p->is_string())
+                        return c.op == OpNotEqual;
+                    const String& s = p->template as<String>();
+                    return compare(std::string(s.begin(), s.end()), c.value.string, c.op);
+                }
+                case literal::True:
+                case literal::False: {
+                    if (not p->is_boolean() or (c.op != OpEqual and c.op != OpNotEqual))
+                        return c.op == OpNotEqual;
+                    const bool b = static_cast<bool>(p->template as<Boolean>());
+                    return compare(b, c.value.kind == literal::True, c.op);
+                }
+                case literal::Null:
+                    if (c.op == OpEqual)
+                        return p->is_null();
+                    return c.op == OpNotEqual and not p->is_null();
+            }
+            return false;
+        }
+
+        template <typename Value>
+        bool test(const filter& f, const Value& v)
+        {
+            for (const conjunction& conj : f) {
+                bool result = true;
+                for (const condition& c : conj) {
+                    if (not test(c, v)) {
+                        result = false;
+                        break;
+                    }
+                }
+                if (result)
+                    return true;
+            }
+            return false;
+        }
+
+    }  // namespace query_detail
+
+
+    //
+    //  class query
+    //
+    //  A compiled JSONPath expression. Throws query_error if the expression
+    //  is malformed or not supported.
+    //
+    class query
+    {
+    public:
+        typedef query_detail::step step_type;
+
+        explicit query(const std::string& expression)
+        : expression_(expression), steps_(query_detail::compiler(expression).compile())
+        {}
+
+        const std::string& expression() const           { return expression_; }
+        const std::vector<step_type>& steps() const     { return steps_; }
+
+    private:
+        std::string             expression_;
+        std::vector<step_type>  steps_;
+    };
+
+
+
+    //
+    //  class query_set
+    //
+    //  Many queries (subscriptions) merged into one automaton, so that a
+    //  document is evaluated once for all of them.
+    //
+    //  The steps of the queries form a trie: queries with a common prefix
+    //  share the nodes of the prefix. The children of a node which are
+    //  selected by a single key or index are found with a hash lookup, thus
+    //  the cost of a key does not depend on the number of subscriptions. Any
+    //  other step (unions, slices, wildcards, filters, recursive descent) is
+    //  an edge which is shared by equal steps and tested one by one.
+    //
+    //  While parsing, the automaton is non-deterministic: its states are
+    //  nodes of the trie, each of which may be active only for the steps
+    //  with recursive descent (a node which has been passed on to the
+    //  descendants of the value where it became active).
+    //
+    class query_set
+    {
+    public:
+        typedef std::size_t id_type;
+
+    private:
+        template <typename E, typename A> friend class query_set_generator;
+
+        static const uint32_t npos = static_cast<uint32_t>(-1);
+
+        // Maps names to nodes. Lookups do not allocate.
+        class name_table
+        {
+        public:
+            uint32_t find(const char* s, std::size_t len) const {
+                auto range = map_.equal_range(hash(s, len));
+                for (auto iter = range.first; iter != range.second; ++iter) {
+                    const std::string& name = iter->second.first;
+                    if (name.size() == len and std::memcmp(name.data(), s, len) == 0)
+                        return iter->second.second;
+                }
+                return npos;
+            }
+
+            void insert(const std::string& name, uint32_t node) {
+                map_.insert(std::make_pair(hash(name.data(), name.size()), std::make_pair(name, node)));
+            }
+
+            bool empty() const { return map_.empty(); }
+
+        private:
+            // FNV-1a
+            static std::size_t hash(const char* s, std::size_t len) {
+                uint64_t h = 14695981039346656037ULL;
+                for (std::size_t i = 0; i < len; ++i) {
+                    h = (h ^ static_cast<unsigned char>(s[i])) * 1099511628211ULL;
+                }
+                return static_cast<std::size_t>(h);
+            }
+
+            std::unordered_multimap<std::size_t, std::pair<std::string, uint32_t>> map_;
+        };
+
+        struct edge_t {
+            query_detail::step  step;
+            uint32_t            target;
+        };
+
+        struct node_t {
+            node_t() : has_descendant_edges(false) {}
+
+            std::vector<id_type>                accept;     // subscriptions which end here
+            name_table                          names;
+            name_table                          descendant_names;
+            std::unordered_map<std::size_t, uint32_t> indices;
+            std::vector<edge_t>                 edges;
+            bool                                has_descendant_edges;
+        };
+
+        // A filter edge whose filter decides on a candidate.
+        typedef std::pair<uint32_t, uint32_t>   filter_ref;     // node, edge index
+
+        struct key_component {
+            const char*     data;
+            std::size_t     size;
+
+            uint32_t find(const node_t& node) const { return node.names.find(data, size); }
+            uint32_t find_descendant(const node_t& node) const { return node.descendant_names.find(data, size); }
+            bool matches(const query_detail::step& st) const { return st.matches(data, size); }
+        };
+
+        struct index_component {
+            std::size_t     index;
+
+            uint32_t find(const node_t& node) const {
+                auto iter = node.indices.find(index);
+                if (iter == node.indices.end())
+                    return npos;
+                return iter->second;
+            }
+            uint32_t find_descendant(const node_t&) const { return npos; }
+            bool matches(const query_detail::step& st) const { return st.matches(index); }
+        };
+
+    public:
+        query_set() : nodes_(1), size_(0) {}
+
+        // Adds a subscription and returns its id. Ids are consecutive
+        // numbers starting at zero.
+        id_type add(const query& q)
+        {
+            uint32_t n = 0;
+            for (const query_detail::step& st : q.steps())
+            {
+                const bool simple = not st.wildcard and not st.is_filter() and st.slices.empty()
+                                    and st.names.size() + st.indices.size() == 1;
+                if (simple and st.names.size() == 1) {
+                    name_table& table = st.descendant ? nodes_[n].descendant_names : nodes_[n].names;
+                    uint32_t target = table.find(st.names[0].data(), st.names[0].size());
+                    if (target == npos) {
+                        target = new_node();
+                        (st.descendant ? nodes_[n].descendant_names : nodes_[n].names).insert(st.names[0], target);
+                    }
+                    if (st.descendant)
+                        nodes_[n].has_descendant_edges = true;
+                    n = target;
+                }
+                else if (simple and not st.descendant) {
+                    auto iter = nodes_[n].indices.find(st.indices[0]);
+                    if (iter == nodes_[n].indices.end()) {
+                        const uint32_t target = new_node();
+                        nodes_[n].indices[st.indices[0]] = target;
+                        n = target;
+                    } else {
+                        n = iter->second;
+                    }
+                }
+                else {
+                    uint32_t target = npos;
+                    for (const edge_t& e : nodes_[n].edges) {
+                        if (e.step.text == st.text) {
+                            target = e.target;
+                            break;
+                        }
+                    }
+                    if (target == npos) {
+                        target = new_node();
+                        edge_t e = { st, target };
+                        nodes_[n].edges.push_back(std::move(e));
+                        if (st.descendant)
+                            nodes_[n].has_descendant_edges = true;
+                    }
+                    n = target;
+                }
+            }
+            nodes_[n].accept.push_back(size_);
+            return size_++;
+        }
+
+        id_type add(const std::string& expression) {
+            return add(query(expression));
+        }
+
+        // The number of subscriptions.
+        std::size_t size() const            { return size_; }
+
+        // The number of nodes of the trie.
+        std::size_t node_count() const      { return nodes_.size(); }
+
+    private:
+        uint32_t new_node() {
+            nodes_.push_back(node_t());
+            return static_cast<uint32_t>(nodes_.size() - 1);
+        }
+
+        const query_detail::step& filter_step(const filter_ref& f) const {
+            return nodes_[f.first].edges[f.second].step;
+        }
+
+        uint32_t filter_target(const filter_ref& f) const {
+            return nodes_[f.first].edges[f.second].target;
+        }
+
+        // The state of a node which is active for all its steps, or only for
+        // the steps with recursive descent.
+        static uint32_t state(uint32_t node, bool descendant_only = false) {
+            return (node << 1) | (descendant_only ? 1u : 0u);
+        }
+        static uint32_t node_of(uint32_t state)             { return state >> 1; }
+        static bool is_descendant_only(uint32_t state)      { return (state & 1u) != 0; }
+
+        static void add_state(std::vector<uint32_t>& states, std::size_t first, uint32_t s) {
+            if (std::find(states.begin() + first, states.end(), s) == states.end())
+                states.push_back(s);
+        }
+
+        // Appends the states of the child c to states, given the states
+        // [first, last) of its container. The filter edges for which the
+        // child is a candidate are appended to filters.
+        // The source states may be a range of states itself, thus they are
+        // accessed by index.
+        template <typename ComponentT>
+        void transition(const std::vector<uint32_t>& source, std::size_t first, std::size_t last,
+                        const ComponentT& c, std::vector<uint32_t>& states, std::vector<filter_ref>& filters) const
+        {
+            const std::size_t states_begin = states.size();
+            const std::size_t filters_begin = filters.size();
+            for (; first != last; ++first)
+            {
+                const uint32_t n = node_of(source[first]);
+                const bool descendant_only = is_descendant_only(source[first]);
+                const node_t& node = nodes_[n];
+                uint32_t target;
+                if (not descendant_only and (target = c.find(node)) != npos)
+                    add_state(states, states_begin, state(target));
+                if ((target = c.find_descendant(node)) != npos)
+                    add_state(states, states_begin, state(target));
+                for (uint32_t i = 0; i < node.edges.size(); ++i) {
+                    const edge_t& e = node.edges[i];
+                    if (descendant_only and not e.step.descendant)
+                        continue;
+                    if (e.step.is_filter()) {
+                        const filter_ref f(n, i);
+                        if (std::find(filters.begin() + filters_begin, filters.end(), f) == filters.end())
+                            filters.push_back(f);
+                    }
+                    else if (c.matches(e.step)) {
+                        add_state(states, states_begin, state(e.target));
+                    }
+                }
+                if (node.has_descendant_edges)
+                    add_state(states, states_begin, state(n, true));
+            }
+        }
+
+        // Appends a match for each subscription which ends in one of the
+        // states [first, last).
+        template <typename Value>
+        void accept(const uint32_t* first, const uint32_t* last, const Value& v,
+                    std::vector<std::pair<const Value*, id_type>>& matches) const
+        {
+            for (; first != last; ++first) {
+                if (is_descendant_only(*first))
+                    continue;
+                for (id_type id : nodes_[node_of(*first)].accept)
+                    matches.push_back(std::make_pair(&v, id));
+            }
+        }
+
+        // Evaluates the states of the complete value v on its descendants.
+        template <typename Value>
+        void evaluate(const std::vector<uint32_t>& states, const Value& v,
+                      std::vector<std::pair<const Value*, id_type>>& matches) const
+        {
+            typedef typename Value::object_type Object;
+            typedef typename Value::array_type  Array;
+
+            if (v.is_object()) {
+                for (const auto& kv : v.template as<Object>()) {
+                    const key_component c = { kv.first.data(), kv.first.size() };
+                    evaluate_child(states, c, kv.second, matches);
+                }
+            } else if (v.is_array()) {
+                const Array& a = v.template as<Array>();
+                for (std::size_t i = 0; i < a.size(); ++i) {
+                    const index_component c = { i };
+                    evaluate_child(states, c, a[i], matches);
+                }
+            }
+        }
+
+        template <typename ComponentT, typename Value>
+        void evaluate_child(const std::vector<uint32_t>& states, const ComponentT& c, const Value& child,
+                            std::vector<std::pair<const Value*, id_type>>& matches) const
+        {
+            std::vector<uint32_t> child_states;
+            std::vector<filter_ref> filters;
+            transition(states, 0, states.size(), c, child_states, filters);
+            for (const filter_ref& f : filters) {
+                if (query_detail::test(filter_step(f).filter, child))
+                    add_state(child_states, 0, state(filter_target(f)));
+            }
+            if (child_states.empty())
+                return;
+            accept(child_states.data(), child_states.data() + child_states.size(), child, matches);
+            evaluate(child_states, child, matches);
+        }
+
+    private:
+        std::vector<node_t>     nodes_;
+        std::size_t             size_;
+    };
+
+
+
+    //
+    //  class query_set_generator
+    //
+    //  Semantic actions which evaluate a query set while parsing. The match
+    //  handler receives each matching value together with the ids of all
+    //  subscriptions it matches, in ascending order. Matches which depend on
+    //  the filter of an enclosing value are only known once that value is
+    //  complete; they are reported with a separate call.
+    //
+    //  Each key and index the parser encounters is a transition from the
+    //  states of the container to the states of the child. A value is only
+    //  created if it matches or if it is a candidate of a filter; everything
+    //  else is skipped without any allocation.
+    //
+    //  Values are passed to the handler when they are complete, thus a value
+    //  which is nested in another matching value is passed first. The steps
+    //  after a filter are evaluated on the (complete) candidate, where the
+    //  members of an object are visited in the order of the object's keys.
+    //
+    //  The generator keeps a copy of the query set. The string buffer
+    //  encoding shall be UTF-8.
+    //
+    template <
+        typename EncodingT = json::unicode::UTF_8_encoding_tag,
+        typename AllocatorT = std::allocator<void>
+    >
+    class query_set_generator :
+        public semantic_actions_base<query_set_generator<EncodingT, AllocatorT>, EncodingT>
+    {
+        typedef semantic_actions_base<query_set_generator<EncodingT, AllocatorT>, EncodingT> base;
+
+        static_assert(sizeof(typename base::char_t) == 1, "The string buffer encoding shall be UTF-8");
+
+    public:
+        typedef typename base::error_t                  error_t;
+        typedef typename base::number_desc_t            number_desc_t;
+        typedef typename base::char_t                   char_t;
+        typedef typename base::const_buffer_t           const_buffer_t;
+        typedef void                                    result_type;
+
+        typedef json::value<AllocatorT>                 Value;
+        typedef typename Value::array_type              Array;
+        typedef typename Value::object_type             Object;
+        typedef typename Value::string_type             String;
+
+        typedef query_set::id_type                      id_type;
+        typedef std::function<void(const std::vector<id_type>& ids, const Value& v)> match_handler_t;
+
+    private:
+        typedef std::vector<Value>                      stack_t;
+        typedef std::vector<size_t>                     markers_t;
+        typedef std::vector<char_t>                     string_temp_buffer_t;
+        typedef query_set::filter_ref                   filter_ref;
+
+        // The states and filter candidates of a node are ranges in the flat
+        // vectors states_ and filters_.
+        struct node_t {
+            uint32_t    states_begin;
+            uint32_t    states_end;
+            uint32_t    filters_begin;
+            uint32_t    filters_end;
+            bool        capture;
+        };
+
+    public:
+
+        query_set_generator(query_set queries, match_handler_t handler = match_handler_t(), const AllocatorT& a = AllocatorT())
+        :   queries_(std::move(queries)), handler_(std::move(handler)), allocator_(a),
+            capture_depth_(0), match_count_(0)
+        {
+        }
+
+        // Sets or gets the match handler.
+        void                        match_handler(match_handler_t handler) { handler_ = std::move(handler); }
+        const match_handler_t&      match_handler() const       { return handler_; }
+
+        const query_set&            queries() const             { return queries_; }
+
+        // The number of values which have been passed to the handler.
+        size_t  match_count() const                             { return match_count_; }
+
+
+        void parse_begin_imp() {
+            error_.reset();
+            reset();
+            states_.push_back(query_set::state(0));
+            pending_ = make_node(0, 0);
+        }
+
+        void parse_end_imp() {}
+
+        void finished_imp() {}
+
+        void begin_array_imp()
+        {
+            begin_container();
+            if (capture_depth_ > 0) {
+                stack_.emplace_back(Array(allocator_));
+                markers_.push_back(stack_.size() - 1);
+            }
+        }
+
+        void end_array_imp()
+        {
+            if (capture_depth_ > 0) {
+                size_t first_idx = markers_.back();
+                markers_.pop_back();
+                typename stack_t::iterator array_iter = stack_.begin() + first_idx;
+                typename stack_t::iterator first = array_iter + 1;
+                Array& a = (*array_iter).template interpret_as<Array>();
+                a.reserve(std::distance(first, stack_.end()));
+                a.insert(a.end(), std::make_move_iterator(first), std::make_move_iterator(stack_.end()));
+                stack_.erase(first, stack_.end());
+            }
+            end_container();
+        }
+
+        void begin_object_imp()
+        {
+            begin_container();
+            if (capture_depth_ > 0) {
+                stack_.emplace_back(Object(allocator_));
+                markers_.push_back(stack_.size() - 1);
+            }
+        }
+
+        bool end_object_imp()
+        {
+            bool duplicateKeyError = false;
+            if (capture_depth_ > 0) {
+                // See value_generator::end_object_imp() for the layout of the stack.
+                typedef typename stack_t::iterator stack_iter;
+                typedef typename Object::iterator obj_iter;
+
+                size_t first_idx = markers_.back();
+                markers_.pop_back();
+                stack_iter object_iter = stack_.begin() + first_idx;
+                stack_iter first = object_iter + 1;
+                stack_iter first_saved = first;
+                stack_iter last = stack_.end();
+                Object& o = (*object_iter).template interpret_as<Object>();
+                while (first != last and not duplicateKeyError) {
+                    String& keyString = (*first).template interpret_as<String>();
+                    ++first;
+                    std::pair<obj_iter, bool> result = o.emplace(std::move(keyString), std::move(*first));
+                    duplicateKeyError = not result.second;
+                    ++first;
+                }
+                stack_.erase(first_saved, last);
+            }
+            if (not duplicateKeyError)
+                end_container();
+            return not duplicateKeyError;
+        }
+
+        void begin_value_at_index_imp(size_t index)
+        {
+            const query_set::index_component c = { index };
+            begin_child(c);
+        }
+
+        void end_value_at_index_imp(size_t) {}
+
+        void begin_key_value_pair_imp(const const_buffer_t& buffer, size_t)
+        {
+            if (capture_depth_ > 0) {
+                stack_.emplace_back(Value::emplace_string, buffer.first, buffer.second, allocator_);
+            }
+            const query_set::key_component c = { reinterpret_cast<const char*>(buffer.first), buffer.second };
+            begin_child(c);
+        }
+
+        void end_key_value_pair_imp() {}
+
+        void value_string_imp(const const_buffer_t& buffer, bool hasMore)
+        {
+            if (not (capture_depth_ > 0 or pending_.capture)) {
+                if (!hasMore)
+                    end_scalar();
+                return;
+            }
+            if (!hasMore) {
+                if (tmp_buffer_.size() == 0) {
+                    stack_.emplace_back(Value::emplace_string, buffer.first, buffer.second, allocator_);
+                }
+                else {
+                    tmp_buffer_.insert(tmp_buffer_.end(), buffer.first, buffer.first+buffer.second);
+                    stack_.emplace_back(Value::emplace_string, tmp_buffer_.data(), tmp_buffer_.size(), allocator_);
+                    tmp_buffer_.clear();
+                }
+                end_scalar();
+            } else {
+                tmp_buffer_.insert(tmp_buffer_.end(), buffer.first, buffer.first+buffer.second);
+            }
+        }
+
+        // See value_generator::accepts_binary_imp().
+        bool accepts_binary_imp() const { return static_cast<bool>(this->binary_sink_); }
+
+        void value_binary_imp(const char* data, std::size_t size, bool hasMore)
+        {
+            base::value_binary_imp(data, size, hasMore);
+            if (!hasMore) {
+                if (capture_depth_ > 0 or pending_.capture)
+                    stack_.emplace_back(Value::emplace_null);
+                end_scalar();
+            }
+        }
+
+        void value_number_imp(const number_desc_t& number)
+        {
+            if (capture_depth_ > 0 or pending_.capture) {
+                if (number.is_integer()) {
+                    stack_.emplace_back(Value::emplace_integral_number, number.c_str(), number.c_str_len());
+                }
+                else {
+                    stack_.emplace_back(Value::emplace_float_number, number.c_str(), number.c_str_len());
+                }
+            }
+            end_scalar();
+        }
+
+        void value_boolean_imp(bool b)
+        {
+            if (capture_depth_ > 0 or pending_.capture)
+                stack_.emplace_back(Value::emplace_boolean, b);
+            end_scalar();
+        }
+
+        void value_null_imp()
+        {
+            if (capture_depth_ > 0 or pending_.capture)
+                stack_.emplace_back(Value::emplace_null);
+            end_scalar();
+        }
+
+
+        void print_imp(std::ostream& os) {
+            os << static_cast<base const&>(*this);
+            os << "Query set generator:\n"
+               << "   subscriptions: " << queries_.size() << '\n'
+               << "   matches:       " << match_count_ << std::endl;
+        }
+
+        void clear_imp(bool shrink_buffers)
+        {
+            reset();
+            error_.reset();
+            if (shrink_buffers) {
+                tmp_buffer_.shrink_to_fit();
+                states_.shrink_to_fit();
+                filters_.shrink_to_fit();
+            }
+        }
+
+        void error_imp(int code, const char* description) {
+            error_.set(code, description);
+        }
+
+        const error_t& error_imp() const {
+            return error_;
+        }
+
+
+    private:
+
+        void reset() {
+            stack_.clear();
+            markers_.clear();
+            tmp_buffer_.clear();
+            nodes_.clear();
+            states_.clear();
+            filters_.clear();
+            capture_depth_ = 0;
+            match_count_ = 0;
+        }
+
+        node_t make_node(uint32_t states_begin, uint32_t filters_begin) const
+        {
+            node_t node;
+            node.states_begin = states_begin;
+            node.states_end = static_cast<uint32_t>(states_.size());
+            node.filters_begin = filters_begin;
+            node.filters_end = static_cast<uint32_t>(filters_.size());
+            node.capture = node.filters_begin != node.filters_end;
+            for (uint32_t i = states_begin; i != node.states_end and not node.capture; ++i) {
+                node.capture = not query_set::is_descendant_only(states_[i])
+                               and not queries_.nodes_[query_set::node_of(states_[i])].accept.empty();
+            }
+            return node;
+        }
+
+        template <typename ComponentT>
+        void begin_child(const ComponentT& c)
+        {
+            const node_t& parent = nodes_.back();
+            const uint32_t states_begin = static_cast<uint32_t>(states_.size());
+            const uint32_t filters_begin = static_cast<uint32_t>(filters_.size());
+            queries_.transition(states_, parent.states_begin, parent.states_end, c, states_, filters_);
+            pending_ = make_node(states_begin, filters_begin);
+        }
+
+        void begin_container() {
+            nodes_.push_back(pending_);
+            if (pending_.capture)
+                ++capture_depth_;
+        }
+
+        void end_container() {
+            const node_t node = nodes_.back();
+            nodes_.pop_back();
+            end_value(node);
+            if (node.capture)
+                --capture_depth_;
+            if (capture_depth_ == 0)
+                stack_.clear();
+        }
+
+        void end_scalar() {
+            end_value(pending_);
+            if (capture_depth_ == 0)
+                stack_.clear();
+        }
+
+        // The value described by node is complete. If it is captured, it is
+        // on top of the stack.
+        void end_value(const node_t& node)
+        {
+            if (node.capture) {
+                const Value& v = stack_.back();
+                matches_.clear();
+                queries_.accept(states_.data() + node.states_begin, states_.data() + node.states_end, v, matches_);
+                if (node.filters_begin != node.filters_end) {
+                    filter_states_.clear();
+                    for (uint32_t i = node.filters_begin; i != node.filters_end; ++i) {
+                        if (query_detail::test(queries_.filter_step(filters_[i]).filter, v))
+                            query_set::add_state(filter_states_, 0, query_set::state(queries_.filter_target(filters_[i])));
+                    }
+                    if (not filter_states_.empty()) {
+                        queries_.accept(filter_states_.data(), filter_states_.data() + filter_states_.size(), v, matches_);
+                        queries_.evaluate(filter_states_, v, matches_);
+                    }
+                }
+                emit();
+            }
+            states_.resize(node.states_begin);
+            filters_.resize(node.filters_begin);
+        }
+
+        // Passes the matches to the handler, one call per value.
+        void emit()
+        {
+            for (std::size_t i = 0; i < matches_.size(); ++i) {
+                const Value* v = matches_[i].first;
+                if (v == nullptr)
+                    continue;
+                ids_.clear();
+                for (std::size_t j = i; j < matches_.size(); ++j) {
+                    if (matches_[j].first == v) {
+                        ids_.push_back(matches_[j].second);
+                        matches_[j].first = nullptr;
+                    }
+                }
+                std::sort(ids_.begin(), ids_.end());
+                ids_.erase(std::unique(ids_.begin(), ids_.end()), ids_.end());
+                ++match_count_;
+                if (handler_)
+                    handler_(ids_, *v);
+            }
+        }
+
+    protected:
+        query_set               queries_;
+        match_handler_t         handler_;
+        stack_t                 stack_;
+        markers_t               markers_;
+        string_temp_buffer_t    tmp_buffer_;
+        std::vector<node_t>     nodes_;
+        std::vector<uint32_t>   states_;
+        std::vector<filter_ref> filters_;
+        std::vector<uint32_t>   filter_states_;
+        std::vector<std::pair<const Value*, id_type>> matches_;
+        std::vector<id_type>    ids_;
+        node_t                  pending_;
+        error_t                 error_;
+        AllocatorT              allocator_;
+        size_t                  capture_depth_;
+        size_t                  match_count_;
+    };
+
+
+
+    //
+    //  class query_generator
+    //
+    //  Semantic actions which evaluate a single query while parsing and pass
+    //  each matching value to the match handler. A query set with one
+    //  subscription, see query_set_generator.
+    //
+    template <
+        typename EncodingT = json::unicode::UTF_8_encoding_tag,
+        typename AllocatorT = std::allocator<void>
+    >
+    class query_generator : public query_set_generator<EncodingT, AllocatorT>
+    {
+        typedef query_set_generator<EncodingT, AllocatorT> base;
+
+    public:
+        typedef typename base::Value                    Value;
+        typedef std::function<void(const Value&)>       match_handler_t;
+
+        query_generator(const query& q, match_handler_t handler = match_handler_t(), const AllocatorT& a = AllocatorT())
+        :   base(make_set(q), adapt(handler), a), query_handler_(std::move(handler))
+        {
+        }
+
+        // Sets or gets the match handler.
+        void                        match_handler(match_handler_t handler) {
+            base::match_handler(adapt(handler));
+            query_handler_ = std::move(handler);
+        }
+        const match_handler_t&      match_handler() const       { return query_handler_; }
+
+    private:
+        static query_set make_set(const query& q) {
+            query_set queries;
+            queries.add(q);
+            return queries;
+        }
+
+        static typename base::match_handler_t adapt(match_handler_t handler) {
+            if (not handler)
+                return typename base::match_handler_t();
+            return [handler](const std::vector<typename base::id_type>&, const Value& v) { handler(v); };
+        }
+
+        match_handler_t         query_handler_;
+    };
+
+
+}}  // namespace json::jsonpath
+
+
+#endif  // JSON_JSON_PATH_QUERY_HPP
@@ -0,0 +1,502 @@
+//
+//  async_parser.hpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#ifndef JSON_PARSER_ASYNC_PARSER_HPP
+#define JSON_PARSER_ASYNC_PARSER_HPP
+
+
+#include "json/config.hpp"
+#include "parse.hpp"
+#include "parser_errors.hpp"
+#include "json/unicode/unicode_detect_bom.hpp"
+#include "json/unicode/unicode_traits.hpp"
+#include "json/utility/ring_queue.hpp"
+#include "json/utility/syncqueue_streambuf.hpp"
+#include "json/utility/istreambuf_iterator.hpp"
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <ios>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+
+
+namespace json {
+
+
+    //
+    //  class async_parser
+    //
+    //  The portable counterpart of JPAsyncJsonParser: an async_parser parses
+    //  JSON text which is provided in a sequence of buffers by one or more
+    //  producers - for example a network connection - on a worker thread.
+    //
+    //  The buffers are passed through a bounded ring_queue. A producer may put
+    //  up to buffer_queue_capacity() buffers ahead of the parser; then
+    //  parse_buffer() blocks until the parser has consumed a buffer. This
+    //  back-pressure limits the memory used by a fast producer.
+    //
+    //  The parser detects the encoding (UTF-8, UTF-16 or UTF-32, with or
+    //  without BOM) from the start of the input. If the semantic actions
+    //  object has the option parseMultipleDocuments set, the parser parses
+    //  all documents in the input, otherwise exactly one.
+    //
+    //  Results are delivered on the worker thread:
+    //
+    //  document_handler    Called with the semantic actions object after each
+    //                      document has been parsed successfully, e.g. to
+    //                      retrieve or move out the result of a
+    //                      value_generator before the next document will be
+    //                      parsed. The handler may call cancel() on the
+    //                      semantic actions object in order to stop parsing.
+    //  error_handler       Called with the error of the semantic actions
+    //                      object, if parsing failed or has been canceled.
+    //  completion_handler  Called when the parser has finished, after any of
+    //                      the above.
+    //
+    //  Alternatively or additionally, get_future() returns a future which
+    //  becomes ready when the parser has finished. Its value is true if all
+    //  documents have been parsed successfully. Then, the semantic actions
+    //  object may be accessed again from any thread.
+    //
+    //  The parser runs on a thread owned by the async_parser, unless start()
+    //  is given an executor which runs the parse task, for example on a thread
+    //  pool.
+    //
+    //  Producer API:
+    //
+    //  parse_buffer(buffer)            Passes a buffer to the parser, waiting
+    //                                  while the buffer queue is full. Returns
+    //                                  false if the parser does not accept
+    //                                  buffers anymore.
+    //  parse_buffer(buffer, timeout)   As above, but returns false if the
+    //                                  buffer could not be delivered within
+    //                                  timeout seconds.
+    //  finish()                        Signals the end of the input.
+    //  cancel()                        Stops the parser. The parser's error
+    //                                  becomes JP_CANCELED.
+    //
+    //  BufferT shall model the buffer concept of basic_syncqueue_streambuf:
+    //  it shall have member functions data() and size() and its value_type
+    //  shall be a byte. The default is a std::vector<char>; buffers are moved
+    //  into the queue.
+    //
+    //  SemanticActionsT shall be a subclass of json::semantic_actions_base.
+    //  The semantic actions object is owned by the async_parser. It shall not
+    //  be accessed from other threads while the parser is running.
+    //
+    //  Example:
+    //
+    //      typedef json::value_generator<>                 SemanticActions;
+    //      json::async_parser<SemanticActions> parser;
+    //      parser.semantic_actions().parseMultipleDocuments(true);
+    //      parser.document_handler([](SemanticActions& sa) {
+    //          process(std::move(sa.result()));
+    //      });
+    //      parser.start();
+    //      while (connection.read(buffer)) {
+    //          parser.parse_buffer(std::move(buffer));
+    //      }
+    //      parser.finish();
+    //      bool success = parser.get_future().get();
+    //
+
+    template <
+        typename SemanticActionsT,
+        typename BufferT = std::vector<char>
+    >
+    class async_parser
+    {
+    public:
+        typedef SemanticActionsT                                semantic_actions_type;
+        typedef typename SemanticActionsT::error_t              error_t;
+        typedef BufferT                                         buffer_type;
+        typedef json::utility::ring_queue<BufferT, true>        queue_type;
+
+        typedef std::function<void(std::function<void()>)>      executor_type;
+        typedef std::function<void(SemanticActionsT&)>          document_handler_t;
+        typedef std::function<void(const error_t&)>             error_handler_t;
+        typedef std::function<void()>                           completion_handler_t;
+
+        static_assert(sizeof(typename BufferT::value_type) == 1, "");
+
+        static std::size_t default_buffer_queue_capacity() { return 8; }
+
+    private:
+        struct state;
+
+    public:
+
+        async_parser()
+        : state_(std::make_shared<state>(default_buffer_queue_capacity()))
+        {
+        }
+
+        // Constructs the semantic actions object from the given arguments.
+        template <typename... Args>
+        explicit async_parser(std::size_t buffer_queue_capacity, Args&&... args)
+        : state_(std::make_shared<state>(buffer_queue_capacity, std::forward<Args>(args)...))
+        {
+        }
+
+        async_parser(const async_parser&) = delete;
+        async_parser& operator=(const async_parser&) = delete;
+
+        // If the parser is still running, cancels it and waits until it has
+        // finished.
+        ~async_parser() {
+            if (state_->started.load()) {
+                if (not state_->closed.load()) {
+                    cancel();
+                }
+                state_->future.wait();
+            }
+            if (thread_.joinable()) {
+                thread_.join();
+            }
+        }
+
+
+        // Handlers shall be set before the parser will be started.
+        void document_handler(document_handler_t handler)       { state_->document_handler = std::move(handler); }
+        void error_handler(error_handler_t handler)             { state_->error_handler = std::move(handler); }
+        void completion_handler(completion_handler_t handler)   { state_->completion_handler = std::move(handler); }
+
+        semantic_actions_type&          semantic_actions()          { return state_->sa; }
+        const semantic_actions_type&    semantic_actions() const    { return state_->sa; }
+
+        std::size_t buffer_queue_capacity() const   { return state_->queue.capacity(); }
+        std::size_t buffer_queue_size() const       { return state_->queue.size(); }
+
+
+        // Starts parsing on a thread owned by the async_parser. Returns false
+        // if the parser has been started already.
+        bool start() {
+            if (state_->started.exchange(true)) {
+                return false;
+            }
+            std::shared_ptr<state> s = state_;
+            thread_ = std::thread([s]() { s->run(); });
+            return true;
+        }
+
+        // Starts parsing by passing the parse task to the given executor,
+        // which shall eventually invoke it on some thread. Returns false if
+        // the parser has been started already.
+        bool start(const executor_type& executor) {
+            if (state_->started.exchange(true)) {
+                return false;
+            }
+            std::shared_ptr<state> s = state_;
+            executor([s]() { s->run(); });
+            return true;
+        }
+
+        bool is_running() const { return state_->running.load(); }
+
+
+        // Passes a buffer to the parser. Waits while the buffer queue is
+        // full. Returns false if the parser does not accept buffers anymore,
+        // that is, after finish() or cancel(), or after the parser stopped
+        // due to an error.
+        bool parse_buffer(buffer_type buffer) {
+            return parse_buffer(std::move(buffer), -1.0);
+        }
+
+        // As above, but returns false if the buffer could not be delivered
+        // within timeout seconds.
+        bool parse_buffer(buffer_type buffer, double timeout) {
+            // An empty buffer would signal EOF to the parser:
+            if (buffer.size() == 0) {
+                return not state_->closed.load();
+            }
+            return state_->put(std::move(buffer), timeout);
+        }
+
+        // Signals the end of the input. Returns false, if the parser did not
+        // accept buffers anymore.
+        bool finish() {
+            return state_->close(false);
+        }
+
+        // Stops the parser as soon as possible. Does not wait until the
+        // parser has finished.
+        void cancel() {
+            state_->close(true);
+        }
+
+        // Returns a future which becomes ready when the parser has finished.
+        std::shared_future<bool> get_future() const { return state_->future; }
+
+
+    private:
+
+        // The state is shared with the parse task, so that the task never
+        // refers to a destroyed async_parser.
+        struct state
+        {
+            typedef json::utility::basic_ring_queue_streambuf<BufferT, char, std::char_traits<char>, true>          char_streambuf_t;
+            typedef json::utility::basic_ring_queue_streambuf<BufferT, uint16_t, std::char_traits<uint16_t>, true>  uint16_streambuf_t;
+            typedef json::utility::basic_ring_queue_streambuf<BufferT, uint32_t, std::char_traits<uint32_t>, true>  uint32_streambuf_t;
+
+            template <typename... Args>
+            explicit state(std::size_t capacity, Args&&... args)
+            :   queue(capacity), sa(std::forward<Args>(args)...),
+                started(false), running(false), closed(false), canceled(false),
+                producers(0), future(promise.get_future().share())
+            {
+            }
+
+            bool put(buffer_type&& buffer, double timeout) {
+                // A producer counts itself, so that the parse task which
+                // stopped early keeps draining the queue until no producer
+                // waits in put() anymore.
+                ++producers;
+                bool result = false;
+                if (not closed.load()) {
+                    result = queue.put(std::move(buffer), timeout) == queue_type::OK;
+                }
+                --producers;
+                return result;
+            }
+
+            bool close(bool cancel) {
+                ++producers;
+                if (cancel) {
+                    canceled.store(true);
+                }
+                bool result = not closed.exchange(true);
+                if (result) {
+                    // The empty buffer signals EOF to a parser waiting for
+                    // input:
+                    queue.put(buffer_type());
+                }
+                --producers;
+                return result;
+            }
+
+            void run() {
+                running.store(true);
+                bool success = false;
+                try {
+                    success = run_detect();
+                }
+                catch (std::exception& ex) {
+                    sa.error(json::JP_UNEXPECTED_ERROR, ex.what());
+                }
+                catch (...) {
+                    sa.error(json::JP_UNKNOWN_ERROR, json::parser_error_str(json::JP_UNKNOWN_ERROR));
+                }
+                if (canceled.load()) {
+                    success = false;
+                    sa.cancel();
+                    sa.error(json::JP_CANCELED, json::parser_error_str(json::JP_CANCELED));
+                }
+                // Do not accept buffers anymore, and release waiting producers:
+                closed.store(true);
+                buffer_type buffer;
+                while (producers.load() > 0 or not queue.empty()) {
+                    if (not queue.try_get(buffer)) {
+                        std::this_thread::yield();
+                    }
+                }
+                if (not success and error_handler) {
+                    error_handler(sa.error());
+                }
+                if (completion_handler) {
+                    completion_handler();
+                }
+                running.store(false);
+                promise.set_value(success);
+            }
+
+            // Detects BOM and encoding from the start of the input, then runs
+            // the parser with a streambuf whose char type matches the encoding.
+            //
+            // Unlike JPAsyncJsonParser, which reads ahead through the streambuf
+            // and then seeks back - which fails if the first buffers are very
+            // small - the first buffers are joined until they hold enough bytes
+            // to determine the encoding.
+            bool run_detect()
+            {
+                const std::size_t lookahead = 4;
+                bool eof = false;
+                buffer_type head = queue.get();
+                if (head.size() == 0) {
+                    eof = true;
+                }
+                else if (head.size() < lookahead) {
+                    std::vector<char> bytes(head.data(), head.data() + head.size());
+                    while (bytes.size() < lookahead) {
+                        buffer_type buffer = queue.get();
+                        if (buffer.size() == 0) {
+                            eof = true;
+                            break;
+                        }
+                        bytes.insert(bytes.end(), buffer.data(), buffer.data() + buffer.size());
+                    }
+                    head = buffer_type(bytes.begin(), bytes.end());
+                }
+
+                const char* first = reinterpret_cast<const char*>(head.data());
+                const char* last = first + head.size();
+                int encoding = json::unicode::detect_bom(first, last);
+                if (encoding < 0) {
+                    throw std::runtime_error("unexpected EOF while trying to determine BOM");
+                }
+                else if (encoding == 0) {
+                    first = reinterpret_cast<const char*>(head.data());
+                    encoding = json::detect_encoding(first, last);
+                    if (encoding <= 0) {
+                        if (encoding == -1)
+                            throw std::runtime_error("unexpected EOF while trying to determine encoding");
+                        else
+                            throw std::runtime_error("unknown encoding - possibly malformed Unicode");
+                    }
+                }
+                const std::size_t offset = first - reinterpret_cast<const char*>(head.data());
+
+                switch (encoding) {
+                    case json::unicode::UNICODE_ENCODING_UTF_8:
+                        return run<char_streambuf_t>(head, offset, eof, json::unicode::UTF_8_encoding_tag());
+                    case json::unicode::UNICODE_ENCODING_UTF_16BE:
+                        return run<uint16_streambuf_t>(head, offset, eof, json::unicode::UTF_16BE_encoding_tag());
+                    case json::unicode::UNICODE_ENCODING_UTF_16LE:
+                        return run<uint16_streambuf_t>(head, offset, eof, json::unicode::UTF_16LE_encoding_tag());
+                    case json::unicode::UNICODE_ENCODING_UTF_32BE:
+                        return run<uint32_streambuf_t>(head, offset, eof, json::unicode::UTF_32BE_encoding_tag());
+                    case json::unicode::UNICODE_ENCODING_UTF_32LE:
+                        return run<uint32_streambuf_t>(head, offset, eof, json::unicode::UTF_32LE_encoding_tag());
+                    default:
+                        throw std::runtime_error("encoding not supported");
+                }
+            }
+
+            // Runs the parser on the input starting at the given byte offset
+            // of the head buffer. If the queue did deliver EOF already, head
+            // holds the whole input.
+            template <typename StreamBufferT, typename EncodingT>
+            bool run(buffer_type& head, std::size_t offset, bool eof, EncodingT encoding)
+            {
+                typedef typename StreamBufferT::char_type   char_type;
+
+                if (eof) {
+                    if ((head.size() - offset) % sizeof(char_type) != 0) {
+                        throw std::runtime_error("input is not a sequence of whole code units");
+                    }
+                    const char_type* first = reinterpret_cast<const char_type*>(head.data() + offset);
+                    const char_type* last = reinterpret_cast<const char_type*>(head.data() + head.size());
+                    return run_documents(first, last, encoding);
+                }
+                StreamBufferT streambuf(queue, head);
+                if (streambuf.pubseekoff(offset / sizeof(char_type), std::ios_base::beg) == std::streampos(-1)) {
+                    throw std::runtime_error("streambuf seek failed");
+                }
+                json::utility::istreambuf_iterator<char_type> first(&streambuf);
+                json::utility::istreambuf_iterator<char_type> last;
+                return run_documents(first, last, encoding);
+            }
+
+            // Parses one or - if sa.parseMultipleDocuments() is set - multiple
+            // documents like parse_loop() does, and calls the document handler
+            // after each document.
+            template <typename IteratorT, typename EncodingT>
+            bool run_documents(IteratorT first, IteratorT last, EncodingT)
+            {
+                typedef json::parser<IteratorT, EncodingT, SemanticActionsT> parser_t;
+
+                parser_t parser(sa);
+                bool result = true;
+                bool done = false;
+                while (not done) {
+                    if (canceled.load()) {
+                        result = false;
+                        break;
+                    }
+                    const bool skipTrailingWhitespaces = false;
+                    if (parser.parse(first, last, skipTrailingWhitespaces) != json::JP_NO_ERROR) {
+                        result = false;
+                        break;
+                    }
+                    // 'first' points to the last significant character of the
+                    // document:
+                    ++first;
+                    if (document_handler) {
+                        document_handler(sa);
+                        if (sa.is_canceled()) {
+                            result = false;
+                            break;
+                        }
+                    }
+                    // Skip white spaces. A Unicode NULL or EOF terminates the
+                    // input:
+                    done = true;
+                    while (first != last) {
+                        uint32_t c = json::unicode::encoding_traits<EncodingT>::to_uint(*first);
+                        if (c == uint32_t(' ') or c == uint32_t('\t') or c == uint32_t('\n') or c == uint32_t('\r')) {
+                            ++first;
+                        }
+                        else {
+                            done = (c == 0 or c == uint32_t(EOF));
+                            break;
+                        }
+                    }
+                    if (not done and not sa.parseMultipleDocuments()) {
+                        done = true;
+                        if (not sa.ignoreSpuriousTrailingBytes()) {
+                            result = false;
+                            sa.error(json::JP_JSON_EXTRA_CHARACTERS_AT_END,
+                                     json::parse_internal::JP_JSON_EXTRA_CHARACTERS_AT_END_String);
+                        }
+                    }
+                }
+                sa.finished();
+                return result;
+            }
+
+            queue_type                  queue;
+            SemanticActionsT            sa;
+            document_handler_t          document_handler;
+            error_handler_t             error_handler;
+            completion_handler_t        completion_handler;
+            std::atomic<bool>           started;
+            std::atomic<bool>           running;
+            std::atomic<bool>           closed;
+            std::atomic<bool>           canceled;
+            std::atomic<int>            producers;
+            std::promise<bool>          promise;
+            std::shared_future<bool>    future;
+        };
+
+    private:
+        std::shared_ptr<state>  state_;
+        std::thread             thread_;
+    };
+
+
+}   // namespace json
+
+
+#endif // JSON_PARSER_ASYNC_PARSER_HPP
@@ -653,6 +653,119 @@ namespace json {
     
     
     
+    //
+    //  class parse_context
+    //
+    //  A parse_context owns a semantic actions object and a parser which can be
+    //  reused for parsing many JSON documents. Unlike the parse functions above
+    //  which create a new parser for each call, a parse_context keeps the 
+    //  capacity of the parser's internal string buffers and the buffers of the
+    //  semantic actions object (for example, the stack of a value_generator) 
+    //  across calls. If the semantic actions object uses an arena allocator and
+    //  has arena recycling enabled, the arena keeps its blocks as well.
+    //
+    //  This considerably reduces the setup costs when parsing many small JSON
+    //  documents.
+    //
+    //  Before each parse, the context will be reset, which clears the result
+    //  and the state of the previous parse. So, the result shall be retrieved
+    //  (or moved out) before parsing the next document.
+    //
+    //  A parse_context is not thread-safe. Function local() returns a default
+    //  instance which is local to the calling thread.
+    //
+    //  Example:
+    //
+    //      typedef json::value_generator<> SemanticActions;
+    //      typedef json::parse_context<const char*, SemanticActions> context_t;
+    //
+    //      context_t& ctx = context_t::local();
+    //      const char* first = msg.data();
+    //      if (ctx.parse(first, msg.data() + msg.size())) {
+    //          process(ctx.result());
+    //      }
+    //
+    
+    template <
+        typename IteratorT, 
+        typename SemanticActionsT,
+        typename EncodingT = typename unicode::iterator_encoding<IteratorT>::type
+    >
+    class parse_context
+    {
+    public:
+        typedef SemanticActionsT                                semantic_actions_type;
+        typedef json::parser<IteratorT, EncodingT, SemanticActionsT>  parser_type;
+        typedef typename SemanticActionsT::error_t              error_t;
+        
+        static_assert( (std::is_base_of<unicode::utf_encoding_tag, EncodingT>::value), "" );
+        static_assert( (sizeof(typename std::iterator_traits<IteratorT>::value_type)
+                        == sizeof(typename encoding_traits<EncodingT>::code_unit_type)), "" );
+        
+        // Constructs the semantic actions object from the given arguments.
+        template <typename... Args>
+        explicit parse_context(Args&&... args) 
+        : sa_(std::forward<Args>(args)...), parser_(sa_)
+        {
+        }
+        
+        parse_context(const parse_context&) = delete;
+        parse_context& operator=(const parse_context&) = delete;
+        
+        // Parses the text in the range [first, last) the same way as 
+        // json::parse(first, last, sa) does.
+        bool parse(IteratorT& first, IteratorT last) {
+            reset();
+            return parse_loop(parser_, sa_, first, last);
+        }
+        
+        // Clears the state of the parser and the semantic actions object, but
+        // keeps the capacity of their internal buffers.
+        void reset() {
+            parser_.reset();
+        }
+        
+        semantic_actions_type&          semantic_actions()          { return sa_; }
+        const semantic_actions_type&    semantic_actions() const    { return sa_; }
+        
+        auto result() -> decltype(std::declval<SemanticActionsT&>().result()) { 
+            return sa_.result(); 
+        }
+        
+        const error_t& error() const { return sa_.error(); }
+        
+#if !defined (JSON_NO_THREAD_LOCAL)
+        // Returns a default constructed context which is local to the calling
+        // thread.
+        static parse_context& local() {
+            static thread_local parse_context ctx;
+            return ctx;
+        }
+#endif
+        
+    private:
+        SemanticActionsT    sa_;
+        parser_type         parser_;
+    };
+    
+    
+    //
+    //  bool parse(Iterator& first, Iterator last, parse_context<...>& ctx)
+    //
+    // Parses the text in the range [first last) using the parser and the 
+    // semantic actions instance of the given parse context. The result of 
+    // parsing will be hold within the context's semantic actions instance.
+    //
+    // Returns true on success, otherwise returns false.
+    
+    template <typename IteratorT, typename SemanticActionsT, typename EncodingT>
+    inline bool
+    parse(IteratorT& first, IteratorT last, parse_context<IteratorT, SemanticActionsT, EncodingT>& ctx)
+    {
+        return ctx.parse(first, last);
+    }
+    
+    
 }
 
 
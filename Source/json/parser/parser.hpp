@@ -364,6 +364,7 @@ namespace json {
         string_buffer_.clear();
         number_string_buffer_.clear();
         pos_ = 0;
+        configure();  // options of the semantic actions may have been changed
     }
     
     
@@ -497,6 +498,10 @@ namespace json {
                     sa_.begin_value_at_index(index);
                     parse_value();
                     sa_.end_value_at_index(index);
+                    if (state_ and sa_.is_canceled()) {
+                        state_.error() = JP_CANCELED;
+                        sa_.error(state_.error(), state_.error_str());
+                    }
                     if (state_) {
                         if (p_ != last_) {
                             unsigned int c = to_uint(*p_);
@@ -650,6 +655,9 @@ namespace json {
                                 sa_.begin_key_value_pair(string_buffer_.buffer(), index);
                                 parse_value();  // whitespaces skipped.
                                 sa_.end_key_value_pair();
+                                if (state_ and sa_.is_canceled()) {
+                                    state_.error() = JP_CANCELED;
+                                }
                                 if (state_) 
                                 {
                                     // Note: We populate the object at end_object().
@@ -72,6 +72,7 @@ namespace json {
         // Other errors
         JP_JSON_EXTRA_CHARACTERS_AT_END = 100, // "extra characters at end of json document not allowed"
         JP_OUT_OF_BOUND_UNICODE_NULL =    101, // "encountered out-of-bound U+0000 character(s)"
+        JP_INVALID_BASE64_ERROR =         102, // "invalid base64 sequence"
 
         JP_PARSER_CLIENT =               1000, // client errors start here
         JP_UNEXPECTED_ERROR =            1001, // exceptions cought by the outer levels of clients, description shall be provided by the clients
@@ -127,6 +128,7 @@ namespace json {
                 // Other errors (signaled by parse_loop and other parse functions)
             case JP_JSON_EXTRA_CHARACTERS_AT_END:       return "extra characters at end of json document not allowed"; break;
             case JP_OUT_OF_BOUND_UNICODE_NULL:          return "encountered out-of-bound U+0000 character(s)"; break;
+            case JP_INVALID_BASE64_ERROR:               return "invalid base64 sequence"; break;
                 
             case JP_UNKNOWN_ERROR:                       return "unknown error"; break;
                 
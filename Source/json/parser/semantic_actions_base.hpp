@@ -25,10 +25,16 @@
 #include "json/config.hpp"
 #include "number_description.hpp"
 #include "parser_errors.hpp"
-#include "json/utility/simple_log.hpp"
+#include "json/utility/async_log.hpp"
+#include "json/utility/base64.hpp"
 #include "json/utility/flags.hpp"
 #include "json/unicode/unicode_traits.hpp"
+#include "json/json_path/path_stack.hpp"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
 #include <string>
+#include <vector>
 #include <iostream>
 #include <type_traits>
 
@@ -149,7 +155,15 @@ namespace json {
         
         typedef number_description                          number_desc_t;
         
-        typedef json::utility::logger<LOG_MAX_LEVEL>        logger_t;
+        typedef json::utility::async_logger<LOG_MAX_LEVEL>  logger_t;
+        
+        // The path of the current value, see track_path().
+        typedef json::json_internal::path_stack<encoding_t> path_t;
+        typedef typename path_t::hash_type                  path_hash_t;
+        
+        // Receives the decoded bytes of a base64 encoded string, see base64_key().
+        // Parameter `key` is the registered key or path which matched.
+        typedef std::function<void(const std::string& key, const char* data, std::size_t size, bool hasMore)> binary_sink_t;
         
         semantic_actions_base() noexcept
         :   noncharacter_handling_option_(SignalErrorOnUnicodeNoncharacter),
@@ -159,7 +173,10 @@ namespace json {
             opt_multiple_documents_(false),
             opt_check_duplicate_key_(true),
             opt_pass_escaped_string_(false),
-            canceled_(false)
+            canceled_(false),
+            opt_track_path_(false),
+            base64_key_index_(-1),
+            base64_error_(false)
         {
 #if defined (NDEBUG)
             logger_.log_level(json::utility::LOG_ERROR);
@@ -173,7 +190,7 @@ namespace json {
         const DerivedT& derived() const { return static_cast<const DerivedT&>(*this); }
         
         // The parser call this function when it encounters the start of a JSON text.
-        void parse_begin()                              { this->derived().parse_begin_imp(); }
+        void parse_begin()                              { path_.clear(); this->derived().parse_begin_imp(); }
         
         // The parser calls this functions when it encounters end of a JSON text
         void parse_end()                                { this->derived().parse_end_imp(); }
@@ -182,37 +199,69 @@ namespace json {
         void finished()                                 { this->derived().finished_imp(); }
         
         // The parser calls this function when it encounters start of an JSON array, aka `[`        
-        void begin_array()                              { this->derived().begin_array_imp(); }
+        void begin_array()                              { base64_key_index_ = -1; this->derived().begin_array_imp(); }
         
         // The parser calls this function when it encounters the end of an JSON array, aka `]`        
         void end_array()                                { this->derived().end_array_imp(); }
         
         // The parser calls this function when it encounters the start of an JSON object, aka `{`        
-        void begin_object()                             { this->derived().begin_object_imp(); }
+        void begin_object()                             { base64_key_index_ = -1; this->derived().begin_object_imp(); }
         
         // The parser calls this function when it encounters the start of an JSON object, aka `}`        
         bool end_object()                               { return this->derived().end_object_imp(); }
 
         // The parser calls this function when it encounters the start of a value as an element
         // of an array at index 'index'.
-        void begin_value_at_index(size_t index)         { this->derived().begin_value_at_index_imp(index); }
+        void begin_value_at_index(size_t index) 
+        { 
+            if (opt_track_path_)
+                path_.push_index(index);
+            if (not base64_paths_.empty()) {
+                base64_key_index_ = find_base64_path();
+                base64_decoder_.reset();
+            }
+            this->derived().begin_value_at_index_imp(index); 
+        }
 
         // The parser calls this function when it encounters the end of a value as an element
         // of an array at index 'index'.
-        void end_value_at_index(size_t index)           { this->derived().end_value_at_index_imp(index); }
+        void end_value_at_index(size_t index) 
+        { 
+            base64_key_index_ = -1; 
+            this->derived().end_value_at_index_imp(index); 
+            if (opt_track_path_)
+                path_.pop();
+        }
         
 
         // The parser calls this function when it encounters the start of a key-value pair 
         // of a JSON object at position 'nth'. The key is passed in parameter `buffer`.
         // Subsequently, the parser will call either begin_array(), begin_object(), or 
         // any of the value_*() function constituting the value which belongs to this key.
-        void begin_key_value_pair(const const_buffer_t& buffer, size_t nth) { this->derived().begin_key_value_pair_imp(buffer, nth); }
+        void begin_key_value_pair(const const_buffer_t& buffer, size_t nth) 
+        {
+            if (not base64_key_units_.empty() or not base64_paths_.empty()) {
+                base64_key_index_ = find_base64_key(buffer);
+                base64_decoder_.reset();
+            }
+            if (opt_track_path_)
+                path_.push_key(buffer.first, buffer.second);
+            if (base64_key_index_ < 0 and not base64_paths_.empty())
+                base64_key_index_ = find_base64_path();
+            this->derived().begin_key_value_pair_imp(buffer, nth); 
+        }
         
         // The parser calls this function when it encounters the end of a key-value 
         // pair which is an element of a JSON object at position 'nth'. The key has
         // been passed in begin_key_value_pair() which has been called immediately
         // before this function.
-        void end_key_value_pair() { this->derived().end_key_value_pair_imp(); }
+        void end_key_value_pair() 
+        { 
+            base64_key_index_ = -1; 
+            this->derived().end_key_value_pair_imp(); 
+            if (opt_track_path_)
+                path_.pop();
+        }
         
         
         // The parser calls this function when it encounters the start of a data string
@@ -226,7 +275,36 @@ namespace json {
         // Unicode replacement characters if the SA has been configured in such a way 
         // so that it shall perform a replacement when an ill-formed Unicode sequence 
         // is encountered.
-        void value_string(const const_buffer_t& buffer, bool hasMore = false) { this->derived().value_string_imp(buffer, hasMore); }
+        // If the string is the value of a key registered with base64_key(), the
+        // string is decoded and passed to value_binary() instead - unless the
+        // derived class does not accept binary values, see accepts_binary_imp().
+        void value_string(const const_buffer_t& buffer, bool hasMore = false) 
+        {
+            if (base64_key_index_ < 0) {
+                this->derived().value_string_imp(buffer, hasMore);
+            } else {
+                value_base64(buffer, hasMore);
+            }
+        }
+        
+        // Receives the decoded bytes of a base64 encoded string value. The bytes
+        // may be passed in several pieces; the last piece has parameter `hasMore`
+        // equal `false` and may be empty.
+        void value_binary(const char* data, std::size_t size, bool hasMore) { this->derived().value_binary_imp(data, size, hasMore); }
+        
+        // Default implementation of value_binary(): passes the bytes to the 
+        // binary sink, if any.
+        void value_binary_imp(const char* data, std::size_t size, bool hasMore) 
+        {
+            if (binary_sink_) {
+                binary_sink_(base64_name(), data, size, hasMore);
+            }
+        }
+        
+        // Returns true if the derived class accepts binary values. Otherwise,
+        // base64 encoded strings are validated only and passed unchanged to 
+        // value_string(). The default implementation returns true.
+        bool accepts_binary_imp() const { return true; }
         
         // The parser calls this function when it encounters a JSON number
         void value_number(const number_desc_t& number)     { this->derived().value_number_imp(number); }
@@ -238,14 +316,17 @@ namespace json {
         void value_boolean(bool b)                       { this->derived().value_boolean_imp(b); }
         
         
-        void clear(bool shrink_buffers = false)          { canceled_ = false; inputEncoding_.clear(); this->derived().clear_imp(shrink_buffers); }
+        void clear(bool shrink_buffers = false)          { canceled_ = false; base64_error_ = false; base64_key_index_ = -1; path_.clear(); inputEncoding_.clear(); this->derived().clear_imp(shrink_buffers); }
 
         void print(std::ostream& os)                    { this->derived().print_imp(os); }
         
         void error(json::parser_error_type code, const char* description)  
         {
             if (canceled_) {
-                this->derived().error_imp(static_cast<int>(JP_CANCELED), parser_error_str(JP_CANCELED));
+                // An invalid base64 sequence cancels the parser, but its error
+                // shall be kept, see value_base64():
+                if (not base64_error_)
+                    this->derived().error_imp(static_cast<int>(JP_CANCELED), parser_error_str(JP_CANCELED));
             } else {
                 this->derived().error_imp(static_cast<int>(code), description);
             }
@@ -256,7 +337,10 @@ namespace json {
         {
             //assert(code <= 0 or code >= static_cast<int>(json::JP_PARSER_CLIENT));
             if (canceled_) {
-                this->derived().error_imp(static_cast<int>(JP_CANCELED), parser_error_str(JP_CANCELED));
+                // An invalid base64 sequence cancels the parser, but its error
+                // shall be kept, see value_base64():
+                if (not base64_error_)
+                    this->derived().error_imp(static_cast<int>(JP_CANCELED), parser_error_str(JP_CANCELED));
             } else {
                 this->derived().error_imp(code, description);
             }
@@ -282,6 +366,76 @@ namespace json {
         void    passEscapdedString(bool set)            { opt_pass_escaped_string_ = set; }
         
         
+        // Base64 Encoded Strings
+        //
+        // The string values of keys registered with base64_key() contain base64
+        // encoded binary data. These strings are decoded while the parser
+        // delivers them - possibly in several chunks - and the decoded bytes
+        // are passed to value_binary() in place of value_string(). Thus, there
+        // is neither an intermediate string nor a second pass over the bytes.
+        // If the derived class does not accept binary values, the strings are
+        // validated and passed unchanged to value_string(). An invalid 
+        // sequence halts the parser with JP_INVALID_BASE64_ERROR.
+        //
+        // Only strings which are immediately the value of such a key are
+        // decoded. Keys are compared code unit by code unit with the string
+        // buffer, so they should be ASCII unless the string buffer is UTF-8.
+        void    base64_key(const std::string& key) {
+            base64_keys_.push_back(key);
+            base64_key_units_.push_back(std::basic_string<char_t>(key.begin(), key.end()));
+        }
+        const std::vector<std::string>& base64_keys() const { return base64_keys_; }
+        
+        // The string value at a path registered with base64_path() is decoded
+        // as well. The path has the form `$.key[0]['key']`, see path_t::parse().
+        // It is matched with path_hash() and then verified component by 
+        // component. Registering a path enables track_path(). Throws 
+        // std::invalid_argument if the path is malformed.
+        void    base64_path(const std::string& expression) {
+            path_t path;
+            if (not path.parse(expression))
+                throw std::invalid_argument("json::semantic_actions_base: malformed base64 path: " + expression);
+            base64_paths_.push_back(expression);
+            base64_path_components_.push_back(path);
+            track_path(true);
+        }
+        const std::vector<std::string>& base64_paths() const { return base64_paths_; }
+        
+        // Removes all registered keys and paths.
+        void    clear_base64_keys() {
+            base64_keys_.clear();
+            base64_key_units_.clear();
+            base64_paths_.clear();
+            base64_path_components_.clear();
+            base64_key_index_ = -1;
+        }
+        
+        json::utility::base64_mode base64_mode() const          { return base64_mode_; }
+        void    base64_mode(json::utility::base64_mode mode)    { base64_mode_ = mode; base64_decoder_ = json::utility::base64_decoder(mode); }
+        
+        // If set, the default implementation of value_binary() passes the 
+        // decoded bytes to the sink.
+        const binary_sink_t& binary_sink() const        { return binary_sink_; }
+        void    binary_sink(const binary_sink_t& sink)  { binary_sink_ = sink; }
+        
+        
+        
+        
+        // Path Tracking
+        //
+        // If enabled, the path of the current value is maintained while
+        // parsing: when the parser calls begin_key_value_pair() or
+        // begin_value_at_index(), path() already includes the key or the
+        // index, and it still does when the parser calls the corresponding
+        // end function. The path also provides a rolling hash, so that 
+        // values can be routed with a lookup of path_hash() rather than by
+        // comparing keys. Tracking is disabled by default, since it copies
+        // each key.
+        bool    track_path() const                      { return opt_track_path_; }
+        void    track_path(bool set)                    { opt_track_path_ = set; path_.clear(); }
+        
+        const path_t& path() const                      { return path_; }
+        path_hash_t   path_hash() const                 { return path_.hash(); }
         
         
         // Log behavior
@@ -380,10 +534,107 @@ namespace json {
         bool                            opt_check_duplicate_key_;
         bool                            opt_pass_escaped_string_;
         bool                            canceled_;
+        bool                            opt_track_path_;
+        path_t                          path_;
+        
+        std::vector<std::string>                    base64_keys_;
+        std::vector<std::basic_string<char_t>>      base64_key_units_;
+        std::vector<std::string>                    base64_paths_;
+        std::vector<path_t>                         base64_path_components_;
+        int                                         base64_key_index_;   // index of the key or path of the current value, or -1
+        bool                                        base64_error_;       // canceled by an invalid base64 sequence
+        json::utility::base64_mode                  base64_mode_ = json::utility::Base64Strict;
+        json::utility::base64_decoder               base64_decoder_;
+        binary_sink_t                               binary_sink_;
         
         
     private:
         
+        int find_base64_key(const const_buffer_t& buffer) const 
+        {
+            for (std::size_t i = 0; i < base64_key_units_.size(); ++i) {
+                const std::basic_string<char_t>& key = base64_key_units_[i];
+                if (key.size() == buffer.second and std::equal(key.begin(), key.end(), buffer.first))
+                    return static_cast<int>(i);
+            }
+            return -1;
+        }
+        
+        // Paths are indexed after the keys.
+        int find_base64_path() const 
+        {
+            if (not opt_track_path_)
+                return -1;
+            const path_hash_t h = path_.hash();
+            for (std::size_t i = 0; i < base64_path_components_.size(); ++i) {
+                const path_t& path = base64_path_components_[i];
+                if (path.hash() == h and path.equal(path_))
+                    return static_cast<int>(base64_keys_.size() + i);
+            }
+            return -1;
+        }
+        
+        const std::string& base64_name() const 
+        {
+            const std::size_t i = static_cast<std::size_t>(base64_key_index_);
+            return i < base64_keys_.size() ? base64_keys_[i] : base64_paths_[i - base64_keys_.size()];
+        }
+        
+        void value_base64(const const_buffer_t& buffer, bool hasMore)
+        {
+            if (canceled_)
+                return;
+            const bool binary = this->derived().accepts_binary_imp();
+            auto sink = [this, binary](const char* data, std::size_t size) {
+                if (binary)
+                    this->value_binary(data, size, true);
+            };
+            bool ok = decode_base64(buffer, sink, std::integral_constant<bool, sizeof(char_t) == 1>());
+            if (ok and not hasMore) {
+                ok = base64_decoder_.finish();
+                if (ok and binary)
+                    this->value_binary(nullptr, 0, false);
+            }
+            if (ok and not binary)
+                this->derived().value_string_imp(buffer, hasMore);
+            if (not ok) {
+                this->derived().error_imp(static_cast<int>(JP_INVALID_BASE64_ERROR), parser_error_str(JP_INVALID_BASE64_ERROR));
+                logger_.log(json::utility::LOG_ERROR, "ERROR: json::parser (%d): %s", 
+                            static_cast<int>(JP_INVALID_BASE64_ERROR), parser_error_str(JP_INVALID_BASE64_ERROR));
+                base64_error_ = true;
+                canceled_ = true;
+            }
+        }
+        
+        template <typename Sink>
+        bool decode_base64(const const_buffer_t& buffer, Sink& sink, std::true_type)
+        {
+            const char* first = reinterpret_cast<const char*>(buffer.first);
+            const char* last = first + buffer.second;
+            return base64_decoder_.decode(first, last, sink) == last;
+        }
+        
+        // Code units wider than a byte are narrowed in small chunks. Any 
+        // non-ASCII code unit becomes an invalid base64 character.
+        template <typename Sink>
+        bool decode_base64(const const_buffer_t& buffer, Sink& sink, std::false_type)
+        {
+            char tmp[256];
+            const char_t* p = buffer.first;
+            const char_t* last = buffer.first + buffer.second;
+            while (p != last) {
+                const std::size_t n = std::min(static_cast<std::size_t>(last - p), sizeof(tmp));
+                for (std::size_t i = 0; i < n; ++i) {
+                    tmp[i] = static_cast<std::uint32_t>(p[i]) < 0x80u ? static_cast<char>(p[i]) : '\x80';
+                }
+                if (base64_decoder_.decode(tmp, tmp + n, sink) != tmp + n)
+                    return false;
+                p += n;
+            }
+            return true;
+        }
+        
+        
         friend inline 
         std::ostream& 
         operator<< (std::ostream& os, const semantic_actions_base& sa) 
@@ -0,0 +1,390 @@
+//
+//  streaming_value_generator.hpp
+//
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#ifndef JSON_PARSER_STREAMING_VALUE_GENERATOR_HPP
+#define JSON_PARSER_STREAMING_VALUE_GENERATOR_HPP
+
+
+#include "json/config.hpp"
+#include "semantic_actions_base.hpp"
+#include "json/value/value.hpp"
+#include "json/utility/arena_allocator.hpp"
+#include <functional>
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <cassert>
+
+
+
+namespace json {
+
+
+    //
+    //  class streaming_value_generator
+    //
+    //  A semantic actions class which does not build the whole JSON document,
+    //  but only the elements of the containers at a certain nesting level, the
+    //  "streaming level". The containers at and above the streaming level will
+    //  not be materialized. Each element of a container at the streaming level
+    //  will be build as a json::value, passed to the element handler and then
+    //  destroyed. So, peak memory usage depends on the size of the largest
+    //  element, rather than on the size of the whole document.
+    //
+    //  The streaming level defaults to 1, which means the elements of the root
+    //  container are passed to the handler, e.g. the records of a huge JSON
+    //  array `[{...}, {...}, ...]`. With a streaming level of 2, the elements
+    //  of all containers which are itself elements of the root container will
+    //  be passed to the handler. Scalar values at a lower nesting level than
+    //  the streaming level are skipped.
+    //
+    //  The handler will be called with a reference to the element. It may
+    //  consume the element or move it elsewhere. When the element is a value
+    //  of an object, the key of the current element can be retrieved via
+    //  `key()`, its position within its container via `index()`.
+    //  A handler may stop parsing by calling `cancel()`.
+    //
+    //  If AllocatorT is an arena_allocator and arena recycling is enabled
+    //  (the default), the arena will be reset after the handler returns, so
+    //  that the next element reuses the arena's blocks. In this case, values
+    //  allocated from the arena must not outlive the handler call - that is,
+    //  a moved value must have been moved into a value using a different
+    //  allocator, or it must have been destroyed before the handler returns.
+    //
+    //  Template parameter EncodingT shall be derived from json::utf_encoding_tag.
+    //  EncodingT shall match the StringBufferEncoding of the parser.
+    //
+
+    template <
+        typename EncodingT = json::unicode::UTF_8_encoding_tag,
+        typename AllocatorT = std::allocator<void>,
+        template <typename, typename > class... ValueImpPolicies
+    >
+    class streaming_value_generator :
+        public semantic_actions_base<streaming_value_generator<EncodingT,AllocatorT,ValueImpPolicies...>, EncodingT>
+    {
+        typedef semantic_actions_base<streaming_value_generator<EncodingT,AllocatorT,ValueImpPolicies...>, EncodingT> base;
+        typedef json::value<AllocatorT, ValueImpPolicies...> json_value_t;
+        typedef typename json_value_t::string_type::value_type _CharT;
+
+        static_assert(std::is_same<typename json::unicode::encoding_traits<EncodingT>::code_unit_type, _CharT>::value,
+                      "code_unit type from EncodingT does not match the char_type of the data string");
+
+    public:
+        typedef typename base::error_t                  error_t;
+        typedef typename base::number_desc_t            number_desc_t;
+
+        typedef json_value_t                            Value;
+        typedef typename Value::array_type              Array;
+        typedef typename Value::object_type             Object;
+        typedef typename Value::string_type             String;
+        typedef typename Value::key_type                KeyString;
+
+        static_assert(std::is_convertible<String, KeyString>::value,
+                      "Value::String must be convertible to Value::KeyString");
+
+        typedef typename base::char_t                   char_t;     // char type of the StringBuffer
+        typedef typename base::encoding_t               encoding_t;
+        typedef void                                    result_type;
+        typedef typename base::buffer_t                 buffer_t;
+        typedef typename base::const_buffer_t           const_buffer_t;
+
+        typedef std::function<void(Value&)>             element_handler_t;
+        typedef std::basic_string<char_t>               key_t;
+
+    private:
+        typedef std::vector<Value>      stack_t;
+        typedef std::vector<size_t>     markers_t;
+        typedef std::vector<char_t>     string_temp_buffer_t;
+
+    public:
+
+        streaming_value_generator(const AllocatorT& a = AllocatorT())
+        :   allocator_(a), handler_(), level_(1), depth_(0), index_(0),
+            element_count_(0), recycle_(true)
+        {
+        }
+
+        streaming_value_generator(element_handler_t handler, const AllocatorT& a = AllocatorT())
+        :   allocator_(a), handler_(std::move(handler)), level_(1), depth_(0), index_(0),
+            element_count_(0), recycle_(true)
+        {
+        }
+
+
+        // Sets or gets the element handler.
+        void                        element_handler(element_handler_t handler) { handler_ = std::move(handler); }
+        const element_handler_t&    element_handler() const     { return handler_; }
+
+        // Sets or gets the streaming level. The level shall be greater than zero.
+        // Level 1 (the default) streams the elements of the root container.
+        void    streaming_level(size_t level)   { assert(level > 0); level_ = level; }
+        size_t  streaming_level() const         { return level_; }
+
+        // Enables or disables recycling the arena after each element. Has no
+        // effect if AllocatorT is not an arena allocator.
+        void    recycle_arena(bool set)         { recycle_ = set; }
+        bool    recycle_arena() const           { return recycle_; }
+
+        // The key of the current element, if its container is an object.
+        const key_t& key() const                { return key_; }
+
+        // The index of the current element within its container.
+        size_t  index() const                   { return index_; }
+
+        // The number of elements which have been passed to the handler.
+        size_t  element_count() const           { return element_count_; }
+
+
+        void parse_begin_imp() {
+            error_.reset();
+            depth_ = 0;
+            element_count_ = 0;
+            stack_.reserve(200);
+            markers_.reserve(20);
+            assert(stack_.size() == 0);
+            assert(markers_.size() == 0);
+        }
+
+        void parse_end_imp()
+        {
+            if (stack_.size() != 0 or depth_ != 0)
+                throw std::logic_error("json::streaming_value_generator: logic error");
+        }
+
+        void finished_imp() {}
+
+        void begin_array_imp()
+        {
+            if (++depth_ <= level_)
+                return;
+            stack_.emplace_back(Array(allocator_));
+            markers_.push_back(stack_.size() -1);  // marker's top value is the index of the array on the stack
+        }
+
+        void end_array_imp()
+        {
+            if (depth_-- <= level_)
+                return;
+
+            typedef typename stack_t::iterator stack_iter;
+            size_t first_idx = markers_.back();     // index of the array on the stack
+            markers_.pop_back();
+            stack_iter array_iter = stack_.begin() + first_idx;
+            stack_iter first = array_iter + 1;      // the first element belonging to the array
+            stack_iter last = stack_.end();
+            Array& a = (*array_iter).template interpret_as<Array>();
+            assert(a.size() == 0);
+            a.reserve(std::distance(first, last));
+            a.insert(a.end(), std::make_move_iterator(first), std::make_move_iterator(last));
+            stack_.erase(first, last);
+        }
+
+        void begin_object_imp()
+        {
+            if (++depth_ <= level_)
+                return;
+            stack_.emplace_back(Object(allocator_));
+            markers_.push_back(stack_.size() - 1); // marker's top value equals the index of the object on the stack
+        }
+
+        bool end_object_imp()
+        {
+            if (depth_-- <= level_)
+                return true;
+
+            // See value_generator::end_object_imp() for the layout of the stack.
+            typedef typename stack_t::iterator stack_iter;
+            typedef typename Object::iterator obj_iter;
+
+            size_t first_idx = markers_.back();     // index of the object on the stack
+            markers_.pop_back();
+            stack_iter object_iter = stack_.begin() + first_idx;
+            stack_iter first = object_iter + 1;     // the first key belonging to the object
+            stack_iter first_saved = first;
+            stack_iter last = stack_.end();
+            Object& o = (*object_iter).template interpret_as<Object>();
+
+            bool duplicateKeyError = false;
+            while (first != last and not duplicateKeyError)
+            {
+                String& keyString = (*first).template interpret_as<String>();
+                ++first;
+                std::pair<obj_iter, bool> result = o.emplace(std::move(keyString), std::move(*first));
+                duplicateKeyError = not result.second;
+                ++first;
+            }
+            stack_.erase(first_saved, last);
+            return not duplicateKeyError;
+        }
+
+        void begin_value_at_index_imp(size_t index) {
+            if (depth_ == level_)
+                index_ = index;
+        }
+
+        void end_value_at_index_imp(size_t) {
+            if (depth_ == level_)
+                deliver();
+        }
+
+        void begin_key_value_pair_imp(const const_buffer_t& buffer, size_t nth)
+        {
+            if (depth_ == level_) {
+                key_.assign(buffer.first, buffer.second);
+                index_ = nth;
+            }
+            else if (depth_ > level_) {
+                stack_.emplace_back(Value::emplace_string, buffer.first, buffer.second, allocator_);
+            }
+        }
+
+        void end_key_value_pair_imp() {
+            if (depth_ == level_)
+                deliver();
+        }
+
+        void value_string_imp(const const_buffer_t& buffer, bool hasMore)
+        {
+            if (depth_ < level_)
+                return;
+            if (!hasMore) {
+                if (tmp_buffer_.size() == 0) {
+                    stack_.emplace_back(Value::emplace_string, buffer.first, buffer.second, allocator_);
+                }
+                else {
+                    tmp_buffer_.insert(tmp_buffer_.end(), buffer.first, buffer.first+buffer.second);
+                    stack_.emplace_back(Value::emplace_string, tmp_buffer_.data(), tmp_buffer_.size(), allocator_);
+                    tmp_buffer_.clear();
+                }
+            } else {
+                tmp_buffer_.insert(tmp_buffer_.end(), buffer.first, buffer.first+buffer.second);
+            }
+        }
+
+        // See value_generator::accepts_binary_imp().
+        bool accepts_binary_imp() const { return static_cast<bool>(this->binary_sink_); }
+
+        void value_binary_imp(const char* data, std::size_t size, bool hasMore)
+        {
+            base::value_binary_imp(data, size, hasMore);
+            if (depth_ >= level_ and !hasMore)
+                stack_.emplace_back(Value::emplace_null);
+        }
+
+        void value_number_imp(const number_desc_t& number)
+        {
+            if (depth_ < level_)
+                return;
+            if (number.is_integer()) {
+                stack_.emplace_back(Value::emplace_integral_number, number.c_str(), number.c_str_len());
+            }
+            else {
+                stack_.emplace_back(Value::emplace_float_number, number.c_str(), number.c_str_len());
+            }
+        }
+
+        void value_boolean_imp(bool b)
+        {
+            if (depth_ < level_)
+                return;
+            stack_.emplace_back(Value::emplace_boolean, b);
+        }
+
+        void value_null_imp()
+        {
+            if (depth_ < level_)
+                return;
+            stack_.emplace_back(Value::emplace_null);
+        }
+
+
+        void print_imp(std::ostream& os) {
+            os << static_cast<base const&>(*this);
+            os << "Streaming value generator:\n"
+               << "   streaming level: " << level_ << '\n'
+               << "   element count:   " << element_count_ << std::endl;
+        }
+
+        void clear_imp(bool shrink_buffers)
+        {
+            stack_.clear();
+            markers_.clear();
+            tmp_buffer_.clear();
+            key_.clear();
+            error_.reset();
+            depth_ = index_ = element_count_ = 0;
+            if (recycle_)
+                json::utility::recycle_allocator(allocator_);
+            if (shrink_buffers) {
+                tmp_buffer_.shrink_to_fit();
+            }
+        }
+
+        void error_imp(int code, const char* description) {
+            error_.set(code, description);
+        }
+
+        const error_t& error_imp() const {
+            return error_;
+        }
+
+
+    private:
+
+        // Passes the element on top of the stack to the handler, destroys it
+        // and recycles the allocator.
+        void deliver()
+        {
+            // The element may be incomplete if an error occurred:
+            if (stack_.size() != 1 or markers_.size() != 0)
+                return;
+            ++element_count_;
+            if (handler_) {
+                handler_(stack_.back());
+            }
+            stack_.clear();
+            if (recycle_)
+                json::utility::recycle_allocator(allocator_);
+        }
+
+
+    protected:
+        stack_t                 stack_;
+        markers_t               markers_;
+        string_temp_buffer_t    tmp_buffer_;
+        key_t                   key_;
+        error_t                 error_;
+        AllocatorT              allocator_;
+        element_handler_t       handler_;
+        size_t                  level_;
+        size_t                  depth_;
+        size_t                  index_;
+        size_t                  element_count_;
+        bool                    recycle_;
+    };
+
+
+} // namespace json
+
+
+
+#endif // JSON_PARSER_STREAMING_VALUE_GENERATOR_HPP
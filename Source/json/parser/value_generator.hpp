@@ -177,7 +177,7 @@ namespace json {
         :   allocator_(a),
             array_count(0), object_count(0), string_count(0), key_string_count(0),
             boolean_count(0), null_count (0), number_count(0),
-            max_stack_size(0)
+            max_stack_size(0), recycle_(false)
         {
             ++s_count_instances_;
             assert(stack_.size() == 0);
@@ -188,6 +188,13 @@ namespace json {
             --s_count_instances_;
         }
         
+        // Enables or disables recycling the arena when the semantic actions 
+        // object will be cleared. Has no effect if AllocatorT is not an arena 
+        // allocator. When enabled, a result which has been moved out must not 
+        // be used after clear() has been called.
+        void    recycle_arena(bool set)         { recycle_ = set; }
+        bool    recycle_arena() const           { return recycle_; }
+        
         
         void parse_begin_imp() {
             //error_.first = 0;
@@ -349,7 +356,7 @@ namespace json {
                     // append last chunk to the tmp buffer:
                     tmp_buffer_.insert(tmp_buffer_.end(), buffer.first, buffer.first+buffer.second);
                     // copy from tmp buffer to the stack:
-                    stack_.emplace_back(Value::emplace_string, buffer.first, tmp_buffer_.size(), allocator_);
+                    stack_.emplace_back(Value::emplace_string, tmp_buffer_.data(), tmp_buffer_.size(), allocator_);
                     tmp_buffer_.clear();
                 }
                 assert(stack_.back().is_string());
@@ -361,6 +368,20 @@ namespace json {
             //t0_.pause();
         }        
         
+        // Base64 encoded strings are decoded only if a binary sink has been
+        // set: the sink receives the decoded bytes and the value becomes null.
+        // Otherwise, the string value keeps the base64 encoded text.
+        bool accepts_binary_imp() const { return static_cast<bool>(this->binary_sink_); }
+        
+        void value_binary_imp(const char* data, std::size_t size, bool hasMore)
+        {
+            base::value_binary_imp(data, size, hasMore);
+            if (!hasMore) {
+                ++null_count;
+                stack_.emplace_back(Value::emplace_null);
+            }
+        }
+        
         void value_number_imp(const number_desc_t& number) 
         {
             //t0_.start();
@@ -409,7 +430,9 @@ namespace json {
             error_.reset();
             markers_.clear();
             tmp_buffer_.clear();
-            // TODO: allocator_.clear();
+            if (recycle_) {
+                json::utility::recycle_allocator(allocator_);
+            }
             
             if (shrink_buffers) {
                 tmp_buffer_.shrink_to_fit();
@@ -472,6 +495,7 @@ namespace json {
         size_t null_count;
         size_t number_count;
         size_t max_stack_size;
+        bool   recycle_;
         
         //    
         // Stream Output operator, defined as inline friend:    
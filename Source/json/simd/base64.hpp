@@ -0,0 +1,379 @@
+//
+//  base64.hpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#ifndef JSON_SIMD_BASE64_HPP
+#define JSON_SIMD_BASE64_HPP
+
+
+#include "json/simd/cpu_features.hpp"
+#include <cstdint>
+#include <cstring>
+
+#if defined (JSON_SIMD_X86_DISPATCH) || defined (__AVX2__)
+#include <immintrin.h>
+#elif defined (__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+
+namespace json { namespace simd {
+
+    //
+    //  Base64 Block Kernels
+    //
+    //  Encode and decode the bulk of a base64 sequence using the standard
+    //  alphabet (RFC 4648). The kernels process whole blocks only and leave
+    //  padding, whitespace, partial quads and error reporting to the caller,
+    //  see json/utility/base64.hpp.
+    //
+    //  Depending on active_isa(), the encoder converts 24 bytes into 32
+    //  characters at a time using AVX2, or 12 bytes into 16 characters using
+    //  SSSE3. The decoder converts 32 characters into 24 bytes using AVX2, or
+    //  16 characters into 12 bytes using SSSE3; it stops at the first block
+    //  which contains a character not in the alphabet. The vector kernels
+    //  are the ones of Muła and Lemire ("Faster Base64 Encoding and Decoding
+    //  Using AVX2 Instructions"). Otherwise, the kernels convert one quad at
+    //  a time using lookup tables.
+    //
+
+    namespace detail {
+
+        static const char base64_alphabet[] =
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        // Maps a character to its 6 bit value, or to -1 if it is not in the
+        // alphabet.
+        struct base64_decode_table
+        {
+            int8_t values[256];
+
+            base64_decode_table() {
+                std::memset(values, -1, sizeof(values));
+                for (int i = 0; i < 64; ++i) {
+                    values[static_cast<uint8_t>(base64_alphabet[i])] = static_cast<int8_t>(i);
+                }
+            }
+
+            int operator[](char c) const {
+                return values[static_cast<uint8_t>(c)];
+            }
+        };
+
+        inline const base64_decode_table& base64_values() {
+            static const base64_decode_table table;
+            return table;
+        }
+
+
+        inline void
+        base64_encode_scalar(const uint8_t*& src, const uint8_t* src_end, char*& dst)
+        {
+            const uint8_t* s = src;
+            char* d = dst;
+            while (src_end - s >= 3) {
+                const uint32_t n = (uint32_t(s[0]) << 16) | (uint32_t(s[1]) << 8) | s[2];
+                d[0] = base64_alphabet[n >> 18];
+                d[1] = base64_alphabet[(n >> 12) & 0x3Fu];
+                d[2] = base64_alphabet[(n >> 6) & 0x3Fu];
+                d[3] = base64_alphabet[n & 0x3Fu];
+                s += 3;
+                d += 4;
+            }
+            src = s;
+            dst = d;
+        }
+
+
+        inline void
+        base64_decode_scalar(const char*& src, const char* src_end, uint8_t*& dst, uint8_t* dst_end)
+        {
+            const base64_decode_table& table = base64_values();
+            const char* s = src;
+            uint8_t* d = dst;
+            while (src_end - s >= 4 and dst_end - d >= 3) {
+                const int a = table[s[0]];
+                const int b = table[s[1]];
+                const int c = table[s[2]];
+                const int e = table[s[3]];
+                if ((a | b | c | e) < 0)
+                    break;
+                const uint32_t n = (uint32_t(a) << 18) | (uint32_t(b) << 12) | (uint32_t(c) << 6) | uint32_t(e);
+                d[0] = static_cast<uint8_t>(n >> 16);
+                d[1] = static_cast<uint8_t>(n >> 8);
+                d[2] = static_cast<uint8_t>(n);
+                s += 4;
+                d += 3;
+            }
+            src = s;
+            dst = d;
+        }
+
+
+#if defined (__SSSE3__) || defined (JSON_SIMD_X86_DISPATCH)
+
+        // Maps 6 bit values to the characters of the alphabet.
+        JSON_SIMD_TARGET("ssse3")
+        inline __m128i base64_lookup_sse(__m128i indices)
+        {
+            __m128i result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+            const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+            result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+            const __m128i shift = _mm_setr_epi8(
+                'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                '/' - 63, 'A', 0, 0);
+            return _mm_add_epi8(_mm_shuffle_epi8(shift, result), indices);
+        }
+
+        // Splits 12 bytes - at offset 0 - into 16 6 bit values.
+        JSON_SIMD_TARGET("ssse3")
+        inline __m128i base64_split_sse(__m128i in)
+        {
+            in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+            const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+            const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+            const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+            const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+            return _mm_or_si128(t1, t3);
+        }
+
+        JSON_SIMD_TARGET("ssse3")
+        inline void
+        base64_encode_ssse3(const uint8_t*& src, const uint8_t* src_end, char*& dst)
+        {
+            // Reads 16 bytes and consumes 12:
+            while (src_end - src >= 16) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), base64_lookup_sse(base64_split_sse(in)));
+                src += 12;
+                dst += 16;
+            }
+            base64_encode_scalar(src, src_end, dst);
+        }
+
+        // Returns the 6 bit values of 16 characters in values, and returns
+        // false if a character is not in the alphabet.
+        JSON_SIMD_TARGET("ssse3")
+        inline bool base64_values_sse(__m128i in, __m128i& values)
+        {
+            const __m128i lut_lo = _mm_setr_epi8(
+                0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+            const __m128i lut_hi = _mm_setr_epi8(
+                0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+            const __m128i lut_roll = _mm_setr_epi8(
+                0, 16, 19, 4, -65, -65, -71, -71,
+                0, 0, 0, 0, 0, 0, 0, 0);
+            const __m128i mask = _mm_set1_epi8(0x0F);
+            const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(in, 4), mask);
+            const __m128i lo_nibbles = _mm_and_si128(in, mask);
+            const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+            const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+            if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0)
+                return false;
+            const __m128i eq_slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+            const __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_slash, hi_nibbles));
+            values = _mm_add_epi8(in, roll);
+            return true;
+        }
+
+        // Packs 16 6 bit values into 12 bytes at offset 0.
+        JSON_SIMD_TARGET("ssse3")
+        inline __m128i base64_pack_sse(__m128i values)
+        {
+            const __m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+            const __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+            return _mm_shuffle_epi8(packed, _mm_setr_epi8(
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        }
+
+        JSON_SIMD_TARGET("ssse3")
+        inline void
+        base64_decode_ssse3(const char*& src, const char* src_end, uint8_t*& dst, uint8_t* dst_end)
+        {
+            // Writes 16 bytes and produces 12:
+            while (src_end - src >= 16 and dst_end - dst >= 16) {
+                __m128i values;
+                if (not base64_values_sse(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), values))
+                    break;
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), base64_pack_sse(values));
+                src += 16;
+                dst += 12;
+            }
+            base64_decode_scalar(src, src_end, dst, dst_end);
+        }
+
+#define JSON_BASE64_HAS_SSSE3 1
+
+#endif
+
+#if defined (JSON_SIMD_X86_DISPATCH) || defined (__AVX2__)
+
+        JSON_SIMD_TARGET("avx2")
+        inline __m256i base64_lookup_avx2(__m256i indices)
+        {
+            __m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+            const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+            result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+            const __m256i shift = _mm256_setr_epi8(
+                'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                '/' - 63, 'A', 0, 0,
+                'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                '/' - 63, 'A', 0, 0);
+            return _mm256_add_epi8(_mm256_shuffle_epi8(shift, result), indices);
+        }
+
+        JSON_SIMD_TARGET("avx2")
+        inline void
+        base64_encode_avx2(const uint8_t*& src, const uint8_t* src_end, char*& dst)
+        {
+            // Each lane splits 12 bytes; reads 28 bytes and consumes 24:
+            const __m256i shuffle = _mm256_setr_epi8(
+                1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+            while (src_end - src >= 28) {
+                const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+                const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 12));
+                __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+                in = _mm256_shuffle_epi8(in, shuffle);
+                const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+                const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+                const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+                const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), base64_lookup_avx2(_mm256_or_si256(t1, t3)));
+                src += 24;
+                dst += 32;
+            }
+            base64_encode_ssse3(src, src_end, dst);
+        }
+
+        JSON_SIMD_TARGET("avx2")
+        inline void
+        base64_decode_avx2(const char*& src, const char* src_end, uint8_t*& dst, uint8_t* dst_end)
+        {
+            const __m256i lut_lo = _mm256_setr_epi8(
+                0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+                0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+            const __m256i lut_hi = _mm256_setr_epi8(
+                0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+            const __m256i lut_roll = _mm256_setr_epi8(
+                0, 16, 19, 4, -65, -65, -71, -71,
+                0, 0, 0, 0, 0, 0, 0, 0,
+                0, 16, 19, 4, -65, -65, -71, -71,
+                0, 0, 0, 0, 0, 0, 0, 0);
+            const __m256i mask = _mm256_set1_epi8(0x0F);
+            const __m256i pack_shuffle = _mm256_setr_epi8(
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+            const __m256i pack_permute = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1);
+
+            // Writes 32 bytes and produces 24:
+            while (src_end - src >= 32 and dst_end - dst >= 32) {
+                const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+                const __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask);
+                const __m256i lo_nibbles = _mm256_and_si256(in, mask);
+                const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+                const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+                if (not _mm256_testz_si256(lo, hi))
+                    break;
+                const __m256i eq_slash = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('/'));
+                const __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_slash, hi_nibbles));
+                const __m256i values = _mm256_add_epi8(in, roll);
+                const __m256i merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+                __m256i packed = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+                packed = _mm256_shuffle_epi8(packed, pack_shuffle);
+                packed = _mm256_permutevar8x32_epi32(packed, pack_permute);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), packed);
+                src += 32;
+                dst += 24;
+            }
+            base64_decode_ssse3(src, src_end, dst, dst_end);
+        }
+
+#define JSON_BASE64_HAS_AVX2 1
+
+#endif
+
+    } // namespace detail
+
+
+    //
+    //  void base64_encode_blocks(const uint8_t*& src, const uint8_t* src_end, char*& dst)
+    //
+    //  Encodes the complete groups of three bytes in [src, src_end) and
+    //  advances src and dst accordingly. That is, on return fewer than three
+    //  bytes remain, which the caller encodes with padding. dst requires room
+    //  for 4 characters per group.
+    //
+    inline void
+    base64_encode_blocks(const uint8_t*& src, const uint8_t* src_end, char*& dst)
+    {
+        const isa level = active_isa();
+#if defined (JSON_BASE64_HAS_AVX2)
+        if (level >= isa::avx2)
+            return detail::base64_encode_avx2(src, src_end, dst);
+#endif
+#if defined (JSON_BASE64_HAS_SSSE3)
+        if (level >= isa::ssse3)
+            return detail::base64_encode_ssse3(src, src_end, dst);
+#endif
+        (void)level;
+        detail::base64_encode_scalar(src, src_end, dst);
+    }
+
+
+    //
+    //  void base64_decode_blocks(const char*& src, const char* src_end,
+    //                            uint8_t*& dst, uint8_t* dst_end)
+    //
+    //  Decodes quads of characters of the alphabet from [src, src_end) into
+    //  [dst, dst_end) and advances src and dst accordingly. Stops at the
+    //  first quad which contains a character not in the alphabet - a padding
+    //  character, white space or an invalid character -, or when fewer than
+    //  four characters or three bytes of room remain. The caller handles
+    //  the remaining characters.
+    //
+    inline void
+    base64_decode_blocks(const char*& src, const char* src_end, uint8_t*& dst, uint8_t* dst_end)
+    {
+        const isa level = active_isa();
+#if defined (JSON_BASE64_HAS_AVX2)
+        if (level >= isa::avx2)
+            return detail::base64_decode_avx2(src, src_end, dst, dst_end);
+#endif
+#if defined (JSON_BASE64_HAS_SSSE3)
+        if (level >= isa::ssse3)
+            return detail::base64_decode_ssse3(src, src_end, dst, dst_end);
+#endif
+        (void)level;
+        detail::base64_decode_scalar(src, src_end, dst, dst_end);
+    }
+
+}}  // namespace json::simd
+
+
+#endif // JSON_SIMD_BASE64_HPP
@@ -0,0 +1,223 @@
+//
+//  cpu_features.hpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#ifndef JSON_SIMD_CPU_FEATURES_HPP
+#define JSON_SIMD_CPU_FEATURES_HPP
+
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+
+//
+//  JSON_SIMD_X86_DISPATCH
+//
+//  Defined if kernels for instruction sets beyond the compiler's target can
+//  be compiled - using function target attributes - and selected at run
+//  time. This requires GCC or Clang on x86. Define JSON_SIMD_NO_DISPATCH in
+//  order to compile only the kernels for the compiler's target.
+//
+//  JSON_SIMD_TARGET(isa) expands to the target attribute of a kernel which
+//  requires the instruction set isa, if dispatching is enabled.
+//
+#if (defined (__x86_64__) || defined (__i386__)) && defined (__SSE2__) \
+    && (defined (__GNUC__) || defined (__clang__)) && !defined (JSON_SIMD_NO_DISPATCH)
+#define JSON_SIMD_X86_DISPATCH 1
+#define JSON_SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define JSON_SIMD_TARGET(isa)
+#endif
+
+
+namespace json { namespace simd {
+
+    //
+    //  Runtime CPU Feature Dispatch
+    //
+    //  The vectorized kernels in json/simd select their implementation at
+    //  run time according to the "active" instruction set level, which
+    //  defaults to the best level supported by both the CPU and the compiled
+    //  kernels. With JSON_SIMD_X86_DISPATCH, a binary built for the SSE2
+    //  baseline uses the SSSE3 and AVX2 kernels where available.
+    //
+    //  The environment variable JSON_SIMD_LEVEL lowers the initial level,
+    //  for example in order to run the tests with the scalar kernels:
+    //
+    //      JSON_SIMD_LEVEL=scalar ./Test
+    //
+    //  Valid values are the names returned by isa_name(). A level beyond
+    //  the detected one is ignored.
+    //
+    //  The levels are ordered within an architecture only: a kernel for
+    //  level L is used if active_isa() >= L.
+    //
+
+    enum class isa : int {
+        scalar = 0,
+        neon,
+        sse2,
+        ssse3,
+        sse4_2,
+        avx2,
+        avx512
+    };
+
+
+    inline const char*
+    isa_name(isa level)
+    {
+        switch (level) {
+            case isa::scalar:   return "scalar";
+            case isa::neon:     return "neon";
+            case isa::sse2:     return "sse2";
+            case isa::ssse3:    return "ssse3";
+            case isa::sse4_2:   return "sse4.2";
+            case isa::avx2:     return "avx2";
+            case isa::avx512:   return "avx512";
+        }
+        return "unknown";
+    }
+
+
+    // Sets level and returns true if name is the name of a level.
+    inline bool
+    parse_isa(const char* name, isa& level)
+    {
+        static const isa levels[] = {
+            isa::scalar, isa::neon, isa::sse2, isa::ssse3, isa::sse4_2, isa::avx2, isa::avx512
+        };
+        for (isa l : levels) {
+            if (std::strcmp(name, isa_name(l)) == 0) {
+                level = l;
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+    namespace detail {
+
+        inline isa
+        detect_isa()
+        {
+#if defined (JSON_SIMD_X86_DISPATCH)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f") and __builtin_cpu_supports("avx512bw"))
+                return isa::avx512;
+            if (__builtin_cpu_supports("avx2"))
+                return isa::avx2;
+            if (__builtin_cpu_supports("sse4.2"))
+                return isa::sse4_2;
+            if (__builtin_cpu_supports("ssse3"))
+                return isa::ssse3;
+            return isa::sse2;
+#elif defined (__AVX2__)
+            return isa::avx2;
+#elif defined (__SSE4_2__)
+            return isa::sse4_2;
+#elif defined (__SSSE3__)
+            return isa::ssse3;
+#elif defined (__SSE2__)
+            return isa::sse2;
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+            return isa::neon;
+#else
+            return isa::scalar;
+#endif
+        }
+
+        inline std::atomic<int>&
+        active_isa_value();
+
+    }
+
+
+    //
+    //  isa detected_isa()
+    //
+    //  Returns the best level supported by the CPU and the compiled kernels.
+    //  The CPU will be queried once.
+    //
+    inline isa
+    detected_isa()
+    {
+        static const isa level = detail::detect_isa();
+        return level;
+    }
+
+
+    //
+    //  isa active_isa()
+    //
+    //  Returns the level the kernels currently use.
+    //
+    inline isa
+    active_isa()
+    {
+        return static_cast<isa>(detail::active_isa_value().load(std::memory_order_relaxed));
+    }
+
+
+    //
+    //  isa set_active_isa(isa level)
+    //
+    //  Selects the level the kernels use, limited to detected_isa(), and
+    //  returns the selected level. Intended for tests and benchmarks, which
+    //  run the kernels at each level. Kernels running concurrently may use
+    //  either level.
+    //
+    inline isa
+    set_active_isa(isa level)
+    {
+        if (level > detected_isa())
+            level = detected_isa();
+        detail::active_isa_value().store(static_cast<int>(level), std::memory_order_relaxed);
+        return level;
+    }
+
+
+    namespace detail {
+
+        inline isa
+        initial_isa()
+        {
+            isa level = detected_isa();
+            const char* name = std::getenv("JSON_SIMD_LEVEL");
+            isa requested;
+            if (name != nullptr and parse_isa(name, requested) and requested < level) {
+                level = requested;
+            }
+            return level;
+        }
+
+        inline std::atomic<int>&
+        active_isa_value()
+        {
+            static std::atomic<int> value(static_cast<int>(initial_isa()));
+            return value;
+        }
+
+    }
+
+}}  // namespace json::simd
+
+
+#endif // JSON_SIMD_CPU_FEATURES_HPP
@@ -0,0 +1,230 @@
+//
+//  escape_scan.hpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#ifndef JSON_SIMD_ESCAPE_SCAN_HPP
+#define JSON_SIMD_ESCAPE_SCAN_HPP
+
+
+#include "json/simd/cpu_features.hpp"
+#include <cstdint>
+#include <cstring>
+
+#if defined (JSON_SIMD_X86_DISPATCH) || defined (__AVX2__)
+#include <immintrin.h>
+#elif defined (__SSE2__)
+#include <emmintrin.h>
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+
+namespace json { namespace simd {
+
+    //
+    //  Escape Scanning
+    //
+    //  Finds the first byte in a UTF-8 sequence which requires to be escaped
+    //  when writing a JSON string. These are the quotation mark, the reverse
+    //  solidus and the control characters (U+0000 through U+001F). Optionally,
+    //  the solidus and any non-ASCII byte.
+    //
+    //  Depending on active_isa(), the scan processes 32 bytes at a time using
+    //  AVX2, 16 bytes at a time using SSE2 or NEON, or 8 bytes at a time using
+    //  SWAR ("SIMD within a register").
+    //
+
+
+    // Returns true if the byte requires to be escaped.
+    inline bool
+    needs_escape(unsigned char ch, bool escapeSolidus, bool escapeNonASCII)
+    {
+        return ch < 0x20u or ch == '"' or ch == '\\'
+            or (ch == '/' and escapeSolidus)
+            or (ch >= 0x80u and escapeNonASCII);
+    }
+
+
+    namespace detail {
+
+        inline const char*
+        find_escape_scalar(const char* first, const char* last, bool escapeSolidus, bool escapeNonASCII)
+        {
+            while (first != last and not needs_escape(static_cast<unsigned char>(*first), escapeSolidus, escapeNonASCII)) {
+                ++first;
+            }
+            return first;
+        }
+
+        // SWAR: tests 8 bytes at a time. The tests are exact with respect to
+        // whether any byte in a word matches, the position will be determined
+        // by a scalar scan of that word.
+
+        inline uint64_t swar_has_zero(uint64_t x) {
+            return (x - 0x0101010101010101ull) & ~x & 0x8080808080808080ull;
+        }
+
+        inline uint64_t swar_has_less(uint64_t x, unsigned char n) {
+            return (x - 0x0101010101010101ull * n) & ~x & 0x8080808080808080ull;
+        }
+
+        inline const char*
+        find_escape_swar(const char* first, const char* last, bool escapeSolidus, bool escapeNonASCII)
+        {
+            const uint64_t ones = 0x0101010101010101ull;
+            const uint64_t nonascii_mask = escapeNonASCII ? 0x8080808080808080ull : 0;
+            while (last - first >= 8) {
+                uint64_t x;
+                std::memcpy(&x, first, 8);
+                uint64_t m = swar_has_zero(x ^ (ones * '"'))
+                           | swar_has_zero(x ^ (ones * '\\'))
+                           | swar_has_less(x, 0x20)
+                           | (x & nonascii_mask);
+                if (escapeSolidus) {
+                    m |= swar_has_zero(x ^ (ones * '/'));
+                }
+                if (m != 0) {
+                    return find_escape_scalar(first, first + 8, escapeSolidus, escapeNonASCII);
+                }
+                first += 8;
+            }
+            return find_escape_scalar(first, last, escapeSolidus, escapeNonASCII);
+        }
+
+#if defined (__SSE2__)
+
+        inline const char*
+        find_escape_sse2(const char* first, const char* last, bool escapeSolidus, bool escapeNonASCII)
+        {
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i backslash = _mm_set1_epi8('\\');
+            // Comparing against the solidus is disabled by comparing against
+            // the quote a second time:
+            const __m128i solidus = _mm_set1_epi8(escapeSolidus ? '/' : '"');
+            const __m128i control_max = _mm_set1_epi8(0x1F);
+            const int nonascii_mask = escapeNonASCII ? 0xFFFF : 0;
+
+            while (last - first >= 16) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+                __m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash));
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(v, solidus));
+                // v <= 0x1F (unsigned) <=> max(v, 0x1F) == 0x1F
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(_mm_max_epu8(v, control_max), control_max));
+                int mask = _mm_movemask_epi8(m) | (_mm_movemask_epi8(v) & nonascii_mask);
+                if (mask != 0) {
+                    return first + __builtin_ctz(static_cast<unsigned int>(mask));
+                }
+                first += 16;
+            }
+            return find_escape_scalar(first, last, escapeSolidus, escapeNonASCII);
+        }
+
+#endif
+
+#if defined (JSON_SIMD_X86_DISPATCH) || defined (__AVX2__)
+
+        inline const char*
+        JSON_SIMD_TARGET("avx2")
+        find_escape_avx2(const char* first, const char* last, bool escapeSolidus, bool escapeNonASCII)
+        {
+            const __m256i quote = _mm256_set1_epi8('"');
+            const __m256i backslash = _mm256_set1_epi8('\\');
+            const __m256i solidus = _mm256_set1_epi8(escapeSolidus ? '/' : '"');
+            const __m256i control_max = _mm256_set1_epi8(0x1F);
+            const unsigned int nonascii_mask = escapeNonASCII ? 0xFFFFFFFFu : 0u;
+
+            while (last - first >= 32) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+                __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash));
+                m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, solidus));
+                m = _mm256_or_si256(m, _mm256_cmpeq_epi8(_mm256_max_epu8(v, control_max), control_max));
+                unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(m))
+                                  | (static_cast<unsigned int>(_mm256_movemask_epi8(v)) & nonascii_mask);
+                if (mask != 0) {
+                    return first + __builtin_ctz(mask);
+                }
+                first += 32;
+            }
+            return find_escape_sse2(first, last, escapeSolidus, escapeNonASCII);
+        }
+
+#endif
+
+#if defined (__ARM_NEON) || defined (__ARM_NEON__)
+
+        inline const char*
+        find_escape_neon(const char* first, const char* last, bool escapeSolidus, bool escapeNonASCII)
+        {
+            const uint8x16_t quote = vdupq_n_u8('"');
+            const uint8x16_t backslash = vdupq_n_u8('\\');
+            const uint8x16_t solidus = vdupq_n_u8(escapeSolidus ? '/' : '"');
+            const uint8x16_t control_end = vdupq_n_u8(0x20);
+            const uint8x16_t nonascii_start = vdupq_n_u8(escapeNonASCII ? 0x80 : 0xFF);
+            const uint8x16_t nonascii_enable = vdupq_n_u8(escapeNonASCII ? 0xFF : 0x00);
+
+            while (last - first >= 16) {
+                uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(first));
+                uint8x16_t m = vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash));
+                m = vorrq_u8(m, vceqq_u8(v, solidus));
+                m = vorrq_u8(m, vcltq_u8(v, control_end));
+                m = vorrq_u8(m, vandq_u8(vcgeq_u8(v, nonascii_start), nonascii_enable));
+                uint64x2_t m64 = vreinterpretq_u64_u8(m);
+                if ((vgetq_lane_u64(m64, 0) | vgetq_lane_u64(m64, 1)) != 0) {
+                    return find_escape_scalar(first, first + 16, escapeSolidus, escapeNonASCII);
+                }
+                first += 16;
+            }
+            return find_escape_scalar(first, last, escapeSolidus, escapeNonASCII);
+        }
+
+#endif
+
+    } // namespace detail
+
+
+    //
+    //  const char* find_escape(const char* first, const char* last,
+    //                          bool escapeSolidus, bool escapeNonASCII)
+    //
+    //  Returns a pointer to the first byte in the range [first, last) which
+    //  requires to be escaped, or last if there is none.
+    //
+    inline const char*
+    find_escape(const char* first, const char* last, bool escapeSolidus, bool escapeNonASCII = false)
+    {
+        const isa level = active_isa();
+#if defined (JSON_SIMD_X86_DISPATCH) || defined (__AVX2__)
+        if (level >= isa::avx2)
+            return detail::find_escape_avx2(first, last, escapeSolidus, escapeNonASCII);
+#endif
+#if defined (__SSE2__)
+        if (level >= isa::sse2)
+            return detail::find_escape_sse2(first, last, escapeSolidus, escapeNonASCII);
+#endif
+#if defined (__ARM_NEON) || defined (__ARM_NEON__)
+        if (level >= isa::neon)
+            return detail::find_escape_neon(first, last, escapeSolidus, escapeNonASCII);
+#endif
+        (void)level;
+        return detail::find_escape_swar(first, last, escapeSolidus, escapeNonASCII);
+    }
+
+}}  // namespace json::simd
+
+
+#endif // JSON_SIMD_ESCAPE_SCAN_HPP
@@ -0,0 +1,692 @@
+//
+//  transcode.hpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#ifndef JSON_SIMD_TRANSCODE_HPP
+#define JSON_SIMD_TRANSCODE_HPP
+
+
+#include "json/simd/utf8_validate.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#if defined (__SSSE3__) || defined (JSON_SIMD_X86_DISPATCH)
+#include <tmmintrin.h>
+#endif
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#elif defined (__aarch64__) && (defined (__ARM_NEON) || defined (__ARM_NEON__))
+#include <arm_neon.h>
+#define JSON_SIMD_TRANSCODE_NEON
+#endif
+
+
+namespace json { namespace simd {
+
+    //
+    //  Bulk Transcoding
+    //
+    //  Kernels which convert between UTF-8, UTF-16 and UTF-32 in host
+    //  endianness from and into contiguous buffers.
+    //
+    //  A kernel converts complete and well-formed characters only: it stops
+    //  in front of the first ill-formed or truncated sequence, or at the end
+    //  of the input, and advances `first` and `dest` past the converted
+    //  characters. Diagnosing the remaining input - and replacing ill-formed
+    //  sequences - is left to the character-wise converters in
+    //  unicode_converter.hpp. Well-formed is what the "safe" converters
+    //  accept: Unicode scalar values, that is no surrogates (except as pairs
+    //  in UTF-16), no overlong UTF-8 and nothing beyond U+10FFFF. The
+    //  destination shall be large enough to hold the result.
+    //
+    //  Runs of ASCII are widened and narrowed 16 code units at a time using
+    //  SSE2 or NEON, otherwise 8 at a time using SWAR. With SSE2, blocks of
+    //  eight 2-byte UTF-8 sequences are decoded and encoded at once, and runs
+    //  of UTF-16 without surrogates are widened and narrowed from and into
+    //  UTF-32. With SSSE3, blocks of four 3-byte UTF-8 sequences are decoded
+    //  at once. Everything else, in particular surrogate pairs and 4-byte
+    //  UTF-8 sequences, is handled by a scalar loop. The vector paths are
+    //  selected by active_isa(), which is read once per call.
+    //
+
+
+    namespace detail {
+
+        template <std::size_t N>
+        struct unit_size : std::integral_constant<std::size_t, N> {};
+
+        // The type used internally to access code units: UTF-8 is always
+        // accessed as unsigned char.
+        template <typename T>
+        struct transcode_unit {
+            typedef typename std::conditional<sizeof(T) == 1, unsigned char, T>::type type;
+        };
+
+
+#pragma mark - Scalar Decoding and Encoding
+
+        // Decodes the character at p. Returns the number of code units, or
+        // zero if the sequence is ill-formed or truncated.
+
+        inline int
+        decode(const unsigned char* p, const unsigned char* end, uint32_t& cp, unit_size<1>)
+        {
+            const uint32_t c0 = p[0];
+            if (c0 < 0x80u) {
+                cp = c0;
+                return 1;
+            }
+            const std::ptrdiff_t n = end - p;
+            if (c0 < 0xC2u) {
+                return 0;
+            }
+            if (c0 < 0xE0u) {
+                if (n < 2 or (p[1] & 0xC0u) != 0x80u)
+                    return 0;
+                cp = ((c0 & 0x1Fu) << 6) | (p[1] & 0x3Fu);
+                return 2;
+            }
+            if (c0 < 0xF0u) {
+                if (n < 3 or (p[1] & 0xC0u) != 0x80u or (p[2] & 0xC0u) != 0x80u)
+                    return 0;
+                cp = ((c0 & 0x0Fu) << 12) | ((p[1] & 0x3Fu) << 6) | (p[2] & 0x3Fu);
+                return (cp >= 0x800u and (cp & 0xF800u) != 0xD800u) ? 3 : 0;
+            }
+            if (c0 < 0xF5u) {
+                if (n < 4 or (p[1] & 0xC0u) != 0x80u or (p[2] & 0xC0u) != 0x80u or (p[3] & 0xC0u) != 0x80u)
+                    return 0;
+                cp = ((c0 & 0x07u) << 18) | ((p[1] & 0x3Fu) << 12) | ((p[2] & 0x3Fu) << 6) | (p[3] & 0x3Fu);
+                return (cp >= 0x10000u and cp <= 0x10FFFFu) ? 4 : 0;
+            }
+            return 0;
+        }
+
+        template <typename U>
+        inline int
+        decode(const U* p, const U* end, uint32_t& cp, unit_size<2>)
+        {
+            const uint32_t u = static_cast<uint16_t>(p[0]);
+            if ((u & 0xF800u) != 0xD800u) {
+                cp = u;
+                return 1;
+            }
+            if (u >= 0xDC00u or end - p < 2)
+                return 0;
+            const uint32_t t = static_cast<uint16_t>(p[1]);
+            if ((t & 0xFC00u) != 0xDC00u)
+                return 0;
+            cp = 0x10000u + ((u - 0xD800u) << 10) + (t - 0xDC00u);
+            return 2;
+        }
+
+        template <typename U>
+        inline int
+        decode(const U* p, const U*, uint32_t& cp, unit_size<4>)
+        {
+            const uint32_t u = static_cast<uint32_t>(p[0]);
+            if ((u & 0xFFFFF800u) == 0xD800u or u > 0x10FFFFu)
+                return 0;
+            cp = u;
+            return 1;
+        }
+
+
+        inline void
+        encode(unsigned char*& d, uint32_t cp, unit_size<1>)
+        {
+            if (cp < 0x80u) {
+                *d++ = static_cast<unsigned char>(cp);
+            }
+            else if (cp < 0x800u) {
+                d[0] = static_cast<unsigned char>(0xC0u | (cp >> 6));
+                d[1] = static_cast<unsigned char>(0x80u | (cp & 0x3Fu));
+                d += 2;
+            }
+            else if (cp < 0x10000u) {
+                d[0] = static_cast<unsigned char>(0xE0u | (cp >> 12));
+                d[1] = static_cast<unsigned char>(0x80u | ((cp >> 6) & 0x3Fu));
+                d[2] = static_cast<unsigned char>(0x80u | (cp & 0x3Fu));
+                d += 3;
+            }
+            else {
+                d[0] = static_cast<unsigned char>(0xF0u | (cp >> 18));
+                d[1] = static_cast<unsigned char>(0x80u | ((cp >> 12) & 0x3Fu));
+                d[2] = static_cast<unsigned char>(0x80u | ((cp >> 6) & 0x3Fu));
+                d[3] = static_cast<unsigned char>(0x80u | (cp & 0x3Fu));
+                d += 4;
+            }
+        }
+
+        template <typename U>
+        inline void
+        encode(U*& d, uint32_t cp, unit_size<2>)
+        {
+            if (cp < 0x10000u) {
+                *d++ = static_cast<U>(cp);
+            }
+            else {
+                cp -= 0x10000u;
+                d[0] = static_cast<U>(0xD800u + (cp >> 10));
+                d[1] = static_cast<U>(0xDC00u + (cp & 0x3FFu));
+                d += 2;
+            }
+        }
+
+        template <typename U>
+        inline void
+        encode(U*& d, uint32_t cp, unit_size<4>)
+        {
+            *d++ = static_cast<U>(cp);
+        }
+
+
+#pragma mark - Vector Helpers
+
+#if defined (__SSE2__)
+
+        // Stores eight 16-bit lanes as UTF-16 or UTF-32 code units.
+        template <typename U>
+        inline void
+        store_units(U* d, __m128i v, unit_size<2>)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d), v);
+        }
+
+        template <typename U>
+        inline void
+        store_units(U* d, __m128i v, unit_size<4>)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d), _mm_unpacklo_epi16(v, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 4), _mm_unpackhi_epi16(v, zero));
+        }
+
+        // Loads eight UTF-16 or UTF-32 code units into 16-bit lanes. Returns
+        // false if a UTF-32 code unit does not fit.
+        template <typename U>
+        inline bool
+        load_units(const U* p, __m128i& v, unit_size<2>)
+        {
+            v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            return true;
+        }
+
+        template <typename U>
+        inline bool
+        load_units(const U* p, __m128i& v, unit_size<4>)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 4));
+            const __m128i high = _mm_srli_epi32(_mm_or_si128(a, b), 16);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, _mm_setzero_si128())) != 0xFFFF)
+                return false;
+            // There is no unsigned saturating 32 to 16 bit pack in SSE2: bias
+            // the values into the signed range, pack and remove the bias.
+            const __m128i bias = _mm_set1_epi32(0x8000);
+            v = _mm_add_epi16(_mm_packs_epi32(_mm_sub_epi32(a, bias), _mm_sub_epi32(b, bias)),
+                              _mm_set1_epi16(-0x8000));
+            return true;
+        }
+
+        // Returns a mask with all bits of a 16-bit lane set if the lane is a
+        // surrogate.
+        inline __m128i
+        surrogate_lanes(__m128i v)
+        {
+            return _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xF800))),
+                                   _mm_set1_epi16(static_cast<short>(0xD800)));
+        }
+
+#elif defined (JSON_SIMD_TRANSCODE_NEON)
+
+        template <typename U>
+        inline void
+        store_units(U* d, uint16x8_t v, unit_size<2>)
+        {
+            std::memcpy(d, &v, sizeof(v));
+        }
+
+        template <typename U>
+        inline void
+        store_units(U* d, uint16x8_t v, unit_size<4>)
+        {
+            const uint32x4_t lo = vmovl_u16(vget_low_u16(v));
+            const uint32x4_t hi = vmovl_u16(vget_high_u16(v));
+            std::memcpy(d, &lo, sizeof(lo));
+            std::memcpy(d + 4, &hi, sizeof(hi));
+        }
+
+        // Loads eight UTF-16 or UTF-32 code units and narrows them to bytes.
+        // Returns false if a code unit is not ASCII.
+        template <typename U>
+        inline bool
+        load_ascii(const U* p, uint8x8_t& v, unit_size<2>)
+        {
+            uint16x8_t u;
+            std::memcpy(&u, p, sizeof(u));
+            if (vmaxvq_u16(u) >= 0x80u)
+                return false;
+            v = vmovn_u16(u);
+            return true;
+        }
+
+        template <typename U>
+        inline bool
+        load_ascii(const U* p, uint8x8_t& v, unit_size<4>)
+        {
+            uint32x4_t a, b;
+            std::memcpy(&a, p, sizeof(a));
+            std::memcpy(&b, p + 4, sizeof(b));
+            if (vmaxvq_u32(vmaxq_u32(a, b)) >= 0x80u)
+                return false;
+            v = vmovn_u16(vcombine_u16(vmovn_u32(a), vmovn_u32(b)));
+            return true;
+        }
+
+#endif
+
+
+#pragma mark - Runs
+
+        // Converts a run of characters which map one to one, that is ASCII
+        // when reading or writing UTF-8, and BMP characters other than
+        // surrogates between UTF-16 and UTF-32.
+
+        template <typename U, std::size_t M>
+        inline void
+        convert_run(const unsigned char*& p, const unsigned char* end, U*& d, unit_size<1>, unit_size<M> to, isa level)
+        {
+#if defined (__SSE2__)
+            const __m128i zero = _mm_setzero_si128();
+            while (level >= isa::sse2 and end - p >= 16) {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                const int mask = _mm_movemask_epi8(v);
+                if (mask != 0) {
+                    const int n = __builtin_ctz(static_cast<unsigned int>(mask));
+                    for (int i = 0; i < n; ++i) {
+                        d[i] = static_cast<U>(p[i]);
+                    }
+                    p += n;
+                    d += n;
+                    return;
+                }
+                store_units(d, _mm_unpacklo_epi8(v, zero), to);
+                store_units(d + 8, _mm_unpackhi_epi8(v, zero), to);
+                p += 16;
+                d += 16;
+            }
+#elif defined (JSON_SIMD_TRANSCODE_NEON)
+            while (level >= isa::neon and end - p >= 16) {
+                const uint8x16_t v = vld1q_u8(p);
+                if (vmaxvq_u8(v) >= 0x80u)
+                    break;
+                store_units(d, vmovl_u8(vget_low_u8(v)), to);
+                store_units(d + 8, vmovl_u8(vget_high_u8(v)), to);
+                p += 16;
+                d += 16;
+            }
+#endif
+            while (end - p >= 8) {
+                uint64_t w;
+                std::memcpy(&w, p, sizeof(w));
+                if ((w & 0x8080808080808080ull) != 0)
+                    break;
+                for (int i = 0; i < 8; ++i) {
+                    d[i] = static_cast<U>(p[i]);
+                }
+                p += 8;
+                d += 8;
+            }
+            while (p != end and *p < 0x80u) {
+                *d++ = static_cast<U>(*p++);
+            }
+        }
+
+        template <typename U, std::size_t N>
+        inline void
+        convert_run(const U*& p, const U* end, unsigned char*& d, unit_size<N> from, unit_size<1>, isa level)
+        {
+#if defined (__SSE2__)
+            const __m128i not_ascii = _mm_set1_epi16(-0x80);
+            const __m128i zero = _mm_setzero_si128();
+            while (level >= isa::sse2 and end - p >= 16) {
+                __m128i a, b;
+                if (not load_units(p, a, from) or not load_units(p + 8, b, from))
+                    break;
+                const __m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(a, b), not_ascii), zero);
+                if (_mm_movemask_epi8(ascii) != 0xFFFF)
+                    break;
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(d), _mm_packus_epi16(a, b));
+                p += 16;
+                d += 16;
+            }
+#elif defined (JSON_SIMD_TRANSCODE_NEON)
+            while (level >= isa::neon and end - p >= 8) {
+                uint8x8_t v;
+                if (not load_ascii(p, v, from))
+                    break;
+                vst1_u8(d, v);
+                p += 8;
+                d += 8;
+            }
+#endif
+            while (p != end and static_cast<uint32_t>(*p) < 0x80u) {
+                *d++ = static_cast<unsigned char>(*p++);
+            }
+        }
+
+        template <typename T, typename U>
+        inline void
+        convert_run(const T*& p, const T* end, U*& d, unit_size<2> from, unit_size<4> to, isa level)
+        {
+#if defined (__SSE2__)
+            while (level >= isa::sse2 and end - p >= 8) {
+                __m128i v;
+                load_units(p, v, from);
+                if (_mm_movemask_epi8(surrogate_lanes(v)) != 0)
+                    break;
+                store_units(d, v, to);
+                p += 8;
+                d += 8;
+            }
+#endif
+            while (p != end and (static_cast<uint16_t>(*p) & 0xF800u) != 0xD800u) {
+                *d++ = static_cast<U>(static_cast<uint16_t>(*p++));
+            }
+        }
+
+        template <typename T, typename U>
+        inline void
+        convert_run(const T*& p, const T* end, U*& d, unit_size<4> from, unit_size<2> to, isa level)
+        {
+#if defined (__SSE2__)
+            while (level >= isa::sse2 and end - p >= 8) {
+                __m128i v;
+                if (not load_units(p, v, from) or _mm_movemask_epi8(surrogate_lanes(v)) != 0)
+                    break;
+                store_units(d, v, to);
+                p += 8;
+                d += 8;
+            }
+#endif
+            while (p != end) {
+                const uint32_t u = static_cast<uint32_t>(*p);
+                if (u >= 0x10000u or (u & 0xF800u) == 0xD800u)
+                    break;
+                *d++ = static_cast<U>(u);
+                ++p;
+            }
+        }
+
+
+#pragma mark - Blocks
+
+        // Converts a block of multi-byte UTF-8 characters which all have the
+        // same length. Returns false and leaves p and d unchanged if the input
+        // does not start with such a block.
+
+        template <typename T, typename U, std::size_t N, std::size_t M>
+        inline bool
+        convert_block(const T*&, const T*, U*&, unit_size<N>, unit_size<M>, isa)
+        {
+            return false;
+        }
+
+#if defined (__SSE2__)
+
+#if defined (__SSSE3__) || defined (JSON_SIMD_X86_DISPATCH)
+        // Stores four 32-bit lanes as UTF-16 or UTF-32 code units.
+        template <typename U>
+        inline void
+        JSON_SIMD_TARGET("ssse3")
+        store_block3(U* d, __m128i cp, unit_size<2>)
+        {
+            const __m128i packed = _mm_shuffle_epi8(cp, _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(d), packed);
+        }
+
+        template <typename U>
+        inline void
+        JSON_SIMD_TARGET("ssse3")
+        store_block3(U* d, __m128i cp, unit_size<4>)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d), cp);
+        }
+
+        // Four 3-byte sequences in the first 12 bytes of v. Gathers each
+        // sequence b0 b1 b2 into a 32-bit lane as b0 << 16 | b1 << 8 | b2.
+        template <typename U, std::size_t M>
+        inline bool
+        JSON_SIMD_TARGET("ssse3")
+        convert_block3(const unsigned char*& p, U*& d, __m128i v, unit_size<M> to)
+        {
+            const __m128i w = _mm_shuffle_epi8(v, _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1));
+            const __m128i pattern3 = _mm_cmpeq_epi32(_mm_and_si128(w, _mm_set1_epi32(0x00F0C0C0)),
+                                                     _mm_set1_epi32(0x00E08080));
+            const __m128i cp3 = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(w, 4), _mm_set1_epi32(0xF000)),
+                                                          _mm_and_si128(_mm_srli_epi32(w, 2), _mm_set1_epi32(0x0FC0))),
+                                             _mm_and_si128(w, _mm_set1_epi32(0x3F)));
+            const __m128i overlong3 = _mm_cmplt_epi32(cp3, _mm_set1_epi32(0x800));
+            const __m128i surrogate3 = _mm_cmpeq_epi32(_mm_and_si128(cp3, _mm_set1_epi32(0xF800)),
+                                                       _mm_set1_epi32(0xD800));
+            if (_mm_movemask_epi8(_mm_andnot_si128(_mm_or_si128(overlong3, surrogate3), pattern3)) != 0xFFFF)
+                return false;
+            store_block3(d, cp3, to);
+            p += 12;
+            d += 4;
+            return true;
+        }
+#endif
+
+        template <typename U, std::size_t M>
+        inline bool
+        convert_block(const unsigned char*& p, const unsigned char* end, U*& d, unit_size<1>, unit_size<M> to, isa level)
+        {
+            if (level < isa::sse2 or end - p < 16)
+                return false;
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i zero = _mm_setzero_si128();
+
+            // Eight 2-byte sequences: each 16-bit lane holds a lead byte
+            // 110xxxxx in its low byte and a continuation byte 10xxxxxx in its
+            // high byte, and the lead byte is not C0 or C1 (overlong):
+            const __m128i pattern = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xC0E0))),
+                                                    _mm_set1_epi16(static_cast<short>(0x80C0)));
+            const __m128i overlong = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(0x001E)), zero);
+            if (_mm_movemask_epi8(_mm_andnot_si128(overlong, pattern)) == 0xFFFF) {
+                const __m128i cp = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(v, _mm_set1_epi16(0x1F)), 6),
+                                                _mm_and_si128(_mm_srli_epi16(v, 8), _mm_set1_epi16(0x3F)));
+                store_units(d, cp, to);
+                p += 16;
+                d += 8;
+                return true;
+            }
+
+#if defined (__SSSE3__) || defined (JSON_SIMD_X86_DISPATCH)
+            if (level >= isa::ssse3)
+                return convert_block3(p, d, v, to);
+#endif
+            return false;
+        }
+
+
+        template <typename T, std::size_t N>
+        inline bool
+        convert_block(const T*& p, const T* end, unsigned char*& d, unit_size<N> from, unit_size<1>, isa level)
+        {
+            // Eight characters in the range U+0080 through U+07FF, which
+            // encode as lead byte 110xxxxx followed by 10xxxxxx. Build both
+            // bytes in a 16-bit lane, the lead byte being the low byte:
+            __m128i v;
+            if (level < isa::sse2 or end - p < 8 or not load_units(p, v, from))
+                return false;
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i fits = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xF800))), zero);
+            const __m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(-0x80)), zero);
+            if (_mm_movemask_epi8(_mm_andnot_si128(ascii, fits)) != 0xFFFF)
+                return false;
+            const __m128i lead = _mm_or_si128(_mm_srli_epi16(v, 6), _mm_set1_epi16(0xC0));
+            const __m128i trail = _mm_or_si128(_mm_and_si128(v, _mm_set1_epi16(0x3F)), _mm_set1_epi16(0x80));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d), _mm_or_si128(lead, _mm_slli_epi16(trail, 8)));
+            p += 8;
+            d += 16;
+            return true;
+        }
+
+#endif  // __SSE2__
+
+
+#pragma mark - Transcoding Loop
+
+        template <typename T, typename U>
+        inline void
+        transcode(const T*& p, const T* end, U*& d)
+        {
+            const unit_size<sizeof(T)> from;
+            const unit_size<sizeof(U)> to;
+            const isa level = active_isa();
+            while (p != end) {
+                convert_run(p, end, d, from, to, level);
+                if (p == end)
+                    break;
+                if (convert_block(p, end, d, from, to, level))
+                    continue;
+                uint32_t cp;
+                const int n = decode(p, end, cp, from);
+                if (n == 0)
+                    break;
+                p += n;
+                encode(d, cp, to);
+            }
+        }
+
+        template <typename InIteratorT, typename OutIteratorT>
+        inline void
+        transcode_range(InIteratorT& first, InIteratorT last, OutIteratorT& dest)
+        {
+            static_assert(std::is_pointer<InIteratorT>::value and std::is_pointer<OutIteratorT>::value,
+                          "bulk transcoding requires pointers");
+            typedef typename std::remove_cv<typename std::remove_pointer<InIteratorT>::type>::type in_char_t;
+            typedef typename std::remove_pointer<OutIteratorT>::type out_char_t;
+            typedef typename transcode_unit<in_char_t>::type in_unit_t;
+            typedef typename transcode_unit<out_char_t>::type out_unit_t;
+
+            const in_unit_t* p = reinterpret_cast<const in_unit_t*>(first);
+            const in_unit_t* const begin = p;
+            out_unit_t* d = reinterpret_cast<out_unit_t*>(dest);
+            out_unit_t* const dbegin = d;
+            transcode(p, reinterpret_cast<const in_unit_t*>(last), d);
+            first += p - begin;
+            dest += d - dbegin;
+        }
+
+    } // namespace detail
+
+
+
+    //
+    //  void utf8_to_utf16(InIteratorT& first, InIteratorT last, OutIteratorT& dest)
+    //  void utf8_to_utf32(...), utf16_to_utf8(...), utf16_to_utf32(...),
+    //  utf32_to_utf8(...), utf32_to_utf16(...)
+    //
+    //  Converts the longest prefix of [first, last) which consists of complete
+    //  and well-formed characters, and writes the result to dest. Both
+    //  iterators shall be pointers to code units whose size matches the
+    //  encoding; UTF-16 and UTF-32 are in host endianness. On return, first
+    //  points to the first character which has not been converted, and dest
+    //  past the last code unit written.
+    //
+
+    template <typename InIteratorT, typename OutIteratorT>
+    inline void
+    utf8_to_utf16(InIteratorT& first, InIteratorT last, OutIteratorT& dest)
+    {
+        static_assert(sizeof(*first) == 1 and sizeof(*dest) == 2, "");
+        detail::transcode_range(first, last, dest);
+    }
+
+    template <typename InIteratorT, typename OutIteratorT>
+    inline void
+    utf8_to_utf32(InIteratorT& first, InIteratorT last, OutIteratorT& dest)
+    {
+        static_assert(sizeof(*first) == 1 and sizeof(*dest) == 4, "");
+        detail::transcode_range(first, last, dest);
+    }
+
+    template <typename InIteratorT, typename OutIteratorT>
+    inline void
+    utf16_to_utf8(InIteratorT& first, InIteratorT last, OutIteratorT& dest)
+    {
+        static_assert(sizeof(*first) == 2 and sizeof(*dest) == 1, "");
+        detail::transcode_range(first, last, dest);
+    }
+
+    template <typename InIteratorT, typename OutIteratorT>
+    inline void
+    utf16_to_utf32(InIteratorT& first, InIteratorT last, OutIteratorT& dest)
+    {
+        static_assert(sizeof(*first) == 2 and sizeof(*dest) == 4, "");
+        detail::transcode_range(first, last, dest);
+    }
+
+    template <typename InIteratorT, typename OutIteratorT>
+    inline void
+    utf32_to_utf8(InIteratorT& first, InIteratorT last, OutIteratorT& dest)
+    {
+        static_assert(sizeof(*first) == 4 and sizeof(*dest) == 1, "");
+        detail::transcode_range(first, last, dest);
+    }
+
+    template <typename InIteratorT, typename OutIteratorT>
+    inline void
+    utf32_to_utf16(InIteratorT& first, InIteratorT last, OutIteratorT& dest)
+    {
+        static_assert(sizeof(*first) == 4 and sizeof(*dest) == 2, "");
+        detail::transcode_range(first, last, dest);
+    }
+
+
+    //
+    //  void utf8_to_utf8(InIteratorT& first, InIteratorT last, OutIteratorT& dest)
+    //
+    //  Copies the longest prefix of [first, last) which consists of complete
+    //  and well-formed UTF-8 characters.
+    //
+    template <typename InIteratorT, typename OutIteratorT>
+    inline void
+    utf8_to_utf8(InIteratorT& first, InIteratorT last, OutIteratorT& dest)
+    {
+        static_assert(std::is_pointer<InIteratorT>::value and std::is_pointer<OutIteratorT>::value,
+                      "bulk transcoding requires pointers");
+        static_assert(sizeof(*first) == 1 and sizeof(*dest) == 1, "");
+        const char* begin = reinterpret_cast<const char*>(first);
+        const std::size_t n = static_cast<std::size_t>(
+            utf8_valid_prefix(begin, reinterpret_cast<const char*>(last)) - begin);
+        if (n != 0) {
+            std::memcpy(dest, first, n);
+        }
+        first += n;
+        dest += n;
+    }
+
+}}  // namespace json::simd
+
+
+#endif // JSON_SIMD_TRANSCODE_HPP
@@ -0,0 +1,375 @@
+//
+//  utf8_validate.hpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#ifndef JSON_SIMD_UTF8_VALIDATE_HPP
+#define JSON_SIMD_UTF8_VALIDATE_HPP
+
+
+#include "json/simd/cpu_features.hpp"
+#include <cstdint>
+#include <cstring>
+
+#if defined (__SSSE3__) || defined (JSON_SIMD_X86_DISPATCH)
+#include <tmmintrin.h>
+#elif defined (__aarch64__) && (defined (__ARM_NEON) || defined (__ARM_NEON__))
+#include <arm_neon.h>
+#endif
+
+
+namespace json { namespace simd {
+
+    //
+    //  UTF-8 Validation
+    //
+    //  Validates UTF-8 in blocks of 16 bytes, using the lookup table approach
+    //  of Keiser and Lemire ("Validating UTF-8 In Less Than One Instruction
+    //  Per Byte"): three table lookups on the high and low nibble of a byte
+    //  and the high nibble of its successor classify all errors which can be
+    //  detected from two consecutive bytes; the required number of
+    //  continuation bytes after 3 and 4 byte sequences is checked separately.
+    //
+    //  Valid UTF-8 is exactly what the "safe" UTF-8 parser in
+    //  unicode_converter.hpp accepts: no overlong forms, no surrogates and
+    //  no code points beyond U+10FFFF.
+    //
+    //  The vectorized validator requires SSSE3 or AArch64 NEON and will be
+    //  selected by active_isa(). Otherwise, a scalar validator which skips
+    //  ASCII 8 bytes at a time will be used.
+    //
+
+
+    namespace detail {
+
+        inline bool utf8_is_trail(unsigned char c) {
+            return (c & 0xC0u) == 0x80u;
+        }
+
+        // Returns a pointer to the first byte of the first character in
+        // [first, last) which is invalid or incomplete, or last.
+        inline const char*
+        utf8_valid_prefix_scalar(const char* first, const char* last)
+        {
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(first);
+            const unsigned char* end = reinterpret_cast<const unsigned char*>(last);
+            while (p != end) {
+                // ASCII, 8 bytes at a time:
+                while (end - p >= 8) {
+                    uint64_t x;
+                    std::memcpy(&x, p, 8);
+                    if ((x & 0x8080808080808080ull) != 0)
+                        break;
+                    p += 8;
+                }
+                if (p == end)
+                    break;
+                const unsigned char c = *p;
+                if (c < 0x80u) {
+                    ++p;
+                    continue;
+                }
+                if (c < 0xC2u) {
+                    break;
+                }
+                else if (c < 0xE0u) {
+                    if (end - p < 2 or not utf8_is_trail(p[1]))
+                        break;
+                    p += 2;
+                }
+                else if (c < 0xF0u) {
+                    if (end - p < 3
+                        or not ((c == 0xE0u) ? (p[1] >= 0xA0u and p[1] <= 0xBFu) :
+                                (c == 0xEDu) ? (p[1] >= 0x80u and p[1] <= 0x9Fu) :
+                                utf8_is_trail(p[1]))
+                        or not utf8_is_trail(p[2]))
+                        break;
+                    p += 3;
+                }
+                else if (c < 0xF5u) {
+                    if (end - p < 4
+                        or not ((c == 0xF0u) ? (p[1] >= 0x90u and p[1] <= 0xBFu) :
+                                (c == 0xF4u) ? (p[1] >= 0x80u and p[1] <= 0x8Fu) :
+                                utf8_is_trail(p[1]))
+                        or not utf8_is_trail(p[2])
+                        or not utf8_is_trail(p[3]))
+                        break;
+                    p += 4;
+                }
+                else {
+                    break;
+                }
+            }
+            return reinterpret_cast<const char*>(p);
+        }
+
+
+        // Returns the start of the first character which ends at or after p,
+        // assuming the bytes before p are valid UTF-8.
+        inline const char*
+        utf8_character_start(const char* first, const char* p)
+        {
+            const char* q = (p - first) > 3 ? p - 3 : first;
+            while (q != p and utf8_is_trail(static_cast<unsigned char>(*q))) {
+                ++q;
+            }
+            return q;
+        }
+
+
+        // Error classes of two consecutive bytes:
+        enum {
+            TOO_SHORT   = 1 << 0,   // 11______ 0_______ or 11______ 11______
+            TOO_LONG    = 1 << 1,   // 0_______ 10______
+            OVERLONG_3  = 1 << 2,   // 11100000 100_____
+            TOO_LARGE   = 1 << 3,   // 11110100 1001____ ... 11111___ 101_____
+            SURROGATE   = 1 << 4,   // 11101101 101_____
+            OVERLONG_2  = 1 << 5,   // 1100000_ 10______
+            TOO_LARGE_1000 = 1 << 6,// 11110101 1000____ ... 11111___ 1000____
+            OVERLONG_4  = 1 << 6,   // 11110000 1000____
+            TWO_CONTS   = 1 << 7,   // 10______ 10______
+            CARRY       = TOO_SHORT | TOO_LONG | TWO_CONTS
+        };
+
+#define JSON_UTF8_BYTE_1_HIGH \
+            TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, \
+            TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, \
+            TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS, \
+            TOO_SHORT | OVERLONG_2, \
+            TOO_SHORT, \
+            TOO_SHORT | OVERLONG_3 | SURROGATE, \
+            TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4
+
+#define JSON_UTF8_BYTE_1_LOW \
+            CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4, \
+            CARRY | OVERLONG_2, \
+            CARRY, \
+            CARRY, \
+            CARRY | TOO_LARGE, \
+            CARRY | TOO_LARGE | TOO_LARGE_1000, \
+            CARRY | TOO_LARGE | TOO_LARGE_1000, \
+            CARRY | TOO_LARGE | TOO_LARGE_1000, \
+            CARRY | TOO_LARGE | TOO_LARGE_1000, \
+            CARRY | TOO_LARGE | TOO_LARGE_1000, \
+            CARRY | TOO_LARGE | TOO_LARGE_1000, \
+            CARRY | TOO_LARGE | TOO_LARGE_1000, \
+            CARRY | TOO_LARGE | TOO_LARGE_1000, \
+            CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE, \
+            CARRY | TOO_LARGE | TOO_LARGE_1000, \
+            CARRY | TOO_LARGE | TOO_LARGE_1000
+
+#define JSON_UTF8_BYTE_2_HIGH \
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, \
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, \
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4, \
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE, \
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE  | TOO_LARGE, \
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE  | TOO_LARGE, \
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+
+#if defined (__SSSE3__) || defined (JSON_SIMD_X86_DISPATCH)
+
+        // All members use SSSE3 instructions, and thus have the SSSE3 target
+        // attribute if the compiler's target is SSE2 only.
+        struct utf8_block_checker
+        {
+            JSON_SIMD_TARGET("ssse3")
+            utf8_block_checker()
+            :   prev_(_mm_setzero_si128()),
+                byte_1_high_(_mm_setr_epi8(JSON_UTF8_BYTE_1_HIGH)),
+                byte_1_low_(_mm_setr_epi8(JSON_UTF8_BYTE_1_LOW)),
+                byte_2_high_(_mm_setr_epi8(JSON_UTF8_BYTE_2_HIGH)),
+                nibble_mask_(_mm_set1_epi8(0x0F))
+            {}
+
+            // Returns true if the block - together with the preceding blocks -
+            // is valid, except for a possibly incomplete character at its end.
+            JSON_SIMD_TARGET("ssse3")
+            bool check(const char* p)
+            {
+                const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                bool result;
+                if (_mm_movemask_epi8(input) == 0) {
+                    // ASCII: valid unless the previous block ends with an
+                    // incomplete character.
+                    result = _mm_movemask_epi8(_mm_cmpeq_epi8(incomplete(prev_), _mm_setzero_si128())) == 0xFFFF;
+                }
+                else {
+                    const __m128i prev1 = _mm_alignr_epi8(input, prev_, 15);
+                    const __m128i prev2 = _mm_alignr_epi8(input, prev_, 14);
+                    const __m128i prev3 = _mm_alignr_epi8(input, prev_, 13);
+                    __m128i sc = _mm_shuffle_epi8(byte_1_high_, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble_mask_));
+                    sc = _mm_and_si128(sc, _mm_shuffle_epi8(byte_1_low_, _mm_and_si128(prev1, nibble_mask_)));
+                    sc = _mm_and_si128(sc, _mm_shuffle_epi8(byte_2_high_, _mm_and_si128(_mm_srli_epi16(input, 4), nibble_mask_)));
+                    const __m128i is_third_byte = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0u - 0x80u)));
+                    const __m128i is_fourth_byte = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0u - 0x80u)));
+                    const __m128i must23_80 = _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8(static_cast<char>(0x80u)));
+                    const __m128i error = _mm_xor_si128(must23_80, sc);
+                    result = _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+                }
+                prev_ = input;
+                return result;
+            }
+
+        private:
+            // Non-zero bytes indicate a character at the end of the block
+            // which requires more bytes.
+            JSON_SIMD_TARGET("ssse3")
+            static __m128i incomplete(__m128i input) {
+                const __m128i max_value = _mm_setr_epi8(
+                    -1, -1, -1, -1, -1, -1, -1, -1,
+                    -1, -1, -1, -1, -1,
+                    static_cast<char>(0xF0u - 1), static_cast<char>(0xE0u - 1), static_cast<char>(0xC0u - 1));
+                return _mm_subs_epu8(input, max_value);
+            }
+
+            __m128i prev_;
+            const __m128i byte_1_high_;
+            const __m128i byte_1_low_;
+            const __m128i byte_2_high_;
+            const __m128i nibble_mask_;
+        };
+
+        const isa utf8_block_checker_isa = isa::ssse3;
+
+#define JSON_UTF8_HAS_BLOCK_CHECKER 1
+
+#elif defined (__aarch64__) && (defined (__ARM_NEON) || defined (__ARM_NEON__))
+
+        struct utf8_block_checker
+        {
+            utf8_block_checker() : prev_(vdupq_n_u8(0))
+            {
+                static const uint8_t byte_1_high[16] = { JSON_UTF8_BYTE_1_HIGH };
+                static const uint8_t byte_1_low[16] = { JSON_UTF8_BYTE_1_LOW };
+                static const uint8_t byte_2_high[16] = { JSON_UTF8_BYTE_2_HIGH };
+                byte_1_high_ = vld1q_u8(byte_1_high);
+                byte_1_low_ = vld1q_u8(byte_1_low);
+                byte_2_high_ = vld1q_u8(byte_2_high);
+            }
+
+            bool check(const char* p)
+            {
+                const uint8x16_t input = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+                bool result;
+                if (vmaxvq_u8(input) < 0x80u) {
+                    result = vmaxvq_u8(incomplete(prev_)) == 0;
+                }
+                else {
+                    const uint8x16_t prev1 = vextq_u8(prev_, input, 15);
+                    const uint8x16_t prev2 = vextq_u8(prev_, input, 14);
+                    const uint8x16_t prev3 = vextq_u8(prev_, input, 13);
+                    uint8x16_t sc = vqtbl1q_u8(byte_1_high_, vshrq_n_u8(prev1, 4));
+                    sc = vandq_u8(sc, vqtbl1q_u8(byte_1_low_, vandq_u8(prev1, vdupq_n_u8(0x0F))));
+                    sc = vandq_u8(sc, vqtbl1q_u8(byte_2_high_, vshrq_n_u8(input, 4)));
+                    const uint8x16_t is_third_byte = vqsubq_u8(prev2, vdupq_n_u8(0xE0u - 0x80u));
+                    const uint8x16_t is_fourth_byte = vqsubq_u8(prev3, vdupq_n_u8(0xF0u - 0x80u));
+                    const uint8x16_t must23_80 = vandq_u8(vorrq_u8(is_third_byte, is_fourth_byte), vdupq_n_u8(0x80u));
+                    result = vmaxvq_u8(veorq_u8(must23_80, sc)) == 0;
+                }
+                prev_ = input;
+                return result;
+            }
+
+        private:
+            static uint8x16_t incomplete(uint8x16_t input) {
+                static const uint8_t max_value[16] = {
+                    255, 255, 255, 255, 255, 255, 255, 255,
+                    255, 255, 255, 255, 255, 0xF0u - 1, 0xE0u - 1, 0xC0u - 1 };
+                return vqsubq_u8(input, vld1q_u8(max_value));
+            }
+
+            uint8x16_t prev_;
+            uint8x16_t byte_1_high_;
+            uint8x16_t byte_1_low_;
+            uint8x16_t byte_2_high_;
+        };
+
+        const isa utf8_block_checker_isa = isa::neon;
+
+#define JSON_UTF8_HAS_BLOCK_CHECKER 1
+
+#endif
+
+#undef JSON_UTF8_BYTE_1_HIGH
+#undef JSON_UTF8_BYTE_1_LOW
+#undef JSON_UTF8_BYTE_2_HIGH
+
+#if defined (JSON_UTF8_HAS_BLOCK_CHECKER)
+
+        // Returns a pointer to the first block of 16 bytes in [first, last)
+        // which contains an error or the end of the last complete block.
+        inline const char*
+        JSON_SIMD_TARGET("ssse3")
+        utf8_valid_blocks(const char* first, const char* last)
+        {
+            utf8_block_checker checker;
+            while (last - first >= 16) {
+                if (not checker.check(first)) {
+                    break;
+                }
+                first += 16;
+            }
+            return first;
+        }
+
+#endif
+
+    } // namespace detail
+
+
+    //
+    //  const char* utf8_valid_prefix(const char* first, const char* last)
+    //
+    //  Returns a pointer to the end of the longest prefix of [first, last)
+    //  which consists of complete and valid UTF-8 characters. That is, the
+    //  result points to the first byte of the first invalid or incomplete
+    //  character, or equals last.
+    //
+    inline const char*
+    utf8_valid_prefix(const char* first, const char* last)
+    {
+        const char* p = first;
+#if defined (JSON_UTF8_HAS_BLOCK_CHECKER)
+        if (active_isa() >= detail::utf8_block_checker_isa) {
+            p = detail::utf8_valid_blocks(first, last);
+            // The blocks before p are valid, except for an incomplete
+            // character at the end, which may have caused the error. Restart
+            // at its beginning:
+            p = detail::utf8_character_start(first, p);
+        }
+#endif
+        return detail::utf8_valid_prefix_scalar(p, last);
+    }
+
+
+    //
+    //  bool is_valid_utf8(const char* first, const char* last)
+    //
+    //  Returns true if [first, last) is a complete and well-formed UTF-8
+    //  sequence.
+    //
+    inline bool
+    is_valid_utf8(const char* first, const char* last)
+    {
+        return utf8_valid_prefix(first, last) == last;
+    }
+
+}}  // namespace json::simd
+
+
+#endif // JSON_SIMD_UTF8_VALIDATE_HPP
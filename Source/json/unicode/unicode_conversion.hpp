@@ -25,6 +25,7 @@
 #include "json/config.hpp"
 #include "unicode_converter.hpp"
 #include "unicode_errors.hpp"
+#include "json/simd/transcode.hpp"
 #include <type_traits>
 
 
@@ -39,6 +40,93 @@ namespace json { namespace unicode {
     
     
     namespace internal {
+        
+        //
+        //  Bulk Transcoding
+        //
+        //  If input and output are contiguous buffers - that is, the iterators
+        //  are pointers - and both encodings are UTF-8, or UTF-16 or UTF-32 in
+        //  host endianness, the well-formed prefix of the input will be
+        //  converted with the vectorized kernels in json/simd/transcode.hpp.
+        //  The character-wise converters then continue at the first
+        //  ill-formed character, if any. Define
+        //  JSON_UNICODE_NO_BULK_TRANSCODING in order to disable it.
+        //
+        
+        // The code unit size in bits of an encoding supported by the bulk
+        // transcoding kernels, otherwise zero.
+        template <typename EncodingT>
+        struct bulk_transcoding_width : std::integral_constant<int, 0> {};
+        
+        template <>
+        struct bulk_transcoding_width<UTF_8_encoding_tag> : std::integral_constant<int, 8> {};
+        
+        template <>
+        struct bulk_transcoding_width<UTF_16LE_encoding_tag> : std::integral_constant<int, 
+            std::is_same<host_endianness::type, json::internal::little_endian_tag>::value ? 16 : 0> {};
+        
+        template <>
+        struct bulk_transcoding_width<UTF_16BE_encoding_tag> : std::integral_constant<int, 
+            std::is_same<host_endianness::type, json::internal::big_endian_tag>::value ? 16 : 0> {};
+        
+        template <>
+        struct bulk_transcoding_width<UTF_32LE_encoding_tag> : std::integral_constant<int, 
+            std::is_same<host_endianness::type, json::internal::little_endian_tag>::value ? 32 : 0> {};
+        
+        template <>
+        struct bulk_transcoding_width<UTF_32BE_encoding_tag> : std::integral_constant<int, 
+            std::is_same<host_endianness::type, json::internal::big_endian_tag>::value ? 32 : 0> {};
+        
+        
+        template <typename InIteratorT, typename FromEncodingT, typename OutIteratorT, typename ToEncodingT>
+        struct use_bulk_transcoding : std::false_type {};
+        
+#if !defined (JSON_UNICODE_NO_BULK_TRANSCODING)
+        template <typename InCharT, typename FromEncodingT, typename OutCharT, typename ToEncodingT>
+        struct use_bulk_transcoding<InCharT*, FromEncodingT, OutCharT*, ToEncodingT> 
+        : std::integral_constant<bool,
+            std::is_integral<InCharT>::value and std::is_integral<OutCharT>::value
+            and not std::is_const<OutCharT>::value
+            and bulk_transcoding_width<FromEncodingT>::value != 0
+            and sizeof(InCharT)*8 == bulk_transcoding_width<FromEncodingT>::value
+            and sizeof(OutCharT)*8 == bulk_transcoding_width<ToEncodingT>::value
+            // UTF-16 and UTF-32 to itself is a copy which only requires to
+            // validate surrogates; leave it to the converters.
+            and (bulk_transcoding_width<FromEncodingT>::value != bulk_transcoding_width<ToEncodingT>::value
+                 or bulk_transcoding_width<FromEncodingT>::value == 8)
+        > {};
+#endif        
+        
+        template <int FromWidth, int ToWidth>
+        struct bulk_transcoder {
+            template <typename InIteratorT, typename OutIteratorT>
+            static void convert(InIteratorT& first, InIteratorT last, OutIteratorT& dest) {
+                json::simd::detail::transcode_range(first, last, dest);
+            }
+        };
+        
+        template <>
+        struct bulk_transcoder<8, 8> {
+            template <typename InIteratorT, typename OutIteratorT>
+            static void convert(InIteratorT& first, InIteratorT last, OutIteratorT& dest) {
+                json::simd::utf8_to_utf8(first, last, dest);
+            }
+        };
+        
+        template <typename FromEncodingT, typename ToEncodingT, typename InIteratorT, typename OutIteratorT>
+        inline void 
+        bulk_transcode(InIteratorT& first, InIteratorT last, OutIteratorT& dest, std::true_type) {
+            bulk_transcoder<
+                bulk_transcoding_width<FromEncodingT>::value, 
+                bulk_transcoding_width<ToEncodingT>::value
+            >::convert(first, last, dest);
+        }
+        
+        template <typename FromEncodingT, typename ToEncodingT, typename InIteratorT, typename OutIteratorT>
+        inline void 
+        bulk_transcode(InIteratorT&, InIteratorT, OutIteratorT&, std::false_type) {
+        }
+        
     }
     
     
@@ -188,6 +276,11 @@ namespace json { namespace unicode {
         static_assert( (internal::IsBaseAndDerived<utf_encoding_tag, FromEncodingT>::value), "" );
         static_assert( (internal::IsBaseAndDerived<utf_encoding_tag, ToEncodingT>::value), "" );
         
+        if (not !state) {
+            internal::bulk_transcode<FromEncodingT, ToEncodingT>(first, last, dest, 
+                internal::use_bulk_transcoding<InIteratorT, FromEncodingT, OutIteratorT, ToEncodingT>());
+        }
+        
 #if !defined (NO_USE_MINOR_SPEED_OPTIMZATION)  // speed vs code size
         // If we have random access input iterators, we can apply some
         // minor optimizations (don't check for first != last):
@@ -266,6 +359,9 @@ namespace json { namespace unicode {
         static_assert( (internal::IsBaseAndDerived<utf_encoding_tag, FromEncodingT>::value), "" );
         static_assert( (internal::IsBaseAndDerived<utf_encoding_tag, ToEncodingT>::value), "" );
         
+        internal::bulk_transcode<FromEncodingT, ToEncodingT>(first, last, dest, 
+            internal::use_bulk_transcoding<InIteratorT, FromEncodingT, OutIteratorT, ToEncodingT>());
+        
 #if !defined (NO_USE_MINOR_SPEED_OPTIMZATION)  // speed vs code size
         // If we have random access input iterators, we can apply some
         // minor optimizations (don't check for first != last):
@@ -400,6 +496,11 @@ namespace json { namespace unicode {
         static_assert( (internal::IsBaseAndDerived<utf_encoding_tag, FromEncodingT>::value), "" );
         static_assert( (internal::IsBaseAndDerived<utf_encoding_tag, ToEncodingT>::value), "" );
         
+        if (not !state) {
+            internal::bulk_transcode<FromEncodingT, ToEncodingT>(first, last, dest, 
+                internal::use_bulk_transcoding<InIteratorT, FromEncodingT, OutIteratorT, ToEncodingT>());
+        }
+        
 #if !defined (NO_USE_MINOR_SPEED_OPTIMZATION)  // speed vs code size
         // If we have random access input iterators, we can apply some
         // minor optimizations (don't check for first != last):
@@ -444,6 +545,9 @@ namespace json { namespace unicode {
         static_assert( (internal::IsBaseAndDerived<utf_encoding_tag, FromEncodingT>::value), "" );
         static_assert( (internal::IsBaseAndDerived<utf_encoding_tag, ToEncodingT>::value), "" );
         
+        internal::bulk_transcode<FromEncodingT, ToEncodingT>(first, last, dest, 
+            internal::use_bulk_transcoding<InIteratorT, FromEncodingT, OutIteratorT, ToEncodingT>());
+        
 #if !defined (NO_USE_MINOR_SPEED_OPTIMZATION)  // speed vs code size
         // If we have random access input iterators, we can apply some
         // minor optimizations (don't check for first != last):
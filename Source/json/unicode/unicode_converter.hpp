@@ -26,6 +26,7 @@
 #include "unicode_utilities.hpp"
 #include "unicode_traits.hpp"
 #include "unicode_errors.hpp"
+#include "json/simd/utf8_validate.hpp"
 
 #include <boost/iterator/iterator_traits.hpp>
 #include <boost/mpl/int.hpp>
@@ -408,7 +409,7 @@ namespace json { namespace unicode { namespace internal {
         __attribute__((always_inline))
 #endif            
         action_double_byte(const buffer_type& buffer, OutIterator& dest) const {
-            std::copy_n(&buffer[0], 2, dest);
+            dest = std::copy_n(&buffer[0], 2, dest);
 //            *dest++ = buffer[0];
 //            *dest++ = buffer[1];
             return true;
@@ -419,7 +420,7 @@ namespace json { namespace unicode { namespace internal {
         __attribute__((always_inline))
 #endif            
         action_triple_byte(const buffer_type& buffer, OutIterator& dest) const {
-            std::copy_n(&buffer[0], 3, dest);
+            dest = std::copy_n(&buffer[0], 3, dest);
 //            *dest++ = buffer[0];
 //            *dest++ = buffer[1];
 //            *dest++ = buffer[2];
@@ -431,7 +432,7 @@ namespace json { namespace unicode { namespace internal {
         __attribute__((always_inline))
 #endif            
         action_quad_byte(const buffer_type& buffer, OutIterator& dest) const {
-            std::copy_n(&buffer[0], 4, dest);
+            dest = std::copy_n(&buffer[0], 4, dest);
 //            *dest++ = buffer[0];
 //            *dest++ = buffer[1];
 //            *dest++ = buffer[2];
@@ -473,7 +474,7 @@ namespace json { namespace unicode { namespace internal {
         __attribute__((always_inline))
 #endif            
         action_double_byte(const buffer_type& buffer, OutIterator& dest) const {
-            std::copy_n(&buffer[0], 2, dest);
+            dest = std::copy_n(&buffer[0], 2, dest);
 //            *dest++ = buffer[0];
 //            *dest++ = buffer[1];
             return true;
@@ -484,7 +485,7 @@ namespace json { namespace unicode { namespace internal {
         __attribute__((always_inline))
 #endif            
         action_triple_byte(const buffer_type& buffer, OutIterator& dest) const {
-            std::copy_n(&buffer[0], 3, dest);
+            dest = std::copy_n(&buffer[0], 3, dest);
 //            *dest++ = buffer[0];
 //            *dest++ = buffer[1];
 //            *dest++ = buffer[2];
@@ -496,7 +497,7 @@ namespace json { namespace unicode { namespace internal {
         __attribute__((always_inline))
 #endif            
         action_quad_byte(const buffer_type& buffer, OutIterator& dest) const {
-            std::copy_n(&buffer[0], 4, dest);
+            dest = std::copy_n(&buffer[0], 4, dest);
 //            *dest++ = buffer[0];
 //            *dest++ = buffer[1];
 //            *dest++ = buffer[2];
@@ -812,6 +813,57 @@ namespace json {  namespace unicode { namespace internal {
     };  // class utf8_parser
     
     
+    
+    //
+    //  struct utf8_block_validation
+    //
+    //  Fast path of the safe UTF-8 parser for contiguous input: validates the
+    //  input block-wise with json::simd::utf8_valid_prefix() and parses the
+    //  valid prefix without any checks. The remainder - which is either empty
+    //  or starts with an invalid or incomplete character - will be parsed by 
+    //  the checking parser, which then reports the error or saves the state
+    //  of the partial multi byte sequence.
+    //
+    //  The fast path will be enabled for the safe, not ParseOne parser and 
+    //  pointers to bytes. It is only taken if the parser is not within a 
+    //  multi byte sequence.
+    //
+    template <bool Enable>
+    struct utf8_block_validation
+    {
+        template <typename Parser, typename InIteratorT, class Actions, typename OutIteratorT>
+        static int parse(Parser& parser, InIteratorT& first, InIteratorT last, Actions actions, OutIteratorT& dest) {
+            return parser.parse(first, last, actions, dest);
+        }
+    };
+    
+    template <>
+    struct utf8_block_validation<true>
+    {
+        template <typename Parser, typename InIteratorT, class Actions, typename OutIteratorT>
+        static int parse(Parser& parser, InIteratorT& first, InIteratorT last, Actions actions, OutIteratorT& dest) 
+        {
+            if (parser.state().get() == 0) {
+                const char* p = reinterpret_cast<const char*>(first);
+                const char* q = json::simd::utf8_valid_prefix(p, reinterpret_cast<const char*>(last));
+                InIteratorT valid_last = first + (q - p);
+                int result = utf8_parser<true, true, false, false>().parse(first, valid_last, actions, dest);
+                if (result != 0 or first == last) {
+                    return result;
+                }
+            }
+            return parser.parse(first, last, actions, dest);
+        }
+    };
+    
+    template <bool NoCheckLast, bool NoCheckTrails, bool ParseOne, typename InIteratorT>
+    struct utf8_use_block_validation : std::integral_constant<bool,
+        not NoCheckLast and not NoCheckTrails and not ParseOne
+        and std::is_pointer<InIteratorT>::value
+        and sizeof(typename boost::iterator_value<InIteratorT>::type) == 1
+    > {};
+    
+    
 }}} // namespace json::unicode::internal
 
 
@@ -1718,8 +1770,13 @@ namespace json {  namespace unicode {
             static_assert(sizeof(typename boost::iterator_value<InIteratorT>::type)
                                 == sizeof(typename encoding_traits<FromEncodingT>::code_unit_type), "");
             typedef typename internal::utf8_to_codepoint_actions<OutIteratorT> actions_t;
+            typedef internal::utf8_block_validation<internal::utf8_use_block_validation<
+                internal::utf8_validation_traits<Validation>::no_check_input_range, 
+                internal::utf8_validation_traits<Validation>::no_check_trails,
+                static_cast<bool>(ParseOne), InIteratorT>::value
+            > block_validation;
             
-            int result = parser_.parse(first, last, actions_t(), dest);
+            int result = block_validation::parse(parser_, first, last, actions_t(), dest);
             return result;
         }
         
@@ -1923,8 +1980,13 @@ namespace json {  namespace unicode {
             static_assert(sizeof(typename boost::iterator_value<InIteratorT>::type)
                                 == sizeof(typename encoding_traits<FromEncodingT>::code_unit_type), "");
             typedef typename internal::utf8_to_utf_actions<OutIteratorT, to_encoding> actions_t;
+            typedef internal::utf8_block_validation<internal::utf8_use_block_validation<
+                internal::utf8_validation_traits<Validation>::no_check_input_range, 
+                internal::utf8_validation_traits<Validation>::no_check_trails,
+                static_cast<bool>(ParseOne), InIteratorT>::value
+            > block_validation;
             
-            int result = parser_.parse(first, last, actions_t(), dest);
+            int result = block_validation::parse(parser_, first, last, actions_t(), dest);
             return result;
         }
         
@@ -21,12 +21,14 @@
 #define JSON_UTILITY_ARENA_ALLOCATOR_HPP
 
 #include "mpl.hpp"
+#include "mutex.hpp"
 #include <type_traits>
 #include <boost/intrusive/slist.hpp>
 #include <cassert>
 #include <utility>
 #include <limits>
 #include <new>
+#include <mutex>
 #include <stdlib.h>
 
 
@@ -64,6 +66,12 @@ namespace json { namespace utility {
         
         arena_allocator(const arena_allocator&) = default;
         
+        // Returns the arena this allocator allocates from.
+        Arena& get_arena() const noexcept { 
+            assert(arena_ != nullptr);
+            return *arena_; 
+        }
+        
         
         T* allocate(std::size_t n) {
             assert(arena_ != nullptr);
@@ -106,6 +114,23 @@ namespace json { namespace utility {
         return !(a1 == a2);
     }
     
+    
+    //
+    //  recycle_allocator()
+    //
+    //  Releases the memory obtained from the allocator after all objects
+    //  allocated from it have been destroyed. For allocators which do not
+    //  support this, this is a no-op. For arena allocators, the arena will be
+    //  reset, which keeps its blocks for reuse.
+    //
+    template <typename Allocator>
+    inline void recycle_allocator(Allocator&) noexcept {}
+    
+    template <typename T, typename Arena>
+    inline void recycle_allocator(arena_allocator<T, Arena>& a) {
+        a.get_arena().reset();
+    }
+    
 
     
 }}
@@ -200,14 +225,34 @@ namespace json { namespace utility {
     
     template <class Alloc>
     class arena {
+        struct Block;
+        
     public:
+        class BlockPool;
+        class Marker;
+        
         explicit arena(const Alloc& alloc,
                        size_t minBlockSize = kDefaultMinBlockSize)
             : allocAndSize_(alloc, minBlockSize)
+            , pool_(nullptr)
             , ptr_(nullptr)
             , end_(nullptr)
             , totalAllocatedSize_(0)
             , bytesUsed_(0)
+            , retainedBlocks_(0)
+        {
+        }
+        
+        // Draws its normal sized blocks from the given pool, and returns them
+        // to the pool when they are released. The pool must outlive the arena.
+        arena(const Alloc& alloc, BlockPool& pool)
+            : allocAndSize_(alloc, pool.minBlockSize())
+            , pool_(&pool)
+            , ptr_(nullptr)
+            , end_(nullptr)
+            , totalAllocatedSize_(0)
+            , bytesUsed_(0)
+            , retainedBlocks_(0)
         {
         }
         
@@ -245,7 +290,7 @@ namespace json { namespace utility {
         }
         
         size_t numberAllocatedBlocks() const {
-            typename BlockList::size_type sz = blocks_.size();
+            typename BlockList::size_type sz = blocks_.size() + largeBlocks_.size() + freeBlocks_.size();
             return sz;
         }
         
@@ -257,17 +302,82 @@ namespace json { namespace utility {
             return bytesUsed_;
         }
         
+        // The number of normal sized blocks which clear() keeps for reuse.
+        // Defaults to zero.
+        size_t retainedBlocks() const { return retainedBlocks_; }
+        void setRetainedBlocks(size_t n) { retainedBlocks_ = n; }
+        
+        // Releases all memory allocated from the arena. Up to retainedBlocks()
+        // normal sized blocks are kept for reuse, the other blocks are returned
+        // to the underlying allocator, respectively the block pool.
+        // Objects allocated from the arena must have been destroyed already.
         void clear() {
-            auto disposer = [this] (Block* b) { b->deallocate(this->alloc()); };
+            reset();
+            size_t n = 0;
+            for (auto it = freeBlocks_.begin(); it != freeBlocks_.end(); ++it) {
+                ++n;
+            }
+            while (n > retainedBlocks_) {
+                Block* b = &freeBlocks_.front();
+                freeBlocks_.pop_front();
+                release(b);
+                --n;
+            }
+        }
+        
+        // Releases all memory allocated from the arena, but keeps the normal 
+        // sized blocks for reuse by subsequent allocations. Large blocks will
+        // be returned to the underlying allocator.
+        // Objects allocated from the arena must have been destroyed already.
+        void reset() {
+            while (!largeBlocks_.empty()) {
+                Block* b = &largeBlocks_.front();
+                largeBlocks_.pop_front();
+                release(b);
+            }
             while (!blocks_.empty()) {
-                blocks_.pop_front_and_dispose(disposer);
+                Block* b = &blocks_.front();
+                blocks_.pop_front();
+                freeBlocks_.push_front(*b);
             }
-            blocks_.clear();
             ptr_ = nullptr;
             end_ = nullptr;
-            totalAllocatedSize_ = 0;
             bytesUsed_ = 0;
-            
+        }
+        
+        // Returns a marker for the current state of the arena. Rewinding the
+        // arena to the marker releases all memory which has been allocated
+        // after the marker has been taken - for example when parsing a
+        // document failed or has been canceled.
+        Marker mark() const {
+            Marker m;
+            m.block_ = blocks_.empty() ? nullptr : const_cast<Block*>(&blocks_.front());
+            m.large_ = largeBlocks_.empty() ? nullptr : const_cast<Block*>(&largeBlocks_.front());
+            m.ptr_ = ptr_;
+            m.end_ = end_;
+            m.bytesUsed_ = bytesUsed_;
+            return m;
+        }
+        
+        // Releases the memory allocated after marker m has been taken. Normal
+        // sized blocks are kept for reuse. Objects allocated after the marker
+        // must have been destroyed already. Markers shall be rewound in the
+        // reverse order they have been taken, and neither reset(), clear()
+        // nor merge() shall have been called after m has been taken.
+        void rewind(const Marker& m) {
+            while (!largeBlocks_.empty() && &largeBlocks_.front() != m.large_) {
+                Block* b = &largeBlocks_.front();
+                largeBlocks_.pop_front();
+                release(b);
+            }
+            while (!blocks_.empty() && &blocks_.front() != m.block_) {
+                Block* b = &blocks_.front();
+                blocks_.pop_front();
+                freeBlocks_.push_front(*b);
+            }
+            ptr_ = m.ptr_;
+            end_ = m.end_;
+            bytesUsed_ = m.bytesUsed_;
         }
         
     private:
@@ -279,12 +389,14 @@ namespace json { namespace utility {
         arena(arena&&) = default;
         arena& operator=(arena&&) = default;
         
-        struct Block;
         typedef boost::intrusive::slist_member_hook<
         boost::intrusive::tag<arena>> BlockLink;
         
         struct Block {
             BlockLink link;
+            size_t size;        // usable size in bytes
+            BlockPool* pool;    // the pool the block belongs to, if any
+            bool large;         // true if this block has been allocated for a single chunk
             
             // Allocate a block with at least size bytes of storage.
             // If allowSlack is true, allocate more than size bytes if convenient
@@ -299,6 +411,7 @@ namespace json { namespace utility {
             }
             
         private:
+            friend class BlockPool;
             Block() { }
             ~Block() { }
         } __attribute__((aligned));
@@ -308,6 +421,114 @@ namespace json { namespace utility {
     public:
         static constexpr size_t kDefaultMinBlockSize = 4096 - sizeof(Block);
         
+        class Marker {
+            friend class arena;
+            Block* block_;
+            Block* large_;
+            char* ptr_;
+            char* end_;
+            size_t bytesUsed_;
+        };
+        
+        /**
+         * A thread-safe pool of normal sized blocks which can be shared by
+         * many arenas, for example by the arenas of the parsers running on a
+         * number of threads. Blocks released by an arena go back to the pool
+         * (up to maxBlocks blocks, the others are deallocated), and a new
+         * block is taken from the pool if available. So, once the pool holds
+         * enough blocks, arenas do not call the underlying allocator anymore.
+         *
+         * The pool must outlive the arenas using it.
+         */
+        class BlockPool {
+        public:
+            explicit BlockPool(size_t minBlockSize = kDefaultMinBlockSize,
+                               size_t maxBlocks = std::numeric_limits<size_t>::max(),
+                               const Alloc& alloc = Alloc())
+                : alloc_(alloc)
+                , minBlockSize_(minBlockSize)
+                , maxBlocks_(maxBlocks)
+                , blockSize_(ArenaAllocatorTraits<Alloc>::goodSize(alloc, sizeof(Block) + minBlockSize) - sizeof(Block))
+                , free_(nullptr)
+                , size_(0)
+            {
+            }
+            
+            ~BlockPool() {
+                while (free_) {
+                    FreeBlock* f = free_;
+                    free_ = f->next;
+                    alloc_.deallocate(f);
+                }
+            }
+            
+            size_t minBlockSize() const { return minBlockSize_; }
+            size_t maxBlocks() const { return maxBlocks_; }
+            
+            // The number of blocks in the pool.
+            size_t size() const {
+                std::lock_guard<json::utility::mutex> lock(mutex_);
+                return size_;
+            }
+            
+        private:
+            BlockPool(const BlockPool&) = delete;
+            BlockPool& operator=(const BlockPool&) = delete;
+            
+            friend class arena;
+            
+            struct FreeBlock {
+                FreeBlock* next;
+            };
+            
+            std::pair<Block*, size_t> get() {
+                void* mem = nullptr;
+                {
+                    std::lock_guard<json::utility::mutex> lock(mutex_);
+                    if (free_) {
+                        mem = free_;
+                        free_ = free_->next;
+                        --size_;
+                    }
+                }
+                std::pair<Block*, size_t> p;
+                if (mem) {
+                    Block* b = new (mem) Block();
+                    b->size = blockSize_;
+                    b->large = false;
+                    p = std::make_pair(b, b->size);
+                } else {
+                    p = Block::allocate(alloc_, minBlockSize_, true);
+                    assert(p.second == blockSize_);
+                }
+                p.first->pool = this;
+                return p;
+            }
+            
+            // Requires the block to be destroyed.
+            void put(void* mem) {
+                {
+                    std::lock_guard<json::utility::mutex> lock(mutex_);
+                    if (size_ < maxBlocks_) {
+                        FreeBlock* f = reinterpret_cast<FreeBlock*>(mem);
+                        f->next = free_;
+                        free_ = f;
+                        ++size_;
+                        return;
+                    }
+                }
+                alloc_.deallocate(mem);
+            }
+            
+            mutable json::utility::mutex mutex_;
+            Alloc alloc_;
+            const size_t minBlockSize_;
+            const size_t maxBlocks_;
+            const size_t blockSize_;
+            FreeBlock* free_;
+            size_t size_;
+        };
+        
     private:
         static constexpr size_t maxAlign = alignof(Block);
         static constexpr bool isAligned(uintptr_t address) {
@@ -333,6 +554,12 @@ namespace json { namespace utility {
         
         void* allocateSlow(size_t size);
         
+        // Returns the block to the underlying allocator, respectively its pool.
+        void release(Block* b) {
+            totalAllocatedSize_ -= b->size + sizeof(Block);
+            b->deallocate(alloc());
+        }
+        
         // Empty member optimization: package Alloc with a non-empty member
         // in case Alloc is empty (as it is in the case of SysAlloc).
         struct AllocAndSize : public Alloc {
@@ -350,11 +577,15 @@ namespace json { namespace utility {
         const Alloc& alloc() const { return allocAndSize_; }
         
         AllocAndSize allocAndSize_;
-        BlockList blocks_;
+        BlockPool* pool_;
+        BlockList blocks_;      // normal blocks, the current block at the front
+        BlockList largeBlocks_; // large blocks, the latest at the front
+        BlockList freeBlocks_;  // normal blocks retained by reset()
         char* ptr_;
         char* end_;
         size_t totalAllocatedSize_;
         size_t bytesUsed_;
+        size_t retainedBlocks_;
     };
     
     /**
@@ -397,6 +628,10 @@ namespace json { namespace utility {
         explicit SysArena(size_t minBlockSize = kDefaultMinBlockSize)
         : arena<SysAlloc>(SysAlloc(), minBlockSize) {
         }
+        
+        explicit SysArena(BlockPool& pool)
+        : arena<SysAlloc>(SysAlloc(), pool) {
+        }
     };
     
 }}  // namespace json::utiltiy
@@ -416,13 +651,22 @@ namespace json { namespace utility {
         
         void* mem = alloc.allocate(allocSize);
         assert(isAligned(mem));
-        return std::make_pair(new (mem) Block(), allocSize - sizeof(Block));
+        Block* b = new (mem) Block();
+        b->size = allocSize - sizeof(Block);
+        b->pool = nullptr;
+        b->large = not allowSlack;
+        return std::make_pair(b, b->size);
     }
     
     template <class Alloc>
     void arena<Alloc>::Block::deallocate(Alloc& alloc) {
+        BlockPool* pool = this->pool;
         this->~Block();
-        alloc.deallocate(this);
+        if (pool) {
+            pool->put(this);
+        } else {
+            alloc.deallocate(this);
+        }
     }
     
     template <class Alloc>
@@ -430,16 +674,27 @@ namespace json { namespace utility {
         std::pair<Block*, size_t> p;
         char* start;
         if (size > minBlockSize()) {
-            // Allocate a large block for this chunk only, put it at the back of the
-            // list so it doesn't get used for small allocations; don't change ptr_
-            // and end_, let them point into a normal block (or none, if they're
-            // null)
+            // Allocate a large block for this chunk only, put it into the list
+            // of large blocks so it doesn't get used for small allocations;
+            // don't change ptr_ and end_, let them point into a normal block
+            // (or none, if they're null)
             p = Block::allocate(alloc(), size, false);
             start = p.first->start();
-            blocks_.push_back(*p.first);
+            largeBlocks_.push_front(*p.first);
+        } else if (!freeBlocks_.empty()) {
+            // Reuse a block retained by reset()
+            Block* b = &freeBlocks_.front();
+            freeBlocks_.pop_front();
+            start = b->start();
+            blocks_.push_front(*b);
+            ptr_ = start + size;
+            end_ = start + b->size;
+            assert(b->size >= size);
+            return start;
         } else {
-            // Allocate a normal sized block and carve out size bytes from it
-            p = Block::allocate(alloc(), minBlockSize(), true);
+            // Allocate a normal sized block - or take one from the pool - and
+            // carve out size bytes from it
+            p = pool_ ? pool_->get() : Block::allocate(alloc(), minBlockSize(), true);
             start = p.first->start();
             blocks_.push_front(*p.first);
             ptr_ = start + size;
@@ -453,8 +708,10 @@ namespace json { namespace utility {
     
     template <class Alloc>
     void arena<Alloc>::merge(arena<Alloc>&& other) {
-        blocks_.splice_after(blocks_.before_begin(), other.blocks_);
-        other.blocks_.clear();
+        // Keep the current block at the front:
+        blocks_.splice_after(blocks_.empty() ? blocks_.before_begin() : blocks_.last(), other.blocks_);
+        largeBlocks_.splice_after(largeBlocks_.empty() ? largeBlocks_.before_begin() : largeBlocks_.last(), other.largeBlocks_);
+        freeBlocks_.splice_after(freeBlocks_.before_begin(), other.freeBlocks_);
         other.ptr_ = other.end_ = nullptr;
         totalAllocatedSize_ += other.totalAllocatedSize_;
         other.totalAllocatedSize_ = 0;
@@ -466,6 +723,12 @@ namespace json { namespace utility {
         while (!blocks_.empty()) {
             blocks_.pop_front_and_dispose(disposer);
         }
+        while (!largeBlocks_.empty()) {
+            largeBlocks_.pop_front_and_dispose(disposer);
+        }
+        while (!freeBlocks_.empty()) {
+            freeBlocks_.pop_front_and_dispose(disposer);
+        }
     }
     
 }}  // namespace json::utility
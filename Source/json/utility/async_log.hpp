@@ -0,0 +1,899 @@
+//
+//  async_log.hpp
+//
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#ifndef JSON_UTILITY_ASYNC_LOG_HPP
+#define JSON_UTILITY_ASYNC_LOG_HPP
+
+
+#include "json/config.hpp"
+#include "simple_log.hpp"
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <cassert>
+
+
+//
+//  Asynchronous Logging
+//
+//  async_logger has the interface of logger, but does not format and write
+//  the message on the calling thread. The message is stored as a record
+//  holding the format string - which serves as the ID of the message - and
+//  the binary arguments into a lock-free ring buffer owned by the calling
+//  thread. A background thread formats the records and writes them to the
+//  output of the async_log_service.
+//
+//  Requirements and limitations:
+//
+//  - The format string must have static storage duration, for example a
+//    string literal, since it is accessed after log() returned.
+//  - Arguments may be integral numbers, enums, floating point numbers,
+//    C strings and pointers. C strings are copied, honoring a precision
+//    given with "%.*s" or "%.Ns", so they need not be zero terminated in
+//    that case. A record holds up to 224 bytes of arguments; longer strings
+//    are truncated.
+//  - The conversions %n and %ls are not supported.
+//  - If the ring buffer of a thread is full, the message is dropped and
+//    counted; the number of dropped messages is written to the output later.
+//    Logging never blocks the calling thread.
+//  - async_logger::flush() writes all pending messages, for example before
+//    the program reads the log output.
+//
+//  Messages above the MaxSeverity template parameter of async_logger
+//  compile away entirely.
+//
+//  If JSON_NO_THREAD_LOCAL is defined, messages are formatted and written
+//  synchronously.
+//
+
+namespace json { namespace utility {
+
+
+    namespace async_log_detail {
+
+        constexpr size_t kMaxArgs = 12;
+        constexpr size_t kRecordSize = 256;
+        constexpr size_t kRingCapacity = 256;   // records per thread
+
+        enum arg_type : unsigned char {
+            ArgInt32, ArgInt64, ArgUInt32, ArgUInt64, ArgDouble, ArgPointer, ArgString
+        };
+
+        struct record_header {
+            const char*     format;
+            int64_t         time;           // microseconds since the epoch
+            unsigned char   level;
+            unsigned char   nargs;
+            unsigned short  size;           // bytes used in data
+            unsigned char   types[kMaxArgs];
+        };
+
+        constexpr size_t kDataSize = kRecordSize - sizeof(record_header);
+
+        struct record : record_header {
+            unsigned char   data[kDataSize];
+        };
+
+
+        // A conversion specification of a printf format string.
+        struct format_spec {
+            const char*     first;      // points to '%'
+            const char*     last;       // points past the conversion character
+            bool            width_star;
+            bool            precision_star;
+            int             precision;  // -1 if there is none
+            char            conversion;
+        };
+
+        // Parses the next conversion specification starting at p. Returns
+        // false if there is none.
+        inline bool next_spec(const char*& p, format_spec& spec)
+        {
+            while (*p) {
+                if (*p != '%') {
+                    ++p;
+                    continue;
+                }
+                if (p[1] == '%') {
+                    p += 2;
+                    continue;
+                }
+                spec.first = p++;
+                while (*p == '-' or *p == '+' or *p == ' ' or *p == '#' or *p == '0')
+                    ++p;
+                spec.width_star = *p == '*';
+                if (spec.width_star)
+                    ++p;
+                while (*p >= '0' and *p <= '9')
+                    ++p;
+                spec.precision_star = false;
+                spec.precision = -1;
+                if (*p == '.') {
+                    ++p;
+                    spec.precision_star = *p == '*';
+                    if (spec.precision_star) {
+                        ++p;
+                    }
+                    else {
+                        spec.precision = 0;
+                        while (*p >= '0' and *p <= '9')
+                            spec.precision = spec.precision * 10 + (*p++ - '0');
+                    }
+                }
+                while (*p == 'h' or *p == 'l' or *p == 'L' or *p == 'q' or *p == 'j' or *p == 'z' or *p == 't')
+                    ++p;
+                spec.conversion = *p;
+                if (*p)
+                    ++p;
+                spec.last = p;
+                return true;
+            }
+            return false;
+        }
+
+
+        //
+        //  Stores the arguments of a message into a record.
+        //
+        //  Only if the message has string arguments, the encoder walks the
+        //  format string in order to find the precision of the string
+        //  conversions.
+        //
+        class encoder
+        {
+        public:
+            encoder(record& r, const char* format, bool scan)
+            : r_(r), format_(format), scan_(scan), pending_(false), stars_(0), star_value_(-1)
+            {
+                r_.format = format;
+                r_.nargs = 0;
+                r_.size = 0;
+                spec_.conversion = 0;
+                spec_.precision = -1;
+                spec_.precision_star = false;
+            }
+
+            template <typename T>
+            typename std::enable_if<std::is_integral<T>::value>::type
+            put(T v) {
+                const int64_t i = static_cast<int64_t>(v);
+                if (scan_ and next_is_star()) {
+                    star_value_ = static_cast<int>(i);
+                }
+                const arg_type t = sizeof(T) <= 4
+                    ? (std::is_signed<T>::value ? ArgInt32 : ArgUInt32)
+                    : (std::is_signed<T>::value ? ArgInt64 : ArgUInt64);
+                put_raw(t, &i, sizeof(i));
+            }
+
+            template <typename T>
+            typename std::enable_if<std::is_enum<T>::value>::type
+            put(T v) {
+                put(static_cast<typename std::underlying_type<T>::type>(v));
+            }
+
+            template <typename T>
+            typename std::enable_if<std::is_floating_point<T>::value>::type
+            put(T v) {
+                const double d = static_cast<double>(v);
+                skip();
+                put_raw(ArgDouble, &d, sizeof(d));
+            }
+
+            void put(const char* s) {
+                int limit = -1;
+                if (scan_) {
+                    if (not next_is_star() and spec_.conversion == 's') {
+                        limit = spec_.precision_star ? star_value_ : spec_.precision;
+                    }
+                }
+                if (r_.nargs == kMaxArgs or r_.size + size_t(2) > kDataSize)
+                    return;
+                size_t n = kDataSize - r_.size - 2;
+                if (limit >= 0 and static_cast<size_t>(limit) < n)
+                    n = static_cast<size_t>(limit);
+                if (s == nullptr) {
+                    s = "(null)";
+                    n = std::min(n, size_t(6));
+                }
+                size_t len = 0;
+                while (len < n and s[len] != 0)
+                    ++len;
+                const unsigned short len16 = static_cast<unsigned short>(len);
+                r_.types[r_.nargs++] = ArgString;
+                std::memcpy(r_.data + r_.size, &len16, 2);
+                std::memcpy(r_.data + r_.size + 2, s, len);
+                r_.size += static_cast<unsigned short>(2 + len);
+            }
+
+            void put(char* s) { put(static_cast<const char*>(s)); }
+
+            template <typename T>
+            void put(T* p) {
+                const void* v = p;
+                skip();
+                put_raw(ArgPointer, &v, sizeof(v));
+            }
+
+            void put(std::nullptr_t) {
+                put(static_cast<const void*>(nullptr));
+            }
+
+        private:
+            void put_raw(arg_type t, const void* v, size_t size) {
+                if (r_.nargs == kMaxArgs or r_.size + size > kDataSize)
+                    return;
+                r_.types[r_.nargs++] = t;
+                std::memcpy(r_.data + r_.size, v, size);
+                r_.size += static_cast<unsigned short>(size);
+            }
+
+            // Advances to the next argument of the format string. Returns true
+            // if it is a '*' width or precision.
+            bool next_is_star() {
+                if (stars_ > 0) {
+                    --stars_;
+                    return true;
+                }
+                if (pending_) {
+                    // The conversion following its '*' arguments.
+                    pending_ = false;
+                    return false;
+                }
+                if (not next_spec(format_, spec_)) {
+                    spec_.conversion = 0;
+                    return false;
+                }
+                stars_ = int(spec_.width_star) + int(spec_.precision_star);
+                if (stars_ > 0) {
+                    --stars_;
+                    pending_ = true;
+                    return true;
+                }
+                return false;
+            }
+
+            void skip() {
+                if (scan_)
+                    next_is_star();
+            }
+
+            record&         r_;
+            const char*     format_;
+            bool            scan_;
+            bool            pending_;
+            int             stars_;
+            int             star_value_;
+            format_spec     spec_;
+        };
+
+
+        template <typename... Args>
+        struct has_string;
+
+        template <>
+        struct has_string<> : std::false_type {};
+
+        template <typename T, typename... Args>
+        struct has_string<T, Args...> : std::integral_constant<bool,
+            std::is_same<typename std::decay<T>::type, const char*>::value
+            or std::is_same<typename std::decay<T>::type, char*>::value
+            or has_string<Args...>::value>
+        {};
+
+        inline void encode_args(encoder&) {}
+
+        template <typename T, typename... Args>
+        inline void encode_args(encoder& e, const T& v, const Args&... args) {
+            e.put(v);
+            encode_args(e, args...);
+        }
+
+        template <typename... Args>
+        inline void encode(record& r, LOG_Level level, const char* format, const Args&... args)
+        {
+            r.time = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            r.level = static_cast<unsigned char>(level);
+            encoder e(r, format, has_string<Args...>::value);
+            encode_args(e, args...);
+        }
+
+
+        //
+        //  Formats the message of a record into buffer, and returns the length
+        //  of the message. The result is truncated to size - 1 characters and
+        //  zero terminated.
+        //
+        class formatter
+        {
+        public:
+            explicit formatter(const record& r)
+            : r_(r), arg_(0), offset_(0)
+            {
+            }
+
+            size_t format(char* buffer, size_t size)
+            {
+                assert(size > 0);
+                char* out = buffer;
+                char* const end = buffer + size - 1;
+                const char* p = r_.format;
+                while (*p and out < end) {
+                    if (*p != '%') {
+                        *out++ = *p++;
+                        continue;
+                    }
+                    if (p[1] == '%') {
+                        *out++ = '%';
+                        p += 2;
+                        continue;
+                    }
+                    format_spec spec;
+                    const char* q = p;
+                    if (not next_spec(q, spec))
+                        break;
+                    p = spec.last;
+                    out += convert(spec, out, static_cast<size_t>(end - out) + 1);
+                    if (out > end)
+                        out = end;
+                }
+                *out = 0;
+                return static_cast<size_t>(out - buffer);
+            }
+
+        private:
+            struct arg {
+                arg_type type;
+                bool     valid;
+                union {
+                    int64_t     i;
+                    double      d;
+                    const void* ptr;
+                };
+                const char* s;
+                size_t      len;
+            };
+
+            arg next_arg() {
+                arg a;
+                a.valid = arg_ < r_.nargs;
+                if (not a.valid) {
+                    a.type = ArgInt64;
+                    a.i = 0;
+                    return a;
+                }
+                a.type = static_cast<arg_type>(r_.types[arg_++]);
+                switch (a.type) {
+                    case ArgString: {
+                        unsigned short len16;
+                        std::memcpy(&len16, r_.data + offset_, 2);
+                        a.s = reinterpret_cast<const char*>(r_.data + offset_ + 2);
+                        a.len = len16;
+                        offset_ += 2 + len16;
+                        break;
+                    }
+                    case ArgDouble:
+                        std::memcpy(&a.d, r_.data + offset_, sizeof(double));
+                        offset_ += sizeof(double);
+                        break;
+                    case ArgPointer:
+                        std::memcpy(&a.ptr, r_.data + offset_, sizeof(void*));
+                        offset_ += sizeof(void*);
+                        break;
+                    default:
+                        std::memcpy(&a.i, r_.data + offset_, sizeof(int64_t));
+                        offset_ += sizeof(int64_t);
+                        break;
+                }
+                return a;
+            }
+
+            static int64_t as_int(const arg& a) {
+                switch (a.type) {
+                    case ArgDouble:     return static_cast<int64_t>(a.d);
+                    case ArgPointer:    return static_cast<int64_t>(reinterpret_cast<intptr_t>(a.ptr));
+                    case ArgString:     return 0;
+                    default:            return a.i;
+                }
+            }
+
+            static uint64_t as_uint(const arg& a) {
+                switch (a.type) {
+                    case ArgInt32:
+                    case ArgUInt32:     return static_cast<uint32_t>(a.i);
+                    default:            return static_cast<uint64_t>(as_int(a));
+                }
+            }
+
+            static double as_double(const arg& a) {
+                return a.type == ArgDouble ? a.d : static_cast<double>(as_int(a));
+            }
+
+            // Writes the conversion into out, and returns the number of
+            // characters which would have been written (as snprintf).
+            size_t convert(const format_spec& spec, char* out, size_t size)
+            {
+                // Rebuild the specification with the values of '*' arguments,
+                // without length modifiers and without the conversion:
+                char f[48];
+                size_t n = 0;
+                const char* p = spec.first;
+                f[n++] = *p++;
+                while (*p == '-' or *p == '+' or *p == ' ' or *p == '#' or *p == '0')
+                    f[n++] = *p++;
+                if (*p == '*') {
+                    n += static_cast<size_t>(snprintf(f + n, 12, "%d", static_cast<int>(as_int(next_arg()))));
+                    ++p;
+                }
+                while (*p >= '0' and *p <= '9' and n < 20)
+                    f[n++] = *p++;
+                int precision = -1;
+                if (*p == '.') {
+                    ++p;
+                    if (*p == '*') {
+                        precision = static_cast<int>(as_int(next_arg()));
+                        ++p;
+                    } else {
+                        precision = 0;
+                        while (*p >= '0' and *p <= '9')
+                            precision = precision * 10 + (*p++ - '0');
+                    }
+                    if (precision >= 0 and spec.conversion != 's') {
+                        n += static_cast<size_t>(snprintf(f + n, 14, ".%d", precision));
+                    }
+                }
+                int result = 0;
+                const char c = spec.conversion;
+                switch (c) {
+                    case 'd': case 'i':
+                        std::strcpy(f + n, "lld");
+                        result = snprintf(out, size, f, static_cast<long long>(as_int(next_arg())));
+                        break;
+                    case 'u': case 'o': case 'x': case 'X':
+                        f[n++] = 'l'; f[n++] = 'l'; f[n++] = c; f[n] = 0;
+                        result = snprintf(out, size, f, static_cast<unsigned long long>(as_uint(next_arg())));
+                        break;
+                    case 'c':
+                        f[n++] = 'c'; f[n] = 0;
+                        result = snprintf(out, size, f, static_cast<int>(as_int(next_arg())));
+                        break;
+                    case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+                        f[n++] = c; f[n] = 0;
+                        result = snprintf(out, size, f, as_double(next_arg()));
+                        break;
+                    case 's': {
+                        arg a = next_arg();
+                        std::strcpy(f + n, ".*s");
+                        if (a.type == ArgString) {
+                            result = snprintf(out, size, f, static_cast<int>(a.len), a.s);
+                        } else {
+                            result = snprintf(out, size, f, 3, "<?>");
+                        }
+                        break;
+                    }
+                    case 'p':
+                        f[n++] = 'p'; f[n] = 0;
+                        result = snprintf(out, size, f, next_arg().ptr);
+                        break;
+                    default:
+                        // %n and unknown conversions are not supported.
+                        break;
+                }
+                return result > 0 ? static_cast<size_t>(result) : 0;
+            }
+
+            const record&   r_;
+            size_t          arg_;
+            size_t          offset_;
+        };
+
+
+        //
+        //  A single producer single consumer ring buffer of records. The
+        //  producer is the owning thread, the consumer the thread which
+        //  drains the buffers of the service.
+        //
+        struct thread_buffer
+        {
+            thread_buffer()
+            : head(0), tail(0), dropped(0), reported_dropped(0), closed(false),
+              thread_id(internal::threadID())
+            {
+            }
+
+            std::atomic<uint64_t>   head;       // written by the consumer
+            char                    pad0_[64 - sizeof(std::atomic<uint64_t>)];
+            std::atomic<uint64_t>   tail;       // written by the producer
+            std::atomic<uint64_t>   dropped;    // written by the producer
+            char                    pad1_[64 - 2 * sizeof(std::atomic<uint64_t>)];
+            uint64_t                reported_dropped;
+            std::atomic<bool>       closed;
+            int                     thread_id;
+            record                  records[kRingCapacity];
+
+            // Returns the slot for the next record, or null if the buffer is
+            // full.
+            record* reserve() {
+                const uint64_t t = tail.load(std::memory_order_relaxed);
+                if (t - head.load(std::memory_order_acquire) == kRingCapacity) {
+                    dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+                return &records[t % kRingCapacity];
+            }
+
+            // Publishes the reserved record. Returns true if the consumer had
+            // taken all former records, that is the buffer went from empty to
+            // non-empty and the consumer has to be woken up.
+            //
+            // Note: the store of tail and the load of head are sequentially
+            // consistent, as are the store of head and the load of tail in the
+            // consumer: either the producer sees the consumer caught up, or
+            // the consumer sees the new record when it re-reads tail.
+            bool commit() {
+                const uint64_t t = tail.load(std::memory_order_relaxed);
+                tail.store(t + 1, std::memory_order_seq_cst);
+                return head.load(std::memory_order_seq_cst) == t;
+            }
+        };
+
+    }  // namespace async_log_detail
+
+
+
+    //
+    //  async_log_service
+    //
+    //  Owns the ring buffers of the logging threads and the background
+    //  thread which writes their messages. There is one instance per process.
+    //  The background thread is started when the first message is logged and
+    //  sleeps until a ring buffer becomes non-empty.
+    //  The service is shut down - and all pending messages are written - when
+    //  the process exits. Messages logged after shut down are written
+    //  synchronously.
+    //
+    class async_log_service
+    {
+        typedef async_log_detail::record            record;
+        typedef async_log_detail::thread_buffer     thread_buffer;
+
+    public:
+        static async_log_service& instance() {
+            // Never destroyed: threads may log while static objects are
+            // destroyed.
+            static async_log_service* s = new async_log_service();
+            return *s;
+        }
+
+        // Sets the stream where messages will be written to. Defaults to
+        // stdout. Pending messages are written to the former output first.
+        void output(FILE* stream) {
+            std::lock_guard<std::mutex> lock(drain_mutex_);
+            drain_locked();
+            out_ = stream;
+        }
+
+        FILE* output() const { return out_; }
+
+        // Writes all messages which have been logged before.
+        void flush() {
+            std::lock_guard<std::mutex> lock(drain_mutex_);
+            drain_locked();
+        }
+
+        // Returns the number of messages which have been dropped since the
+        // ring buffer of their thread was full.
+        uint64_t dropped() const {
+            std::lock_guard<std::mutex> lock(buffers_mutex_);
+            return dropped_ + dropped_in(buffers_);
+        }
+
+        // Stops the background thread and writes all pending messages.
+        void shutdown() {
+            {
+                std::lock_guard<std::mutex> lock(wait_mutex_);
+                if (stop_)
+                    return;
+                stop_ = true;
+            }
+            cv_.notify_one();
+            if (worker_.joinable()) {
+                worker_.join();
+            }
+            std::lock_guard<std::mutex> lock(drain_mutex_);
+            drain_locked();
+            stopped_.store(true, std::memory_order_release);
+        }
+
+        template <typename... Args>
+        void log(LOG_Level level, const char* format, const Args&... args)
+        {
+#if !defined (JSON_NO_THREAD_LOCAL)
+            if (not stopped_.load(std::memory_order_acquire)) {
+                thread_buffer* b = local_buffer();
+                if (b) {
+                    record* r = b->reserve();
+                    if (r) {
+                        async_log_detail::encode(*r, level, format, args...);
+                        if (b->commit())
+                            wake();
+                    }
+                    return;
+                }
+            }
+#endif
+            record r;
+            async_log_detail::encode(r, level, format, args...);
+            std::lock_guard<std::mutex> lock(drain_mutex_);
+            write(r, internal::threadID());
+            fflush(out_);
+        }
+
+    private:
+        async_log_service()
+        : out_(stdout), dropped_(0), stop_(false), pending_(false), stopped_(false),
+          last_second_(-1)
+        {
+            time_str_[0] = 0;
+            // Messages may be written after the statics of the program have
+            // been destroyed, see shutdown_at_exit(), thus the service keeps
+            // its own copy of the executable name.
+            std::strncpy(exec_name_, internal::executableName(), sizeof(exec_name_) - 1);
+            exec_name_[sizeof(exec_name_) - 1] = 0;
+            std::atexit(&async_log_service::shutdown_at_exit);
+        }
+
+        async_log_service(const async_log_service&) = delete;
+        async_log_service& operator=(const async_log_service&) = delete;
+
+        static void shutdown_at_exit() {
+            instance().shutdown();
+        }
+
+#if !defined (JSON_NO_THREAD_LOCAL)
+        // Marks the buffer of a thread closed when the thread exits. The
+        // service deletes it after it has been drained.
+        struct buffer_closer {
+            thread_buffer* buffer;
+            ~buffer_closer() {
+                if (buffer)
+                    buffer->closed.store(true, std::memory_order_release);
+            }
+        };
+
+        thread_buffer* local_buffer() {
+            static thread_local thread_buffer* tls_buffer = nullptr;
+            if (tls_buffer == nullptr) {
+                static thread_local buffer_closer closer = {nullptr};
+                if (closer.buffer != nullptr) {
+                    // The thread is exiting.
+                    return nullptr;
+                }
+                thread_buffer* b = new thread_buffer();
+                {
+                    std::lock_guard<std::mutex> lock(buffers_mutex_);
+                    buffers_.push_back(b);
+                }
+                start();
+                closer.buffer = b;
+                tls_buffer = b;
+            }
+            return tls_buffer;
+        }
+#endif
+
+        static uint64_t dropped_in(const std::vector<thread_buffer*>& buffers) {
+            uint64_t result = 0;
+            for (thread_buffer* b : buffers) {
+                result += b->dropped.load(std::memory_order_relaxed);
+            }
+            return result;
+        }
+
+        // Starts the background thread, when the first thread logs. Once
+        // the service has been shut down, no thread will be started.
+        void start() {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            if (not stop_ and not worker_.joinable()) {
+                worker_ = std::thread(&async_log_service::run, this);
+            }
+        }
+
+        // Wakes up the background thread after a buffer became non-empty.
+        void wake() {
+            {
+                std::lock_guard<std::mutex> lock(wait_mutex_);
+                pending_ = true;
+            }
+            cv_.notify_one();
+        }
+
+        void run() {
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            for (;;) {
+                cv_.wait(lock, [this]{ return stop_ or pending_; });
+                if (stop_)
+                    return;
+                pending_ = false;
+                lock.unlock();
+                {
+                    std::lock_guard<std::mutex> drain_lock(drain_mutex_);
+                    drain_locked();
+                }
+                lock.lock();
+            }
+        }
+
+        // Writes the messages of all buffers, in the order of the buffers.
+        // Returns true if a message has been written. Requires drain_mutex_.
+        bool drain_locked()
+        {
+            std::vector<thread_buffer*> buffers;
+            {
+                std::lock_guard<std::mutex> lock(buffers_mutex_);
+                buffers = buffers_;
+            }
+            bool written = false;
+            for (thread_buffer* b : buffers) {
+                const bool closed = b->closed.load(std::memory_order_acquire);
+                uint64_t h = b->head.load(std::memory_order_relaxed);
+                uint64_t t = b->tail.load(std::memory_order_seq_cst);
+                // Records committed while the buffer is drained did not wake
+                // up the consumer (see thread_buffer::commit()), thus tail is
+                // read again after head has been stored.
+                while (h != t) {
+                    for (; h != t; ++h) {
+                        write(b->records[h % async_log_detail::kRingCapacity], b->thread_id);
+                    }
+                    b->head.store(h, std::memory_order_seq_cst);
+                    t = b->tail.load(std::memory_order_seq_cst);
+                    written = true;
+                }
+                const uint64_t dropped = b->dropped.load(std::memory_order_relaxed);
+                if (dropped != b->reported_dropped) {
+                    fprintf(out_, "%s %s [%x:%x]: %llu log messages dropped\n",
+                            time_string(std::time(nullptr)), exec_name_,
+                            internal::processID(), b->thread_id,
+                            static_cast<unsigned long long>(dropped - b->reported_dropped));
+                    b->reported_dropped = dropped;
+                }
+                if (closed and b->tail.load(std::memory_order_acquire) == h) {
+                    std::lock_guard<std::mutex> lock(buffers_mutex_);
+                    buffers_.erase(std::find(buffers_.begin(), buffers_.end(), b));
+                    dropped_ += b->dropped.load(std::memory_order_relaxed);
+                    delete b;
+                }
+            }
+            fflush(out_);
+            return written;
+        }
+
+        void write(const record& r, int thread_id)
+        {
+            char message[1024];
+            async_log_detail::formatter f(r);
+            size_t len = f.format(message, sizeof(message));
+            const bool newline = len == 0 or message[len - 1] != '\n';
+            fprintf(out_, "%s %s [%x:%x]: %s%s",
+                    time_string(static_cast<time_t>(r.time / 1000000)), exec_name_,
+                    internal::processID(), thread_id, message, newline ? "\n" : "");
+        }
+
+        // Requires drain_mutex_.
+        const char* time_string(time_t t) {
+            if (t != last_second_) {
+                struct tm timeInfo;
+                localtime_r(&t, &timeInfo);
+                strftime(time_str_, sizeof(time_str_), "%Y-%m-%d %X", &timeInfo);
+                last_second_ = t;
+            }
+            return time_str_;
+        }
+
+        FILE*                           out_;
+        std::vector<thread_buffer*>     buffers_;
+        uint64_t                        dropped_;   // of deleted buffers
+        mutable std::mutex              buffers_mutex_;
+        std::mutex                      drain_mutex_;
+        std::mutex                      wait_mutex_;
+        std::condition_variable         cv_;
+        bool                            stop_;
+        bool                            pending_;   // a buffer became non-empty
+        std::atomic<bool>               stopped_;
+        std::thread                     worker_;
+        time_t                          last_second_;
+        char                            time_str_[80];
+        char                            exec_name_[256];
+    };
+
+
+
+    //
+    //  async_logger
+    //
+    //  A drop-in replacement for logger, which writes its messages through
+    //  the async_log_service.
+    //
+    template <typename MaxSeverity = log_warning >
+    class async_logger
+    {
+    public:
+
+        async_logger()
+        : max_severity_(MaxSeverity::value)
+        {
+        }
+
+        template <typename LogSeverity>
+        void log_level(LogSeverity) {
+            max_severity_ = LogSeverity::value;
+        }
+
+        void log_level(LOG_Level level) {
+            max_severity_ = level;
+        }
+
+        LOG_Level log_level() const {
+            LOG_Level v = MaxSeverity::value;
+            return std::min(max_severity_, v);
+        }
+
+
+        template <typename LogSeverity, typename... Args>
+        typename std::enable_if< (LogSeverity::value <= MaxSeverity::value), void>::type
+        log(LogSeverity, const char* format, const Args&... args) const
+        {
+            if (LogSeverity::value > max_severity_)
+                return;
+            async_log_service::instance().log(LogSeverity::value, format, args...);
+        }
+
+        template <typename LogSeverity, typename... Args>
+        typename std::enable_if<(LogSeverity::value > MaxSeverity::value ), void>::type
+        log(LogSeverity, const char*, const Args&...) const
+        {
+        }
+
+        // Writes all pending messages of all threads.
+        static void flush() {
+            async_log_service::instance().flush();
+        }
+
+    private:
+        LOG_Level       max_severity_;
+    };
+
+
+}}   // namespace json::utility
+
+
+
+#endif  // JSON_UTILITY_ASYNC_LOG_HPP
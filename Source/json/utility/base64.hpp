@@ -23,12 +23,16 @@
 #define BASE64_BASE64_HPP
 
 
+#include "json/simd/base64.hpp"
 #include <iterator>
+#include <algorithm>
+#include <utility>
 #include <stdexcept>
 #include <sstream>
 #include <iostream>
 #include <cassert>
 #include <cstdint>
+#include <cstdio>
 
 //  Generate lookup table:
 // 
@@ -66,63 +70,6 @@ namespace json { namespace utility {
         int to_int(const T& v) {
             return static_cast<int>(static_cast<uint8_t>(v));
         }
-    
-    }
-
-        
-    // Encode a sequence of bytes starting at 'first' into its base64 representation
-    // using the usual alphabet and write the result into output iterator 'result'.
-    // Note: this encoding does not embed new lines.
-    template <class InputIterator, class OutputIterator>
-    OutputIterator encodeBase64(InputIterator first, InputIterator last, OutputIterator result)
-    {
-        static_assert( (sizeof(typename std::iterator_traits<InputIterator>::value_type) == sizeof(char)), "" );
-        
-        using base64_detail::to_int;
-        
-        const char base64chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-        
-        while (first != last)
-        {
-            // Read the next three bytes (if available) into one 24-bit number:
-            uint32_t n = to_int(*first) << 16;
-            ++first;
-            if (first != last) {
-                n |= (to_int(*first) << 8);
-                ++first;
-                if (first != last) { 
-                    n |= to_int(*first);   
-                    ++first;
-                    // encode it into 4 bytes:
-                    *result++ = base64chars[static_cast<uint8_t>(n >> 18) & 0x3Fu];
-                    *result++ = base64chars[static_cast<uint8_t>(n >> 12) & 0x3Fu];
-                    *result++ = base64chars[static_cast<uint8_t>(n >> 6) & 0x3Fu];
-                    *result++ = base64chars[static_cast<uint8_t>(n) & 0x3Fu];
-                    //continue;                    
-                }
-                else {
-                    // padding = 1
-                    *result++ = base64chars[static_cast<uint8_t>(n >> 18) & 0x3Fu];
-                    *result++ = base64chars[static_cast<uint8_t>(n >> 12) & 0x3Fu];
-                    *result++ = base64chars[static_cast<uint8_t>(n >> 6) & 0x3Fu];
-                    *result++ = '=';
-                }
-            }
-            else {
-                //padding = 2
-                *result++ = base64chars[static_cast<uint8_t>(n >> 18) & 0x3Fu];
-                *result++ = base64chars[static_cast<uint8_t>(n >> 12) & 0x3Fu];
-                *result++ = '=';
-                *result++ = '=';
-            }
-        }
-        
-        assert(first == last);        
-        return result;
-    }
-
-        
-    namespace base64_detail {
         
         
         // Returns
@@ -153,29 +100,120 @@ namespace json { namespace utility {
             }
         }
         
+        
+        // The kernels process the input in chunks of kChunkSize bytes, which
+        // is a multiple of 3 and 4.
+        constexpr std::size_t kChunkSize = 3 * 1024;
+        
+        // Returns the next chunk of at most size bytes of [first, last) and
+        // advances first. Input which is not contiguous is copied into buffer.
+        template <typename InputIterator>
+        inline std::pair<const char*, const char*>
+        next_chunk(InputIterator& first, InputIterator last, char* buffer, std::size_t size)
+        {
+            std::size_t n = 0;
+            while (n < size and first != last) {
+                buffer[n++] = static_cast<char>(*first);
+                ++first;
+            }
+            return std::make_pair(static_cast<const char*>(buffer), static_cast<const char*>(buffer + n));
+        }
+        
+        template <typename T>
+        inline std::pair<const char*, const char*>
+        next_chunk(T*& first, T* last, char*, std::size_t size)
+        {
+            const std::size_t n = std::min(size, static_cast<std::size_t>(last - first));
+            const char* p = reinterpret_cast<const char*>(first);
+            first += n;
+            return std::make_pair(p, p + n);
+        }
+        
+        
+        // Encodes the last one or two bytes with padding.
+        inline char* encode_tail(const uint8_t* first, const uint8_t* last, char* dst)
+        {
+            const char base64chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            if (first == last)
+                return dst;
+            uint32_t n = uint32_t(first[0]) << 16;
+            if (last - first == 2)
+                n |= uint32_t(first[1]) << 8;
+            *dst++ = base64chars[(n >> 18) & 0x3Fu];
+            *dst++ = base64chars[(n >> 12) & 0x3Fu];
+            *dst++ = (last - first == 2) ? base64chars[(n >> 6) & 0x3Fu] : '=';
+            *dst++ = '=';
+            return dst;
+        }
+    
     }
 
-    
-    // Decode a base64 encoded sequence starting at 'first' into its binary
-    // repesentation and write it into output iterator 'result'.
-    // The base62 sequence shall not contain new lines.
+        
+    // Encode a sequence of bytes starting at 'first' into its base64 representation
+    // using the usual alphabet and write the result into output iterator 'result'.
+    // Note: this encoding does not embed new lines.
+    //
+    // The bulk of the input is encoded by the vectorized kernels in
+    // json/simd/base64.hpp. Input given as pointers is read in place,
+    // otherwise it is copied in chunks.
     template <class InputIterator, class OutputIterator>
-    OutputIterator decodeBase64(InputIterator first, InputIterator last, OutputIterator result)
+    OutputIterator encodeBase64(InputIterator first, InputIterator last, OutputIterator result)
     {
-        static_assert(sizeof(typename std::iterator_traits<InputIterator>::value_type) == sizeof(char), "");
-        
-        using base64_detail::to_int;
-        using base64_detail::lookup;
-        
-        // The length of the input shall be a modulo of 4
+        static_assert( (sizeof(typename std::iterator_traits<InputIterator>::value_type) == sizeof(char)), "" );
         
-        // Errors:
-        //  invalid character
-        //  spurious bytes after last padding character
-        //  expected padding character
-        //  unexpected EOF
-        // 
+        using base64_detail::kChunkSize;
         
+        char buffer[kChunkSize];
+        char out[kChunkSize / 3 * 4];
+        while (first != last)
+        {
+            std::pair<const char*, const char*> chunk = base64_detail::next_chunk(first, last, buffer, kChunkSize);
+            const uint8_t* src = reinterpret_cast<const uint8_t*>(chunk.first);
+            const uint8_t* src_end = reinterpret_cast<const uint8_t*>(chunk.second);
+            char* dst = out;
+            json::simd::base64_encode_blocks(src, src_end, dst);
+            // Only the last chunk may have a tail:
+            dst = base64_detail::encode_tail(src, src_end, dst);
+            result = std::copy(static_cast<const char*>(out), static_cast<const char*>(dst), result);
+        }
+        return result;
+    }
+
+    
+    enum base64_mode {
+        Base64Strict,               // only characters of the alphabet and padding
+        Base64IgnoreWhitespace      // additionally ignores space, tab, CR and LF
+    };
+    
+    
+    //
+    //  base64_decoder
+    //
+    //  Decodes a base64 sequence which may be split into arbitrary chunks,
+    //  for example as they arrive from a stream or from the parser. The
+    //  decoded bytes are passed to a sink, a callable with signature
+    //
+    //      void(const char* data, std::size_t size)
+    //
+    //  in pieces of at most a few kilobytes, so that a large sequence never
+    //  needs to be held in memory, neither encoded nor decoded.
+    //
+    //  Example:
+    //
+    //      base64_decoder decoder(Base64IgnoreWhitespace);
+    //      base64_file_sink sink(file);
+    //      while (read chunk) {
+    //          if (decoder.decode(chunk_first, chunk_last, sink) != chunk_last)
+    //              break;  // see decoder.error()
+    //      }
+    //      bool ok = decoder.finish();
+    //
+    //  The sequence shall be padded to a multiple of four characters. After
+    //  the padding, only white space (if ignored) is allowed.
+    //
+    class base64_decoder
+    {
+    public:
         enum error_t {
             ErrorNone = 0,
             ErrorInvalidCharacter = -1,
@@ -184,126 +222,210 @@ namespace json { namespace utility {
             ErrorUnexpectedEOF = -4
         };
         
-        int error = ErrorNone;
-        while (first != last) 
-        {            
-            int32_t n = lookup(static_cast<uint8_t>(*first));                                
-            if (n >= 0 and ++first != last) {
-                int32_t c = lookup(static_cast<uint8_t>(*first));
-                if (c >= 0 and ++first != last) {
-                    n <<= 6;
-                    n |= c;
-                    c = lookup(static_cast<uint8_t>(*first));
-                    if (++first != last) { 
-                        if (c >= 0) {
-                            n <<= 6;
-                            n |= c;
-                            c = lookup(static_cast<uint8_t>(*first));
-                            if (c >= 0) {
-                                n <<= 6;
-                                n |= c;
-                                // write 3 bytes:
-                                *result++ = (n>>16) & 0x000000FF;
-                                *result++ = (n>>8) & 0x000000FF;
-                                *result++ = (n) & 0x000000FF;
-                                ++first;
-                                continue;
-                            }
-                            else {
-                                if (c == -2) {
-                                    // first and last padding character
-                                    if (++first != last) {
-                                        error = ErrorSpuriousBytes; // error: spurious bytes after last padding character
-                                        break;
-                                    }
-                                    *result++ = (n>>10) & 0x000000FF;
-                                    *result++ = (n>>2) & 0x000000FF;
-                                    assert(first == last);
-                                    return result;
-                                }
-                                else {
-                                    error = ErrorInvalidCharacter; // error: invalid character
-                                    break;
-                                }
-                            }
-                        }
-                        else {
-                            if (c == -2) {
-                                // 1. padding character, expecting second one
-                                c = lookup(static_cast<uint8_t>(*first));
-                                if (c != -2) {
-                                    error = ErrorExpectedPaddingCharacter; // error: expected padding character
-                                    break;
-                                }
-                                if (++first != last) {
-                                    error = ErrorSpuriousBytes; // error: spurious bytes after last padding character
-                                    break;
-                                }
-                                *result++ = (n>>4) & 0x000000FF;
-                                assert(first == last);
-                                return result;
-                            }
-                            else {
-                                error = ErrorInvalidCharacter;// error: invalid character
-                                break;
-                            }
-                        }
-                    } else {
-                        error = ErrorUnexpectedEOF; // error: unexpected EOF
-                        break;
+        explicit base64_decoder(base64_mode mode = Base64Strict)
+        : mode_(mode)
+        {
+            reset();
+        }
+        
+        // Prepares the decoder for a new sequence.
+        void reset() {
+            quad_ = 0;
+            count_ = 0;
+            state_ = Data;
+            error_ = ErrorNone;
+            size_ = 0;
+        }
+        
+        // Decodes the chunk [first, last) and passes the decoded bytes to
+        // sink. Returns last, or - on error - a pointer to the offending
+        // character. After an error, further chunks are ignored.
+        template <typename Sink>
+        const char* decode(const char* first, const char* last, Sink&& sink)
+        {
+            if (error_ != ErrorNone)
+                return first;
+            
+            const json::simd::detail::base64_decode_table& table = json::simd::detail::base64_values();
+            uint8_t buffer[base64_detail::kChunkSize];
+            uint8_t* const buffer_end = buffer + sizeof(buffer);
+            uint8_t* out = buffer;
+            
+            while (first != last)
+            {
+                if (count_ == 0 and state_ == Data) {
+                    if (buffer_end - out < 64) {
+                        flush(buffer, out, sink);
                     }
+                    json::simd::base64_decode_blocks(first, last, out, buffer_end);
+                    if (first == last)
+                        break;
                 }
-                else {
-                    // error: unexpected EOF or invalid byte or invalid padding
-                    if (c < 0) {
-                        error = ErrorInvalidCharacter;
-                    }
-                    else {
-                        error = ErrorUnexpectedEOF;
+                if (buffer_end - out < 3) {
+                    flush(buffer, out, sink);
+                }
+                const char c = *first;
+                const int v = table[c];
+                if (v >= 0 and state_ == Data) {
+                    quad_ = (quad_ << 6) | static_cast<uint32_t>(v);
+                    if (++count_ == 4) {
+                        out[0] = static_cast<uint8_t>(quad_ >> 16);
+                        out[1] = static_cast<uint8_t>(quad_ >> 8);
+                        out[2] = static_cast<uint8_t>(quad_);
+                        out += 3;
+                        quad_ = 0;
+                        count_ = 0;
                     }
-                    break;                        
+                    ++first;
+                    continue;
                 }
-            } else {
-                // error: unexpected EOF or invalid byte or invalid padding
-                if (n < 0) {
-                    error = ErrorInvalidCharacter;
+                if (mode_ == Base64IgnoreWhitespace and (c == ' ' or c == '\t' or c == '\r' or c == '\n')) {
+                    ++first;
+                    continue;
                 }
-                else {
-                    error = ErrorUnexpectedEOF;
+                if (c == '=' and state_ == Data and count_ == 3) {
+                    // Last padding character:
+                    out[0] = static_cast<uint8_t>(quad_ >> 10);
+                    out[1] = static_cast<uint8_t>(quad_ >> 2);
+                    out += 2;
+                    count_ = 0;
+                    state_ = Done;
+                    ++first;
+                    continue;
                 }
-                break;                        
+                if (c == '=' and state_ == Data and count_ == 2) {
+                    // First of two padding characters:
+                    state_ = ExpectPadding;
+                    ++first;
+                    continue;
+                }
+                if (c == '=' and state_ == ExpectPadding) {
+                    out[0] = static_cast<uint8_t>(quad_ >> 4);
+                    out += 1;
+                    count_ = 0;
+                    state_ = Done;
+                    ++first;
+                    continue;
+                }
+                switch (state_) {
+                    case Data:          error_ = ErrorInvalidCharacter; break;
+                    case ExpectPadding: error_ = ErrorExpectedPaddingCharacter; break;
+                    case Done:          error_ = ErrorSpuriousBytes; break;
+                }
+                break;
             }
-        }  // while
+            flush(buffer, out, sink);
+            return first;
+        }
         
-        if (error != ErrorNone) {
-            // We reach here only in case of an error
-            // Gather some error info:
-            bool eof_reached = first == last;
-            int32_t ch = eof_reached ? EOF : static_cast<uint8_t>(*first);
-            std::stringstream ss(std::stringstream::out);
-            switch (error) {
-                case ErrorInvalidCharacter:
-                    ss << "Invalid character:" << std::hex << "0x" << ch;
-                    break;
-                case ErrorSpuriousBytes:
-                    ss << "Spurious bytes: ";
-                    std::copy(first, last, std::ostream_iterator<uint8_t>(ss));
-                    break;
-                case ErrorExpectedPaddingCharacter:
-                    ss << "Expected padding character, got " << std::hex << ch;
-                    break;
-                case ErrorUnexpectedEOF:
-                    ss << "Unexpected EOF";
-                    break;
-                default:;
+        // Signals the end of the sequence. Returns true if the sequence is
+        // complete and no error occurred.
+        bool finish() {
+            if (error_ == ErrorNone and (count_ != 0)) {
+                error_ = ErrorUnexpectedEOF;
             }
-            
-            std::string msg = ss.str();
-            std::cerr << "Error: " << msg << std::endl;
-            throw std::runtime_error(msg);
+            return error_ == ErrorNone;
+        }
+        
+        error_t error() const { return error_; }
+        
+        // Returns the number of decoded bytes.
+        std::size_t size() const { return size_; }
+        
+    private:
+        enum state_t { Data, ExpectPadding, Done };
+        
+        template <typename Sink>
+        void flush(uint8_t* buffer, uint8_t*& out, Sink& sink) {
+            if (out != buffer) {
+                sink(reinterpret_cast<const char*>(buffer), static_cast<std::size_t>(out - buffer));
+                size_ += static_cast<std::size_t>(out - buffer);
+                out = buffer;
+            }
+        }
+        
+        base64_mode     mode_;
+        uint32_t        quad_;
+        int             count_;
+        state_t         state_;
+        error_t         error_;
+        std::size_t     size_;
+    };
+    
+    
+    // A sink for base64_decoder which writes to a file.
+    struct base64_file_sink
+    {
+        explicit base64_file_sink(FILE* file) : file_(file) {}
+        
+        void operator()(const char* data, std::size_t size) const {
+            std::fwrite(data, 1, size, file_);
+        }
+        
+        FILE* file_;
+    };
+
+    
+    // Decode a base64 encoded sequence starting at 'first' into its binary
+    // repesentation and write it into output iterator 'result'.
+    // Unless mode equals Base64IgnoreWhitespace, the base64 sequence shall
+    // not contain new lines.
+    // Throws std::runtime_error if the sequence is malformed.
+    template <class InputIterator, class OutputIterator>
+    OutputIterator decodeBase64(InputIterator first, InputIterator last, OutputIterator result,
+                                base64_mode mode = Base64Strict)
+    {
+        static_assert(sizeof(typename std::iterator_traits<InputIterator>::value_type) == sizeof(char), "");
+        
+        using base64_detail::kChunkSize;
+        
+        base64_decoder decoder(mode);
+        auto sink = [&result](const char* data, std::size_t size) {
+            const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+            result = std::copy(p, p + size, result);
+        };
+        
+        char buffer[kChunkSize];
+        std::pair<const char*, const char*> chunk(buffer, buffer);
+        const char* p = buffer;
+        while (first != last)
+        {
+            chunk = base64_detail::next_chunk(first, last, buffer, kChunkSize);
+            p = decoder.decode(chunk.first, chunk.second, sink);
+            if (decoder.error() != base64_decoder::ErrorNone)
+                break;
+        }
+        if (decoder.finish()) {
+            return result;
         }
-        assert(first == last);
-        return result;        
+        
+        // We reach here only in case of an error
+        // Gather some error info:
+        const bool eof_reached = decoder.error() == base64_decoder::ErrorUnexpectedEOF;
+        int32_t ch = eof_reached ? EOF : static_cast<uint8_t>(*p);
+        std::stringstream ss(std::stringstream::out);
+        switch (decoder.error()) {
+            case base64_decoder::ErrorInvalidCharacter:
+                ss << "Invalid character:" << std::hex << "0x" << ch;
+                break;
+            case base64_decoder::ErrorSpuriousBytes:
+                ss << "Spurious bytes: ";
+                std::copy(reinterpret_cast<const uint8_t*>(p), reinterpret_cast<const uint8_t*>(chunk.second),
+                          std::ostream_iterator<uint8_t>(ss));
+                std::copy(first, last, std::ostream_iterator<uint8_t>(ss));
+                break;
+            case base64_decoder::ErrorExpectedPaddingCharacter:
+                ss << "Expected padding character, got " << std::hex << ch;
+                break;
+            case base64_decoder::ErrorUnexpectedEOF:
+                ss << "Unexpected EOF";
+                break;
+            default:;
+        }
+        
+        std::string msg = ss.str();
+        std::cerr << "Error: " << msg << std::endl;
+        throw std::runtime_error(msg);
     }
     
     
@@ -0,0 +1,217 @@
+//
+//  futex.hpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#ifndef JSON_UTILITY_FUTEX_HPP
+#define JSON_UTILITY_FUTEX_HPP
+
+
+#include "json/config.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <climits>
+
+#if defined (__linux__) && !defined (JSON_UTILITY_NO_FUTEX)
+#define JSON_UTILITY_LINUX_FUTEX 1
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <ctime>
+#else
+#include <mutex>
+#include <condition_variable>
+#endif
+
+
+namespace json { namespace utility {
+
+    //
+    //  futex
+    //
+    //  An atomic int threads can block on until another thread changes its
+    //  value and wakes them. This is the building block of the portable
+    //  mutex and semaphore.
+    //
+    //  On Linux, waiting and waking map directly to the futex system call.
+    //  Otherwise - or if JSON_UTILITY_NO_FUTEX is defined - a condition
+    //  variable is used.
+    //
+    //  A waiting thread may return spuriously, that is without a wake and
+    //  with the value unchanged. Callers shall re-check their condition.
+    //
+    class futex {
+    public:
+        typedef std::chrono::steady_clock   clock_type;
+        typedef clock_type::time_point      time_point;
+
+        futex(const futex&) = delete;
+        futex& operator=(const futex&) = delete;
+
+        explicit futex(int value = 0) : value_(value) {}
+
+        std::atomic<int>& value() { return value_; }
+        const std::atomic<int>& value() const { return value_; }
+
+        // Blocks while the value equals expected, until woken.
+        void wait(int expected)
+        {
+#if defined (JSON_UTILITY_LINUX_FUTEX)
+            syscall(SYS_futex, address(), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (value_.load() == expected) {
+                cond_.wait(lock);
+            }
+#endif
+        }
+
+        // Blocks while the value equals expected, until woken or until the
+        // deadline passed. Returns false if the deadline passed.
+        bool wait_until(int expected, const time_point& deadline)
+        {
+#if defined (JSON_UTILITY_LINUX_FUTEX)
+            const clock_type::duration remaining = deadline - clock_type::now();
+            if (remaining <= clock_type::duration::zero()) {
+                return false;
+            }
+            const std::chrono::nanoseconds ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining);
+            struct timespec ts;
+            ts.tv_sec = static_cast<time_t>(ns.count() / 1000000000);
+            ts.tv_nsec = static_cast<long>(ns.count() % 1000000000);
+            long result = syscall(SYS_futex, address(), FUTEX_WAIT_PRIVATE, expected, &ts, nullptr, 0);
+            return not (result == -1 and errno == ETIMEDOUT);
+#else
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (value_.load() != expected) {
+                return true;
+            }
+            return cond_.wait_until(lock, deadline) == std::cv_status::no_timeout;
+#endif
+        }
+
+        // Wakes one thread waiting on this futex. The value shall have been
+        // changed before.
+        void wake_one()
+        {
+#if defined (JSON_UTILITY_LINUX_FUTEX)
+            syscall(SYS_futex, address(), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+            { std::lock_guard<std::mutex> lock(mutex_); }
+            cond_.notify_one();
+#endif
+        }
+
+        // Wakes all threads waiting on this futex.
+        void wake_all()
+        {
+#if defined (JSON_UTILITY_LINUX_FUTEX)
+            syscall(SYS_futex, address(), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+            { std::lock_guard<std::mutex> lock(mutex_); }
+            cond_.notify_all();
+#endif
+        }
+
+    private:
+#if defined (JSON_UTILITY_LINUX_FUTEX)
+        static_assert(sizeof(std::atomic<int>) == sizeof(int), "futex requires a plain int");
+        int* address() { return reinterpret_cast<int*>(&value_); }
+#endif
+
+    private:
+        std::atomic<int>            value_;
+#if !defined (JSON_UTILITY_LINUX_FUTEX)
+        std::mutex                  mutex_;
+        std::condition_variable     cond_;
+#endif
+    };
+
+
+
+    namespace futex_detail {
+
+        inline void cpu_relax()
+        {
+#if defined (__x86_64__) || defined (__i386__)
+            __builtin_ia32_pause();
+#elif defined (__aarch64__) || defined (__arm__)
+            __asm__ __volatile__ ("yield");
+#endif
+        }
+
+        // Spinning is pointless on a single processor.
+        inline int max_spins()
+        {
+            static const int n = std::thread::hardware_concurrency() > 1 ? 1000 : 0;
+            return n;
+        }
+
+    }
+
+
+    //
+    //  adaptive_spinner
+    //
+    //  Spins for a while before a thread blocks. The number of spins adapts
+    //  to how long it took to succeed recently, similar to the adaptive
+    //  mutex of glibc: the limit is twice the running average plus a
+    //  constant, capped at max_spins(). Unlike glibc, spinning in vain
+    //  lowers the average, so that threads which always end up blocking
+    //  stop burning cycles.
+    //
+    class adaptive_spinner {
+    public:
+        adaptive_spinner() : estimate_(0) {}
+
+        // Calls try_acquire() until it returns true, or until the spin limit
+        // has been reached. Returns the result of the last call.
+        template <typename Predicate>
+        bool spin(Predicate try_acquire)
+        {
+            const int estimate = estimate_.load(std::memory_order_relaxed);
+            const int limit = std::min(futex_detail::max_spins(), 2 * estimate + 10);
+            if (futex_detail::max_spins() == 0) {
+                return try_acquire();
+            }
+            int n = 0;
+            bool acquired = false;
+            while (n < limit) {
+                if (try_acquire()) {
+                    acquired = true;
+                    break;
+                }
+                futex_detail::cpu_relax();
+                ++n;
+            }
+            const int sample = acquired ? n : 0;
+            estimate_.store(estimate + (sample - estimate) / 8, std::memory_order_relaxed);
+            return acquired;
+        }
+
+    private:
+        std::atomic<int> estimate_;
+    };
+
+
+}}  // namespace json::utility
+
+
+#endif // JSON_UTILITY_FUTEX_HPP
@@ -1,5 +1,3 @@
-#ifndef JSON_UTILITY_LRU_CACHE_HPP
-#define JSON_UTILITY_LRU_CACHE_HPP
 //
 //  lru_cache.hpp
 //
@@ -19,110 +17,526 @@
 //  limitations under the License.
 //
 
+#ifndef JSON_UTILITY_LRU_CACHE_HPP
+#define JSON_UTILITY_LRU_CACHE_HPP
+
 
-#include <boost/bimap.hpp>
-#include <boost/bimap/list_of.hpp>
-#include <boost/bimap/set_of.hpp>
-#include <boost/function.hpp>
-#include <assert.h>
+#include "json/config.hpp"
+#include "string_hasher.hpp"
+#include "mutex.hpp"
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
 
 
 
 namespace json { namespace utility {
 
-    // Class providing fixed-size (by number of records) LRU-replacement cache 
-    // of a function with signature V f(K) 
-    template <typename K, typename V> 
-    class lru_cache 
-    { 
-    public: 
-        
-        typedef int dummy_type; 
-        
-        // Bimap with key access on left view, key access 
-        // history on right view, and associated value. 
-        typedef boost::bimaps::bimap< 
-            boost::bimaps::set_of<K>
-          , boost::bimaps::list_of<dummy_type>
-          , boost::bimaps::with_info<V> 
-        > cache_type; 
-        
-        // Constuctor specifies the cached function and 
-        // the maximum number of records to be stored. 
-        lru_cache(const boost::function<V(const K&)>& f, 
-                  size_t c) 
-        :   fn_(f) 
-          , capacity_(c) 
-        { 
-            assert(capacity_ != 0); 
-        } 
-        
-        // Obtain value of the cached function for k 
-        V operator()(const K& k) { 
-            
-            // Attempt to find existing record 
-            const typename cache_type::left_iterator it = cache_.left.find(k); 
-            
-            if (it == cache_.left.end()) { 
-                
-                // We don't have it: 
-                // Evaluate function and create new record 
-                const V v = fn_(k); 
-                insert(k,v); 
-                return v; 
-                
-            } else { 
-                
-                // We do have it: 
-                // Update the access record view. 
-                cache_.right.relocate( 
-                                      cache_.right.end(), 
-                                      cache_.project_right(it) 
-                                      ); 
-                
-                return it->info; 
-            } 
-        } 
-        
-        // Obtain the cached keys, most recently used element 
-        // at head, least recently used at tail. 
-        // This method is provided purely to support testing. 
-        template <typename IT> 
-        void 
-        get_keys(IT dst) const 
-        { 
-            typename cache_type::right_const_reverse_iterator src = cache_.right.rbegin(); 
-            while (src != cache_.right.rend()) { 
-                *dst++ = (*src++).second; 
-            } 
-        } 
-        
-    private: 
-        
-        void insert(const K& k,const V& v) { 
-            
-            assert(cache_.size()<=capacity_); 
-            
-            // If necessary, make space 
-            if (cache_.size() == capacity_) { 
-                // by purging the least-recently-used element 
-                cache_.right.erase(cache_.right.begin()); 
-            } 
-            
-            // Create a new record from the key, a dummy and the value 
-            cache_.insert( 
-                          typename cache_type::value_type( 
-                                                          k,0,v 
-                                                          ) 
-                          ); 
-        } 
-        
-        const boost::function<V(const K&)> fn_; 
-        const size_t capacity_; 
-        cache_type cache_; 
+
+    //
+    //  Hash function and key equality for the keys of a lru_cache.
+    //
+    //  Both accept the key type and - for heterogeneous lookup - any other
+    //  type Q the cache may be searched with. The specializations for
+    //  std::basic_string also accept a "string buffer", that is a
+    //  std::pair<const CharT*, std::size_t>, so that a string can be looked up
+    //  without constructing a key.
+    //
+    template <typename K>
+    struct lru_cache_hash
+    {
+        std::size_t operator()(const K& k) const { return std::hash<K>()(k); }
+    };
+
+    template <typename K>
+    struct lru_cache_key_equal
+    {
+        bool operator()(const K& lhv, const K& rhv) const { return lhv == rhv; }
+    };
+
+
+    template <typename CharT, typename TraitsT, typename AllocatorT>
+    struct lru_cache_hash<std::basic_string<CharT, TraitsT, AllocatorT> >
+    {
+        std::size_t operator()(const std::basic_string<CharT, TraitsT, AllocatorT>& s) const {
+            return string_hasher<CharT>()(s.data(), s.size());
+        }
+        std::size_t operator()(const std::pair<const CharT*, std::size_t>& s) const {
+            return string_hasher<CharT>()(s.first, s.second);
+        }
+    };
+
+    template <typename CharT, typename TraitsT, typename AllocatorT>
+    struct lru_cache_key_equal<std::basic_string<CharT, TraitsT, AllocatorT> >
+    {
+        typedef std::basic_string<CharT, TraitsT, AllocatorT> string_type;
+
+        bool operator()(const string_type& lhv, const string_type& rhv) const {
+            return lhv == rhv;
+        }
+        bool operator()(const string_type& lhv, const std::pair<const CharT*, std::size_t>& rhv) const {
+            return lhv.size() == rhv.second
+                and TraitsT::compare(lhv.data(), rhv.first, rhv.second) == 0;
+        }
     };
 
-}}
 
 
-#endif
+    //
+    //  class lru_cache
+    //
+    //  A cache with a fixed number of records, which evicts records which have
+    //  not been used recently when it is full.
+    //
+    //  The records are preallocated and linked into an intrusive hash table
+    //  with separate chaining. Finding a record neither allocates nor moves
+    //  records around: a hit merely sets the record's reference bit.
+    //  Eviction follows the CLOCK policy, an approximation of LRU: a "hand"
+    //  sweeps over the records, clears the reference bits which are set and
+    //  evicts the first record whose bit is clear. So, a record which has been
+    //  used since the hand passed it last gets a second chance. New records
+    //  start with a clear reference bit, which lets records that are used
+    //  only once leave the cache first.
+    //
+    //  If a record is replaced, its key and value are assigned to, so a key or
+    //  value type such as std::string may reuse its capacity.
+    //
+    //  Lookup is heterogeneous: find() and erase() accept any type Q which the
+    //  hash function and key equality accept, for example a
+    //  std::pair<const char*, std::size_t> for std::string keys (see
+    //  lru_cache_hash).
+    //
+    //  As a function cache - constructed with a function of signature
+    //  V f(const K&) - operator()(k) returns the cached value of f(k) and
+    //  evaluates f only if k is not cached.
+    //
+    //  K and V shall be DefaultConstructible and MoveAssignable.
+    //
+    //  A lru_cache is not thread-safe; see concurrent_lru_cache.
+    //
+    template <
+        typename K,
+        typename V,
+        typename Hash = lru_cache_hash<K>,
+        typename KeyEqual = lru_cache_key_equal<K>
+    >
+    class lru_cache
+    {
+    public:
+        typedef K                                   key_type;
+        typedef V                                   mapped_type;
+        typedef Hash                                hasher;
+        typedef KeyEqual                            key_equal;
+        typedef std::function<V(const K&)>          function_type;
+
+    private:
+        struct node {
+            node() : hash(0), next(nullptr), referenced(false) {}
+
+            K               key;
+            V               value;
+            std::size_t     hash;
+            node*           next;       // next node in the bucket, or in the free list
+            bool            referenced;
+        };
+
+    public:
+
+        explicit lru_cache(std::size_t capacity,
+                           const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+        :   nodes_(new node[capacity]), capacity_(capacity),
+            buckets_(new node*[bucket_count(capacity)]()), mask_(bucket_count(capacity) - 1),
+            free_(nullptr), hand_(0), size_(0), hash_(hash), equal_(equal)
+        {
+            assert(capacity_ != 0);
+            make_free_list();
+        }
+
+        // Constructs a function cache.
+        lru_cache(const function_type& f, std::size_t capacity)
+        :   lru_cache(capacity)
+        {
+            fn_ = f;
+        }
+
+        lru_cache(const lru_cache&) = delete;
+        lru_cache& operator=(const lru_cache&) = delete;
+
+
+        std::size_t capacity() const    { return capacity_; }
+        std::size_t size() const        { return size_; }
+        bool        empty() const       { return size_ == 0; }
+
+        hasher      hash_function() const   { return hash_; }
+        key_equal   key_eq() const          { return equal_; }
+
+
+        // Returns the value of the cached function for k. Requires that the
+        // cache has been constructed with a function.
+        V operator()(const K& k) {
+            assert(fn_);
+            const std::size_t h = hash_(k);
+            if (V* v = find_hashed(k, h)) {
+                return *v;
+            }
+            V v = fn_(k);
+            insert_hashed(k, v, h);
+            return v;
+        }
+
+
+        // Returns a pointer to the value whose key equals q, or nullptr. The
+        // pointer is valid until the next modification of the cache.
+        template <typename Q>
+        V* find(const Q& q) {
+            return find_hashed(q, hash_(q));
+        }
+
+        // As above, where h shall equal hash_function()(q).
+        template <typename Q>
+        V* find_hashed(const Q& q, std::size_t h) {
+            node* n = find_node(q, h);
+            if (n == nullptr) {
+                return nullptr;
+            }
+            n->referenced = true;
+            return &n->value;
+        }
+
+        // Returns a pointer to the value whose key is the given character
+        // sequence, or nullptr. Requires K to be a string.
+        template <typename CharT>
+        V* find(const CharT* s, std::size_t len) {
+            return find(std::pair<const CharT*, std::size_t>(s, len));
+        }
+
+        // Inserts a record, or assigns the value if a record with an equal
+        // key exists. If the cache is full, evicts a record. Returns a pointer
+        // to the value in the cache.
+        template <typename KK, typename VV>
+        V* insert(KK&& k, VV&& v) {
+            const std::size_t h = hash_(k);
+            return insert_hashed(std::forward<KK>(k), std::forward<VV>(v), h);
+        }
+
+        // As above, where h shall equal hash_function()(k).
+        template <typename KK, typename VV>
+        V* insert_hashed(KK&& k, VV&& v, std::size_t h) {
+            node* n = find_node(k, h);
+            if (n != nullptr) {
+                n->value = std::forward<VV>(v);
+                n->referenced = true;
+                return &n->value;
+            }
+            n = free_;
+            if (n != nullptr) {
+                free_ = n->next;
+            }
+            else {
+                n = evict();
+            }
+            n->key = std::forward<KK>(k);
+            n->value = std::forward<VV>(v);
+            n->hash = h;
+            n->referenced = false;
+            node*& bucket = buckets_[h & mask_];
+            n->next = bucket;
+            bucket = n;
+            ++size_;
+            return &n->value;
+        }
+
+        // Removes the record whose key equals q. Returns true if a record
+        // has been removed.
+        template <typename Q>
+        bool erase(const Q& q) {
+            return erase_hashed(q, hash_(q));
+        }
+
+        template <typename Q>
+        bool erase_hashed(const Q& q, std::size_t h) {
+            node* n = find_node(q, h);
+            if (n == nullptr) {
+                return false;
+            }
+            unlink(n);
+            release(n);
+            n->next = free_;
+            free_ = n;
+            --size_;
+            return true;
+        }
+
+        void clear() {
+            for (std::size_t i = 0; i <= mask_; ++i) {
+                buckets_[i] = nullptr;
+            }
+            for (std::size_t i = 0; i < capacity_; ++i) {
+                release(&nodes_[i]);
+            }
+            make_free_list();
+            hand_ = 0;
+            size_ = 0;
+        }
+
+        // Calls f(key, value) for each record, in no particular order.
+        template <typename F>
+        void for_each(F f) const {
+            for (std::size_t i = 0; i <= mask_; ++i) {
+                for (const node* n = buckets_[i]; n != nullptr; n = n->next) {
+                    f(n->key, n->value);
+                }
+            }
+        }
+
+    private:
+        static std::size_t bucket_count(std::size_t capacity) {
+            std::size_t n = 1;
+            while (n < capacity) {
+                n <<= 1;
+            }
+            return n;
+        }
+
+        void make_free_list() {
+            free_ = nullptr;
+            for (std::size_t i = capacity_; i > 0; --i) {
+                nodes_[i - 1].next = free_;
+                free_ = &nodes_[i - 1];
+            }
+        }
+
+        template <typename Q>
+        node* find_node(const Q& q, std::size_t h) const {
+            for (node* n = buckets_[h & mask_]; n != nullptr; n = n->next) {
+                if (n->hash == h and equal_(n->key, q)) {
+                    return n;
+                }
+            }
+            return nullptr;
+        }
+
+        void unlink(node* n) {
+            node** p = &buckets_[n->hash & mask_];
+            while (*p != n) {
+                p = &(*p)->next;
+            }
+            *p = n->next;
+        }
+
+        // Resets key and value, which releases their resources.
+        static void release(node* n) {
+            n->key = K();
+            n->value = V();
+            n->referenced = false;
+        }
+
+        // Requires a full cache. Returns the unlinked victim.
+        node* evict() {
+            assert(size_ == capacity_);
+            while (nodes_[hand_].referenced) {
+                nodes_[hand_].referenced = false;
+                hand_ = hand_ + 1 == capacity_ ? 0 : hand_ + 1;
+            }
+            node* victim = &nodes_[hand_];
+            hand_ = hand_ + 1 == capacity_ ? 0 : hand_ + 1;
+            unlink(victim);
+            --size_;
+            return victim;
+        }
+
+    private:
+        std::unique_ptr<node[]>     nodes_;
+        const std::size_t           capacity_;
+        std::unique_ptr<node*[]>    buckets_;
+        const std::size_t           mask_;
+        node*                       free_;
+        std::size_t                 hand_;
+        std::size_t                 size_;
+        Hash                        hash_;
+        KeyEqual                    equal_;
+        function_type               fn_;
+    };
+
+
+
+    //
+    //  class concurrent_lru_cache
+    //
+    //  A thread-safe lru_cache, which is split into a number of shards. Each
+    //  shard is a lru_cache guarded by its own mutex, and a key is mapped to
+    //  a shard by its hash value. So, threads contend only if they access the
+    //  same shard at the same time.
+    //
+    //  Since a record may be evicted by another thread at any time, values are
+    //  returned by copy. A function cache evaluates the function outside the
+    //  lock; when two threads miss the same key concurrently, both evaluate
+    //  the function.
+    //
+    template <
+        typename K,
+        typename V,
+        typename Hash = lru_cache_hash<K>,
+        typename KeyEqual = lru_cache_key_equal<K>,
+        typename MutexT = json::utility::mutex
+    >
+    class concurrent_lru_cache
+    {
+    public:
+        typedef lru_cache<K, V, Hash, KeyEqual>     cache_type;
+        typedef K                                   key_type;
+        typedef V                                   mapped_type;
+        typedef typename cache_type::function_type  function_type;
+
+        static std::size_t default_shard_count() { return 16; }
+
+    private:
+        struct shard {
+            explicit shard(std::size_t capacity) : cache(capacity) {}
+
+            MutexT          mutex;
+            cache_type      cache;
+            char            pad[64];
+        };
+
+    public:
+
+        // The capacity is distributed evenly over the shards. The number of
+        // shards is rounded up to a power of two.
+        explicit concurrent_lru_cache(std::size_t capacity,
+                                      std::size_t shards = default_shard_count())
+        :   shift_(0), hash_()
+        {
+            assert(capacity != 0 and shards != 0);
+            std::size_t n = 1;
+            unsigned bits = 0;
+            while (n < shards) {
+                n <<= 1;
+                ++bits;
+            }
+            shift_ = 64 - bits;
+            const std::size_t shard_capacity = (capacity + n - 1) / n;
+            shards_.reserve(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                shards_.emplace_back(new shard(shard_capacity));
+            }
+        }
+
+        // Constructs a function cache.
+        concurrent_lru_cache(const function_type& f, std::size_t capacity,
+                             std::size_t shards = default_shard_count())
+        :   concurrent_lru_cache(capacity, shards)
+        {
+            fn_ = f;
+        }
+
+        concurrent_lru_cache(const concurrent_lru_cache&) = delete;
+        concurrent_lru_cache& operator=(const concurrent_lru_cache&) = delete;
+
+
+        std::size_t shard_count() const { return shards_.size(); }
+
+        std::size_t capacity() const {
+            return shards_.size() * shards_[0]->cache.capacity();
+        }
+
+        // The result is approximate while other threads modify the cache.
+        std::size_t size() const {
+            std::size_t result = 0;
+            for (const std::unique_ptr<shard>& s : shards_) {
+                std::lock_guard<MutexT> lock(s->mutex);
+                result += s->cache.size();
+            }
+            return result;
+        }
+
+
+        V operator()(const K& k) {
+            assert(fn_);
+            const std::size_t h = hash_(k);
+            shard& s = shard_for(h);
+            {
+                std::lock_guard<MutexT> lock(s.mutex);
+                if (V* v = s.cache.find_hashed(k, h)) {
+                    return *v;
+                }
+            }
+            V v = fn_(k);
+            std::lock_guard<MutexT> lock(s.mutex);
+            s.cache.insert_hashed(k, v, h);
+            return v;
+        }
+
+        // Copies the value whose key equals q to v. Returns false, if the
+        // key is not cached.
+        template <typename Q>
+        bool find(const Q& q, V& v) {
+            const std::size_t h = hash_(q);
+            shard& s = shard_for(h);
+            std::lock_guard<MutexT> lock(s.mutex);
+            if (V* p = s.cache.find_hashed(q, h)) {
+                v = *p;
+                return true;
+            }
+            return false;
+        }
+
+        template <typename CharT>
+        bool find(const CharT* str, std::size_t len, V& v) {
+            return find(std::pair<const CharT*, std::size_t>(str, len), v);
+        }
+
+        template <typename KK, typename VV>
+        void insert(KK&& k, VV&& v) {
+            const std::size_t h = hash_(k);
+            shard& s = shard_for(h);
+            std::lock_guard<MutexT> lock(s.mutex);
+            s.cache.insert_hashed(std::forward<KK>(k), std::forward<VV>(v), h);
+        }
+
+        template <typename Q>
+        bool erase(const Q& q) {
+            const std::size_t h = hash_(q);
+            shard& s = shard_for(h);
+            std::lock_guard<MutexT> lock(s.mutex);
+            return s.cache.erase_hashed(q, h);
+        }
+
+        void clear() {
+            for (std::unique_ptr<shard>& s : shards_) {
+                std::lock_guard<MutexT> lock(s->mutex);
+                s->cache.clear();
+            }
+        }
+
+    private:
+        // The hash value selects the bucket within a shard by its low bits.
+        // The shard is selected by the high bits of the hash value multiplied
+        // by 2^64 / phi, so that both are independent even for weak hash
+        // functions such as the identity.
+        shard& shard_for(std::size_t h) {
+            if (shift_ == 64) {
+                return *shards_[0];
+            }
+            const uint64_t m = static_cast<uint64_t>(h) * UINT64_C(0x9E3779B97F4A7C15);
+            return *shards_[static_cast<std::size_t>(m >> shift_)];
+        }
+
+    private:
+        std::vector<std::unique_ptr<shard> >    shards_;
+        unsigned                                shift_;
+        Hash                                    hash_;
+        function_type                           fn_;
+    };
+
+
+}}  // namespace json::utility
+
+
+#endif // JSON_UTILITY_LRU_CACHE_HPP
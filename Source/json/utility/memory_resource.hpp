@@ -0,0 +1,324 @@
+//
+//  memory_resource.hpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#ifndef JSON_UTILITY_MEMORY_RESOURCE_HPP
+#define JSON_UTILITY_MEMORY_RESOURCE_HPP
+
+
+#include "json/config.hpp"
+#include "arena_allocator.hpp"
+#include "pool_allocator.hpp"
+#include <atomic>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+
+#if !defined (JSON_NO_STD_PMR) && __cplusplus >= 201703L && defined (__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define JSON_HAS_STD_PMR 1
+#endif
+#endif
+
+
+//
+//  Memory resources
+//
+//  A memory resource encapsulates an allocation strategy behind a virtual
+//  interface, so that the strategy can be chosen at runtime without changing
+//  the type of the containers using it.
+//
+//  If the standard library provides header <memory_resource> (C++17),
+//  json::pmr::memory_resource is std::pmr::memory_resource, and the standard
+//  resources (for example std::pmr::monotonic_buffer_resource) can be used
+//  with json::pmr. Otherwise, json::pmr provides an equivalent class and the
+//  functions new_delete_resource(), get_default_resource() and
+//  set_default_resource().
+//
+//  json::pmr::polymorphic_allocator is always defined here, since the
+//  value policies rebind allocators with the nested rebind template, which
+//  std::pmr::polymorphic_allocator does not provide.
+//
+
+namespace json { namespace pmr {
+
+#if defined (JSON_HAS_STD_PMR)
+
+    using std::pmr::memory_resource;
+    using std::pmr::new_delete_resource;
+    using std::pmr::get_default_resource;
+    using std::pmr::set_default_resource;
+
+#else
+
+    class memory_resource
+    {
+        static constexpr size_t max_align = alignof(std::max_align_t);
+
+    public:
+        virtual ~memory_resource() {}
+
+        void* allocate(size_t bytes, size_t alignment = max_align) {
+            return do_allocate(bytes, alignment);
+        }
+
+        void deallocate(void* p, size_t bytes, size_t alignment = max_align) {
+            do_deallocate(p, bytes, alignment);
+        }
+
+        bool is_equal(const memory_resource& other) const noexcept {
+            return do_is_equal(other);
+        }
+
+    private:
+        virtual void* do_allocate(size_t bytes, size_t alignment) = 0;
+        virtual void do_deallocate(void* p, size_t bytes, size_t alignment) = 0;
+        virtual bool do_is_equal(const memory_resource& other) const noexcept = 0;
+    };
+
+    inline bool operator==(const memory_resource& a, const memory_resource& b) noexcept {
+        return &a == &b or a.is_equal(b);
+    }
+
+    inline bool operator!=(const memory_resource& a, const memory_resource& b) noexcept {
+        return !(a == b);
+    }
+
+#endif
+
+
+    namespace detail {
+
+        // Over-aligned requests are served by allocating alignment additional
+        // bytes. The pointer returned from the underlying allocation is
+        // stored right before the aligned pointer.
+
+        inline bool is_over_aligned(size_t alignment) {
+            return alignment > alignof(std::max_align_t);
+        }
+
+        inline size_t over_aligned_size(size_t bytes, size_t alignment) {
+            return bytes + alignment + sizeof(void*);
+        }
+
+        inline void* align_over_aligned(void* raw, size_t alignment) {
+            uintptr_t p = reinterpret_cast<uintptr_t>(raw) + sizeof(void*);
+            p = (p + alignment - 1) & ~uintptr_t(alignment - 1);
+            reinterpret_cast<void**>(p)[-1] = raw;
+            return reinterpret_cast<void*>(p);
+        }
+
+        inline void* raw_over_aligned(void* p) {
+            return static_cast<void**>(p)[-1];
+        }
+
+#if !defined (JSON_HAS_STD_PMR)
+        class new_delete_resource_imp : public memory_resource
+        {
+            virtual void* do_allocate(size_t bytes, size_t alignment) {
+                if (is_over_aligned(alignment)) {
+                    return align_over_aligned(::operator new(over_aligned_size(bytes, alignment)), alignment);
+                }
+                return ::operator new(bytes);
+            }
+            virtual void do_deallocate(void* p, size_t, size_t alignment) {
+                ::operator delete(is_over_aligned(alignment) ? raw_over_aligned(p) : p);
+            }
+            virtual bool do_is_equal(const memory_resource& other) const noexcept {
+                return this == &other;
+            }
+        };
+#endif
+    }
+
+
+#if !defined (JSON_HAS_STD_PMR)
+
+    // Returns a memory resource which uses ::operator new and ::operator
+    // delete.
+    inline memory_resource* new_delete_resource() noexcept {
+        static detail::new_delete_resource_imp r;
+        return &r;
+    }
+
+    namespace detail {
+        inline std::atomic<memory_resource*>& default_resource() {
+            static std::atomic<memory_resource*> r(new_delete_resource());
+            return r;
+        }
+    }
+
+    // Returns the memory resource used by default constructed polymorphic
+    // allocators. Initially, this is new_delete_resource().
+    inline memory_resource* get_default_resource() noexcept {
+        return detail::default_resource().load(std::memory_order_acquire);
+    }
+
+    // Sets the default memory resource, and returns the previous one. If r is
+    // null, sets new_delete_resource().
+    inline memory_resource* set_default_resource(memory_resource* r) noexcept {
+        return detail::default_resource().exchange(r ? r : new_delete_resource(), std::memory_order_acq_rel);
+    }
+
+#endif
+
+
+    //
+    //  polymorphic_allocator<T>
+    //
+    //  An allocator which allocates from a memory resource. A default
+    //  constructed allocator uses get_default_resource(). Two allocators
+    //  compare equal if their memory resources compare equal.
+    //
+    //  Like the other allocators of this library - and unlike
+    //  std::pmr::polymorphic_allocator - copies of containers keep the
+    //  memory resource of the original.
+    //
+    template <typename T>
+    class polymorphic_allocator
+    {
+        memory_resource* resource_;
+
+    public:
+        typedef T value_type;
+
+        template <typename U> struct rebind
+        {
+            typedef polymorphic_allocator<U> other;
+        };
+
+        polymorphic_allocator() noexcept
+        : resource_(get_default_resource())
+        {
+        }
+
+        polymorphic_allocator(memory_resource* r) noexcept
+        : resource_(r)
+        {
+            assert(r != nullptr);
+        }
+
+        template <typename U>
+        polymorphic_allocator(const polymorphic_allocator<U>& other) noexcept
+        : resource_(other.resource())
+        {
+        }
+
+        polymorphic_allocator(const polymorphic_allocator&) = default;
+
+        memory_resource* resource() const noexcept { return resource_; }
+
+        T* allocate(std::size_t n) {
+            return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* p, std::size_t n) noexcept {
+            resource_->deallocate(p, n * sizeof(T), alignof(T));
+        }
+    };
+
+    template <typename T1, typename T2>
+    inline bool
+    operator==(const polymorphic_allocator<T1>& a, const polymorphic_allocator<T2>& b) noexcept {
+        return *a.resource() == *b.resource();
+    }
+
+    template <typename T1, typename T2>
+    inline bool
+    operator!=(const polymorphic_allocator<T1>& a, const polymorphic_allocator<T2>& b) noexcept {
+        return !(a == b);
+    }
+
+
+    //
+    //  arena_resource<Arena>
+    //
+    //  A memory resource which allocates from an arena, for example a
+    //  json::utility::SysArena or json::utility::MmapArena. Deallocation is
+    //  a no-op; the memory is released when the arena is reset or destroyed.
+    //  The arena must outlive the resource.
+    //
+    template <typename Arena = json::utility::SysArena>
+    class arena_resource : public memory_resource
+    {
+    public:
+        typedef Arena arena_type;
+
+        explicit arena_resource(Arena& arena) noexcept : arena_(arena) {}
+
+        Arena& arena() const noexcept { return arena_; }
+
+    private:
+        virtual void* do_allocate(size_t bytes, size_t alignment) {
+            if (detail::is_over_aligned(alignment)) {
+                return detail::align_over_aligned(arena_.allocate(detail::over_aligned_size(bytes, alignment)), alignment);
+            }
+            return arena_.allocate(bytes);
+        }
+
+        virtual void do_deallocate(void* p, size_t, size_t alignment) {
+            arena_.deallocate(detail::is_over_aligned(alignment) ? detail::raw_over_aligned(p) : p);
+        }
+
+        virtual bool do_is_equal(const memory_resource& other) const noexcept {
+            const arena_resource* r = dynamic_cast<const arena_resource*>(&other);
+            return r != nullptr and &r->arena_ == &arena_;
+        }
+
+        Arena& arena_;
+    };
+
+
+    //
+    //  pool_resource
+    //
+    //  A memory resource which allocates from the process wide
+    //  json::utility::SlabPool. All instances compare equal.
+    //
+    class pool_resource : public memory_resource
+    {
+        typedef json::utility::SlabPool pool;
+
+        virtual void* do_allocate(size_t bytes, size_t alignment) {
+            if (detail::is_over_aligned(alignment)) {
+                return detail::align_over_aligned(pool::allocate(detail::over_aligned_size(bytes, alignment)), alignment);
+            }
+            return pool::allocate(bytes);
+        }
+
+        virtual void do_deallocate(void* p, size_t bytes, size_t alignment) {
+            if (detail::is_over_aligned(alignment)) {
+                pool::deallocate(detail::raw_over_aligned(p), detail::over_aligned_size(bytes, alignment));
+            }
+            else {
+                pool::deallocate(p, bytes);
+            }
+        }
+
+        virtual bool do_is_equal(const memory_resource& other) const noexcept {
+            return dynamic_cast<const pool_resource*>(&other) != nullptr;
+        }
+    };
+
+
+}}  // namespace json::pmr
+
+
+#endif  // JSON_UTILITY_MEMORY_RESOURCE_HPP
@@ -0,0 +1,262 @@
+//
+//  mmap_arena.hpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#ifndef JSON_UTILITY_MMAP_ARENA_HPP
+#define JSON_UTILITY_MMAP_ARENA_HPP
+
+
+#include "json/config.hpp"
+#include "arena_allocator.hpp"
+#include <algorithm>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+
+#if defined (__unix__) || defined (__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define JSON_UTILITY_HAS_MMAP_ARENA 1
+#endif
+
+
+#if defined (JSON_UTILITY_HAS_MMAP_ARENA)
+
+namespace json { namespace utility {
+
+
+    /**
+     * An arena which allocates from one large range of virtual memory
+     * instead of a list of blocks obtained from malloc().
+     *
+     * The range is reserved with mmap() when the arena is constructed, but
+     * not backed by memory. The arena commits the memory in steps of
+     * kCommitSize (2 MB) as allocations advance, and the kernel provides the
+     * pages when they are touched first. Optionally, the arena asks for
+     * transparent huge pages (madvise(MADV_HUGEPAGE), Linux only), which
+     * considerably reduces TLB misses when traversing a huge DOM.
+     *
+     * Since the memory is contiguous, allocation is a pointer increment and
+     * there are no blocks to manage: reset() returns the pages to the system
+     * with madvise(MADV_DONTNEED) except the first retainedBytes(), and
+     * destroying the arena is a single munmap() - regardless of the size of
+     * the document. The memory does not fragment the heap of the process.
+     *
+     * The reserved size limits the total size of the allocations; allocate()
+     * throws std::bad_alloc if the reserved range is exhausted. Reserving
+     * address space is cheap on 64-bit systems, so the default is 4 GB (256
+     * MB on 32-bit systems).
+     *
+     * MmapArena has the interface of arena, and can be used with
+     * arena_allocator:
+     *
+     *   MmapArena arena(MmapArena::kDefaultReserveSize, true);
+     *   typedef arena_allocator<void, MmapArena> allocator_t;
+     *   value_generator<UTF_8_encoding_tag, allocator_t> sa((allocator_t(arena)));
+     */
+    class MmapArena {
+    public:
+        static constexpr size_t kCommitSize = size_t(2) * 1024 * 1024;
+        static constexpr size_t kDefaultReserveSize = sizeof(void*) == 8
+            ? size_t(4) * 1024 * 1024 * 1024 : size_t(256) * 1024 * 1024;
+
+        class Marker {
+            friend class MmapArena;
+            char* ptr_;
+            size_t bytesUsed_;
+        };
+
+        explicit MmapArena(size_t reserveSize = kDefaultReserveSize, bool hugePages = false)
+            : region_(nullptr)
+            , regionSize_(0)
+            , base_(nullptr)
+            , ptr_(nullptr)
+            , committed_(nullptr)
+            , limit_(nullptr)
+            , highWater_(nullptr)
+            , bytesUsed_(0)
+            , retainedBytes_(0)
+            , hugePages_(hugePages)
+        {
+            reserveSize = (reserveSize + kCommitSize - 1) & ~(kCommitSize - 1);
+            // Reserve an additional commit step in order to align the range
+            // to the huge page size:
+            regionSize_ = reserveSize + kCommitSize;
+            void* p = ::mmap(nullptr, regionSize_, PROT_NONE, MAP_PRIVATE | MAP_ANON | MAP_NORESERVE, -1, 0);
+            if (p == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            region_ = static_cast<char*>(p);
+            base_ = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(region_) + kCommitSize - 1) & ~uintptr_t(kCommitSize - 1));
+            ptr_ = base_;
+            committed_ = base_;
+            highWater_ = base_;
+            limit_ = base_ + reserveSize;
+        }
+
+        ~MmapArena() {
+            if (region_) {
+                ::munmap(region_, regionSize_);
+            }
+        }
+
+        void* allocate(size_t size)
+        {
+            size = roundUp(size);
+            if (size > static_cast<size_t>(committed_ - ptr_)) {
+                commit(size);
+            }
+            char* r = ptr_;
+            ptr_ += size;
+            bytesUsed_ += size;
+            return r;
+        }
+
+        void deallocate(void*) noexcept {
+            // Deallocate? Never!
+        }
+
+        // Gets the total memory committed by the arena.
+        size_t totalSize() const {
+            return static_cast<size_t>(committed_ - base_) + sizeof(MmapArena);
+        }
+
+        size_t numberAllocatedBlocks() const {
+            return committed_ != base_ ? 1 : 0;
+        }
+
+        size_t bytesUsed() const {
+            return bytesUsed_;
+        }
+
+        size_t reservedSize() const {
+            return static_cast<size_t>(limit_ - base_);
+        }
+
+        bool hugePages() const { return hugePages_; }
+
+        // The number of bytes at the start of the range which reset() keeps
+        // backed by memory. Defaults to zero.
+        size_t retainedBytes() const { return retainedBytes_; }
+        void setRetainedBytes(size_t n) { retainedBytes_ = n; }
+
+        // Releases all memory allocated from the arena and returns the pages
+        // touched beyond retainedBytes() to the system. The range stays
+        // committed, and reused pages will be provided - zero filled - by the
+        // kernel when touched again.
+        // Objects allocated from the arena must have been destroyed already.
+        void reset() {
+            release(retainedBytes_);
+        }
+
+        // As reset(), and additionally decommits the range. The setting of
+        // retainedBytes() is kept for subsequent calls to reset().
+        void clear() {
+            release(0);
+            if (committed_ != base_) {
+                ::mprotect(base_, static_cast<size_t>(committed_ - base_), PROT_NONE);
+                committed_ = base_;
+            }
+            highWater_ = base_;
+        }
+
+        Marker mark() const {
+            Marker m;
+            m.ptr_ = ptr_;
+            m.bytesUsed_ = bytesUsed_;
+            return m;
+        }
+
+        // Releases the memory allocated after marker m has been taken. The
+        // pages are not returned to the system.
+        void rewind(const Marker& m) {
+            assert(m.ptr_ >= base_ and m.ptr_ <= ptr_);
+            highWater_ = std::max(highWater_, ptr_);
+            ptr_ = m.ptr_;
+            bytesUsed_ = m.bytesUsed_;
+        }
+
+    private:
+        MmapArena(const MmapArena&) = delete;
+        MmapArena& operator=(const MmapArena&) = delete;
+
+        static constexpr size_t maxAlign = alignof(std::max_align_t);
+
+        static constexpr size_t roundUp(size_t size) {
+            return (size + maxAlign - 1) & ~(maxAlign - 1);
+        }
+
+        static size_t roundUpPage(size_t size) {
+            const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            return (size + page - 1) / page * page;
+        }
+
+        void commit(size_t size) {
+            highWater_ = std::max(highWater_, ptr_);
+            if (size > static_cast<size_t>(limit_ - ptr_)) {
+                throw std::bad_alloc();
+            }
+            size_t n = static_cast<size_t>(ptr_ + size - committed_);
+            n = (n + kCommitSize - 1) & ~(kCommitSize - 1);
+            n = std::min(n, static_cast<size_t>(limit_ - committed_));
+            if (::mprotect(committed_, n, PROT_READ | PROT_WRITE) != 0) {
+                throw std::bad_alloc();
+            }
+#if defined (MADV_HUGEPAGE)
+            if (hugePages_) {
+                ::madvise(committed_, n, MADV_HUGEPAGE);
+            }
+#endif
+            committed_ += n;
+            // The pages up to the end of this allocation will be touched:
+            highWater_ = std::max(highWater_, ptr_ + size);
+        }
+
+        // Releases all allocations and returns the pages touched beyond the
+        // first `retained` bytes to the system.
+        void release(size_t retained) {
+            highWater_ = std::max(highWater_, ptr_);
+            char* keep = base_ + std::min(roundUpPage(retained), static_cast<size_t>(committed_ - base_));
+            if (highWater_ > keep) {
+                ::madvise(keep, static_cast<size_t>(highWater_ - keep), MADV_DONTNEED);
+                highWater_ = keep;
+            }
+            ptr_ = base_;
+            bytesUsed_ = 0;
+        }
+
+        char*   region_;        // the mapped range
+        size_t  regionSize_;
+        char*   base_;          // the start of the range, aligned to kCommitSize
+        char*   ptr_;           // the next allocation
+        char*   committed_;     // the end of the committed range
+        char*   limit_;         // the end of the reserved range
+        char*   highWater_;     // the pages below may have been touched
+        size_t  bytesUsed_;
+        size_t  retainedBytes_;
+        bool    hugePages_;
+    };
+
+
+}}  // namespace json::utility
+
+#endif  // JSON_UTILITY_HAS_MMAP_ARENA
+
+
+#endif  // JSON_UTILITY_MMAP_ARENA_HPP
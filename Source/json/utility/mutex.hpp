@@ -0,0 +1,109 @@
+//
+//  mutex.hpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#ifndef JSON_UTILITY_MUTEX_HPP
+#define JSON_UTILITY_MUTEX_HPP
+
+
+#include "json/config.hpp"
+#include "futex.hpp"
+#include <atomic>
+
+#if defined(DEBUG)
+#include <cstdio>
+#endif
+
+
+namespace json { namespace utility {
+
+
+    //
+    //  mutex
+    //
+    //  A non-recursive mutex which models Lockable, and a portable drop-in
+    //  replacement for json::objc::gcd::mutex.
+    //
+    //  The state is 0 (unlocked), 1 (locked) or 2 (locked, with possibly
+    //  waiting threads), so that an uncontended lock and unlock is a single
+    //  atomic operation each, and unlock() only wakes a thread if one may be
+    //  waiting. A contended lock() spins adaptively before it blocks.
+    //
+    class mutex  {
+    public:
+
+        mutex(const mutex&) = delete;
+        mutex& operator=(const mutex&) = delete;
+
+        mutex() : state_(0) {}
+
+        ~mutex() {}
+
+        void lock() {
+            if (try_lock()) {
+                return;
+            }
+            if (spinner_.spin([this]() {
+                    return state_.value().load(std::memory_order_relaxed) == 0 and try_lock();
+                })) {
+                return;
+            }
+#if defined (DEBUG)
+            double timeout = 1.0;
+            double locktime = 0;
+            while (state_.value().exchange(2, std::memory_order_acquire) != 0) {
+                const futex::time_point deadline = futex::clock_type::now()
+                    + std::chrono::duration_cast<futex::clock_type::duration>(std::chrono::duration<double>(timeout));
+                if (not state_.wait_until(2, deadline)) {
+                    locktime += timeout;
+                    std::printf("WARNING: mutex %p locking for %g seconds\n", static_cast<void*>(this), locktime);
+                    if (timeout < 64.0)
+                        timeout *= 2;
+                }
+            }
+#else
+            while (state_.value().exchange(2, std::memory_order_acquire) != 0) {
+                state_.wait(2);
+            }
+#endif
+        }
+
+        bool try_lock() {
+            int expected = 0;
+            return state_.value().compare_exchange_strong(expected, 1,
+                                                          std::memory_order_acquire,
+                                                          std::memory_order_relaxed);
+        }
+
+        void unlock() {
+            if (state_.value().exchange(0, std::memory_order_release) == 2) {
+                state_.wake_one();
+            }
+        }
+
+    private:
+        futex               state_;
+        adaptive_spinner    spinner_;
+    };
+
+
+
+}}  // namespace json::utility
+
+
+#endif // JSON_UTILITY_MUTEX_HPP
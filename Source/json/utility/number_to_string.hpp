@@ -115,7 +115,7 @@ namespace json { namespace utility {
 
     template <typename T, typename OutputIterator>
     OutputIterator write_number(T const& value, OutputIterator dest
-                                , typename std::enable_if<std::is_integral<T>::value>::type* = 0)
+                                , typename std::enable_if<std::is_integral<T>::value and std::is_signed<T>::value>::type* = 0)
     {
         namespace karma = boost::spirit::karma;
         
@@ -125,6 +125,18 @@ namespace json { namespace utility {
         return out;
     }
     
+    template <typename T, typename OutputIterator>
+    OutputIterator write_number(T const& value, OutputIterator dest
+                                , typename std::enable_if<std::is_integral<T>::value and std::is_unsigned<T>::value>::type* = 0)
+    {
+        namespace karma = boost::spirit::karma;
+        
+        OutputIterator out = dest;
+        karma::uint_generator<T, 10> generator;
+        /*bool result =*/ karma::generate(out, generator, value);
+        return out;
+    }
+    
     template <typename T, typename OutputIterator, template <typename> class Formatter = json_float_number_policy>
     OutputIterator write_number(T const& value, OutputIterator dest
                                 , typename std::enable_if<std::is_floating_point<T>::value>::type* = 0)
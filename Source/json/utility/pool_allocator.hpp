@@ -0,0 +1,395 @@
+//
+//  pool_allocator.hpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#ifndef JSON_UTILITY_POOL_ALLOCATOR_HPP
+#define JSON_UTILITY_POOL_ALLOCATOR_HPP
+
+
+#include "json/config.hpp"
+#include "mutex.hpp"
+#include <mutex>
+#include <vector>
+#include <new>
+#include <cstddef>
+#include <cstdlib>
+#include <cassert>
+
+
+namespace json { namespace utility {
+
+
+    /**
+     * SlabPool is a process wide allocator for small objects, which recycles
+     * freed memory.
+     *
+     * Requests are rounded up to one of kNumClasses size classes (16 to 512
+     * bytes). Memory of a size class is carved from slabs of kSlabSize bytes.
+     * Freed nodes are kept on a free list of their size class and returned by
+     * subsequent allocations of that class. Larger requests are forwarded to
+     * ::operator new.
+     *
+     * Each thread has a cache of free nodes per size class, so allocating and
+     * deallocating is a list operation without any synchronization. A thread
+     * fetches and returns nodes in batches from the central free lists, which
+     * are guarded by a mutex per size class. A thread cache is returned to
+     * the central free lists when the thread exits.
+     *
+     * Unlike an arena, the memory of a mutable DOM which inserts, erases and
+     * replaces values does not grow: freed nodes are reused. Slabs are never
+     * returned to the system, though: the memory of the pool is the maximum
+     * memory in use at any one time.
+     *
+     * If JSON_NO_THREAD_LOCAL is defined, there are no thread caches and all
+     * requests use the central free lists.
+     */
+    class SlabPool {
+    public:
+        static constexpr size_t kNumClasses = 16;
+        static constexpr size_t kMaxSize = 512;
+        static constexpr size_t kSlabSize = 64 * 1024;
+
+        static void* allocate(size_t size)
+        {
+            if (size > kMaxSize) {
+                return ::operator new(size);
+            }
+            const size_t c = sizeClass(size);
+#if !defined (JSON_NO_THREAD_LOCAL)
+            ThreadCache& tc = threadCache();
+            if (tc.state == ThreadCache::Active) {
+                FreeList& l = tc.lists[c];
+                if (l.head) {
+                    Node* n = l.head;
+                    l.head = n->next;
+                    --l.count;
+                    return n;
+                }
+            }
+            return allocateSlow(tc, c);
+#else
+            return central().get(c);
+#endif
+        }
+
+        static void deallocate(void* p, size_t size) noexcept
+        {
+            if (p == nullptr)
+                return;
+            if (size > kMaxSize) {
+                ::operator delete(p);
+                return;
+            }
+            const size_t c = sizeClass(size);
+#if !defined (JSON_NO_THREAD_LOCAL)
+            ThreadCache& tc = threadCache();
+            if (tc.state == ThreadCache::Active) {
+                FreeList& l = tc.lists[c];
+                Node* n = static_cast<Node*>(p);
+                n->next = l.head;
+                l.head = n;
+                if (++l.count > 2 * batchSize(c)) {
+                    releaseBatch(l, c);
+                }
+                return;
+            }
+            deallocateSlow(tc, p, c);
+#else
+            central().put(p, c);
+#endif
+        }
+
+        // Returns the size class of a request of size bytes, which must not
+        // exceed kMaxSize. The size classes are 16 to 128 in steps of 16,
+        // 160 to 256 in steps of 32 and 320 to 512 in steps of 64 bytes.
+        static constexpr size_t sizeClass(size_t size) {
+            return size <= 128 ? (size + (size == 0)  + 15) / 16 - 1
+                 : size <= 256 ? 8 + (size - 129) / 32
+                 : 12 + (size - 257) / 64;
+        }
+
+        static constexpr size_t classSize(size_t c) {
+            return c < 8 ? (c + 1) * 16
+                 : c < 12 ? 128 + (c - 7) * 32
+                 : 256 + (c - 11) * 64;
+        }
+
+        // The number of nodes a thread cache fetches from or returns to the
+        // central free list at once.
+        static constexpr size_t batchSize(size_t c) {
+            return 4096 / classSize(c) < 4 ? 4
+                 : 4096 / classSize(c) > 64 ? 64
+                 : 4096 / classSize(c);
+        }
+
+        // Returns the total size of the slabs obtained from the system.
+        static size_t totalSize() {
+            Central& cen = central();
+            size_t result = 0;
+            for (size_t c = 0; c < kNumClasses; ++c) {
+                std::lock_guard<json::utility::mutex> lock(cen.classes[c].mutex);
+                result += cen.classes[c].slabs.size() * kSlabSize;
+            }
+            return result;
+        }
+
+        // Returns the number of free nodes of size class c in the central
+        // free list, not counting the nodes cached by threads.
+        static size_t centralFreeNodes(size_t c) {
+            assert(c < kNumClasses);
+            CentralClass& cc = central().classes[c];
+            std::lock_guard<json::utility::mutex> lock(cc.mutex);
+            return cc.count;
+        }
+
+        // Returns the free nodes cached by the calling thread to the central
+        // free lists.
+        static void flushThreadCache() {
+#if !defined (JSON_NO_THREAD_LOCAL)
+            flush(threadCache());
+#endif
+        }
+
+    private:
+        struct Node {
+            Node* next;
+        };
+
+        struct FreeList {
+            Node*   head;
+            size_t  count;
+        };
+
+        struct CentralClass {
+            json::utility::mutex    mutex;
+            Node*                   head = nullptr;
+            size_t                  count = 0;
+            std::vector<void*>      slabs;
+        };
+
+        struct Central {
+            CentralClass classes[kNumClasses];
+
+            void* get(size_t c) {
+                FreeList l = {nullptr, 0};
+                getBatch(l, c, 1);
+                return l.head;
+            }
+
+            void put(void* p, size_t c) {
+                Node* n = static_cast<Node*>(p);
+                n->next = nullptr;
+                putBatch(n, n, 1, c);
+            }
+
+            // Moves up to n nodes to list l, which must be empty.
+            void getBatch(FreeList& l, size_t c, size_t n) {
+                CentralClass& cc = classes[c];
+                std::lock_guard<json::utility::mutex> lock(cc.mutex);
+                if (cc.head == nullptr) {
+                    carveSlab(cc, c);
+                }
+                Node* first = cc.head;
+                Node* last = first;
+                size_t count = 1;
+                while (count < n and last->next) {
+                    last = last->next;
+                    ++count;
+                }
+                cc.head = last->next;
+                cc.count -= count;
+                last->next = nullptr;
+                l.head = first;
+                l.count = count;
+            }
+
+            void putBatch(Node* first, Node* last, size_t n, size_t c) {
+                CentralClass& cc = classes[c];
+                std::lock_guard<json::utility::mutex> lock(cc.mutex);
+                last->next = cc.head;
+                cc.head = first;
+                cc.count += n;
+            }
+
+            static void carveSlab(CentralClass& cc, size_t c) {
+                char* slab = static_cast<char*>(::malloc(kSlabSize));
+                if (slab == nullptr) {
+                    throw std::bad_alloc();
+                }
+                cc.slabs.push_back(slab);
+                const size_t size = classSize(c);
+                const size_t n = kSlabSize / size;
+                Node* head = cc.head;
+                for (size_t i = n; i > 0; --i) {
+                    Node* node = reinterpret_cast<Node*>(slab + (i - 1) * size);
+                    node->next = head;
+                    head = node;
+                }
+                cc.head = head;
+                cc.count += n;
+            }
+        };
+
+        // The central free lists are never destroyed, since threads may
+        // return their caches after static objects have been destroyed.
+        static Central& central() {
+            static Central* c = new Central();
+            return *c;
+        }
+
+#if !defined (JSON_NO_THREAD_LOCAL)
+        // The thread cache is trivially destructible, so accessing it requires
+        // no initialization check. An instance of Reaper flushes the cache
+        // when the thread exits and marks it Dead, after which the thread
+        // uses the central free lists.
+        struct ThreadCache {
+            enum State { Uninitialized = 0, Active, Dead };
+            FreeList    lists[kNumClasses];
+            int         state;
+        };
+
+        struct Reaper {
+            ~Reaper() {
+                ThreadCache& tc = threadCache();
+                flush(tc);
+                tc.state = ThreadCache::Dead;
+            }
+        };
+
+        static ThreadCache& threadCache() {
+            static thread_local ThreadCache tc;
+            return tc;
+        }
+
+        static bool activate(ThreadCache& tc) {
+            if (tc.state == ThreadCache::Uninitialized) {
+                static thread_local Reaper reaper;
+                (void)reaper;
+                tc.state = ThreadCache::Active;
+            }
+            return tc.state == ThreadCache::Active;
+        }
+
+        static void* allocateSlow(ThreadCache& tc, size_t c) {
+            if (not activate(tc)) {
+                return central().get(c);
+            }
+            FreeList& l = tc.lists[c];
+            if (l.head == nullptr) {
+                central().getBatch(l, c, batchSize(c));
+            }
+            Node* n = l.head;
+            l.head = n->next;
+            --l.count;
+            return n;
+        }
+
+        static void deallocateSlow(ThreadCache& tc, void* p, size_t c) {
+            if (activate(tc)) {
+                deallocate(p, classSize(c));
+            }
+            else {
+                central().put(p, c);
+            }
+        }
+
+        // Returns batchSize(c) nodes of list l to the central free list.
+        static void releaseBatch(FreeList& l, size_t c) {
+            const size_t n = batchSize(c);
+            Node* first = l.head;
+            Node* last = first;
+            for (size_t i = 1; i < n; ++i) {
+                last = last->next;
+            }
+            l.head = last->next;
+            l.count -= n;
+            central().putBatch(first, last, n, c);
+        }
+
+        static void flush(ThreadCache& tc) {
+            for (size_t c = 0; c < kNumClasses; ++c) {
+                FreeList& l = tc.lists[c];
+                if (l.head) {
+                    Node* last = l.head;
+                    while (last->next) {
+                        last = last->next;
+                    }
+                    central().putBatch(l.head, last, l.count, c);
+                    l.head = nullptr;
+                    l.count = 0;
+                }
+            }
+        }
+#endif
+    };
+
+
+    //
+    //  pool_allocator<T>
+    //
+    //  A stateless allocator which allocates from the SlabPool. All instances
+    //  compare equal, so memory may be deallocated by any thread. Since it is
+    //  an empty class, json::value and value_generator do not wrap it into a
+    //  scoped_allocator_adaptor:
+    //
+    //      typedef json::utility::pool_allocator<void> allocator_t;
+    //      typedef json::value<allocator_t> Value;
+    //      typedef json::value_generator<UTF_8_encoding_tag, allocator_t> SemanticActions;
+    //
+    template <typename T>
+    class pool_allocator
+    {
+    public:
+        typedef T value_type;
+
+        template <typename U> struct rebind
+        {
+            typedef pool_allocator<U> other;
+        };
+
+        pool_allocator() noexcept {}
+
+        template <typename U>
+        pool_allocator(const pool_allocator<U>&) noexcept {}
+
+        T* allocate(std::size_t n) {
+            return static_cast<T*>(SlabPool::allocate(n * sizeof(T)));
+        }
+
+        void deallocate(T* p, std::size_t n) noexcept {
+            SlabPool::deallocate(p, n * sizeof(T));
+        }
+    };
+
+    template <typename T1, typename T2>
+    inline bool
+    operator==(const pool_allocator<T1>&, const pool_allocator<T2>&) noexcept {
+        return true;
+    }
+
+    template <typename T1, typename T2>
+    inline bool
+    operator!=(const pool_allocator<T1>&, const pool_allocator<T2>&) noexcept {
+        return false;
+    }
+
+
+}}  // namespace json::utility
+
+
+#endif  // JSON_UTILITY_POOL_ALLOCATOR_HPP
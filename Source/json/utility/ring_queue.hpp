@@ -0,0 +1,237 @@
+//
+//  ring_queue.hpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#ifndef JSON_UTILITY_RING_QUEUE_HPP
+#define JSON_UTILITY_RING_QUEUE_HPP
+
+
+#include "json/config.hpp"
+#include "semaphore.hpp"
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <thread>
+#include <type_traits>
+#include <cstddef>
+#include <cassert>
+
+
+namespace json { namespace utility {
+
+
+    //
+    //  ring_queue
+    //
+    //  A bounded FIFO queue for a single consumer and a single producer or -
+    //  if MultipleProducers is true - multiple producers.
+    //
+    //  Unlike synchronous_queue, which has no capacity, a ring_queue lets
+    //  producers put up to capacity() items ahead of the consumer. A producer
+    //  which reads the input from the network for example, can keep a number
+    //  of buffers ready for the parser, so that neither stalls when the other
+    //  one is slow for a moment.
+    //
+    //  The ring is lock-free: a producer claims a slot by incrementing the
+    //  tail, stores the item and publishes the slot by setting its sequence
+    //  number. The consumer takes the items in order. Two counting semaphores
+    //  count the free slots and the items, so threads only block when the
+    //  queue is full or empty, respectively.
+    //
+    //  The interface follows synchronous_queue:
+    //
+    //  q.put(v)                    Waits until there is a free slot.
+    //  result_type r = q.put(v, timeout)
+    //  bool b = q.try_put(v)
+    //  T v = q.get()               Waits until there is an item.
+    //  std::pair<result_type, T> r = q.get(timeout)
+    //  bool b = q.try_get(v)
+    //
+    //  A timeout is given in seconds. A timeout of zero polls, a negative
+    //  timeout waits forever.
+    //
+
+    template <typename T, bool MultipleProducers = false>
+    class ring_queue {
+    public:
+
+        typedef T value_type;
+
+        enum result_type {
+            OK = 0,
+            TIMEOUT_NOT_DELIVERED = -1,
+            TIMEOUT_NOTHING_OFFERED = -3
+        };
+
+
+        // noncopyable
+        ring_queue(const ring_queue&) = delete;
+        ring_queue& operator=(const ring_queue&) = delete;
+
+        explicit ring_queue(std::size_t capacity)
+        :   slots_(new slot[capacity]), capacity_(capacity), head_(0), tail_(0),
+            free_(static_cast<long>(capacity)), items_(0)
+        {
+            assert(capacity > 0);
+            for (std::size_t i = 0; i < capacity; ++i) {
+                slots_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        ~ring_queue() {
+            while (items_.try_wait()) {
+                pop();
+            }
+        }
+
+        std::size_t capacity() const { return capacity_; }
+
+        // Returns the number of items in the queue. The result is approximate
+        // while other threads access the queue.
+        std::size_t size() const {
+            const std::size_t tail = tail_.load(std::memory_order_acquire);
+            const std::size_t head = head_.load(std::memory_order_acquire);
+            return tail - head;
+        }
+
+        bool empty() const { return size() == 0; }
+
+
+        void put(const T& v) {
+            free_.wait();
+            push(v);
+        }
+
+        void put(T&& v) {
+            free_.wait();
+            push(std::move(v));
+        }
+
+        result_type put(const T& v, double timeout) {
+            if (not free_.wait(timeout)) {
+                return TIMEOUT_NOT_DELIVERED;
+            }
+            push(v);
+            return OK;
+        }
+
+        result_type put(T&& v, double timeout) {
+            if (not free_.wait(timeout)) {
+                return TIMEOUT_NOT_DELIVERED;
+            }
+            push(std::move(v));
+            return OK;
+        }
+
+        bool try_put(const T& v) {
+            return put(v, 0) == OK;
+        }
+
+        bool try_put(T&& v) {
+            return put(std::move(v), 0) == OK;
+        }
+
+
+        T get() {
+            items_.wait();
+            return pop();
+        }
+
+        std::pair<result_type, T> get(double timeout) {
+            if (not items_.wait(timeout)) {
+                return std::pair<result_type, T>(TIMEOUT_NOTHING_OFFERED, T());
+            }
+            return std::pair<result_type, T>(OK, pop());
+        }
+
+        bool try_get(T& v) {
+            if (not items_.wait(0)) {
+                return false;
+            }
+            v = pop();
+            return true;
+        }
+
+
+    private:
+        struct slot {
+            // Equals the position of the slot for the producer which may
+            // store an item, and the position plus one for the consumer.
+            std::atomic<std::size_t> sequence;
+            typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type storage;
+
+            T* value() { return reinterpret_cast<T*>(&storage); }
+        };
+
+        // Requires a free slot.
+        template <typename U>
+        void push(U&& v) {
+            std::size_t pos;
+            if (MultipleProducers) {
+                pos = tail_.fetch_add(1, std::memory_order_relaxed);
+            }
+            else {
+                pos = tail_.load(std::memory_order_relaxed);
+                tail_.store(pos + 1, std::memory_order_relaxed);
+            }
+            slot& s = slots_[pos % capacity_];
+            // The permit taken from free_ may have been granted by a pop()
+            // of another slot, while the consumer has not yet released this
+            // one:
+            while (s.sequence.load(std::memory_order_acquire) != pos) {
+                std::this_thread::yield();
+            }
+            new (s.value()) T(std::forward<U>(v));
+            s.sequence.store(pos + 1, std::memory_order_release);
+            items_.signal();
+        }
+
+        // Requires an item.
+        T pop() {
+            const std::size_t pos = head_.load(std::memory_order_relaxed);
+            slot& s = slots_[pos % capacity_];
+            // With multiple producers, the producer which claimed this slot
+            // may not have published it yet, while a later one has:
+            while (s.sequence.load(std::memory_order_acquire) != pos + 1) {
+                std::this_thread::yield();
+            }
+            T result = std::move(*s.value());
+            s.value()->~T();
+            s.sequence.store(pos + capacity_, std::memory_order_release);
+            head_.store(pos + 1, std::memory_order_release);
+            free_.signal();
+            return result;
+        }
+
+    private:
+        std::unique_ptr<slot[]>     slots_;
+        const std::size_t           capacity_;
+        char                        pad0_[64];
+        std::atomic<std::size_t>    head_;
+        char                        pad1_[64];
+        std::atomic<std::size_t>    tail_;
+        char                        pad2_[64];
+        semaphore                   free_;
+        semaphore                   items_;
+    };
+
+
+}}  // namespace json::utility
+
+
+#endif // JSON_UTILITY_RING_QUEUE_HPP
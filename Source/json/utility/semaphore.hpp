@@ -0,0 +1,154 @@
+//
+//  semaphore.hpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#ifndef JSON_UTILITY_SEMAPHORE_HPP
+#define JSON_UTILITY_SEMAPHORE_HPP
+
+
+#include "json/config.hpp"
+#include "futex.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cassert>
+
+
+namespace json { namespace utility {
+
+
+    //
+    //  semaphore
+    //
+    //  A counting semaphore, and a portable drop-in replacement for
+    //  json::objc::gcd::semaphore:
+    //
+    //  signal()        increments the count and resumes a waiting thread.
+    //  wait()          waits until the count is greater than zero, then
+    //                  decrements it. Returns true.
+    //  wait(timeout)   as wait(), but returns false if the count did not
+    //                  become greater than zero within timeout seconds. A
+    //                  timeout of zero polls, a negative timeout waits forever
+    //                  (see wait_forever()).
+    //
+    //  A waiting thread spins adaptively before it blocks, which shortens the
+    //  latency of handing off a buffer to a thread which is about to wait.
+    //
+    //  When destroyed, the semaphore resumes the threads still waiting, like
+    //  its GCD counterpart.
+    //
+    class semaphore {
+    public:
+        typedef double      duration_type;
+
+
+        static duration_type wait_forever() { return -1.0; }
+
+        semaphore(const semaphore&) = delete;
+        semaphore& operator=(const semaphore&) = delete;
+
+        explicit semaphore(long n) : count_(static_cast<int>(n)), waiters_(0) {
+            assert(n >= 0);
+        }
+
+        ~semaphore() {
+            while (waiters_.load() > 0) {
+                count_.value().fetch_add(1);
+                count_.wake_all();
+                std::this_thread::yield();
+            }
+        }
+
+        void signal()  {
+            count_.value().fetch_add(1);
+            if (waiters_.load() > 0) {
+                count_.wake_one();
+            }
+        }
+
+        bool wait()  {
+            if (try_wait()) {
+                return true;
+            }
+            return wait_slow(nullptr);
+        }
+
+        bool wait(semaphore::duration_type timeout_sec)  {
+            if (timeout_sec < 0) {
+                return wait();
+            }
+            if (try_wait()) {
+                return true;
+            }
+            if (timeout_sec == 0) {
+                return false;
+            }
+            const futex::time_point deadline = futex::clock_type::now()
+                + std::chrono::duration_cast<futex::clock_type::duration>(std::chrono::duration<double>(timeout_sec));
+            return wait_slow(&deadline);
+        }
+
+        // Decrements the count if it is greater than zero, without waiting.
+        bool try_wait() {
+            int count = count_.value().load(std::memory_order_relaxed);
+            while (count > 0) {
+                if (count_.value().compare_exchange_weak(count, count - 1,
+                                                         std::memory_order_acquire,
+                                                         std::memory_order_relaxed))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        bool wait_slow(const futex::time_point* deadline) {
+            if (spinner_.spin([this]() { return try_wait(); })) {
+                return true;
+            }
+            // A signal() which does not see this waiter has incremented the
+            // count before, and the futex does not block on a count other
+            // than zero:
+            waiters_.fetch_add(1);
+            bool result = true;
+            while (not try_wait()) {
+                if (deadline == nullptr) {
+                    count_.wait(0);
+                }
+                else if (not count_.wait_until(0, *deadline)) {
+                    result = try_wait();
+                    break;
+                }
+            }
+            // This shall be the last access, see the destructor.
+            waiters_.fetch_sub(1);
+            return result;
+        }
+
+    private:
+        futex               count_;
+        std::atomic<int>    waiters_;
+        adaptive_spinner    spinner_;
+    };
+
+
+}}  // namespace json::utility
+
+
+#endif  // JSON_UTILITY_SEMAPHORE_HPP
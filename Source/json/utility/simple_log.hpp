@@ -27,8 +27,12 @@
 #include <cstdarg>
 #include <ctime>
 #include <string>
+#include <mutex>
 #include <type_traits>
 
+#include <cstring>
+#include <stdlib.h>
+
 #include <sys/types.h>
 #include <unistd.h>
 
@@ -37,13 +41,15 @@
 #include <pthread.h>
 #include <mach-o/dyld.h>
 #include <sys/param.h>
-#include <stdlib.h>
-#include <cstring>
+#elif defined (__linux__)
+#include <sys/syscall.h>
+#include <limits.h>
 #else
-#error no platform support
+#include <thread>
+#include <functional>
 #endif
 
-#if TARGET_OS_IPHONE or TARGET_IPHONE_SIMULATOR
+#if defined (__APPLE_CC__) and (TARGET_OS_IPHONE or TARGET_IPHONE_SIMULATOR)
 #include <CoreFoundation/CoreFoundation.h>
 #endif
 
@@ -60,53 +66,86 @@ namespace json { namespace utility {
             return (int)s_process_id;        
         }
         
-        // requires __DARWIN__
+        inline int currentThreadID() {
+#if defined (__APPLE_CC__)
+            return static_cast<int>(pthread_mach_thread_np(pthread_self()));
+#elif defined (__linux__)
+            return static_cast<int>(::syscall(SYS_gettid));
+#else
+            return static_cast<int>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+#endif
+        }
+        
+        // Returns the ID of the calling thread.
         inline int threadID() {
-            static mach_port_t s_thread_id = 0;
+#if !defined (JSON_NO_THREAD_LOCAL)
+            static thread_local int s_thread_id = 0;
             if (s_thread_id == 0) {
-                s_thread_id = pthread_mach_thread_np(pthread_self());
+                s_thread_id = currentThreadID();
             }
             return s_thread_id;
+#else
+            return currentThreadID();
+#endif
         }
         
-        // requires __DARWIN__
+        // Returns the name of the executable. The name is determined once
+        // and stored in a buffer which is never destroyed, so that it can 
+        // still be used by functions registered with atexit().
         inline const char* executableName() {
-            static std::string s_exec_name;
-#if TARGET_OS_IPHONE or TARGET_IPHONE_SIMULATOR
-        // TODO: implement for iOS
-            if (s_exec_name.empty()) {
+            static std::once_flag s_once;
+            static char s_exec_name[256];
+            std::call_once(s_once, [] {
+                std::string name;
+#if not defined (__APPLE_CC__)
+#if defined (__linux__)
+                char path[PATH_MAX];
+                ssize_t n = readlink("/proc/self/exe", path, sizeof(path) - 1);
+                if (n > 0) {
+                    path[n] = 0;
+                    const char* lastComponent = strrchr(path, '/');
+                    name = lastComponent ? lastComponent + 1 : path;
+                }
+#endif
+#elif TARGET_OS_IPHONE or TARGET_IPHONE_SIMULATOR
+                // TODO: implement for iOS
                 char buffer[256];
                 *buffer = 0;
                 CFBundleRef mainBundle = CFBundleGetMainBundle();
                 if (mainBundle) {
-                    CFStringRef name = (CFStringRef)CFBundleGetValueForInfoDictionaryKey(mainBundle, kCFBundleExecutableKey);
-                    if (name) {
-                        if (!CFStringGetCString(name, buffer, sizeof(buffer), kCFStringEncodingUTF8)) {
+                    CFStringRef cfname = (CFStringRef)CFBundleGetValueForInfoDictionaryKey(mainBundle, kCFBundleExecutableKey);
+                    if (cfname) {
+                        if (!CFStringGetCString(cfname, buffer, sizeof(buffer), kCFStringEncodingUTF8)) {
                             *buffer = 0;
                         }
                     }
                 }
-                s_exec_name = *buffer ? buffer : "<Appname>";
-            }
+                name = buffer;
 #else                        
-            if (s_exec_name.empty()) {
                 uint32_t bufsize = 0;
                 _NSGetExecutablePath(NULL, &bufsize);
                 char* path = (char*)malloc(static_cast<size_t>(bufsize));
                 _NSGetExecutablePath(path, &bufsize);                
                 char* real_path = realpath(path, NULL);
                 free(path);
-                char* lastComponent = strrchr(real_path, '/');
-                if (!lastComponent) {
-                    lastComponent = real_path;
-                } else {
-                    ++lastComponent;
+                if (real_path) {
+                    char* lastComponent = strrchr(real_path, '/');
+                    if (!lastComponent) {
+                        lastComponent = real_path;
+                    } else {
+                        ++lastComponent;
+                    }
+                    name = lastComponent;
+                    free(real_path);
                 }
-                s_exec_name = lastComponent;
-                free(real_path);
-            }
 #endif            
-            return s_exec_name.c_str();
+                if (name.empty()) {
+                    name = "<Appname>";
+                }
+                strncpy(s_exec_name, name.c_str(), sizeof(s_exec_name) - 1);
+                s_exec_name[sizeof(s_exec_name) - 1] = 0;
+            });
+            return s_exec_name;
         }
         
                 
@@ -199,25 +238,27 @@ namespace json { namespace utility {
                 char time_str[80];
                 time_t t;
                 std::time(&t);
-                struct tm* timeInfo;
-                timeInfo = localtime(&t);
-                strftime(time_str, sizeof(time_str), "%Y-%m-%d %X", timeInfo);
+                struct tm timeInfo;
+                localtime_r(&t, &timeInfo);
+                strftime(time_str, sizeof(time_str), "%Y-%m-%d %X", &timeInfo);
                 fprintf(fstream, "%s %s [%x:%x]: ", 
                         time_str, executableName(), processID(), threadID());
                 vfprintf(fstream, format, args);
-                if (format[strlen(format)] != '\n')
+                const size_t len = strlen(format);
+                if (len == 0 or format[len - 1] != '\n')
                     fprintf(fstream, "\n");
             }
             static void flog(FILE* fstream, const char* s) {
                 char time_str[80];
                 time_t t;
                 std::time(&t);
-                struct tm* timeInfo;
-                timeInfo = localtime(&t);
-                strftime(time_str, sizeof(time_str), "%Y-%m-%d %X", timeInfo);
+                struct tm timeInfo;
+                localtime_r(&t, &timeInfo);
+                strftime(time_str, sizeof(time_str), "%Y-%m-%d %X", &timeInfo);
                 fprintf(fstream, "%s %s [%x:%x]: %s", 
                         time_str, executableName(), processID(), threadID(), s);
-                if (s[strlen(s)] != '\n')
+                const size_t len = strlen(s);
+                if (len == 0 or s[len - 1] != '\n')
                     fprintf(fstream, "\n");
             }
         };
@@ -23,37 +23,154 @@
 
 
 #include "json/config.hpp"
-#include <boost/functional/hash.hpp>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 
 
 namespace json { namespace utility {
-    
-    //    
+
+
+    namespace string_hasher_detail {
+
+        // The hash function follows wyhash: it reads the input 16 bytes at a
+        // time (48 bytes in three independent lanes for long input), and
+        // reads inputs of up to 16 bytes with overlapping loads, so there is
+        // no loop over the tail bytes. The mixing step is a 64x64 -> 128 bit
+        // multiplication folded to 64 bits.
+        //
+        // Hash values depend on the byte order of the host, thus they shall
+        // not be stored or transmitted.
+
+        static const uint64_t secret[4] = {
+            UINT64_C(0x2d358dccaa6c78a5), UINT64_C(0x8bb84b93962eacc9),
+            UINT64_C(0x4b33a62ed433d4a3), UINT64_C(0x4d5a2da51de1aa47)
+        };
+
+        inline void mum(uint64_t& a, uint64_t& b) {
+#if defined (__SIZEOF_INT128__)
+            __uint128_t r = a;
+            r *= b;
+            a = static_cast<uint64_t>(r);
+            b = static_cast<uint64_t>(r >> 64);
+#else
+            const uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+            const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+            const uint64_t t = rl + (rm0 << 32);
+            uint64_t c = t < rl;
+            const uint64_t lo = t + (rm1 << 32);
+            c += lo < t;
+            const uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+            a = lo;
+            b = hi;
+#endif
+        }
+
+        inline uint64_t mix(uint64_t a, uint64_t b) {
+            mum(a, b);
+            return a ^ b;
+        }
+
+        inline uint64_t read8(const unsigned char* p) {
+            uint64_t v;
+            std::memcpy(&v, p, 8);
+            return v;
+        }
+
+        inline uint64_t read4(const unsigned char* p) {
+            uint32_t v;
+            std::memcpy(&v, p, 4);
+            return v;
+        }
+
+        // Reads 1 to 3 bytes.
+        inline uint64_t read3(const unsigned char* p, std::size_t k) {
+            return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+        }
+
+        inline uint64_t hash_bytes(const void* key, std::size_t len, uint64_t seed)
+        {
+            const unsigned char* p = static_cast<const unsigned char*>(key);
+            seed ^= mix(seed ^ secret[0], secret[1]);
+            uint64_t a, b;
+            if (len <= 16) {
+                if (len >= 4) {
+                    a = (read4(p) << 32) | read4(p + ((len >> 3) << 2));
+                    b = (read4(p + len - 4) << 32) | read4(p + len - 4 - ((len >> 3) << 2));
+                }
+                else if (len > 0) {
+                    a = read3(p, len);
+                    b = 0;
+                }
+                else {
+                    a = b = 0;
+                }
+            }
+            else {
+                std::size_t i = len;
+                if (i >= 48) {
+                    uint64_t see1 = seed, see2 = seed;
+                    do {
+                        seed = mix(read8(p) ^ secret[1], read8(p + 8) ^ seed);
+                        see1 = mix(read8(p + 16) ^ secret[2], read8(p + 24) ^ see1);
+                        see2 = mix(read8(p + 32) ^ secret[3], read8(p + 40) ^ see2);
+                        p += 48;
+                        i -= 48;
+                    } while (i >= 48);
+                    seed ^= see1 ^ see2;
+                }
+                while (i > 16) {
+                    seed = mix(read8(p) ^ secret[1], read8(p + 8) ^ seed);
+                    i -= 16;
+                    p += 16;
+                }
+                a = read8(p + i - 16);
+                b = read8(p + i - 8);
+            }
+            a ^= secret[1];
+            b ^= seed;
+            mum(a, b);
+            return mix(a ^ secret[0] ^ len, b ^ secret[1]);
+        }
+
+    }
+
+
+    //
     // Hash function for CharT arrays
     //
+    // The hash value of a zero terminated string equals the hash value of the
+    // same characters given as (first, len). A seed other than the default
+    // may be used to make the hash values of a table unpredictable, which
+    // protects it against hash flooding by crafted input.
+    //
     static const std::size_t SEED = 0;
-    
+
     template <typename CharT>
     struct string_hasher
     {
-        
+        explicit string_hasher(std::size_t seed = SEED) : seed_(seed) {}
+
         // str must be zero terminated
         std::size_t operator()(const CharT* str) const
-        {  
-            std::size_t seed = SEED;
-            for(; *str; ++str)   boost::hash_combine(seed, *str);
-            return seed;
+        {
+            return (*this)(str, std::char_traits<CharT>::length(str));
         }
         std::size_t operator()(const CharT* first, std::size_t len) const
-        {  
-            std::size_t seed = SEED;
-            for(; len; --len, ++first)   boost::hash_combine(seed, *first);
-            return seed;
-        }
-    };   
-    
-    
+        {
+            return static_cast<std::size_t>(
+                string_hasher_detail::hash_bytes(first, len * sizeof(CharT), seed_));
+        }
+
+        std::size_t seed() const { return seed_; }
+
+    private:
+        std::size_t seed_;
+    };
+
+
 }}  // namespace json::internal
 
 
-#endif // JSON_UTILITY_STRING_HASHER_HPP
\ No newline at end of file
+#endif // JSON_UTILITY_STRING_HASHER_HPP
@@ -25,20 +25,14 @@
 #include "json/config.hpp"
 #include <utility>
 #include <iostream>
-#include <semaphore.h>
+#include <cassert>
 
-#include "json/objc/mutex.hpp"
-#include "json/objc/semaphore.hpp"
-
-
-// TODO: remove json/objc/* dependencies
+#include "mutex.hpp"
+#include "semaphore.hpp"
 
 
 namespace json { namespace utility {
     
-    using json::objc::gcd::mutex;
-    using json::objc::gcd::semaphore;
-    
     
     //
     //  synchronous_queue   
@@ -24,6 +24,7 @@
 
 #include "json/config.hpp"
 #include "synchronous_queue.hpp"
+#include "ring_queue.hpp"
 #include <streambuf>
 #include <ios>
 #include <utility>
@@ -39,8 +40,13 @@ namespace json { namespace utility {
     // for use in conjunction with a synchrounous queue, whose value_type
     // models the buffer type concept. The buffer's value_type shall be a
     // char type.
+    //
+    // QueueT may be any queue with the get(timeout) member function of
+    // synchronous_queue, in particular a ring_queue (see also
+    // basic_ring_queue_streambuf below).
 
-    template <typename BufferT, typename CharT, typename TraitsT = std::char_traits<CharT> >
+    template <typename BufferT, typename CharT, typename TraitsT = std::char_traits<CharT>,
+              typename QueueT = synchronous_queue<BufferT> >
     class basic_syncqueue_streambuf : public std::basic_streambuf<CharT, TraitsT>
     {
         static_assert(sizeof(typename BufferT::value_type) == 1, "" );
@@ -52,7 +58,7 @@ namespace json { namespace utility {
         typedef typename base_type::off_type            off_type;
         typedef CharT                                   char_type;
         
-        typedef synchronous_queue<BufferT>              queue_type;
+        typedef QueueT                                  queue_type;
         typedef typename queue_type::value_type         queue_buffer_type;
         typedef typename queue_buffer_type::value_type  qb_char_type;
         
@@ -150,7 +156,7 @@ namespace json { namespace utility {
                 return EOF;  // timeout
             }
             else {
-                buffer_ = r.second;
+                buffer_ = std::move(r.second);
             }
             if (buffer_.data() == NULL or buffer_.size() == 0) {
                 //queue_ptr_->commit();
@@ -213,6 +219,17 @@ namespace json { namespace utility {
     };
 
 
+    //
+    // basic_ring_queue_streambuf
+    //
+    // A basic_syncqueue_streambuf reading from a ring_queue, which lets the
+    // producer put a number of buffers ahead of the reader.
+    //
+    template <typename BufferT, typename CharT, typename TraitsT = std::char_traits<CharT>,
+              bool MultipleProducers = false>
+    using basic_ring_queue_streambuf =
+        basic_syncqueue_streambuf<BufferT, CharT, TraitsT, ring_queue<BufferT, MultipleProducers> >;
+
         
     
 }}
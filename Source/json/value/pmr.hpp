@@ -0,0 +1,54 @@
+//
+//  pmr.hpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef JSON_VALUE_PMR_HPP
+#define JSON_VALUE_PMR_HPP
+
+
+#include "value.hpp"
+#include "json/utility/memory_resource.hpp"
+
+
+//
+//  json::pmr::value
+//
+//  A json::value whose arrays, objects and strings allocate from a memory
+//  resource which is chosen at runtime. Since the allocator is stateful, the
+//  containers use a scoped_allocator_adaptor, and nested values and strings
+//  allocate from the same memory resource as their container.
+//
+//  Example:
+//
+//      json::utility::SysArena arena;
+//      json::pmr::arena_resource<> resource(arena);
+//      json::pmr::value v(json::pmr::value::emplace_object, json::pmr::allocator(&resource));
+//
+//      // Parsing into a pmr::value:
+//      typedef json::value_generator<
+//          json::unicode::UTF_8_encoding_tag,
+//          json::pmr::polymorphic_allocator<void>
+//      > SemanticActions;
+//      SemanticActions sa((json::pmr::allocator(&resource)));
+//
+//  A default constructed value and a default constructed allocator use
+//  json::pmr::get_default_resource().
+//
+
+namespace json { namespace pmr {
+
+    typedef polymorphic_allocator<void>         allocator;
+    typedef json::value<allocator>              value;
+
+    typedef value::array_type                   array;
+    typedef value::object_type                  object;
+    typedef value::string_type                  string;
+    typedef value::key_type                     key_type;
+
+}}  // namespace json::pmr
+
+
+#endif  // JSON_VALUE_PMR_HPP
@@ -0,0 +1,190 @@
+//
+//  buffered_writer_test.cpp
+//  Test
+//
+//  Created by agent on 10/18/26.
+//
+//
+
+#include "json/value/value.hpp"
+#include "json/generator/write_value.hpp"
+#include "json/generator/buffered_writer.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <iterator>
+#include <unistd.h>
+
+
+using namespace json;
+
+
+namespace {
+
+    typedef json::value<>   Value;
+    typedef Value::string_type String;
+    typedef Value::object_type Object;
+    typedef Value::array_type  Array;
+
+
+    Value make_sample()
+    {
+        Object o;
+        o.emplace("id", 0);
+        o.emplace("key2", "string 2");
+        o.emplace("key3", "quote \" and backslash \\ and a/solidus");
+        o.emplace("key4", "\xC3\xA4\xC3\xB6\xC3\xBC \xE2\x82\xAC");
+        o.emplace("key5", 1.5);
+        o.emplace("key6", true);
+        o.emplace("key7", json::null);
+
+        Array a;
+        for (int i = 0; i < 100; ++i) {
+            o["id"] = i;
+            a.emplace_back(o);
+        }
+        a.emplace_back(Array());
+        a.emplace_back(Object());
+        return Value(std::move(a));
+    }
+
+
+    class BufferedWriterTest : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        BufferedWriterTest() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~BufferedWriterTest() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+
+    TEST_F(BufferedWriterTest, MatchesWriteValue)
+    {
+        const Value v = make_sample();
+        const unsigned int flags[] = {0, writer_base::pretty_print, writer_base::escape_solidus};
+
+        for (unsigned int f : flags) {
+            std::string expected;
+            json::write_value(v, std::back_inserter(expected), f);
+
+            std::string s;
+            json::string_sink sink(s);
+            json::write_buffered(v, sink, f);
+            EXPECT_EQ(expected, s);
+        }
+    }
+
+
+    TEST_F(BufferedWriterTest, SmallBuffer)
+    {
+        // The smallest possible buffer, which is smaller than most of the
+        // serialized objects.
+        const Value v = make_sample();
+        std::string expected;
+        json::write_value(v, std::back_inserter(expected), writer_base::pretty_print);
+
+        std::vector<char> out;
+        json::vector_sink sink(out);
+        json::buffered_writer<Value, json::vector_sink> w(sink, writer_base::pretty_print, json::output_buffer<char, json::vector_sink>::min_capacity);
+        w.write(v);
+        w.flush();
+        EXPECT_EQ(expected, std::string(out.begin(), out.end()));
+    }
+
+
+    TEST_F(BufferedWriterTest, CallbackSink)
+    {
+        const Value v = make_sample();
+        std::string expected;
+        json::write_value(v, std::back_inserter(expected));
+
+        std::string s;
+        size_t calls = 0;
+        json::callback_sink sink([&](const char* p, std::size_t n) {
+            ++calls;
+            s.append(p, n);
+        });
+        json::buffered_writer<Value, json::callback_sink> w(sink, 0, 256);
+        w.write(v);
+        EXPECT_TRUE(s.size() < expected.size());
+        w.flush();
+        EXPECT_EQ(expected, s);
+        EXPECT_LT(1, calls);
+    }
+
+
+    TEST_F(BufferedWriterTest, FileDescriptorSink)
+    {
+        const Value v = make_sample();
+        std::string expected;
+        json::write_value(v, std::back_inserter(expected));
+
+        char path[] = "/tmp/buffered_writer_test_XXXXXX";
+        int fd = mkstemp(path);
+        ASSERT_TRUE(fd >= 0);
+        unlink(path);
+
+        json::fd_sink sink(fd);
+        json::write_buffered(v, sink);
+
+        std::string s(expected.size(), '\0');
+        ASSERT_EQ(off_t(0), lseek(fd, 0, SEEK_SET));
+        ssize_t n = read(fd, &s[0], s.size());
+        close(fd);
+        EXPECT_EQ(ssize_t(expected.size()), n);
+        EXPECT_EQ(expected, s);
+    }
+
+
+    TEST_F(BufferedWriterTest, EscapeControlCharacters)
+    {
+        const Value v = Value(Array{Value(String("a\x01" "b\x1F" "c\n"))});
+        std::string s;
+        json::string_sink sink(s);
+        json::write_buffered(v, sink);
+        EXPECT_EQ(std::string("[\"a\\u0001b\\u001Fc\\n\"]"), s);
+    }
+
+
+    TEST_F(BufferedWriterTest, EscapedUnicodeOutput)
+    {
+        // Like write_value(), only string values are written as escaped
+        // Unicode, keys are written in UTF-8:
+        Object o;
+        o.emplace("\xC3\xA4", "\xE2\x82\xAC");
+        const Value v = Value(Array{Value(o), make_sample()});
+
+        std::string expected;
+        json::write_value(v, std::back_inserter(expected), 0, json::unicode::escaped_unicode_encoding);
+        EXPECT_EQ("[{\"\xC3\xA4\":\"\\u20AC\"}", expected.substr(0, 16));
+
+        std::string s;
+        json::string_sink sink(s);
+        json::write_buffered(v, sink, 0, json::unicode::escaped_unicode_encoding);
+        EXPECT_EQ(expected, s);
+    }
+
+}
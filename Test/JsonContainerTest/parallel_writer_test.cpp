@@ -0,0 +1,220 @@
+//
+//  parallel_writer_test.cpp
+//  Test
+//
+//  Created by agent on 10/18/26.
+//
+//
+
+#include "json/value/value.hpp"
+#include "json/generator/write_value.hpp"
+#include "json/generator/parallel_writer.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <iterator>
+#include <stdexcept>
+#include <unistd.h>
+
+
+using namespace json;
+
+
+namespace {
+
+    typedef json::value<>   Value;
+    typedef Value::string_type String;
+    typedef Value::object_type Object;
+    typedef Value::array_type  Array;
+
+
+    Object make_object(int i)
+    {
+        Object o;
+        o.emplace("id", i);
+        o.emplace("name", "quote \" and backslash \\ and a/solidus");
+        o.emplace("text", "\xC3\xA4\xC3\xB6\xC3\xBC \xE2\x82\xAC");
+        o.emplace("value", 1.5);
+        o.emplace("flags", Array{Value(true), Value(json::null)});
+        return o;
+    }
+
+    // A document with a large array, a large object and small containers
+    // at different levels.
+    Value make_document()
+    {
+        Array large_array;
+        for (int i = 0; i < 1000; ++i) {
+            large_array.emplace_back(make_object(i));
+        }
+        Object large_object;
+        for (int i = 0; i < 500; ++i) {
+            large_object.emplace("key" + std::to_string(i), Array{Value(i), Value("x")});
+        }
+        Object doc;
+        doc.emplace("items", std::move(large_array));
+        doc.emplace("index", std::move(large_object));
+        doc.emplace("empty_array", Array());
+        doc.emplace("empty_object", Object());
+        doc.emplace("small", make_object(-1));
+        doc.emplace("count", 1000);
+        return Value(Array{Value(std::move(doc)), Value("trailer")});
+    }
+
+
+    class ParallelWriterTest : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        ParallelWriterTest() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~ParallelWriterTest() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+
+    TEST_F(ParallelWriterTest, MatchesWriteValue)
+    {
+        const Value v = make_document();
+        const unsigned int flags[] = {0, writer_base::pretty_print, writer_base::escape_solidus};
+        const std::size_t ranges[] = {1, 7, 256, 100000};
+
+        for (unsigned int f : flags) {
+            std::string expected;
+            json::write_value(v, std::back_inserter(expected), f);
+            for (std::size_t r : ranges) {
+                parallel_write_options options;
+                options.threads = 4;
+                options.min_range = r;
+                std::string s;
+                json::string_sink sink(s);
+                json::write_parallel(v, sink, f, json::unicode::UTF_8_encoding, options);
+                EXPECT_EQ(expected, s) << "flags: " << f << " min_range: " << r;
+            }
+        }
+    }
+
+
+    TEST_F(ParallelWriterTest, Scalars)
+    {
+        const Value values[] = {Value(1), Value("abc"), Value(json::null), Value(Array()), Value(Object())};
+        for (const Value& v : values) {
+            std::string expected;
+            json::write_value(v, std::back_inserter(expected));
+            std::string s;
+            json::string_sink sink(s);
+            json::write_parallel(v, sink);
+            EXPECT_EQ(expected, s);
+        }
+    }
+
+
+    TEST_F(ParallelWriterTest, EscapedUnicode)
+    {
+        const Value v = make_document();
+        std::string expected;
+        json::write_value(v, std::back_inserter(expected), writer_base::pretty_print, json::unicode::escaped_unicode_encoding);
+
+        parallel_write_options options;
+        options.threads = 3;
+        options.min_range = 10;
+        std::string s;
+        json::string_sink sink(s);
+        json::write_parallel(v, sink, writer_base::pretty_print, json::unicode::escaped_unicode_encoding, options);
+        EXPECT_EQ(expected, s);
+    }
+
+
+    TEST_F(ParallelWriterTest, VectoredOutput)
+    {
+        const Value v = make_document();
+        std::string expected;
+        json::write_value(v, std::back_inserter(expected), writer_base::pretty_print);
+
+        char path[] = "/tmp/parallel_writer_test_XXXXXX";
+        int fd = mkstemp(path);
+        ASSERT_TRUE(fd >= 0);
+        unlink(path);
+
+        parallel_write_options options;
+        options.threads = 4;
+        options.min_range = 5;
+        json::fd_sink sink(fd);
+        json::write_parallel(v, sink, writer_base::pretty_print, json::unicode::UTF_8_encoding, options);
+
+        std::string s(expected.size(), '\0');
+        ASSERT_EQ(off_t(0), lseek(fd, 0, SEEK_SET));
+        ssize_t n = read(fd, &s[0], s.size());
+        close(fd);
+        EXPECT_EQ(ssize_t(expected.size()), n);
+        EXPECT_EQ(expected, s);
+    }
+
+
+    TEST_F(ParallelWriterTest, SinkError)
+    {
+        const Value v = make_document();
+        parallel_write_options options;
+        options.threads = 4;
+        options.min_range = 5;
+        std::size_t calls = 0;
+        json::callback_sink sink([&](const char*, std::size_t) {
+            if (++calls == 3)
+                throw std::runtime_error("sink error");
+        });
+        EXPECT_THROW(json::write_parallel(v, sink, 0, json::unicode::UTF_8_encoding, options), std::runtime_error);
+    }
+
+
+    TEST_F(ParallelWriterTest, Reuse)
+    {
+        // The worker threads are kept across writes, also after a write failed:
+        const Value v = make_document();
+        std::string expected;
+        json::write_value(v, std::back_inserter(expected));
+
+        parallel_write_options options;
+        options.threads = 4;
+        options.min_range = 5;
+        std::string s;
+        bool fail = false;
+        json::callback_sink sink([&](const char* data, std::size_t size) {
+            if (fail)
+                throw std::runtime_error("sink error");
+            s.append(data, size);
+        });
+        json::parallel_writer<Value, json::callback_sink> w(sink, 0, options);
+        for (int i = 0; i < 5; ++i) {
+            s.clear();
+            fail = i == 2;
+            if (fail) {
+                EXPECT_THROW(w.write(v), std::runtime_error);
+            } else {
+                w.write(v);
+                EXPECT_EQ(expected, s);
+            }
+        }
+    }
+
+}
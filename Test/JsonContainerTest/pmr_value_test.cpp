@@ -0,0 +1,218 @@
+//
+//  pmr_value_test.cpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#include "json/value/pmr.hpp"
+#include "json/parser/parse.hpp"
+#include "json/parser/value_generator.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+namespace {
+
+    using json::utility::SysArena;
+    namespace pmr = json::pmr;
+
+
+    // A memory resource which counts its allocations.
+    class counting_resource : public pmr::memory_resource
+    {
+    public:
+        counting_resource() : allocations(0), deallocations(0) {}
+
+        size_t allocations;
+        size_t deallocations;
+
+    private:
+        virtual void* do_allocate(size_t bytes, size_t alignment) {
+            ++allocations;
+            return pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+        virtual void do_deallocate(void* p, size_t bytes, size_t alignment) {
+            ++deallocations;
+            pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+        virtual bool do_is_equal(const pmr::memory_resource& other) const noexcept {
+            return this == &other;
+        }
+    };
+
+
+    // Builds a document with the given allocator. The type of the result does
+    // not depend on the memory resource.
+    pmr::value make_document(const pmr::allocator& a)
+    {
+        pmr::value v(pmr::value::emplace_object, a);
+        pmr::object& o = v.as<pmr::object>();
+        for (int i = 0; i < 100; ++i) {
+            pmr::value item(pmr::value::emplace_array, a);
+            item.as<pmr::array>().emplace_back(pmr::value::emplace_string, "a string which does not fit into the small buffer");
+            item.as<pmr::array>().emplace_back(i);
+            o.emplace(std::to_string(i).c_str(), std::move(item));
+        }
+        return v;
+    }
+
+
+    class PmrValueTest : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        PmrValueTest() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~PmrValueTest() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+#pragma mark -
+
+    TEST_F(PmrValueTest, PolymorphicAllocator)
+    {
+        counting_resource r1;
+        counting_resource r2;
+        pmr::polymorphic_allocator<int> a1(&r1);
+        pmr::polymorphic_allocator<char> a2(a1);
+        pmr::polymorphic_allocator<int> a3(&r2);
+        EXPECT_TRUE(a1 == a2);
+        EXPECT_TRUE(a1 != a3);
+        EXPECT_EQ(&r1, a2.resource());
+
+        int* p = a1.allocate(10);
+        a1.deallocate(p, 10);
+        EXPECT_EQ(1, r1.allocations);
+        EXPECT_EQ(1, r1.deallocations);
+
+        pmr::polymorphic_allocator<int> a4;
+        EXPECT_EQ(pmr::get_default_resource(), a4.resource());
+
+        pmr::memory_resource* prev = pmr::set_default_resource(&r2);
+        EXPECT_EQ(&r2, pmr::polymorphic_allocator<int>().resource());
+        pmr::set_default_resource(prev);
+        EXPECT_EQ(prev, pmr::get_default_resource());
+
+        // Over-aligned requests:
+        struct alignas(64) over_aligned { char c[64]; };
+        pmr::polymorphic_allocator<over_aligned> a5(&r1);
+        over_aligned* q = a5.allocate(3);
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(q) % 64);
+        a5.deallocate(q, 3);
+    }
+
+
+    TEST_F(PmrValueTest, NestedValuesUseTheResource)
+    {
+        counting_resource r;
+        {
+            pmr::value v = make_document(pmr::allocator(&r));
+            ASSERT_TRUE(v.is_object());
+            EXPECT_EQ(100, v.as<pmr::object>().size());
+            const pmr::array& item = v.as<pmr::object>().at("42").as<pmr::array>();
+            EXPECT_EQ(pmr::string("a string which does not fit into the small buffer"), item[0].as<pmr::string>());
+            EXPECT_TRUE(item.get_allocator() == pmr::allocator(&r));
+            EXPECT_TRUE(item[0].as<pmr::string>().get_allocator() == pmr::allocator(&r));
+            // Map nodes, keys, arrays and strings:
+            EXPECT_LE(400, r.allocations);
+        }
+        EXPECT_EQ(r.allocations, r.deallocations);
+    }
+
+
+    TEST_F(PmrValueTest, ResourceChosenAtRuntime)
+    {
+        SysArena arena;
+        pmr::arena_resource<> arena_resource(arena);
+        pmr::pool_resource pool_resource;
+        pmr::memory_resource* resources[] = {
+            pmr::new_delete_resource(), &arena_resource, &pool_resource
+        };
+
+        for (pmr::memory_resource* r : resources) {
+            pmr::value v = make_document(pmr::allocator(r));
+            EXPECT_TRUE(v.as<pmr::object>().get_allocator().resource() == r);
+            const pmr::value::integral_number_type& n = v.as<pmr::object>().at("99").as<pmr::array>()[1].as<pmr::value::integral_number_type>();
+            EXPECT_EQ(99, static_cast<int>(n));
+        }
+        EXPECT_LT(0, arena.bytesUsed());
+
+        pmr::arena_resource<> other_arena_resource(arena);
+        EXPECT_TRUE(arena_resource.is_equal(other_arena_resource));
+        EXPECT_FALSE(arena_resource.is_equal(pool_resource));
+        EXPECT_TRUE(pool_resource.is_equal(pmr::pool_resource()));
+    }
+
+
+    TEST_F(PmrValueTest, ParseIntoArena)
+    {
+        typedef json::value_generator<json::unicode::UTF_8_encoding_tag, pmr::allocator> SemanticActions;
+        typedef json::parse_context<const char*, SemanticActions> context_t;
+
+        SysArena arena;
+        pmr::arena_resource<> resource(arena);
+        context_t ctx((pmr::allocator(&resource)));
+
+        const std::string s = "{\"name\": \"abcdefghijklmnopqrstuvwxyz0123456789\", \"values\": [1, 2, 3]}";
+        const char* first = s.data();
+        ASSERT_TRUE(ctx.parse(first, s.data() + s.size()));
+        pmr::value result = std::move(ctx.result());
+        ASSERT_TRUE(result.is_object());
+        pmr::object& o = result.as<pmr::object>();
+        EXPECT_TRUE(o.get_allocator().resource() == &resource);
+        EXPECT_TRUE(o.at("name").as<pmr::string>().get_allocator().resource() == &resource);
+        EXPECT_EQ(3, o.at("values").as<pmr::array>().size());
+        EXPECT_LT(0, arena.bytesUsed());
+    }
+
+
+#if defined (JSON_HAS_STD_PMR)
+    TEST_F(PmrValueTest, StandardMemoryResource)
+    {
+        char buffer[64 * 1024];
+        std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        pmr::value v = make_document(pmr::allocator(&resource));
+        EXPECT_EQ(100, v.as<pmr::object>().size());
+        const pmr::string& str = v.as<pmr::object>().at("7").as<pmr::array>()[0].as<pmr::string>();
+        EXPECT_LE(buffer, str.data());
+        EXPECT_GT(buffer + sizeof(buffer), str.data());
+    }
+#endif
+
+}
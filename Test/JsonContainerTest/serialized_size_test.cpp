@@ -0,0 +1,177 @@
+//
+//  serialized_size_test.cpp
+//  Test
+//
+//  Created by agent on 10/18/26.
+//
+//
+
+#include "json/value/value.hpp"
+#include "json/generator/write_value.hpp"
+#include "json/generator/serialized_size.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <iterator>
+
+
+using namespace json;
+
+
+namespace {
+
+    typedef json::value<>   Value;
+    typedef Value::string_type String;
+    typedef Value::object_type Object;
+    typedef Value::array_type  Array;
+
+
+    Value make_sample(int n)
+    {
+        Object o;
+        o.emplace("id", 0);
+        o.emplace("key2", "string 2");
+        o.emplace("key3", "quote \" and backslash \\ and a/solidus");
+        o.emplace("key4", "\xC3\xA4\xC3\xB6\xC3\xBC \xE2\x82\xAC \xF0\x9D\x84\x9E");
+        o.emplace("key5", 1.5);
+        o.emplace("key6", true);
+        o.emplace("key7", json::null);
+        o.emplace("key8", "control \x01\x1F\b\f\n\r\t characters");
+        o.emplace("\xC3\xA4", -1234567);
+        o.emplace("nested", Array{Value(Array{Value(1), Value(Object())}), Value(Array())});
+
+        Array a;
+        for (int i = 0; i < n; ++i) {
+            o["id"] = i;
+            a.emplace_back(o);
+        }
+        a.emplace_back(Array());
+        a.emplace_back(Object());
+        return Value(std::move(a));
+    }
+
+
+    class SerializedSizeTest : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        SerializedSizeTest() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~SerializedSizeTest() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+    const unsigned int all_flags[] = {
+        0,
+        writer_base::pretty_print,
+        writer_base::escape_solidus,
+        writer_base::pretty_print|writer_base::escape_solidus
+    };
+
+
+    TEST_F(SerializedSizeTest, Scalars)
+    {
+        EXPECT_EQ(4, serialized_size(Value(json::null)));
+        EXPECT_EQ(4, serialized_size(Value(true)));
+        EXPECT_EQ(5, serialized_size(Value(false)));
+        EXPECT_EQ(4, serialized_size(Value(-123)));
+        EXPECT_EQ(5, serialized_size(Value("abc")));
+        EXPECT_EQ(10, serialized_size(Value("a\x01" "b")));
+        EXPECT_EQ(2, serialized_size(Value(Array())));
+        EXPECT_EQ(2, serialized_size(Value(Object())));
+    }
+
+
+    TEST_F(SerializedSizeTest, MatchesWriteValueUTF8)
+    {
+        const Value v = make_sample(10);
+        for (unsigned int f : all_flags) {
+            std::string expected;
+            json::write_value(v, std::back_inserter(expected), f);
+            EXPECT_EQ(expected.size(), serialized_size(v, f));
+        }
+    }
+
+
+    TEST_F(SerializedSizeTest, MatchesWriteValueOtherEncodings)
+    {
+        const Value v = make_sample(3);
+        for (unsigned int f : all_flags) {
+            std::string escaped;
+            json::write_value(v, std::back_inserter(escaped), f, json::unicode::escaped_unicode_encoding);
+            EXPECT_EQ(escaped.size(), serialized_size(v, f, json::unicode::escaped_unicode_encoding));
+
+            std::u16string utf16;
+            json::write_value(v, std::back_inserter(utf16), f, json::unicode::UTF_16LE_encoding);
+            EXPECT_EQ(utf16.size(), serialized_size(v, f, json::unicode::UTF_16LE_encoding));
+        }
+    }
+
+
+    TEST_F(SerializedSizeTest, WriteValueExact)
+    {
+        const Value v = make_sample(10);
+        for (unsigned int f : all_flags) {
+            std::string expected;
+            json::write_value(v, std::back_inserter(expected), f);
+
+            std::string s = "prefix";
+            json::write_value_exact(v, s, f);
+            EXPECT_EQ("prefix" + expected, s);
+        }
+
+        std::string escaped;
+        json::write_value(v, std::back_inserter(escaped), 0, json::unicode::escaped_unicode_encoding);
+        std::string s;
+        json::write_value_exact(v, s, 0, json::unicode::escaped_unicode_encoding);
+        EXPECT_EQ(escaped, s);
+    }
+
+
+    TEST_F(SerializedSizeTest, Cache)
+    {
+        Value v = make_sample(100);
+        json::serialized_size_cache cache(8);
+        for (unsigned int f : all_flags) {
+            std::string expected;
+            json::write_value(v, std::back_inserter(expected), f);
+            EXPECT_EQ(expected.size(), serialized_size(v, f, json::unicode::UTF_8_encoding, &cache));
+            // The top level array and its 100 objects with ten members:
+            EXPECT_EQ(101, cache.size());
+            EXPECT_EQ(expected.size(), serialized_size(v, f, json::unicode::UTF_8_encoding, &cache));
+            EXPECT_EQ(101, cache.size());
+        }
+
+        // Modify an element, and erase the modified containers:
+        serialized_size(v, 0, json::unicode::UTF_8_encoding, &cache);
+        Array& a = v.as<Array>();
+        a[0].as<Object>()["key2"] = "a longer string";
+        cache.erase(&a[0].as<Object>());
+        cache.erase(&a);
+        std::string expected;
+        json::write_value(v, std::back_inserter(expected), 0);
+        EXPECT_EQ(expected.size(), serialized_size(v, 0, json::unicode::UTF_8_encoding, &cache));
+        EXPECT_EQ(101, cache.size());
+    }
+
+}
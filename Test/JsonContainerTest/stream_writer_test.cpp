@@ -0,0 +1,190 @@
+//
+//  stream_writer_test.cpp
+//  Test
+//
+//  Created by agent on 10/18/26.
+//
+//
+
+#include "json/value/value.hpp"
+#include "json/generator/write_value.hpp"
+#include "json/generator/stream_writer.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <iterator>
+
+
+using namespace json;
+
+
+namespace {
+
+    typedef json::value<>   Value;
+    typedef Value::string_type String;
+    typedef Value::object_type Object;
+    typedef Value::array_type  Array;
+
+    typedef json::stream_writer<json::string_sink> writer_t;
+
+
+    class StreamWriterTest : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        StreamWriterTest() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~StreamWriterTest() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+
+    TEST_F(StreamWriterTest, Scalars)
+    {
+        {
+            std::string s;
+            json::string_sink sink(s);
+            writer_t w(sink);
+            EXPECT_FALSE(w.complete());
+            w.value(-123);
+            EXPECT_TRUE(w.complete());
+            w.flush();
+            EXPECT_EQ("-123", s);
+        }
+        {
+            std::string s;
+            json::string_sink sink(s);
+            writer_t w(sink);
+            w.begin_array().value(true).value(false).null().value(18446744073709551615ull).value(1.5).value("abc").end_array();
+            w.flush();
+            EXPECT_EQ("[true,false,null,18446744073709551615,1.5e00,\"abc\"]", s);
+        }
+    }
+
+
+    TEST_F(StreamWriterTest, MatchesWriteValue)
+    {
+        // Build a value and generate the same sequence of calls:
+        Object o;
+        o.emplace("id", 0);
+        o.emplace("name", "quote \" and backslash \\ and a/solidus");
+        o.emplace("text", "\xC3\xA4\xC3\xB6\xC3\xBC \xE2\x82\xAC");
+        o.emplace("empty_array", Array());
+        o.emplace("empty_object", Object());
+        o.emplace("values", Array{Value(1), Value(2.5), Value(true), Value(json::null)});
+        const Value v = Value(Array{Value(o), Value(o)});
+
+        const unsigned int flags[] = {0, writer_base::pretty_print, writer_base::escape_solidus};
+        for (unsigned int f : flags) {
+            std::string expected;
+            json::write_value(v, std::back_inserter(expected), f);
+
+            std::string s;
+            json::string_sink sink(s);
+            writer_t w(sink, f);
+            w.begin_array();
+            for (int i = 0; i < 2; ++i) {
+                w.begin_object();
+                // Object keys are ordered:
+                w.key("empty_array").begin_array().end_array();
+                w.key("empty_object").begin_object().end_object();
+                w.key("id").value(0);
+                w.key("name").value(std::string("quote \" and backslash \\ and a/solidus"));
+                w.key("text").value("\xC3\xA4\xC3\xB6\xC3\xBC \xE2\x82\xAC");
+                w.key("values").begin_array().value(1).value(2.5).value(true).null().end_array();
+                EXPECT_EQ(2, w.depth());
+                w.end_object();
+            }
+            w.end_array();
+            EXPECT_EQ(0, w.depth());
+            EXPECT_TRUE(w.complete());
+            w.flush();
+            EXPECT_EQ(expected, s);
+        }
+    }
+
+
+    TEST_F(StreamWriterTest, Raw)
+    {
+        std::string s;
+        json::string_sink sink(s);
+        writer_t w(sink);
+        w.begin_object().key("a").raw("[1,2,3]").key("b").raw(std::string("{}")).end_object();
+        w.flush();
+        EXPECT_EQ("{\"a\":[1,2,3],\"b\":{}}", s);
+    }
+
+
+    TEST_F(StreamWriterTest, EscapeStrings)
+    {
+        std::string s;
+        json::string_sink sink(s);
+        writer_t w(sink);
+        w.begin_array().value("a\x01" "b\x1F" "c\n").value("x\0y", 3).end_array();
+        w.flush();
+        EXPECT_EQ(std::string("[\"a\\u0001b\\u001Fc\\n\",\"x\\u0000y\"]"), s);
+    }
+
+
+    TEST_F(StreamWriterTest, EscapedUnicodeOutput)
+    {
+        std::string s;
+        json::string_sink sink(s);
+        json::stream_writer<json::string_sink, json::unicode::escaped_unicode_encoding_t> w(sink);
+        w.begin_object().key("\xC3\xA4").value("\xE2\x82\xAC").end_object();
+        w.flush();
+        // Like write_value(), keys are written in UTF-8:
+        EXPECT_EQ("{\"\xC3\xA4\":\"\\u20AC\"}", s);
+
+        Object o;
+        o.emplace("\xC3\xA4", "\xE2\x82\xAC");
+        std::string expected;
+        json::write_value(Value(o), std::back_inserter(expected), 0, json::unicode::escaped_unicode_encoding);
+        EXPECT_EQ(expected, s);
+    }
+
+
+    TEST_F(StreamWriterTest, SmallBuffer)
+    {
+        // Many values, and strings longer than the buffer.
+        std::vector<char> out;
+        json::vector_sink sink(out);
+        json::stream_writer<json::vector_sink> w(sink, 0, json::output_buffer<char, json::vector_sink>::min_capacity);
+
+        const std::string long_string(1000, 'x');
+        std::string expected = "[";
+        w.begin_array();
+        for (int i = 0; i < 100; ++i) {
+            if (i)
+                expected += ",";
+            expected += "\"" + long_string + "\"," + std::to_string(i);
+            w.value(long_string).value(i);
+        }
+        expected += "]";
+        w.end_array();
+        w.flush();
+        EXPECT_EQ(expected, std::string(out.begin(), out.end()));
+    }
+
+}
@@ -0,0 +1,286 @@
+//
+//  async_parser_test.cpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#include "json/parser/async_parser.hpp"
+#include "json/parser/value_generator.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+
+
+namespace {
+
+    using namespace json;
+
+    typedef json::value_generator<unicode::UTF_8_encoding_tag> SemanticActions;
+    typedef SemanticActions::Value Value;
+    typedef Value::array_type Array;
+    typedef Value::object_type Object;
+    typedef json::async_parser<SemanticActions> async_parser_t;
+    typedef async_parser_t::buffer_type buffer_t;
+
+
+    // Splits the text into buffers of the given size.
+    std::vector<buffer_t> make_buffers(const std::string& text, size_t size) {
+        std::vector<buffer_t> buffers;
+        for (size_t i = 0; i < text.size(); i += size) {
+            size_t n = std::min(size, text.size() - i);
+            buffers.push_back(buffer_t(text.data() + i, text.data() + i + n));
+        }
+        return buffers;
+    }
+
+
+    class AsyncParserTest : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        AsyncParserTest() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~AsyncParserTest() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+
+    TEST_F(AsyncParserTest, ParseSingleDocument)
+    {
+        const std::string s = "{\"a\": \"abc\", \"b\": [true, false, null], \"c\": 1.5}";
+
+        async_parser_t parser;
+        Value result;
+        parser.document_handler([&result](SemanticActions& sa) {
+            result = std::move(sa.result());
+        });
+        EXPECT_TRUE(parser.start());
+        EXPECT_FALSE(parser.start());
+        for (buffer_t& buffer : make_buffers(s, 3)) {
+            EXPECT_TRUE(parser.parse_buffer(std::move(buffer)));
+        }
+        EXPECT_TRUE(parser.finish());
+        EXPECT_FALSE(parser.finish());
+
+        EXPECT_TRUE(parser.get_future().get());
+        EXPECT_FALSE(parser.is_running());
+        EXPECT_EQ(0, parser.semantic_actions().error().code());
+        ASSERT_TRUE(result.is_object());
+        EXPECT_EQ(3, result.as<Object>().size());
+    }
+
+
+    TEST_F(AsyncParserTest, ParseMultipleDocuments)
+    {
+        std::string s;
+        const int N = 200;
+        for (int i = 0; i < N; ++i) {
+            s += "[" + std::to_string(i) + ", \"abc\", {\"x\": null}]\n";
+        }
+
+        async_parser_t parser(2);
+        parser.semantic_actions().parseMultipleDocuments(true);
+        std::vector<Value> results;
+        parser.document_handler([&results](SemanticActions& sa) {
+            results.push_back(std::move(sa.result()));
+        });
+        bool completed = false;
+        parser.completion_handler([&completed]() { completed = true; });
+        parser.start();
+
+        std::thread producer([&]() {
+            for (buffer_t& buffer : make_buffers(s, 7)) {
+                parser.parse_buffer(std::move(buffer));
+            }
+            parser.finish();
+        });
+        bool success = parser.get_future().get();
+        producer.join();
+
+        EXPECT_TRUE(success);
+        EXPECT_TRUE(completed);
+        ASSERT_EQ(N, results.size());
+        for (int i = 0; i < N; ++i) {
+            ASSERT_TRUE(results[i].is_array());
+            EXPECT_EQ(3, results[i].as<Array>().size());
+        }
+    }
+
+
+    TEST_F(AsyncParserTest, SyntaxErrorReleasesProducers)
+    {
+        async_parser_t parser(2);
+        int errors = 0;
+        int error_code = 0;
+        parser.error_handler([&](const SemanticActions::error_t& error) {
+            ++errors;
+            error_code = error.code();
+        });
+        parser.start();
+
+        // The producer shall not block forever after the parser stopped:
+        std::thread producer([&]() {
+            EXPECT_TRUE(parser.parse_buffer(buffer_t(1, '[')));
+            EXPECT_TRUE(parser.parse_buffer(buffer_t(1, 'x')));
+            for (int i = 0; i < 100; ++i) {
+                parser.parse_buffer(buffer_t(100, ' '));
+            }
+            EXPECT_FALSE(parser.parse_buffer(buffer_t(1, ']')));
+        });
+        EXPECT_FALSE(parser.get_future().get());
+        producer.join();
+
+        EXPECT_EQ(1, errors);
+        EXPECT_NE(0, error_code);
+        EXPECT_FALSE(parser.finish());
+    }
+
+
+    TEST_F(AsyncParserTest, ExtraCharactersAtEnd)
+    {
+        async_parser_t parser;
+        parser.start();
+        const std::string s = "[1] [2]";
+        parser.parse_buffer(buffer_t(s.begin(), s.end()));
+        parser.finish();
+        EXPECT_FALSE(parser.get_future().get());
+        EXPECT_EQ(json::JP_JSON_EXTRA_CHARACTERS_AT_END, parser.semantic_actions().error().code());
+    }
+
+
+    TEST_F(AsyncParserTest, BufferQueueBackPressure)
+    {
+        async_parser_t parser(2);
+        EXPECT_EQ(2, parser.buffer_queue_capacity());
+
+        // Not yet started, so the buffers are not consumed:
+        EXPECT_TRUE(parser.parse_buffer(buffer_t(1, '['), 0));
+        EXPECT_TRUE(parser.parse_buffer(buffer_t(1, '1'), 0));
+        EXPECT_EQ(2, parser.buffer_queue_size());
+        EXPECT_FALSE(parser.parse_buffer(buffer_t(1, ']'), 0.01));
+
+        parser.start();
+        EXPECT_TRUE(parser.parse_buffer(buffer_t(1, ']')));
+        parser.finish();
+        EXPECT_TRUE(parser.get_future().get());
+        EXPECT_EQ(0, parser.buffer_queue_size());
+    }
+
+
+    TEST_F(AsyncParserTest, Cancel)
+    {
+        async_parser_t parser;
+        bool completed = false;
+        parser.completion_handler([&completed]() { completed = true; });
+        parser.start();
+        const std::string s = "[1, 2, ";
+        ASSERT_TRUE(parser.parse_buffer(buffer_t(s.begin(), s.end())));
+        // Cancel the parser in the middle of the document, once it has
+        // consumed the buffer and waits for more input:
+        while (parser.buffer_queue_size() != 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        EXPECT_TRUE(parser.is_running());
+        parser.cancel();
+
+        EXPECT_FALSE(parser.get_future().get());
+        EXPECT_TRUE(completed);
+        EXPECT_EQ(json::JP_CANCELED, parser.semantic_actions().error().code());
+        EXPECT_FALSE(parser.parse_buffer(buffer_t(1, ']')));
+    }
+
+
+    TEST_F(AsyncParserTest, DestroyWhileRunning)
+    {
+        bool completed = false;
+        {
+            async_parser_t parser;
+            parser.completion_handler([&completed]() { completed = true; });
+            parser.start();
+            parser.parse_buffer(buffer_t(1, '{'));
+        }
+        EXPECT_TRUE(completed);
+    }
+
+
+    TEST_F(AsyncParserTest, StartWithExecutor)
+    {
+        std::vector<std::thread> pool;
+        async_parser_t::executor_type executor = [&pool](std::function<void()> task) {
+            pool.push_back(std::thread(std::move(task)));
+        };
+        {
+            async_parser_t parser;
+            parser.start(executor);
+            const std::string s = "[\"abc\"]";
+            parser.parse_buffer(buffer_t(s.begin(), s.end()));
+            parser.finish();
+            EXPECT_TRUE(parser.get_future().get());
+            EXPECT_TRUE(parser.semantic_actions().result().is_array());
+        }
+        ASSERT_EQ(1, pool.size());
+        pool[0].join();
+    }
+
+
+    TEST_F(AsyncParserTest, DetectsUTF16LE)
+    {
+        const std::string s = "[\"abc\", {\"key\": 12345}]";
+        std::string text;
+        for (char c : s) {
+            text.push_back(c);
+            text.push_back('\0');
+        }
+
+        async_parser_t parser;
+        parser.start();
+        for (buffer_t& buffer : make_buffers(text, 4)) {
+            parser.parse_buffer(std::move(buffer));
+        }
+        parser.finish();
+        EXPECT_TRUE(parser.get_future().get());
+        Value& result = parser.semantic_actions().result();
+        ASSERT_TRUE(result.is_array());
+        EXPECT_EQ(2, result.as<Array>().size());
+    }
+
+}
@@ -0,0 +1,311 @@
+//
+//  base64_value_test.cpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#include "json/parser/parse.hpp"
+#include "json/parser/value_generator.hpp"
+#include "json/parser/async_parser.hpp"
+#include "json/utility/base64.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <iterator>
+#include <utility>
+#include <stdexcept>
+#include <cstdlib>
+#include <thread>
+#include <chrono>
+
+
+namespace {
+
+    using namespace json;
+
+    typedef json::value_generator<unicode::UTF_8_encoding_tag> SemanticActions;
+    typedef SemanticActions::Value Value;
+    typedef Value::array_type Array;
+    typedef Value::object_type Object;
+    typedef Value::string_type String;
+    typedef json::parse_context<const char*, SemanticActions> context_t;
+
+
+    std::string random_bytes(std::size_t n)
+    {
+        std::string result;
+        result.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            result.push_back(static_cast<char>(std::rand() & 0xFF));
+        }
+        return result;
+    }
+
+    std::string encode(const std::string& bytes)
+    {
+        std::string result;
+        json::utility::encodeBase64(bytes.begin(), bytes.end(), std::back_inserter(result));
+        return result;
+    }
+
+
+    class Base64ValueTest : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        Base64ValueTest() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~Base64ValueTest() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+#pragma mark -
+
+    TEST_F(Base64ValueTest, DecodesValuesOfRegisteredKeys)
+    {
+        const std::string small = "binary data";
+        const std::string large = random_bytes(200000);   // delivered in several chunks
+        const std::string s = "{\"name\": \"" + encode("not decoded") + "\", "
+                              "\"data\": \"" + encode(large) + "\", "
+                              "\"list\": [\"" + encode(small) + "\"], "
+                              "\"nested\": {\"data\": \"" + encode(small) + "\"}, "
+                              "\"empty\": \"\"}";
+
+        std::vector<std::pair<std::string, std::string>> received;
+        bool complete = true;
+        context_t ctx;
+        ctx.semantic_actions().base64_key("data");
+        ctx.semantic_actions().base64_key("empty");
+        ctx.semantic_actions().binary_sink([&](const std::string& key, const char* data, std::size_t size, bool hasMore) {
+            if (complete)
+                received.push_back(std::make_pair(key, std::string()));
+            received.back().second.append(data, size);
+            complete = not hasMore;
+        });
+        const char* first = s.data();
+        ASSERT_TRUE(ctx.parse(first, s.data() + s.size())) << ctx.error().c_str();
+
+        // Only strings which are immediately the value of the key are decoded,
+        // at any level:
+        ASSERT_EQ(3, received.size());
+        EXPECT_EQ("data", received[0].first);
+        EXPECT_TRUE(large == received[0].second);
+        EXPECT_EQ("data", received[1].first);
+        EXPECT_EQ(small, received[1].second);
+        EXPECT_EQ("empty", received[2].first);
+        EXPECT_TRUE(received[2].second.empty());
+
+        Value result = std::move(ctx.result());
+        const Object& o = result.as<Object>();
+        EXPECT_EQ(String(encode("not decoded").c_str()), o.at("name").as<String>());
+        EXPECT_TRUE(o.at("data").is_null());
+        EXPECT_EQ(String(encode(small).c_str()), o.at("list").as<Array>()[0].as<String>());
+        EXPECT_TRUE(o.at("nested").as<Object>().at("data").is_null());
+        EXPECT_TRUE(o.at("empty").is_null());
+    }
+
+
+    TEST_F(Base64ValueTest, KeepsTextWithoutSink)
+    {
+        // Without a binary sink, the strings are validated but the values
+        // keep the base64 encoded text:
+        const std::string large = random_bytes(200000);
+        const std::string s = "{\"data\": \"" + encode(large) + "\", \"nested\": {\"data\": \"" + encode("abc") + "\"}}";
+
+        context_t ctx;
+        ctx.semantic_actions().base64_key("data");
+        const char* first = s.data();
+        ASSERT_TRUE(ctx.parse(first, s.data() + s.size())) << ctx.error().c_str();
+        const Object& o = ctx.result().as<Object>();
+        EXPECT_EQ(String(encode(large).c_str()), o.at("data").as<String>());
+        EXPECT_EQ(String(encode("abc").c_str()), o.at("nested").as<Object>().at("data").as<String>());
+    }
+
+
+    TEST_F(Base64ValueTest, BinarySink)
+    {
+        const std::string image = random_bytes(100000);
+        const std::string s = "[{\"id\": 1, \"image\": \"" + encode(image) + "\"}, {\"id\": 2, \"image\": \"" + encode("xyz") + "\"}]";
+
+        std::vector<std::string> received;
+        bool complete = true;
+        context_t ctx;
+        ctx.semantic_actions().base64_key("image");
+        ctx.semantic_actions().binary_sink([&](const std::string& key, const char* data, std::size_t size, bool hasMore) {
+            EXPECT_EQ("image", key);
+            if (complete)
+                received.push_back(std::string());
+            received.back().append(data, size);
+            complete = not hasMore;
+        });
+        const char* first = s.data();
+        ASSERT_TRUE(ctx.parse(first, s.data() + s.size())) << ctx.error().c_str();
+        EXPECT_TRUE(complete);
+        ASSERT_EQ(2, received.size());
+        EXPECT_EQ(image, received[0]);
+        EXPECT_EQ("xyz", received[1]);
+
+        // The sink consumes the bytes, the values become null:
+        const Array& a = ctx.result().as<Array>();
+        EXPECT_TRUE(a[0].as<Object>().at("image").is_null());
+        EXPECT_TRUE(a[1].as<Object>().at("image").is_null());
+    }
+
+
+    TEST_F(Base64ValueTest, Base64Path)
+    {
+        typedef std::pair<std::string, std::string> binary_t;
+        std::vector<binary_t> received;
+        bool complete = true;
+
+        context_t ctx;
+        ctx.semantic_actions().base64_path("$.items[1].data");
+        ctx.semantic_actions().base64_path("$['raw'][0]");
+        ctx.semantic_actions().binary_sink([&](const std::string& key, const char* data, std::size_t size, bool hasMore) {
+            if (complete)
+                received.push_back(binary_t(key, std::string()));
+            received.back().second.append(data, size);
+            complete = not hasMore;
+        });
+        std::string s = "{\"items\": [{\"data\": \"YWJj\"}, {\"data\": \"ZGVm\"}], "
+                        "\"raw\": [\"Z2hp\", \"amts\"], \"data\": \"bm8=\"}";
+        const char* first = s.data();
+        ASSERT_TRUE(ctx.parse(first, s.data() + s.size())) << ctx.error().c_str();
+        EXPECT_EQ(std::vector<binary_t>({binary_t("$.items[1].data", "def"), binary_t("$['raw'][0]", "ghi")}), received);
+        // The other strings are passed as is:
+        const Object& o = ctx.result().as<Object>();
+        EXPECT_EQ(String("YWJj"), o.at("items").as<Array>()[0].as<Object>().at("data").as<String>());
+        EXPECT_TRUE(o.at("items").as<Array>()[1].as<Object>().at("data").is_null());
+        EXPECT_TRUE(o.at("raw").as<Array>()[0].is_null());
+        EXPECT_EQ(String("amts"), o.at("raw").as<Array>()[1].as<String>());
+        EXPECT_EQ(String("bm8="), o.at("data").as<String>());
+
+        // Keys and paths may be combined:
+        received.clear();
+        ctx.semantic_actions().base64_key("data");
+        s = "{\"data\": \"YWJj\", \"raw\": [\"ZGVm\"]}";
+        first = s.data();
+        ASSERT_TRUE(ctx.parse(first, s.data() + s.size())) << ctx.error().c_str();
+        EXPECT_EQ(std::vector<binary_t>({binary_t("data", "abc"), binary_t("$['raw'][0]", "def")}), received);
+
+        EXPECT_THROW(ctx.semantic_actions().base64_path("$.items["), std::invalid_argument);
+        EXPECT_EQ(2, ctx.semantic_actions().base64_paths().size());
+    }
+
+
+    TEST_F(Base64ValueTest, InvalidBase64)
+    {
+        const std::string docs[] = {
+            "{\"data\": \"YWJj*GVm\"}",         // invalid character
+            "{\"data\": \"YWJjZA\"}",           // missing padding
+            "{\"data\": \"YWJjZA== \"}",        // spurious bytes
+            "{\"data\": \"YWJj\\nZGVm\"}"       // new line in strict mode
+        };
+        for (const std::string& s : docs) {
+            context_t ctx;
+            ctx.semantic_actions().base64_key("data");
+            const char* first = s.data();
+            EXPECT_FALSE(ctx.parse(first, s.data() + s.size())) << s;
+            EXPECT_EQ(static_cast<int>(JP_INVALID_BASE64_ERROR), ctx.error().code()) << s;
+        }
+
+        context_t ctx;
+        ctx.semantic_actions().base64_key("data");
+        ctx.semantic_actions().base64_mode(json::utility::Base64IgnoreWhitespace);
+        const std::string s = "{\"data\": \"YWJj\\nZGVm\\n\"}";
+        const char* first = s.data();
+        ASSERT_TRUE(ctx.parse(first, s.data() + s.size())) << ctx.error().c_str();
+        EXPECT_EQ(String("YWJj\nZGVm\n"), ctx.result().as<Object>().at("data").as<String>());
+    }
+
+
+    TEST_F(Base64ValueTest, Utf16StringBuffer)
+    {
+        typedef json::semantic_actions_noop<unicode::UTF_16_encoding_tag> SemanticActions16;
+        typedef json::parse_context<const char*, SemanticActions16> context16_t;
+
+        const std::string s = "{\"data\": \"" + encode("abc") + "\", \"text\": \"" + encode("def") + "\"}";
+        std::string received;
+        context16_t ctx;
+        ctx.semantic_actions().base64_key("data");
+        ctx.semantic_actions().binary_sink([&](const std::string&, const char* data, std::size_t size, bool) {
+            received.append(data, size);
+        });
+        const char* first = s.data();
+        ASSERT_TRUE(ctx.parse(first, s.data() + s.size())) << ctx.error().c_str();
+        EXPECT_EQ("abc", received);
+
+        // Non-ASCII code units are invalid base64 characters:
+        const std::string bogus = "{\"data\": \"YWJ\u00e9\"}";
+        first = bogus.data();
+        EXPECT_FALSE(ctx.parse(first, bogus.data() + bogus.size()));
+        EXPECT_EQ(static_cast<int>(JP_INVALID_BASE64_ERROR), ctx.error().code());
+    }
+
+
+    TEST_F(Base64ValueTest, CancelWhileWaitingForInput)
+    {
+        typedef json::async_parser<SemanticActions> async_parser_t;
+        typedef async_parser_t::buffer_type buffer_t;
+
+        // The parser is canceled within a base64 string, while it waits for
+        // more input. The error shall be JP_CANCELED:
+        async_parser_t parser;
+        parser.semantic_actions().base64_key("data");
+        parser.start();
+        const std::string s = "{\"data\": \"" + encode("abcdef").substr(0, 4);
+        ASSERT_TRUE(parser.parse_buffer(buffer_t(s.begin(), s.end())));
+        while (parser.buffer_queue_size() != 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        parser.cancel();
+        EXPECT_FALSE(parser.get_future().get());
+        EXPECT_EQ(static_cast<int>(JP_CANCELED), parser.semantic_actions().error().code());
+
+        // An invalid sequence still reports its own error:
+        async_parser_t parser2;
+        parser2.semantic_actions().base64_key("data");
+        parser2.start();
+        const std::string bogus = "{\"data\": \"YWJj*GVm\"}";
+        parser2.parse_buffer(buffer_t(bogus.begin(), bogus.end()));
+        parser2.finish();
+        EXPECT_FALSE(parser2.get_future().get());
+        EXPECT_EQ(static_cast<int>(JP_INVALID_BASE64_ERROR), parser2.semantic_actions().error().code());
+    }
+
+}
@@ -0,0 +1,297 @@
+//
+//  json_path_query_set_test.cpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#include "json/json_path/query.hpp"
+#include "json/parser/parse.hpp"
+#include "json/generator/write_value.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <iterator>
+#include <sstream>
+
+
+namespace {
+
+    using json::jsonpath::query;
+    using json::jsonpath::query_set;
+
+    typedef json::jsonpath::query_set_generator<> SemanticActions;
+    typedef json::jsonpath::query_generator<> SingleQuerySemanticActions;
+    typedef SemanticActions::Value Value;
+    typedef std::vector<std::size_t> ids;
+    typedef std::vector<std::string> strings;
+
+
+    const std::string store =
+        "{ \"store\": {\n"
+        "    \"book\": [\n"
+        "      { \"category\": \"reference\", \"author\": \"Nigel Rees\", \"title\": \"Sayings of the Century\", \"price\": 8.95 },\n"
+        "      { \"category\": \"fiction\", \"author\": \"Evelyn Waugh\", \"title\": \"Sword of Honour\", \"price\": 12.99 },\n"
+        "      { \"category\": \"fiction\", \"author\": \"Herman Melville\", \"title\": \"Moby Dick\", \"isbn\": \"0-553-21311-3\", \"price\": 8.99 },\n"
+        "      { \"category\": \"fiction\", \"author\": \"J. R. R. Tolkien\", \"title\": \"The Lord of the Rings\", \"isbn\": \"0-395-19395-8\", \"price\": 22 }\n"
+        "    ],\n"
+        "    \"bicycle\": { \"color\": \"red\", \"price\": 19.95 }\n"
+        "  }\n"
+        "}";
+
+
+    std::string to_string(const Value& v)
+    {
+        std::string str;
+        json::write_value(v, std::back_inserter(str));
+        return str;
+    }
+
+
+    // A match: the ids of the subscriptions and the serialized value.
+    typedef std::pair<ids, std::string> match_t;
+
+    std::vector<match_t> run(const query_set& queries, const std::string& text = store)
+    {
+        std::vector<match_t> result;
+        SemanticActions sa(queries, [&result](const ids& matched, const Value& v) {
+            result.push_back(match_t(matched, to_string(v)));
+        });
+        std::string::const_iterator first = text.begin();
+        EXPECT_TRUE(json::parse(first, text.end(), sa)) << sa.error().c_str();
+        EXPECT_EQ(result.size(), sa.match_count());
+        return result;
+    }
+
+    // The serialized values matched by the subscription id.
+    strings select(const std::vector<match_t>& matches, std::size_t id)
+    {
+        strings result;
+        for (const match_t& m : matches) {
+            if (std::find(m.first.begin(), m.first.end(), id) != m.first.end())
+                result.push_back(m.second);
+        }
+        return result;
+    }
+
+    // The serialized values matched by the query when evaluated alone.
+    strings run_single(const std::string& expression, const std::string& text = store)
+    {
+        strings result;
+        SingleQuerySemanticActions sa(query(expression), [&result](const Value& v) {
+            result.push_back(to_string(v));
+        });
+        std::string::const_iterator first = text.begin();
+        EXPECT_TRUE(json::parse(first, text.end(), sa)) << expression << ": " << sa.error().c_str();
+        return result;
+    }
+
+
+    class JsonPathQuerySetTest : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        JsonPathQuerySetTest() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~JsonPathQuerySetTest() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+#pragma mark -
+
+    TEST_F(JsonPathQuerySetTest, SharedPrefixes)
+    {
+        query_set queries;
+        EXPECT_EQ(0, queries.add("$.store.book[*].author"));
+        EXPECT_EQ(1, queries.add("$.store.book[*].title"));
+        EXPECT_EQ(2, queries.add("$['store'].bicycle.color"));
+        EXPECT_EQ(3, queries.add("$.store.book[ * ].author"));
+        EXPECT_EQ(4, queries.size());
+        // $, store, book, [*], author, title, bicycle, color, [ * ] and its author:
+        EXPECT_EQ(10, queries.node_count());
+
+        std::vector<match_t> matches = run(queries);
+        EXPECT_EQ(9, matches.size());
+        EXPECT_EQ(strings({"\"Nigel Rees\"", "\"Evelyn Waugh\"", "\"Herman Melville\"", "\"J. R. R. Tolkien\""}),
+                  select(matches, 0));
+        EXPECT_EQ(select(matches, 0), select(matches, 3));
+        EXPECT_EQ(4, select(matches, 1).size());
+        EXPECT_EQ(strings({"\"red\""}), select(matches, 2));
+    }
+
+
+    TEST_F(JsonPathQuerySetTest, IdsAreGroupedPerValue)
+    {
+        query_set queries;
+        queries.add("$..price");
+        queries.add("$.store.bicycle.price");
+        queries.add("$.store.bicycle.*");
+        queries.add("$..bicycle[?(@ > 19)]");
+        queries.add("$..price");
+
+        std::vector<match_t> matches = run(queries);
+        std::map<std::string, ids> by_value;
+        for (const match_t& m : matches) {
+            EXPECT_TRUE(by_value.insert(std::make_pair(m.second, m.first)).second) << m.second;
+        }
+        EXPECT_EQ(ids({2}), by_value["\"red\""]);
+        EXPECT_EQ(ids({0, 4}), by_value["22"]);
+        EXPECT_EQ(6, matches.size());
+        // The price of the bicycle:
+        EXPECT_EQ(ids({0, 1, 2, 3, 4}), matches.back().first);
+    }
+
+
+    TEST_F(JsonPathQuerySetTest, DescendantAndChildSteps)
+    {
+        // The root is shared by child and descendant steps, a child step must
+        // not match below the root, and vice versa:
+        const std::string text = "{\"a\": {\"b\": 1, \"a\": 2}, \"b\": {\"c\": {\"b\": 3}}}";
+        query_set queries;
+        queries.add("$.a");
+        queries.add("$..b");
+        queries.add("$.b");
+        queries.add("$..a.b");
+        queries.add("$.b..b");
+        queries.add("$..[0]");
+
+        std::vector<match_t> matches = run(queries, text);
+        EXPECT_EQ(strings({"{\"a\":2,\"b\":1}"}), select(matches, 0));
+        EXPECT_EQ(strings({"1", "3", "{\"c\":{\"b\":3}}"}), select(matches, 1));
+        EXPECT_EQ(strings({"{\"c\":{\"b\":3}}"}), select(matches, 2));
+        EXPECT_EQ(strings({"1"}), select(matches, 3));
+        EXPECT_EQ(strings({"3"}), select(matches, 4));
+        EXPECT_TRUE(select(matches, 5).empty());
+    }
+
+
+    TEST_F(JsonPathQuerySetTest, Filters)
+    {
+        query_set queries;
+        queries.add("$..book[?(@.isbn)].title");
+        queries.add("$..book[?(@.price < 10)].title");
+        queries.add("$..book[?(@.isbn)].author");
+        queries.add("$.store.book[?(@.category == 'fiction' && @.price >= 22)]");
+        queries.add("$..book[*].title");
+
+        std::vector<match_t> matches = run(queries);
+        EXPECT_EQ(strings({"\"Moby Dick\"", "\"The Lord of the Rings\""}), select(matches, 0));
+        EXPECT_EQ(strings({"\"Sayings of the Century\"", "\"Moby Dick\""}), select(matches, 1));
+        EXPECT_EQ(strings({"\"Herman Melville\"", "\"J. R. R. Tolkien\""}), select(matches, 2));
+        EXPECT_EQ(1, select(matches, 3).size());
+        EXPECT_EQ(4, select(matches, 4).size());
+        // A match which depends on the filter of an enclosing value is
+        // reported when that value is complete, separately:
+        std::vector<ids> moby_dick;
+        for (const match_t& m : matches) {
+            if (m.second == "\"Moby Dick\"")
+                moby_dick.push_back(m.first);
+        }
+        EXPECT_EQ(std::vector<ids>({ids({4}), ids({0, 1})}), moby_dick);
+    }
+
+
+    TEST_F(JsonPathQuerySetTest, AgreesWithSingleQueries)
+    {
+        const char* expressions[] = {
+            "$", "$.store", "$.store.*", "$..*", "$..price", "$.store..price", "$..book[2].title",
+            "$.store.book[0:2].title", "$.store.book[::2]", "$.store.book[1,3].author",
+            "$..book[?(@.isbn)].title", "$..[?(@.price > 19)].price", "$..[\"isbn\"]",
+            "$.store.book[?(@.category != \"fiction\" || @.price > 20)].author", "$..book..*",
+            "$['store']['bicycle']['color','price']", "$.store.missing", "$..book[?(@)].*"
+        };
+        query_set queries;
+        for (const char* e : expressions)
+            queries.add(e);
+
+        std::vector<match_t> matches = run(queries);
+        for (std::size_t id = 0; id < queries.size(); ++id) {
+            strings expected = run_single(expressions[id]);
+            strings actual = select(matches, id);
+            std::sort(expected.begin(), expected.end());
+            std::sort(actual.begin(), actual.end());
+            EXPECT_EQ(expected, actual) << expressions[id];
+        }
+    }
+
+
+    TEST_F(JsonPathQuerySetTest, ManySubscriptions)
+    {
+        // An event stream with many subscriptions of the same shape:
+        std::ostringstream os;
+        os << "{\"events\": [";
+        for (int i = 0; i < 50; ++i) {
+            os << (i ? ", " : "") << "{\"topic\": \"t" << i % 10 << "\", \"user\": {\"id\": " << i
+               << ", \"name\": \"u" << i << "\"}, \"payload\": {\"k" << i % 7 << "\": " << i << "}}";
+        }
+        os << "]}";
+        const std::string text = os.str();
+
+        std::vector<std::string> expressions;
+        for (int i = 0; i < 1000; ++i) {
+            std::ostringstream e;
+            e << "$.events[" << i % 60 << "].payload.k" << i % 7;
+            expressions.push_back(e.str());
+        }
+        for (int i = 0; i < 1000; ++i) {
+            std::ostringstream e;
+            e << "$.events[?(@.topic == 't" << i % 12 << "')].user.id";
+            expressions.push_back(e.str());
+        }
+        expressions.push_back("$..name");
+
+        query_set queries;
+        for (const std::string& e : expressions)
+            queries.add(e);
+        EXPECT_EQ(2001, queries.size());
+        // Equal subscriptions share all nodes:
+        EXPECT_EQ(579, queries.node_count());
+
+        std::vector<match_t> matches = run(queries, text);
+        for (std::size_t id = 0; id < queries.size(); id += 37) {
+            EXPECT_EQ(run_single(expressions[id], text), select(matches, id)) << expressions[id];
+        }
+        EXPECT_EQ(50, select(matches, 2000).size());
+
+        // Each value is passed once:
+        std::map<std::string, int> count;
+        for (const match_t& m : matches)
+            ++count[m.second];
+        EXPECT_EQ(1, count["\"u7\""]);
+    }
+
+}
@@ -0,0 +1,247 @@
+//
+//  json_path_query_test.cpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#include "json/json_path/query.hpp"
+#include "json/parser/parse.hpp"
+#include "json/generator/write_value.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <iterator>
+#include <sstream>
+
+
+namespace {
+
+    using json::jsonpath::query;
+    using json::jsonpath::query_error;
+
+    typedef json::jsonpath::query_generator<> SemanticActions;
+    typedef SemanticActions::Value Value;
+    typedef SemanticActions::Object Object;
+    typedef SemanticActions::String String;
+    typedef Value::float_number_type FloatNumber;
+
+
+    const std::string store =
+        "{ \"store\": {\n"
+        "    \"book\": [\n"
+        "      { \"category\": \"reference\", \"author\": \"Nigel Rees\", \"title\": \"Sayings of the Century\", \"price\": 8.95 },\n"
+        "      { \"category\": \"fiction\", \"author\": \"Evelyn Waugh\", \"title\": \"Sword of Honour\", \"price\": 12.99 },\n"
+        "      { \"category\": \"fiction\", \"author\": \"Herman Melville\", \"title\": \"Moby Dick\", \"isbn\": \"0-553-21311-3\", \"price\": 8.99 },\n"
+        "      { \"category\": \"fiction\", \"author\": \"J. R. R. Tolkien\", \"title\": \"The Lord of the Rings\", \"isbn\": \"0-395-19395-8\", \"price\": 22 }\n"
+        "    ],\n"
+        "    \"bicycle\": { \"color\": \"red\", \"price\": 19.95 }\n"
+        "  }\n"
+        "}";
+
+
+    // Returns the matches as strings: strings unquoted, floats with six digits,
+    // other values serialized.
+    std::vector<std::string> run(const std::string& expression, const std::string& text = store)
+    {
+        std::vector<std::string> result;
+        SemanticActions sa(query(expression), [&result](const Value& v) {
+            if (v.is_string()) {
+                const String& s = v.as<String>();
+                result.push_back(std::string(s.begin(), s.end()));
+            } else if (v.is_float_number()) {
+                std::ostringstream os;
+                os << static_cast<double>(v.as<FloatNumber>());
+                result.push_back(os.str());
+            } else {
+                std::string str;
+                json::write_value(v, std::back_inserter(str));
+                result.push_back(str);
+            }
+        });
+        std::string::const_iterator first = text.begin();
+        EXPECT_TRUE(json::parse(first, text.end(), sa)) << expression << ": " << sa.error().c_str();
+        EXPECT_EQ(result.size(), sa.match_count());
+        return result;
+    }
+
+    typedef std::vector<std::string> strings;
+
+
+    class JsonPathQueryTest : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        JsonPathQueryTest() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~JsonPathQueryTest() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+#pragma mark -
+
+    TEST_F(JsonPathQueryTest, ChildAndWildcard)
+    {
+        EXPECT_EQ(strings({"Nigel Rees", "Evelyn Waugh", "Herman Melville", "J. R. R. Tolkien"}),
+                  run("$.store.book[*].author"));
+        EXPECT_EQ(strings({"red"}), run("$['store']['bicycle'][\"color\"]"));
+        EXPECT_EQ(strings({"red", "19.95"}), run("$.store.bicycle.*"));
+        EXPECT_EQ(strings({"reference", "Nigel Rees"}), run("$.store.book[0]['category','author']"));
+        EXPECT_EQ(2, run("$.store.*").size());
+        EXPECT_EQ(1, run("$").size());
+        EXPECT_TRUE(run("$.store.missing").empty());
+        EXPECT_TRUE(run("$.store.bicycle[0]").empty());
+    }
+
+
+    TEST_F(JsonPathQueryTest, RecursiveDescent)
+    {
+        EXPECT_EQ(strings({"Nigel Rees", "Evelyn Waugh", "Herman Melville", "J. R. R. Tolkien"}),
+                  run("$..author"));
+        EXPECT_EQ(strings({"8.95", "12.99", "8.99", "22", "19.95"}), run("$.store..price"));
+        EXPECT_EQ(strings({"Moby Dick"}), run("$..book[2].title"));
+        EXPECT_EQ(strings({"0-553-21311-3", "0-395-19395-8"}), run("$..[\"isbn\"]"));
+
+        // A nested match is complete first:
+        EXPECT_EQ(strings({"1", "{\"a\":1}"}), run("$..a", "{\"a\": {\"a\": 1}}"));
+        EXPECT_EQ(strings({"1", "2", "[2]", "[1,[2]]"}), run("$..*", "[[1, [2]]]"));
+    }
+
+
+    TEST_F(JsonPathQueryTest, IndicesAndSlices)
+    {
+        const std::string a = "[0, 1, 2, 3, 4, 5, 6, 7, 8, 9]";
+        EXPECT_EQ(strings({"3"}), run("$[3]", a));
+        EXPECT_EQ(strings({"1", "4", "9"}), run("$[1,4,9,10]", a));
+        EXPECT_EQ(strings({"0", "1", "2"}), run("$[:3]", a));
+        EXPECT_EQ(strings({"7", "8", "9"}), run("$[7:]", a));
+        EXPECT_EQ(strings({"1", "4", "7"}), run("$[1:8:3]", a));
+        EXPECT_EQ(strings({"0", "2", "4", "6", "8"}), run("$[::2]", a));
+        EXPECT_EQ(strings({"Sayings of the Century", "Sword of Honour"}), run("$.store.book[0:2].title"));
+    }
+
+
+    TEST_F(JsonPathQueryTest, Filters)
+    {
+        EXPECT_EQ(strings({"Moby Dick", "The Lord of the Rings"}), run("$..book[?(@.isbn)].title"));
+        EXPECT_EQ(strings({"Sayings of the Century", "Moby Dick"}), run("$..book[?(@.price < 10)].title"));
+        EXPECT_EQ(strings({"J. R. R. Tolkien"}),
+                  run("$.store.book[?(@.category == 'fiction' && @.price >= 22)].author"));
+        EXPECT_EQ(strings({"Nigel Rees", "J. R. R. Tolkien"}),
+                  run("$.store.book[?(@.category != \"fiction\" || @.price > 20)].author"));
+        EXPECT_EQ(strings({"22", "19.95"}), run("$..[?(@.price > 19)].price"));
+
+        const std::string a = "[1, 5, 3, \"x\", null, true, {\"a\": [4, 5]}]";
+        EXPECT_EQ(strings({"5", "3"}), run("$[?(@ >= 3)]", a));
+        EXPECT_EQ(strings({"x"}), run("$[?(@ == 'x')]", a));
+        EXPECT_EQ(strings({"null"}), run("$[?(@ == null)]", a));
+        EXPECT_EQ(strings({"true"}), run("$[?(@ == true)]", a));
+        EXPECT_EQ(strings({"{\"a\":[4,5]}"}), run("$[?(@.a[1] == 5)]", a));
+        // Steps after a filter apply to the candidate:
+        EXPECT_EQ(strings({"4", "5"}), run("$[?(@.a)].a[*]", a));
+    }
+
+
+    TEST_F(JsonPathQueryTest, LargeValues)
+    {
+        // Strings are delivered in chunks:
+        const std::string big(100000, 'x');
+        const std::string text = "{\"skip\": \"" + big + "\", \"big\": \"" + big + "\"}";
+        std::vector<std::string> result = run("$.big", text);
+        ASSERT_EQ(1, result.size());
+        EXPECT_EQ(big, result[0]);
+    }
+
+
+    TEST_F(JsonPathQueryTest, Reuse)
+    {
+        size_t count = 0;
+        SemanticActions sa(query("$..price"), [&count](const Value&) { ++count; });
+        for (int i = 0; i < 3; ++i) {
+            std::string::const_iterator first = store.begin();
+            ASSERT_TRUE(json::parse(first, store.end(), sa));
+            EXPECT_EQ(5, sa.match_count());
+        }
+        EXPECT_EQ(15, count);
+    }
+
+
+    TEST_F(JsonPathQueryTest, Base64Values)
+    {
+        const std::string text = "{\"items\": [{\"data\": \"YWJj\"}, {\"data\": \"ZGVm\"}]}";
+        std::vector<std::string> values;
+        SemanticActions sa(query("$.items[*].data"), [&values](const Value& v) {
+            std::string str;
+            json::write_value(v, std::back_inserter(str));
+            values.push_back(str);
+        });
+        sa.base64_key("data");
+
+        // Without a binary sink, the matches keep the base64 encoded text:
+        std::string::const_iterator first = text.begin();
+        ASSERT_TRUE(json::parse(first, text.end(), sa)) << sa.error().c_str();
+        EXPECT_EQ(std::vector<std::string>({"\"YWJj\"", "\"ZGVm\""}), values);
+
+        // With a binary sink, the sink receives the bytes and the matches are null:
+        std::string bytes;
+        sa.binary_sink([&bytes](const std::string&, const char* data, std::size_t size, bool) {
+            bytes.append(data, size);
+        });
+        values.clear();
+        first = text.begin();
+        ASSERT_TRUE(json::parse(first, text.end(), sa)) << sa.error().c_str();
+        EXPECT_EQ("abcdef", bytes);
+        EXPECT_EQ(std::vector<std::string>({"null", "null"}), values);
+    }
+
+
+    TEST_F(JsonPathQueryTest, MalformedExpressions)
+    {
+        const char* expressions[] = {
+            "", "store", "$.", "$[", "$[1", "$[-1]", "$[1:2:0]", "$['a'", "$x",
+            "$[?(@.a <)]", "$[?(@.a == 1]", "$[?(a)]", "$[?(@.*)]"
+        };
+        for (const char* e : expressions) {
+            EXPECT_THROW(query q(e), query_error) << e;
+        }
+        try {
+            query q("$.a[-1]");
+        } catch (const query_error& ex) {
+            EXPECT_EQ(4, ex.position());
+        }
+    }
+
+}
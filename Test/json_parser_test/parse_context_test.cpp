@@ -0,0 +1,167 @@
+//
+//  parse_context_test.cpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#include "json/parser/parse.hpp"
+#include "json/parser/value_generator.hpp"
+#include "json/utility/arena_allocator.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+
+
+namespace {
+
+    using namespace json;
+
+    typedef json::value_generator<unicode::UTF_8_encoding_tag> SemanticActions;
+    typedef SemanticActions::Value Value;
+    typedef Value::array_type Array;
+    typedef Value::object_type Object;
+    typedef json::parse_context<const char*, SemanticActions> context_t;
+
+
+    class ParseContextTest : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        ParseContextTest() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~ParseContextTest() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+
+    TEST_F(ParseContextTest, ParseMultipleDocuments)
+    {
+        const std::string docs[] = {
+            "[1, 2, 3]",
+            "{\"a\": \"abc\", \"b\": [true, false, null]}",
+            "[\"x\"]"
+        };
+
+        context_t ctx;
+        for (int n = 0; n < 2; ++n) {
+            for (const std::string& s : docs) {
+                const char* first = s.data();
+                bool success = json::parse(first, s.data() + s.size(), ctx);
+                EXPECT_TRUE(success);
+            }
+            Value& result = ctx.result();
+            ASSERT_TRUE(result.is_array());
+            EXPECT_EQ(1, result.as<Array>().size());
+        }
+    }
+
+
+    TEST_F(ParseContextTest, ResetAfterError)
+    {
+        context_t ctx;
+
+        const std::string bogus = "[1, 2";
+        const char* first = bogus.data();
+        EXPECT_FALSE(ctx.parse(first, bogus.data() + bogus.size()));
+        EXPECT_NE(0, ctx.error().code());
+
+        const std::string s = "{\"a\": 1}";
+        first = s.data();
+        EXPECT_TRUE(ctx.parse(first, s.data() + s.size()));
+        EXPECT_EQ(0, ctx.error().code());
+        EXPECT_TRUE(ctx.result().is_object());
+    }
+
+
+    TEST_F(ParseContextTest, ReconfiguresAfterOptionChange)
+    {
+        context_t ctx;
+        const std::string s = "[1] xyz";
+
+        const char* first = s.data();
+        EXPECT_FALSE(ctx.parse(first, s.data() + s.size()));
+
+        ctx.semantic_actions().ignoreSpuriousTrailingBytes(true);
+        first = s.data();
+        EXPECT_TRUE(ctx.parse(first, s.data() + s.size()));
+    }
+
+
+    TEST_F(ParseContextTest, KeepsArenaBlocks)
+    {
+        typedef json::utility::arena_allocator<void, json::utility::SysArena> Allocator;
+        typedef json::value_generator<unicode::UTF_8_encoding_tag, Allocator> ArenaSemanticActions;
+        typedef json::parse_context<const char*, ArenaSemanticActions> arena_context_t;
+
+        json::utility::SysArena arena;
+        arena_context_t ctx((Allocator(arena)));
+        ctx.semantic_actions().recycle_arena(true);
+
+        const std::string s = "{\"name\": \"abcdefghijklmnopqrstuvwxyz\", \"values\": [1, 2, 3]}";
+        const char* first = s.data();
+        ASSERT_TRUE(ctx.parse(first, s.data() + s.size()));
+        const size_t blocks = arena.numberAllocatedBlocks();
+        const size_t totalSize = arena.totalSize();
+        EXPECT_LT(0, blocks);
+
+        for (int i = 0; i < 100; ++i) {
+            first = s.data();
+            ASSERT_TRUE(ctx.parse(first, s.data() + s.size()));
+            EXPECT_TRUE(ctx.result().is_object());
+        }
+        EXPECT_EQ(blocks, arena.numberAllocatedBlocks());
+        EXPECT_EQ(totalSize, arena.totalSize());
+    }
+
+
+    TEST_F(ParseContextTest, ThreadLocalContext)
+    {
+        context_t* main_ctx = &context_t::local();
+        EXPECT_EQ(main_ctx, &context_t::local());
+
+        context_t* thread_ctx = nullptr;
+        std::thread t([&]() {
+            thread_ctx = &context_t::local();
+            const std::string s = "[1, 2]";
+            const char* first = s.data();
+            EXPECT_TRUE(context_t::local().parse(first, s.data() + s.size()));
+        });
+        t.join();
+        EXPECT_NE(main_ctx, thread_ctx);
+    }
+
+}
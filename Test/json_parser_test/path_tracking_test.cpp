@@ -0,0 +1,282 @@
+//
+//  path_tracking_test.cpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#include "json/parser/parse.hpp"
+#include "json/parser/semantic_actions_base.hpp"
+#include "json/json_path/path_stack.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <unordered_map>
+
+
+namespace {
+
+    using namespace json;
+
+
+    // Records the path and its hash of each scalar value.
+    template <typename EncodingT>
+    class path_recorder :
+        public semantic_actions_base<path_recorder<EncodingT>, EncodingT>
+    {
+        typedef semantic_actions_base<path_recorder<EncodingT>, EncodingT> base;
+
+    public:
+        typedef typename base::error_t                  error_t;
+        typedef typename base::number_desc_t            number_desc_t;
+        typedef typename base::const_buffer_t           const_buffer_t;
+        typedef typename base::path_hash_t              path_hash_t;
+        typedef void                                    result_type;
+
+        path_recorder() { this->track_path(true); }
+
+        void parse_begin_imp()                              { paths.clear(); hashes.clear(); }
+        void parse_end_imp()                                {}
+        void finished_imp()                                 {}
+        void begin_array_imp()                              {}
+        void end_array_imp()                                {}
+        void begin_object_imp()                             {}
+        bool end_object_imp()                               { return true; }
+        void begin_value_at_index_imp(size_t)               {}
+        void end_value_at_index_imp(size_t)                 {}
+        void begin_key_value_pair_imp(const const_buffer_t&, size_t) {}
+        void end_key_value_pair_imp()                       {}
+        void value_string_imp(const const_buffer_t&, bool hasMore) { if (!hasMore) record(); }
+        void value_number_imp(const number_desc_t&)         { record(); }
+        void value_boolean_imp(bool)                        { record(); }
+        void value_null_imp()                               { record(); }
+        void clear_imp(bool)                                {}
+        void print_imp(std::ostream&)                       {}
+
+        void error_imp(int code, const char* description)   { error_.set(code, description); }
+        const error_t& error_imp() const                    { return error_; }
+
+        std::vector<std::string>    paths;
+        std::vector<path_hash_t>    hashes;
+
+    private:
+        void record() {
+            std::ostringstream os;
+            this->path().write(os);
+            paths.push_back(os.str());
+            hashes.push_back(this->path_hash());
+        }
+
+        error_t error_;
+    };
+
+    typedef path_recorder<unicode::UTF_8_encoding_tag> SemanticActions;
+    typedef SemanticActions::path_t path_t;
+    typedef std::vector<std::string> strings;
+
+
+    bool parse(const std::string& s, SemanticActions& sa)
+    {
+        std::string::const_iterator first = s.begin();
+        return json::parse(first, s.end(), sa);
+    }
+
+
+    class PathTrackingTest : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        PathTrackingTest() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~PathTrackingTest() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+#pragma mark -
+
+    TEST_F(PathTrackingTest, PathStack)
+    {
+        path_t path;
+        EXPECT_EQ(0, path.level());
+        EXPECT_EQ(path_t::root_hash(), path.hash());
+
+        path.push_key("items", 5);
+        path.push_index(3);
+        path.push_key("id", 2);
+        EXPECT_EQ(3, path.level());
+        ASSERT_TRUE(path.is_key(0));
+        EXPECT_EQ("items", std::string(path.key(0).first, path.key(0).second));
+        EXPECT_FALSE(path.is_key(1));
+        EXPECT_EQ(3, path.index(1));
+        EXPECT_EQ("id", std::string(path.key(2).first, path.key(2).second));
+
+        const path_t::hash_type items = path_t::combine_key(path_t::root_hash(), "items", 5);
+        EXPECT_EQ(items, path.hash(1));
+        EXPECT_EQ(path_t::combine_index(items, 3), path.hash(2));
+        EXPECT_EQ(path_t::combine_key(path_t::combine_index(items, 3), "id", 2), path.hash());
+
+        path.pop();
+        path.pop();
+        path.push_key("count", 5);
+        EXPECT_EQ(2, path.level());
+        EXPECT_EQ("count", std::string(path.key(1).first, path.key(1).second));
+        EXPECT_EQ(path_t::combine_key(items, "count", 5), path.hash());
+
+        // Keys and indices, and the boundaries of keys, make a difference:
+        EXPECT_NE(path_t::combine_key(path_t::root_hash(), "ab", 2),
+                  path_t::combine_key(path_t::combine_key(path_t::root_hash(), "a", 1), "b", 1));
+        EXPECT_NE(path_t::combine_key(path_t::root_hash(), "\x03", 1),
+                  path_t::combine_index(path_t::root_hash(), 3));
+
+        path.clear();
+        EXPECT_EQ(path_t::root_hash(), path.hash());
+    }
+
+
+    TEST_F(PathTrackingTest, PathsOfValues)
+    {
+        SemanticActions sa;
+        ASSERT_TRUE(parse("{\"a\": [1, {\"b\": true}, []], \"c\": null, \"d\\\"e\": \"x\"}", sa)) << sa.error().c_str();
+        EXPECT_EQ(strings({"$['a'][0]", "$['a'][1]['b']", "$['c']", "$['d\"e']"}), sa.paths);
+        EXPECT_EQ(0, sa.path().level());
+
+        ASSERT_TRUE(parse("[[0, 1], 2]", sa));
+        EXPECT_EQ(strings({"$[0][0]", "$[0][1]", "$[1]"}), sa.paths);
+
+        ASSERT_TRUE(parse("[\"x\"]", sa));
+        EXPECT_EQ(strings({"$[0]"}), sa.paths);
+        EXPECT_EQ(path_t::combine_index(path_t::root_hash(), 0), sa.hashes[0]);
+    }
+
+
+    TEST_F(PathTrackingTest, RouteByHash)
+    {
+        std::unordered_map<path_t::hash_type, std::string> routes;
+        path_t::hash_type h = path_t::combine_key(path_t::root_hash(), "events", 6);
+        for (int i = 0; i < 3; ++i) {
+            routes[path_t::combine_key(path_t::combine_index(h, i), "id", 2)] = "id";
+        }
+        routes[path_t::combine_key(path_t::root_hash(), "count", 5)] = "count";
+
+        SemanticActions sa;
+        ASSERT_TRUE(parse("{\"events\": [{\"id\": 1, \"x\": 0}, {\"x\": 1, \"id\": 2}], \"count\": 2}", sa));
+        strings routed;
+        for (path_t::hash_type hash : sa.hashes) {
+            auto iter = routes.find(hash);
+            routed.push_back(iter == routes.end() ? "-" : iter->second);
+        }
+        EXPECT_EQ(strings({"id", "-", "-", "id", "count"}), routed);
+    }
+
+
+    TEST_F(PathTrackingTest, DisabledAndErrors)
+    {
+        SemanticActions sa;
+        sa.track_path(false);
+        ASSERT_TRUE(parse("{\"a\": [1]}", sa));
+        EXPECT_EQ(strings({"$"}), sa.paths);
+
+        // A malformed document leaves no components behind:
+        sa.track_path(true);
+        EXPECT_FALSE(parse("{\"a\": [1, {\"b\": ", sa));
+        ASSERT_TRUE(parse("{\"c\": 1}", sa));
+        EXPECT_EQ(strings({"$['c']"}), sa.paths);
+    }
+
+
+    TEST_F(PathTrackingTest, ParsePath)
+    {
+        path_t expected;
+        expected.push_key("items", 5);
+        expected.push_index(3);
+        expected.push_key("id", 2);
+
+        path_t path;
+        ASSERT_TRUE(path.parse("$.items[3]['id']"));
+        EXPECT_TRUE(path.equal(expected));
+        EXPECT_EQ(expected.hash(), path.hash());
+        path.clear();
+        ASSERT_TRUE(path.parse("$[\"items\"][3].id"));
+        EXPECT_TRUE(path.equal(expected));
+        path.clear();
+        ASSERT_TRUE(path.parse("$.items[3].ie"));
+        EXPECT_FALSE(path.equal(expected));
+        path.clear();
+        ASSERT_TRUE(path.parse("$"));
+        EXPECT_EQ(0, path.level());
+
+        const char* malformed[] = { "", "items", "$.", "$..a", "$[", "$[x]", "$[1", "$['a'", "$['a']x" };
+        for (const char* e : malformed) {
+            path.clear();
+            EXPECT_FALSE(path.parse(e)) << e;
+        }
+    }
+
+
+    TEST_F(PathTrackingTest, Base64Path)
+    {
+        // Registering a base64 path enables path tracking:
+        std::vector<std::string> keys;
+        SemanticActions sa;
+        sa.track_path(false);
+        sa.base64_path("$['raw'][0]");
+        EXPECT_TRUE(sa.track_path());
+        sa.binary_sink([&](const std::string& key, const char*, std::size_t, bool hasMore) {
+            if (!hasMore)
+                keys.push_back(key);
+        });
+        ASSERT_TRUE(parse("{\"raw\": [\"Z2hp\", \"amts\"]}", sa)) << sa.error().c_str();
+        EXPECT_EQ(strings({"$['raw'][0]"}), keys);
+        EXPECT_EQ(strings({"$['raw'][1]"}), sa.paths);
+    }
+
+
+    TEST_F(PathTrackingTest, Utf16StringBuffer)
+    {
+        typedef path_recorder<unicode::UTF_16_encoding_tag> SemanticActions16;
+        typedef SemanticActions16::path_t path16_t;
+
+        SemanticActions16 sa;
+        const std::string s = "{\"k\\u00e9y\": [true]}";
+        std::string::const_iterator first = s.begin();
+        ASSERT_TRUE(json::parse(first, s.end(), sa)) << sa.error().c_str();
+        ASSERT_EQ(1, sa.hashes.size());
+        const path16_t::char_type key[] = { 'k', 0xE9, 'y' };
+        EXPECT_EQ(path16_t::combine_index(path16_t::combine_key(path16_t::root_hash(), key, 3), 0), sa.hashes[0]);
+    }
+
+}
@@ -0,0 +1,197 @@
+//
+//  streaming_value_generator_test.cpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#include "json/parser/parse.hpp"
+#include "json/parser/streaming_value_generator.hpp"
+#include "json/utility/arena_allocator.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+
+namespace {
+
+    using namespace json;
+
+    typedef json::streaming_value_generator<unicode::UTF_8_encoding_tag> SemanticActions;
+    typedef SemanticActions::Value Value;
+    typedef Value::array_type Array;
+    typedef Value::object_type Object;
+    typedef Value::string_type String;
+
+
+    class StreamingValueGeneratorTest : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        StreamingValueGeneratorTest() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~StreamingValueGeneratorTest() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+
+    TEST_F(StreamingValueGeneratorTest, StreamsElementsOfRootArray)
+    {
+        const std::string s = "[1, \"abc\", [true, null], {\"a\": 2}]";
+
+        std::vector<Value> elements;
+        std::vector<size_t> indices;
+        SemanticActions sa;
+        sa.element_handler([&](Value& v) {
+            indices.push_back(sa.index());
+            elements.push_back(std::move(v));
+        });
+
+        std::string::const_iterator first = s.begin();
+        bool success = json::parse(first, s.cend(), sa);
+        ASSERT_TRUE(success);
+        ASSERT_EQ(4, elements.size());
+        EXPECT_EQ(4, sa.element_count());
+
+        EXPECT_TRUE(elements[0].is_integral_number());
+        EXPECT_TRUE(elements[1].is_string());
+        EXPECT_EQ(std::string("abc"), std::string(elements[1].as<String>().c_str()));
+        ASSERT_TRUE(elements[2].is_array());
+        EXPECT_EQ(2, elements[2].as<Array>().size());
+        EXPECT_TRUE(elements[2].as<Array>()[0].is_boolean());
+        EXPECT_TRUE(elements[2].as<Array>()[1].is_null());
+        ASSERT_TRUE(elements[3].is_object());
+        EXPECT_EQ(1, elements[3].as<Object>().size());
+
+        for (size_t i = 0; i < indices.size(); ++i) {
+            EXPECT_EQ(i, indices[i]);
+        }
+    }
+
+
+    TEST_F(StreamingValueGeneratorTest, StreamsValuesOfRootObject)
+    {
+        const std::string s = "{\"a\": [1,2,3], \"b\": \"x\"}";
+
+        std::vector<std::string> keys;
+        std::vector<Value> elements;
+        SemanticActions sa([&](Value& v) {
+            keys.push_back(sa.key());
+            elements.push_back(std::move(v));
+        });
+
+        std::string::const_iterator first = s.begin();
+        bool success = json::parse(first, s.cend(), sa);
+        ASSERT_TRUE(success);
+        ASSERT_EQ(2, elements.size());
+        EXPECT_EQ("a", keys[0]);
+        EXPECT_EQ("b", keys[1]);
+        ASSERT_TRUE(elements[0].is_array());
+        EXPECT_EQ(3, elements[0].as<Array>().size());
+        EXPECT_TRUE(elements[1].is_string());
+    }
+
+
+    TEST_F(StreamingValueGeneratorTest, StreamingLevel)
+    {
+        // Elements of the containers at nesting level 2. The scalar at level
+        // 1 will be skipped.
+        const std::string s = "[[1, 2], 3, {\"k\": [4]}, []]";
+
+        size_t count = 0;
+        SemanticActions sa([&](Value&) { ++count; });
+        sa.streaming_level(2);
+
+        std::string::const_iterator first = s.begin();
+        bool success = json::parse(first, s.cend(), sa);
+        ASSERT_TRUE(success);
+        EXPECT_EQ(3, count);
+    }
+
+
+    TEST_F(StreamingValueGeneratorTest, CancelFromHandler)
+    {
+        const std::string s = "[1, 2, 3, 4, 5]";
+
+        size_t count = 0;
+        SemanticActions sa;
+        sa.element_handler([&](Value&) {
+            if (++count == 2)
+                sa.cancel();
+        });
+
+        std::string::const_iterator first = s.begin();
+        bool success = json::parse(first, s.cend(), sa);
+        EXPECT_FALSE(success);
+        EXPECT_EQ(2, count);
+    }
+
+
+    TEST_F(StreamingValueGeneratorTest, RecyclesArena)
+    {
+        typedef json::utility::arena_allocator<void, json::utility::SysArena> Allocator;
+        typedef json::streaming_value_generator<unicode::UTF_8_encoding_tag, Allocator> ArenaSemanticActions;
+        typedef ArenaSemanticActions::Value ArenaValue;
+
+        // Each element allocates far less than a block, thus the arena shall
+        // never need more than one normal block.
+        std::string s = "[";
+        for (int i = 0; i < 1000; ++i) {
+            if (i > 0)
+                s += ",";
+            s += "{\"name\": \"abcdefghijklmnopqrstuvwxyz0123456789\", \"values\": [1, 2, 3]}";
+        }
+        s += "]";
+
+        json::utility::SysArena arena;
+        Allocator a(arena);
+        size_t count = 0;
+        size_t maxBlocks = 0;
+        ArenaSemanticActions sa([&](ArenaValue& v) {
+            ++count;
+            EXPECT_TRUE(v.is_object());
+            maxBlocks = std::max(maxBlocks, arena.numberAllocatedBlocks());
+        }, a);
+
+        std::string::const_iterator first = s.begin();
+        bool success = json::parse(first, s.cend(), sa);
+        ASSERT_TRUE(success);
+        EXPECT_EQ(1000, count);
+        EXPECT_EQ(1, maxBlocks);
+        EXPECT_EQ(0, arena.bytesUsed());
+    }
+
+}
@@ -0,0 +1,276 @@
+//
+//  transcode_test.cpp
+//  Test
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#include "json/simd/transcode.hpp"
+#include "json/unicode/unicode_conversion.hpp"
+#include "json/unicode/unicode_traits.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <iterator>
+#include <random>
+
+
+namespace {
+
+    using namespace json::unicode;
+
+    static_assert(internal::use_bulk_transcoding<const char*, UTF_8_encoding_tag, uint16_t*, UTF_16LE_encoding_tag>::value, "");
+    static_assert(internal::use_bulk_transcoding<uint32_t*, UTF_32LE_encoding_tag, char*, UTF_8_encoding_tag>::value, "");
+    static_assert(not internal::use_bulk_transcoding<std::deque<char>::iterator, UTF_8_encoding_tag, uint16_t*, UTF_16LE_encoding_tag>::value, "");
+    static_assert(not internal::use_bulk_transcoding<const char*, UTF_8_encoding_tag, uint16_t*, UTF_16BE_encoding_tag>::value, "");
+
+
+    // Returns code points in runs of characters which encode with the
+    // same number of UTF-8 bytes, in order to hit the vectorized blocks.
+    std::vector<code_point_t> random_code_points(std::mt19937& gen, std::size_t n)
+    {
+        static const code_point_t ranges[][2] = {
+            {0x01, 0x7F}, {0x80, 0x7FF}, {0x800, 0xD7FF}, {0xE000, 0xFFFF}, {0x10000, 0x10FFFF}
+        };
+        std::uniform_int_distribution<int> range_dist(0, 4);
+        std::uniform_int_distribution<int> run_dist(1, 40);
+        std::vector<code_point_t> result;
+        while (result.size() < n) {
+            const code_point_t* range = ranges[range_dist(gen)];
+            std::uniform_int_distribution<code_point_t> cp_dist(range[0], range[1]);
+            for (int i = run_dist(gen); i > 0; --i) {
+                result.push_back(cp_dist(gen));
+            }
+        }
+        return result;
+    }
+
+    std::string to_utf8(const std::vector<code_point_t>& cps)
+    {
+        std::string s;
+        for (code_point_t cp : cps) {
+            if (cp < 0x80) {
+                s.push_back(static_cast<char>(cp));
+            } else if (cp < 0x800) {
+                s.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+                s.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            } else if (cp < 0x10000) {
+                s.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+                s.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                s.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            } else {
+                s.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+                s.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+                s.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                s.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            }
+        }
+        return s;
+    }
+
+    std::vector<uint16_t> to_utf16(const std::vector<code_point_t>& cps)
+    {
+        std::vector<uint16_t> s;
+        for (code_point_t cp : cps) {
+            if (cp < 0x10000) {
+                s.push_back(static_cast<uint16_t>(cp));
+            } else {
+                s.push_back(static_cast<uint16_t>(0xD800 + ((cp - 0x10000) >> 10)));
+                s.push_back(static_cast<uint16_t>(0xDC00 + ((cp - 0x10000) & 0x3FF)));
+            }
+        }
+        return s;
+    }
+
+
+    // Converts the source once from a std::deque, which uses the character-
+    // wise converters, and once from and into contiguous buffers, which uses
+    // the bulk transcoding kernels. Both shall produce the same result, output
+    // and final position.
+    template <typename FromEncodingT, typename ToEncodingT, typename OutCharT, typename InCharT>
+    void check_convert(const std::vector<InCharT>& source, ConvertOption option)
+    {
+        const std::deque<InCharT> d(source.begin(), source.end());
+        typename std::deque<InCharT>::const_iterator dfirst = d.begin();
+        std::vector<OutCharT> expected;
+        std::back_insert_iterator<std::vector<OutCharT>> out(expected);
+        const int expected_result = convert(dfirst, d.end(), FromEncodingT(), out, ToEncodingT(), option);
+
+        std::vector<OutCharT> buffer(source.size() * 4 + 4);
+        const InCharT* first = source.data();
+        OutCharT* dest = buffer.data();
+        const int result = convert(first, source.data() + source.size(), FromEncodingT(), dest, ToEncodingT(), option);
+
+        ASSERT_EQ(expected_result, result);
+        EXPECT_EQ(std::distance(d.begin(), dfirst), first - source.data());
+        EXPECT_TRUE(expected == std::vector<OutCharT>(buffer.data(), dest));
+    }
+
+
+    class TranscodeTest : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        TranscodeTest() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~TranscodeTest() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+
+    TEST_F(TranscodeTest, KernelsStopAtIllFormedInput)
+    {
+        // U+00E4 U+20AC U+1D11E, followed by a lone trail byte:
+        const std::string s = "abc\xC3\xA4\xE2\x82\xAC\xF0\x9D\x84\x9E\x80xyz";
+        uint16_t utf16[32];
+        const char* first = s.data();
+        uint16_t* dest = utf16;
+        json::simd::utf8_to_utf16(first, s.data() + s.size(), dest);
+        EXPECT_EQ(12, first - s.data());
+        ASSERT_EQ(7, dest - utf16);
+        EXPECT_EQ(0xE4, utf16[3]);
+        EXPECT_EQ(0x20AC, utf16[4]);
+        EXPECT_EQ(0xD834, utf16[5]);
+        EXPECT_EQ(0xDD1E, utf16[6]);
+
+        // A truncated surrogate pair:
+        const uint16_t* first16 = utf16;
+        char utf8[32];
+        char* dest8 = utf8;
+        json::simd::utf16_to_utf8(first16, static_cast<const uint16_t*>(utf16 + 6), dest8);
+        EXPECT_EQ(5, first16 - utf16);
+        EXPECT_EQ(std::string("abc\xC3\xA4\xE2\x82\xAC"), std::string(utf8, dest8));
+
+        // Surrogates and code points beyond U+10FFFF in UTF-32:
+        const uint32_t utf32[] = {0x41, 0x10FFFF, 0xDFFF, 0x41};
+        const uint32_t* first32 = utf32;
+        dest = utf16;
+        json::simd::utf32_to_utf16(first32, utf32 + 4, dest);
+        EXPECT_EQ(2, first32 - utf32);
+        const uint32_t beyond[] = {0x110000};
+        first32 = beyond;
+        dest8 = utf8;
+        json::simd::utf32_to_utf8(first32, beyond + 1, dest8);
+        EXPECT_EQ(beyond, first32);
+        EXPECT_EQ(utf8, dest8);
+    }
+
+
+    TEST_F(TranscodeTest, ConvertFromUTF8)
+    {
+        std::mt19937 gen(1);
+        std::uniform_int_distribution<std::size_t> length_dist(0, 300);
+        for (int i = 0; i < 3000; ++i) {
+            std::string s = to_utf8(random_code_points(gen, length_dist(gen)));
+            if (i % 2 == 1 and not s.empty()) {
+                std::uniform_int_distribution<std::size_t> pos_dist(0, s.size() - 1);
+                std::uniform_int_distribution<int> byte_dist(0x80, 0xFF);
+                s[pos_dist(gen)] = static_cast<char>(byte_dist(gen));
+            }
+            const std::vector<char> source(s.begin(), s.end());
+            const ConvertOption option = (i % 4 == 3) ? ReplaceIllFormed : None;
+            check_convert<UTF_8_encoding_tag, UTF_16LE_encoding_tag, uint16_t>(source, option);
+            check_convert<UTF_8_encoding_tag, UTF_32LE_encoding_tag, uint32_t>(source, option);
+            check_convert<UTF_8_encoding_tag, UTF_8_encoding_tag, char>(source, option);
+            if (::testing::Test::HasFatalFailure())
+                return;
+        }
+    }
+
+
+    TEST_F(TranscodeTest, ConvertFromUTF16)
+    {
+        std::mt19937 gen(2);
+        std::uniform_int_distribution<std::size_t> length_dist(0, 300);
+        for (int i = 0; i < 3000; ++i) {
+            std::vector<uint16_t> source = to_utf16(random_code_points(gen, length_dist(gen)));
+            if (i % 2 == 1 and not source.empty()) {
+                std::uniform_int_distribution<std::size_t> pos_dist(0, source.size() - 1);
+                std::uniform_int_distribution<int> surrogate_dist(0xD800, 0xDFFF);
+                source[pos_dist(gen)] = static_cast<uint16_t>(surrogate_dist(gen));
+            }
+            const ConvertOption option = (i % 4 == 3) ? ReplaceIllFormed : None;
+            check_convert<UTF_16LE_encoding_tag, UTF_8_encoding_tag, char>(source, option);
+            check_convert<UTF_16LE_encoding_tag, UTF_32LE_encoding_tag, uint32_t>(source, option);
+            if (::testing::Test::HasFatalFailure())
+                return;
+        }
+    }
+
+
+    TEST_F(TranscodeTest, ConvertFromUTF32)
+    {
+        std::mt19937 gen(3);
+        std::uniform_int_distribution<std::size_t> length_dist(0, 300);
+        for (int i = 0; i < 3000; ++i) {
+            const std::vector<code_point_t> cps = random_code_points(gen, length_dist(gen));
+            std::vector<uint32_t> source(cps.begin(), cps.end());
+            if (i % 2 == 1 and not source.empty()) {
+                std::uniform_int_distribution<std::size_t> pos_dist(0, source.size() - 1);
+                source[pos_dist(gen)] = (i % 4 == 1) ? 0xDC00u : 0x110000u;
+            }
+            check_convert<UTF_32LE_encoding_tag, UTF_8_encoding_tag, char>(source, None);
+            check_convert<UTF_32LE_encoding_tag, UTF_16LE_encoding_tag, uint16_t>(source, None);
+            if (::testing::Test::HasFatalFailure())
+                return;
+        }
+    }
+
+
+    TEST_F(TranscodeTest, StatefulConvert)
+    {
+        // With a pending multi-byte sequence the bulk kernels must not be
+        // used before the converter completed it.
+        const std::string s = "\xE2\x82\xAC" "abcdefghijklmnopqrstuvwxyz\xC3\xA4\xC3\xA4\xC3\xA4\xC3\xA4\xC3\xA4\xC3\xA4\xC3\xA4\xC3\xA4";
+        for (std::size_t split = 1; split < s.size(); ++split) {
+            mb_state<UTF_8_encoding_tag> state;
+            std::vector<uint16_t> buffer(s.size() * 2);
+            uint16_t* dest = buffer.data();
+            const char* first = s.data();
+            const int r = convert(first, s.data() + split, UTF_8_encoding_tag(), dest, UTF_16LE_encoding_tag(), state);
+            EXPECT_TRUE(r == 0 or r == E_UNEXPECTED_ENDOFINPUT);
+            first = s.data() + split;
+            ASSERT_EQ(0, convert(first, s.data() + s.size(), UTF_8_encoding_tag(), dest, UTF_16LE_encoding_tag(), state));
+            ASSERT_EQ(35, dest - buffer.data());
+            EXPECT_EQ(0x20AC, buffer[0]);
+            EXPECT_EQ('z', buffer[26]);
+            EXPECT_EQ(0xE4, buffer[34]);
+        }
+    }
+
+}
@@ -0,0 +1,221 @@
+//
+//  utf8_validate_test.cpp
+//  Test
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#include "json/simd/utf8_validate.hpp"
+#include "json/unicode/unicode_converter.hpp"
+#include "json/unicode/unicode_traits.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <iterator>
+#include <random>
+
+
+namespace {
+
+    using json::simd::utf8_valid_prefix;
+    using json::simd::detail::utf8_valid_prefix_scalar;
+    using namespace json::unicode;
+
+
+    // A generator of mostly valid UTF-8, with single bytes replaced by
+    // random values.
+    std::string random_utf8(std::mt19937& gen, std::size_t n, bool corrupt)
+    {
+        static const char* const samples[] = {
+            "a", "b", "0", " ", "\"",
+            "\xC3\xA4", "\xC2\x80", "\xDF\xBF",
+            "\xE2\x82\xAC", "\xE0\xA0\x80", "\xED\x9F\xBF", "\xEF\xBF\xBF",
+            "\xF0\x90\x80\x80", "\xF0\x9D\x84\x9E", "\xF4\x8F\xBF\xBF"
+        };
+        std::uniform_int_distribution<int> sample_dist(0, sizeof(samples)/sizeof(samples[0]) - 1);
+        std::string s;
+        while (s.size() < n) {
+            // Runs of ASCII in order to hit the ASCII paths:
+            if (sample_dist(gen) == 0) {
+                s.append(20, 'x');
+            }
+            s.append(samples[sample_dist(gen)]);
+        }
+        if (corrupt and not s.empty()) {
+            std::uniform_int_distribution<std::size_t> pos_dist(0, s.size() - 1);
+            std::uniform_int_distribution<int> byte_dist(0x80, 0xFF);
+            s[pos_dist(gen)] = static_cast<char>(byte_dist(gen));
+        }
+        return s;
+    }
+
+
+    class UTF8ValidateTest : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        UTF8ValidateTest() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~UTF8ValidateTest() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+
+    TEST_F(UTF8ValidateTest, AllTwoByteSequencesAtEveryOffset)
+    {
+        // Every combination of two bytes, plus a third and fourth byte from a
+        // small set, placed at every offset of a 40 byte buffer:
+        const unsigned char trails[] = {0x00, 0x41, 0x80, 0x8F, 0x90, 0x9F, 0xA0, 0xBF, 0xC0};
+        for (int b0 = 0x80; b0 < 0x100; ++b0) {
+            for (int b1 = 0; b1 < 0x100; b1 += 1) {
+                for (unsigned char b2 : trails) {
+                    for (int pos = 12; pos < 20; ++pos) {
+                        char buffer[40];
+                        std::memset(buffer, 'a', sizeof(buffer));
+                        buffer[pos] = static_cast<char>(b0);
+                        buffer[pos+1] = static_cast<char>(b1);
+                        buffer[pos+2] = static_cast<char>(b2);
+                        buffer[pos+3] = static_cast<char>(0x80);
+                        ASSERT_EQ(utf8_valid_prefix_scalar(buffer, buffer + sizeof(buffer)),
+                                  utf8_valid_prefix(buffer, buffer + sizeof(buffer)))
+                            << std::hex << "bytes: " << b0 << " " << b1 << " " << int(b2) << " at " << std::dec << pos;
+                    }
+                }
+            }
+        }
+    }
+
+
+    TEST_F(UTF8ValidateTest, RandomInput)
+    {
+        std::mt19937 gen(1);
+        std::uniform_int_distribution<std::size_t> length_dist(0, 300);
+        for (int i = 0; i < 20000; ++i) {
+            const std::string s = random_utf8(gen, length_dist(gen), i % 2 == 1);
+            const char* first = s.data();
+            const char* last = first + s.size();
+            const char* expected = utf8_valid_prefix_scalar(first, last);
+            ASSERT_EQ(expected - first, utf8_valid_prefix(first, last) - first) << "iteration: " << i;
+            if (i % 2 == 0) {
+                EXPECT_TRUE(json::simd::is_valid_utf8(first, last));
+            }
+            // Truncated input:
+            if (s.size() > 1) {
+                const char* truncated = last - 1;
+                ASSERT_EQ(utf8_valid_prefix_scalar(first, truncated), utf8_valid_prefix(first, truncated));
+            }
+        }
+    }
+
+
+    TEST_F(UTF8ValidateTest, ConverterMatchesCharacterwiseParser)
+    {
+        // The block validation fast path is taken for pointers. Converting from
+        // a std::deque uses the character-wise parser. Both shall produce the
+        // same output, result and final position.
+        typedef converter<UTF_8_encoding_tag, UTF_16LE_encoding_tag, Validation::SAFE, Stateful::No> cvt_t;
+        typedef converter<UTF_8_encoding_tag, code_point_t, Validation::SAFE, Stateful::No> cp_cvt_t;
+
+        std::mt19937 gen(2);
+        std::uniform_int_distribution<std::size_t> length_dist(0, 200);
+        for (int i = 0; i < 5000; ++i) {
+            const std::string s = random_utf8(gen, length_dist(gen), i % 3 == 1);
+            const std::deque<char> d(s.begin(), s.end());
+
+            std::vector<uint16_t> expected;
+            std::deque<char>::const_iterator dfirst = d.begin();
+            std::back_insert_iterator<std::vector<uint16_t>> dest1(expected);
+            int expected_result = cvt_t().convert(dfirst, d.end(), dest1);
+
+            std::vector<uint16_t> result;
+            const char* first = s.data();
+            std::back_insert_iterator<std::vector<uint16_t>> dest2(result);
+            int r = cvt_t().convert(first, s.data() + s.size(), dest2);
+
+            ASSERT_EQ(expected_result, r) << "iteration: " << i;
+            EXPECT_EQ(std::distance(d.begin(), dfirst), first - s.data());
+            EXPECT_TRUE(expected == result);
+
+            std::vector<code_point_t> expected_cp;
+            dfirst = d.begin();
+            std::back_insert_iterator<std::vector<code_point_t>> dest3(expected_cp);
+            expected_result = cp_cvt_t().convert(dfirst, d.end(), dest3);
+
+            std::vector<code_point_t> result_cp;
+            first = s.data();
+            std::back_insert_iterator<std::vector<code_point_t>> dest4(result_cp);
+            r = cp_cvt_t().convert(first, s.data() + s.size(), dest4);
+            ASSERT_EQ(expected_result, r);
+            EXPECT_EQ(std::distance(d.begin(), dfirst), first - s.data());
+            EXPECT_TRUE(expected_cp == result_cp);
+        }
+    }
+
+
+    TEST_F(UTF8ValidateTest, StatefulConverterAcrossChunks)
+    {
+        // A stateful converter shall handle multi byte sequences which are
+        // split between calls.
+        typedef converter<UTF_8_encoding_tag, UTF_16LE_encoding_tag, Validation::SAFE, Stateful::Yes> cvt_t;
+
+        std::mt19937 gen(3);
+        for (int i = 0; i < 500; ++i) {
+            const std::string s = random_utf8(gen, 100, false);
+            std::vector<uint16_t> expected;
+            {
+                cvt_t cvt;
+                const char* first = s.data();
+                std::back_insert_iterator<std::vector<uint16_t>> dest(expected);
+                ASSERT_EQ(0, cvt.convert(first, s.data() + s.size(), dest));
+            }
+            std::vector<uint16_t> result;
+            {
+                cvt_t cvt;
+                std::back_insert_iterator<std::vector<uint16_t>> dest(result);
+                std::size_t split = 1 + i % (s.size() - 1);
+                const char* first = s.data();
+                int r = cvt.convert(first, s.data() + split, dest);
+                EXPECT_TRUE(r == 0 or r == E_UNEXPECTED_ENDOFINPUT);
+                first = s.data() + split;
+                ASSERT_EQ(0, cvt.convert(first, s.data() + s.size(), dest));
+            }
+            EXPECT_TRUE(expected == result);
+        }
+    }
+
+}
@@ -22,6 +22,8 @@
 
 #include <cstddef>
 #include <cassert>
+#include <cstring>
+#include <thread>
 
 namespace nm {
     
@@ -342,7 +344,123 @@ namespace {
         
         std::string str(22, 'a');
 
-        string s = {22, 'a', a};        
+        string s = {22, 'a', a};
+    }
+
+
+    TEST_F(ArenaAllocatorTest, ResetRetainsNormalBlocks)
+    {
+        SysArena arena;
+
+        arena.allocate(100);
+        arena.allocate(2*SysArena::kDefaultMinBlockSize);  // large block
+        EXPECT_EQ(2, arena.numberAllocatedBlocks());
+
+        arena.reset();
+        EXPECT_EQ(0, arena.bytesUsed());
+        EXPECT_EQ(1, arena.numberAllocatedBlocks());  // the large block has been released
+        size_t totalSize = arena.totalSize();
+
+        // Allocations reuse the retained block:
+        arena.allocate(100);
+        EXPECT_EQ(1, arena.numberAllocatedBlocks());
+        EXPECT_EQ(totalSize, arena.totalSize());
+
+        arena.clear();
+        EXPECT_EQ(0, arena.numberAllocatedBlocks());
+    }
+
+
+    TEST_F(ArenaAllocatorTest, MarkAndRewind)
+    {
+        SysArena arena;
+        
+        arena.allocate(100);
+        SysArena::Marker m = arena.mark();
+        const size_t bytesUsed = arena.bytesUsed();
+        char* p0 = static_cast<char*>(arena.allocate(16));
+        
+        // Allocate enough to require further normal blocks and a large block:
+        for (int i = 0; i < 100; ++i) {
+            arena.allocate(200);
+        }
+        arena.allocate(2*SysArena::kDefaultMinBlockSize);
+        const size_t blocks = arena.numberAllocatedBlocks();
+        EXPECT_LT(2, blocks);
+        
+        arena.rewind(m);
+        EXPECT_EQ(bytesUsed, arena.bytesUsed());
+        // The large block has been released, the normal blocks are retained:
+        EXPECT_EQ(blocks - 1, arena.numberAllocatedBlocks());
+        
+        // The next allocation continues right after the marker:
+        char* p1 = static_cast<char*>(arena.allocate(16));
+        EXPECT_EQ(p0, p1);
+        
+        // Rewinding to a marker of an empty arena:
+        SysArena arena2;
+        SysArena::Marker m2 = arena2.mark();
+        arena2.allocate(100);
+        arena2.rewind(m2);
+        EXPECT_EQ(0, arena2.bytesUsed());
+        EXPECT_EQ(1, arena2.numberAllocatedBlocks());
+    }
+
+
+    TEST_F(ArenaAllocatorTest, ClearRetainsBlocks)
+    {
+        SysArena arena;
+        EXPECT_EQ(0, arena.retainedBlocks());
+        arena.setRetainedBlocks(2);
+        
+        for (int i = 0; i < 100; ++i) {
+            arena.allocate(200);
+        }
+        EXPECT_LT(2, arena.numberAllocatedBlocks());
+        
+        arena.clear();
+        EXPECT_EQ(0, arena.bytesUsed());
+        EXPECT_EQ(2, arena.numberAllocatedBlocks());
+        
+        arena.setRetainedBlocks(0);
+        arena.clear();
+        EXPECT_EQ(0, arena.numberAllocatedBlocks());
+        EXPECT_EQ(sizeof(SysArena), arena.totalSize());
+    }
+
+
+    TEST_F(ArenaAllocatorTest, SharedBlockPool)
+    {
+        SysArena::BlockPool pool(SysArena::kDefaultMinBlockSize, 64);
+        EXPECT_EQ(0, pool.size());
+        {
+            SysArena arena(pool);
+            for (int i = 0; i < 100; ++i) {
+                arena.allocate(200);
+            }
+            const size_t blocks = arena.numberAllocatedBlocks();
+            arena.clear();
+            EXPECT_EQ(blocks, pool.size());
+        }
+        
+        // Arenas on several threads draw their blocks from the pool and
+        // return them:
+        const size_t pooled = pool.size();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.push_back(std::thread([&pool]() {
+                for (int n = 0; n < 100; ++n) {
+                    SysArena arena(pool);
+                    for (int i = 0; i < 50; ++i) {
+                        std::memset(arena.allocate(100), 0, 100);
+                    }
+                }
+            }));
+        }
+        for (std::thread& t : threads)
+            t.join();
+        EXPECT_LE(pooled, pool.size());
+        EXPECT_GE(pool.maxBlocks(), pool.size());
     }
 
     
@@ -0,0 +1,250 @@
+//
+//  async_log_test.cpp
+//  Test
+//
+//  Created by agent on 10/18/26.
+//
+//
+
+#include "json/utility/async_log.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+
+
+namespace {
+
+    using json::utility::async_logger;
+    using json::utility::async_log_service;
+    namespace utility = json::utility;
+
+
+    // Redirects the output of the service into a temporary file.
+    class captured_output
+    {
+    public:
+        captured_output()
+        : file_(tmpfile()), previous_(async_log_service::instance().output())
+        {
+            async_log_service::instance().output(file_);
+        }
+
+        ~captured_output() {
+            async_log_service::instance().output(previous_);
+            fclose(file_);
+        }
+
+        // Returns the size of the output, without flushing the service.
+        long size() {
+            return ftell(file_);
+        }
+
+        // Returns the messages written so far, without the line headers.
+        std::vector<std::string> lines() {
+            async_log_service::instance().flush();
+            std::vector<std::string> result;
+            rewind(file_);
+            char buffer[2048];
+            while (fgets(buffer, sizeof(buffer), file_)) {
+                std::string line(buffer);
+                std::string::size_type pos = line.find("]: ");
+                if (pos != std::string::npos)
+                    line = line.substr(pos + 3);
+                if (not line.empty() and line.back() == '\n')
+                    line.pop_back();
+                result.push_back(line);
+            }
+            return result;
+        }
+
+    private:
+        FILE* file_;
+        FILE* previous_;
+    };
+
+
+    class AsyncLogTest : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        AsyncLogTest() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~AsyncLogTest() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+#pragma mark -
+
+    TEST_F(AsyncLogTest, Formatting)
+    {
+        captured_output out;
+        async_logger<utility::log_debug> logger;
+        logger.log_level(utility::LOG_LEVEL_DEBUG);
+
+        const char text[] = "abcdefgh";     // not zero terminated below
+        const size_t len = 3;
+        enum color { red, green = 7 };
+
+        logger.log(utility::LOG_WARNING, "int %d, string %s\n", -42, "test");
+        logger.log(utility::LOG_WARNING, "precision %.*s|%.2s", len, text, text);
+        logger.log(utility::LOG_WARNING, "hex %x %X %#x", 255u, 0xabcu, -1);
+        logger.log(utility::LOG_WARNING, "float %f %5.2f %e", 1.5, 3.14159f, 1e10);
+        logger.log(utility::LOG_WARNING, "percent 100%% %c", 'x');
+        logger.log(utility::LOG_WARNING, "long %lu %lld", 18446744073709551615ul, -9223372036854775807ll);
+        logger.log(utility::LOG_WARNING, "width [%5d] [%-5s] [%*d]", 12, "ab", 4, 7);
+        logger.log(utility::LOG_WARNING, "enum %d, missing %d %s", green);
+        logger.log(utility::LOG_WARNING, "no arguments");
+
+        std::vector<std::string> lines = out.lines();
+        ASSERT_EQ(9, lines.size());
+        EXPECT_EQ("int -42, string test", lines[0]);
+        EXPECT_EQ("precision abc|ab", lines[1]);
+        EXPECT_EQ("hex ff ABC 0xffffffff", lines[2]);
+        EXPECT_EQ("float 1.500000  3.14 1.000000e+10", lines[3]);
+        EXPECT_EQ("percent 100% x", lines[4]);
+        EXPECT_EQ("long 18446744073709551615 -9223372036854775807", lines[5]);
+        EXPECT_EQ("width [   12] [ab   ] [   7]", lines[6]);
+        EXPECT_EQ("enum 7, missing 0 <?>", lines[7]);
+        EXPECT_EQ("no arguments", lines[8]);
+    }
+
+
+    TEST_F(AsyncLogTest, SeverityFilter)
+    {
+        captured_output out;
+        async_logger<utility::log_warning> logger;
+
+        logger.log(utility::LOG_ERROR, "error");
+        logger.log(utility::LOG_WARNING, "warning");
+        // Compiled away:
+        logger.log(utility::LOG_DEBUG, "debug");
+        logger.log(utility::LOG_TRACE, "trace");
+
+        logger.log_level(utility::LOG_ERROR);
+        EXPECT_EQ(utility::LOG_LEVEL_ERROR, logger.log_level());
+        logger.log(utility::LOG_WARNING, "warning");
+        logger.log(utility::LOG_FATAL, "fatal");
+
+        // The level cannot exceed the compile time maximum:
+        logger.log_level(utility::LOG_LEVEL_DEBUG);
+        EXPECT_EQ(utility::LOG_LEVEL_WARNING, logger.log_level());
+
+        std::vector<std::string> lines = out.lines();
+        ASSERT_EQ(3, lines.size());
+        EXPECT_EQ("error", lines[0]);
+        EXPECT_EQ("warning", lines[1]);
+        EXPECT_EQ("fatal", lines[2]);
+    }
+
+
+    TEST_F(AsyncLogTest, MultipleThreads)
+    {
+        captured_output out;
+        const int NumThreads = 4;
+        const int N = 200;  // fits into the ring buffer of a thread
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < NumThreads; ++t) {
+            threads.push_back(std::thread([t]() {
+                async_logger<utility::log_warning> logger;
+                for (int i = 0; i < N; ++i) {
+                    logger.log(utility::LOG_WARNING, "thread %d message %d", t, i);
+                }
+            }));
+        }
+        for (std::thread& t : threads)
+            t.join();
+
+        std::vector<std::string> lines = out.lines();
+        std::vector<int> next(NumThreads, 0);
+        int count = 0;
+        for (const std::string& line : lines) {
+            int t, i;
+            if (sscanf(line.c_str(), "thread %d message %d", &t, &i) != 2)
+                continue;
+            ASSERT_LE(0, t);
+            ASSERT_GT(NumThreads, t);
+            // The messages of a thread keep their order:
+            EXPECT_EQ(next[t], i);
+            next[t] = i + 1;
+            ++count;
+        }
+        EXPECT_EQ(NumThreads * N, count);
+    }
+
+
+    TEST_F(AsyncLogTest, WrittenByBackgroundThread)
+    {
+        // The background thread is woken up when a message has been logged;
+        // no flush is required:
+        captured_output out;
+        async_logger<utility::log_warning> logger;
+        for (int i = 0; i < 3; ++i) {
+            const long size = out.size();
+            logger.log(utility::LOG_WARNING, "message %d", i);
+            for (int n = 0; n < 500 and out.size() == size; ++n) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            EXPECT_LT(size, out.size());
+        }
+        std::vector<std::string> lines = out.lines();
+        ASSERT_EQ(3, lines.size());
+        EXPECT_EQ("message 2", lines[2]);
+    }
+
+
+    TEST_F(AsyncLogTest, DroppedMessages)
+    {
+        captured_output out;
+        const uint64_t dropped = async_log_service::instance().dropped();
+        const int N = 100000;
+        std::thread t([]() {
+            async_logger<utility::log_warning> logger;
+            for (int i = 0; i < N; ++i) {
+                logger.log(utility::LOG_WARNING, "message %d", i);
+            }
+        });
+        t.join();
+
+        // Logging never blocks; messages which do not fit into the ring
+        // buffer are dropped and reported:
+        std::vector<std::string> lines = out.lines();
+        const uint64_t n = async_log_service::instance().dropped() - dropped;
+        uint64_t written = 0;
+        bool reported = false;
+        for (const std::string& line : lines) {
+            if (line.find("log messages dropped") != std::string::npos)
+                reported = true;
+            else
+                ++written;
+        }
+        EXPECT_EQ(uint64_t(N), written + n);
+        EXPECT_EQ(n > 0, reported);
+    }
+
+}
@@ -7,6 +7,7 @@
 //
 
 #include "json/utility/base64.hpp"
+#include "json/simd/cpu_features.hpp"
 #include <gtest/gtest.h>
 
 #include <iostream>
@@ -16,6 +17,8 @@
 #include <iterator>
 #include <string>
 #include <cstdlib>
+#include <cstdio>
+#include <random>
 
 
 // RFC 4648
@@ -43,6 +46,74 @@ namespace {
     }
     
         
+    // Encodes one byte at a time.
+    std::string
+    encode_reference(const std::string& in)
+    {
+        const char base64chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string result;
+        uint32_t n = 0;
+        int bits = 0;
+        for (char c : in) {
+            n = (n << 8) | static_cast<uint8_t>(c);
+            bits += 8;
+            while (bits >= 6) {
+                bits -= 6;
+                result.push_back(base64chars[(n >> bits) & 0x3F]);
+            }
+        }
+        if (bits > 0) {
+            result.push_back(base64chars[(n << (6 - bits)) & 0x3F]);
+        }
+        while (result.size() % 4)
+            result.push_back('=');
+        return result;
+    }
+    
+    std::string
+    random_bytes(std::mt19937& gen, size_t size)
+    {
+        std::uniform_int_distribution<int> byte_dist(0, 255);
+        std::string s(size, 0);
+        for (char& c : s) {
+            c = static_cast<char>(byte_dist(gen));
+        }
+        return s;
+    }
+    
+    // Decodes the chunks and returns the result, or the error code as string.
+    std::string
+    decode_chunks(const std::vector<std::string>& chunks, json::utility::base64_mode mode)
+    {
+        using json::utility::base64_decoder;
+        base64_decoder decoder(mode);
+        std::string result;
+        for (const std::string& chunk : chunks) {
+            const char* last = chunk.data() + chunk.size();
+            if (decoder.decode(chunk.data(), last, [&result](const char* p, size_t n) { result.append(p, n); }) != last) {
+                break;
+            }
+        }
+        if (not decoder.finish()) {
+            return "error " + std::to_string(decoder.error());
+        }
+        EXPECT_EQ(result.size(), decoder.size());
+        return result;
+    }
+    
+    // The instruction set levels the kernels implement.
+    std::vector<json::simd::isa> base64_levels()
+    {
+        using json::simd::isa;
+        std::vector<isa> levels = { isa::scalar };
+        if (json::simd::detected_isa() >= isa::ssse3)
+            levels.push_back(isa::ssse3);
+        if (json::simd::detected_isa() >= isa::avx2)
+            levels.push_back(isa::avx2);
+        return levels;
+    }
+    
+        
     class base64_test : public ::testing::Test {
     protected:
         // You can remove any or all of the following functions if its body
@@ -174,4 +245,144 @@ namespace {
         }
     }
 
-}
\ No newline at end of file
+    
+    TEST_F(base64_test, KernelsAtEachLevel) {
+        
+        using namespace json::simd;
+        const isa active = active_isa();
+        std::mt19937 gen(46);
+        std::vector<std::string> inputs;
+        for (size_t size = 0; size < 200; ++size) {
+            inputs.push_back(random_bytes(gen, size));
+        }
+        inputs.push_back(random_bytes(gen, 100000));
+        
+        for (isa level : base64_levels()) {
+            set_active_isa(level);
+            for (const std::string& in : inputs) {
+                const std::string b = encode_reference(in);
+                ASSERT_EQ(b, encode(in)) << "level: " << isa_name(level) << " size: " << in.size();
+                ASSERT_EQ(in, decode(b)) << "level: " << isa_name(level) << " size: " << in.size();
+                
+                std::string from_pointers;
+                json::utility::decodeBase64(b.data(), b.data() + b.size(), std::back_inserter(from_pointers));
+                ASSERT_EQ(in, from_pointers);
+            }
+            
+            // Every byte value at each position of a sequence decoded by the
+            // vector kernels:
+            const std::string b = encode_reference(random_bytes(gen, 96));
+            for (size_t pos = 0; pos < b.size(); ++pos) {
+                for (int ch = 0; ch < 256; ++ch) {
+                    std::string s = b;
+                    s[pos] = static_cast<char>(ch);
+                    json::utility::base64_decoder decoder;
+                    std::string result;
+                    const char* p = decoder.decode(s.data(), s.data() + s.size(),
+                                                   [&result](const char* data, size_t n) { result.append(data, n); });
+                    if (json::utility::base64_detail::lookup(static_cast<uint8_t>(ch)) >= 0) {
+                        ASSERT_EQ(s.data() + s.size(), p);
+                        ASSERT_EQ(encode_reference(result), s);
+                    }
+                    else if (ch != '=') {
+                        ASSERT_EQ(s.data() + pos, p) << "level: " << isa_name(level) << " pos: " << pos << " ch: " << ch;
+                        ASSERT_EQ(json::utility::base64_decoder::ErrorInvalidCharacter, decoder.error());
+                    }
+                }
+            }
+        }
+        set_active_isa(active);
+    }
+    
+    
+    TEST_F(base64_test, ChunkedDecoding) {
+        
+        using json::utility::Base64Strict;
+        using json::utility::Base64IgnoreWhitespace;
+        
+        std::mt19937 gen(47);
+        for (int i = 0; i < 200; ++i) {
+            std::uniform_int_distribution<size_t> size_dist(0, i < 100 ? 100 : 20000);
+            const std::string in = random_bytes(gen, size_dist(gen));
+            const std::string b = encode_reference(in);
+            
+            // Split into chunks of random size:
+            std::uniform_int_distribution<size_t> chunk_dist(1, i % 2 ? 7 : 5000);
+            std::vector<std::string> chunks;
+            for (size_t pos = 0; pos < b.size(); ) {
+                const size_t n = std::min(b.size() - pos, chunk_dist(gen));
+                chunks.push_back(b.substr(pos, n));
+                pos += n;
+            }
+            EXPECT_EQ(in, decode_chunks(chunks, Base64Strict));
+            
+            // Line breaks every 76 characters and trailing white space:
+            std::string wrapped;
+            for (size_t pos = 0; pos < b.size(); pos += 76) {
+                wrapped += b.substr(pos, 76);
+                wrapped += "\r\n";
+            }
+            wrapped += " \t";
+            EXPECT_EQ(in, decode_chunks({wrapped}, Base64IgnoreWhitespace));
+            // Invalid character, or spurious bytes after the padding:
+            EXPECT_EQ(0, decode_chunks({wrapped}, Base64Strict).find("error"));
+        }
+    }
+    
+    
+    TEST_F(base64_test, DecoderErrors) {
+        
+        using json::utility::Base64Strict;
+        using json::utility::Base64IgnoreWhitespace;
+        
+        EXPECT_EQ("f", decode_chunks({"Zg", "=", "="}, Base64Strict));
+        EXPECT_EQ("fo", decode_chunks({"Zm", "8", "="}, Base64Strict));
+        EXPECT_EQ("f", decode_chunks({"Z", "g ", "\n=", " =\n"}, Base64IgnoreWhitespace));
+        EXPECT_EQ("", decode_chunks({}, Base64Strict));
+        
+        EXPECT_EQ("error -4", decode_chunks({"Zg"}, Base64Strict));
+        EXPECT_EQ("error -4", decode_chunks({"Zg="}, Base64Strict));
+        EXPECT_EQ("error -4", decode_chunks({"Zm9vY"}, Base64Strict));
+        EXPECT_EQ("error -3", decode_chunks({"Zg=a"}, Base64Strict));
+        EXPECT_EQ("error -2", decode_chunks({"Zg==", "Zg=="}, Base64Strict));
+        EXPECT_EQ("error -2", decode_chunks({"Zm8=a"}, Base64IgnoreWhitespace));
+        EXPECT_EQ("error -1", decode_chunks({"Z==="}, Base64Strict));
+        EXPECT_EQ("error -1", decode_chunks({"Zm9v=="}, Base64Strict));
+        EXPECT_EQ("error -1", decode_chunks({"Zm9v", "Y*=="}, Base64Strict));
+        
+        EXPECT_THROW(decode("Zm9vYmF"), std::runtime_error);
+        EXPECT_THROW(decode("Zm9vYmE=Zg=="), std::runtime_error);
+        EXPECT_THROW(decode("Zm9v\nYmFy"), std::runtime_error);
+        
+        const std::string wrapped = "Zm9v\nYmFy";
+        std::string result;
+        json::utility::decodeBase64(wrapped.begin(), wrapped.end(), std::back_inserter(result), Base64IgnoreWhitespace);
+        EXPECT_EQ("foobar", result);
+    }
+    
+    
+    TEST_F(base64_test, FileSink) {
+        
+        std::mt19937 gen(48);
+        const std::string in = random_bytes(gen, 300000);
+        const std::string b = encode(in);
+        
+        FILE* file = tmpfile();
+        ASSERT_TRUE(file != NULL);
+        json::utility::base64_decoder decoder;
+        for (size_t pos = 0; pos < b.size(); pos += 1000) {
+            const size_t n = std::min(size_t(1000), b.size() - pos);
+            const char* last = b.data() + pos + n;
+            ASSERT_EQ(last, decoder.decode(b.data() + pos, last, json::utility::base64_file_sink(file)));
+        }
+        ASSERT_TRUE(decoder.finish());
+        EXPECT_EQ(in.size(), decoder.size());
+        
+        std::string out(in.size(), 0);
+        rewind(file);
+        EXPECT_EQ(in.size(), fread(&out[0], 1, out.size(), file));
+        EXPECT_EQ(in, out);
+        fclose(file);
+    }
+
+}
@@ -0,0 +1,286 @@
+//
+//  cpu_dispatch_test.cpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#include "json/simd/cpu_features.hpp"
+#include "json/simd/escape_scan.hpp"
+#include "json/simd/utf8_validate.hpp"
+#include "json/simd/transcode.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+
+namespace {
+
+    using namespace json::simd;
+
+
+    // The test corpora, relative to the working directory of the test.
+    // Files which cannot be found are skipped.
+    const char* corpus_files[] = {
+        "Resources/twitter_timeline.json",
+        "Resources/Test-UTF8.json",
+        "Resources/Test-UTF8-esc.json",
+        "Resources/github_events.json",
+        "Resources/sample.json",
+        "Resources/update-center.json",
+        "Resources/TestJson/pass1.json"
+    };
+
+    bool read_file(const std::string& path, std::string& content)
+    {
+        std::ifstream is(path.c_str(), std::ios::binary);
+        if (not is)
+            return false;
+        content.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    // Returns the corpora, plus random and corrupted UTF-8.
+    std::vector<std::string> test_inputs()
+    {
+        std::vector<std::string> inputs;
+        for (const char* file : corpus_files) {
+            std::string content;
+            if (read_file(file, content) or read_file(std::string("../") + file, content)) {
+                inputs.push_back(content);
+            }
+        }
+
+        static const char* const samples[] = {
+            "a", "0", " ", "\"", "\\", "/", "\t",
+            "\xC3\xA4", "\xDF\xBF", "\xE2\x82\xAC", "\xED\x9F\xBF", "\xEF\xBF\xBF",
+            "\xF0\x9D\x84\x9E", "\xF4\x8F\xBF\xBF"
+        };
+        std::mt19937 gen(35);
+        std::uniform_int_distribution<int> sample_dist(0, sizeof(samples)/sizeof(samples[0]) - 1);
+        std::uniform_int_distribution<int> length_dist(0, 400);
+        std::uniform_int_distribution<int> byte_dist(0x80, 0xFF);
+        for (int i = 0; i < 500; ++i) {
+            std::string s;
+            const std::size_t n = length_dist(gen);
+            while (s.size() < n) {
+                if (sample_dist(gen) == 0) {
+                    s.append(40, 'x');
+                }
+                // Runs of the same character hit the block paths:
+                const char* sample = samples[sample_dist(gen)];
+                for (int k = (i % 4 == 0) ? 8 : 1; k > 0; --k) {
+                    s.append(sample);
+                }
+            }
+            if (i % 3 == 1 and not s.empty()) {
+                std::uniform_int_distribution<std::size_t> pos_dist(0, s.size() - 1);
+                s[pos_dist(gen)] = static_cast<char>(byte_dist(gen));
+            }
+            inputs.push_back(s);
+        }
+        return inputs;
+    }
+
+
+    // The results of all kernels for one input.
+    struct kernel_results
+    {
+        std::vector<std::ptrdiff_t> escapes;
+        std::ptrdiff_t valid_prefix;
+        std::vector<uint16_t> utf16;
+        std::vector<uint32_t> utf32;
+        std::string utf8_from_utf16;
+        std::string utf8_from_utf32;
+        std::vector<uint16_t> utf16_from_utf32;
+        std::vector<uint32_t> utf32_from_utf16;
+
+        bool operator==(const kernel_results& other) const {
+            return escapes == other.escapes and valid_prefix == other.valid_prefix
+                and utf16 == other.utf16 and utf32 == other.utf32
+                and utf8_from_utf16 == other.utf8_from_utf16 and utf8_from_utf32 == other.utf8_from_utf32
+                and utf16_from_utf32 == other.utf16_from_utf32 and utf32_from_utf16 == other.utf32_from_utf16;
+        }
+    };
+
+    // Runs all kernels at the active level.
+    kernel_results run_kernels(const std::string& s)
+    {
+        kernel_results r;
+        const char* first = s.data();
+        const char* last = first + s.size();
+
+        for (int flags = 0; flags < 4; ++flags) {
+            const char* p = first;
+            while (p != last) {
+                p = find_escape(p, last, (flags & 1) != 0, (flags & 2) != 0);
+                r.escapes.push_back(p - first);
+                if (p != last)
+                    ++p;
+            }
+        }
+
+        r.valid_prefix = utf8_valid_prefix(first, last) - first;
+
+        r.utf16.resize(s.size());
+        uint16_t* d16 = r.utf16.data();
+        const char* p = first;
+        utf8_to_utf16(p, last, d16);
+        r.utf16.resize(d16 - r.utf16.data());
+
+        r.utf32.resize(s.size());
+        uint32_t* d32 = r.utf32.data();
+        p = first;
+        utf8_to_utf32(p, last, d32);
+        r.utf32.resize(d32 - r.utf32.data());
+
+        r.utf8_from_utf16.resize(r.utf16.size() * 3);
+        char* d8 = &r.utf8_from_utf16[0];
+        const uint16_t* p16 = r.utf16.data();
+        utf16_to_utf8(p16, static_cast<const uint16_t*>(r.utf16.data() + r.utf16.size()), d8);
+        r.utf8_from_utf16.resize(d8 - r.utf8_from_utf16.data());
+
+        r.utf8_from_utf32.resize(r.utf32.size() * 4);
+        d8 = &r.utf8_from_utf32[0];
+        const uint32_t* p32 = r.utf32.data();
+        utf32_to_utf8(p32, static_cast<const uint32_t*>(r.utf32.data() + r.utf32.size()), d8);
+        r.utf8_from_utf32.resize(d8 - r.utf8_from_utf32.data());
+
+        r.utf16_from_utf32.resize(r.utf32.size() * 2);
+        d16 = r.utf16_from_utf32.data();
+        p32 = r.utf32.data();
+        utf32_to_utf16(p32, static_cast<const uint32_t*>(r.utf32.data() + r.utf32.size()), d16);
+        r.utf16_from_utf32.resize(d16 - r.utf16_from_utf32.data());
+
+        r.utf32_from_utf16.resize(r.utf16.size());
+        d32 = r.utf32_from_utf16.data();
+        p16 = r.utf16.data();
+        utf16_to_utf32(p16, static_cast<const uint16_t*>(r.utf16.data() + r.utf16.size()), d32);
+        r.utf32_from_utf16.resize(d32 - r.utf32_from_utf16.data());
+
+        return r;
+    }
+
+
+    class CpuDispatchTest : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        CpuDispatchTest() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~CpuDispatchTest() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+            saved_level_ = active_isa();
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+            set_active_isa(saved_level_);
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+        isa saved_level_;
+    };
+
+
+
+    TEST_F(CpuDispatchTest, LevelNames)
+    {
+        const isa levels[] = {
+            isa::scalar, isa::neon, isa::sse2, isa::ssse3, isa::sse4_2, isa::avx2, isa::avx512
+        };
+        for (isa level : levels) {
+            isa parsed = isa::scalar;
+            EXPECT_TRUE(parse_isa(isa_name(level), parsed));
+            EXPECT_EQ(static_cast<int>(level), static_cast<int>(parsed));
+        }
+        isa parsed = isa::sse2;
+        EXPECT_FALSE(parse_isa("mmx", parsed));
+        EXPECT_EQ(static_cast<int>(isa::sse2), static_cast<int>(parsed));
+    }
+
+
+    TEST_F(CpuDispatchTest, SetActiveLevelIsLimitedToDetectedLevel)
+    {
+        EXPECT_TRUE(active_isa() <= detected_isa());
+        EXPECT_EQ(static_cast<int>(isa::scalar), static_cast<int>(set_active_isa(isa::scalar)));
+        EXPECT_EQ(static_cast<int>(isa::scalar), static_cast<int>(active_isa()));
+        EXPECT_EQ(static_cast<int>(detected_isa()), static_cast<int>(set_active_isa(isa::avx512)));
+        EXPECT_EQ(static_cast<int>(detected_isa()), static_cast<int>(active_isa()));
+    }
+
+
+    TEST_F(CpuDispatchTest, ScalarKernelsMatchReference)
+    {
+        set_active_isa(isa::scalar);
+        const std::vector<std::string> inputs = test_inputs();
+        for (std::size_t i = 0; i < inputs.size(); ++i) {
+            const std::string& s = inputs[i];
+            const char* first = s.data();
+            const char* last = first + s.size();
+            for (int flags = 0; flags < 4; ++flags) {
+                for (const char* p = first; p != last; ++p) {
+                    const char* expected = detail::find_escape_scalar(p, last, (flags & 1) != 0, (flags & 2) != 0);
+                    ASSERT_EQ(expected, find_escape(p, last, (flags & 1) != 0, (flags & 2) != 0)) << "input: " << i;
+                    p = expected;
+                    if (p == last)
+                        break;
+                }
+            }
+            ASSERT_EQ(detail::utf8_valid_prefix_scalar(first, last), utf8_valid_prefix(first, last)) << "input: " << i;
+        }
+    }
+
+
+    TEST_F(CpuDispatchTest, EveryLevelMatchesScalarKernels)
+    {
+        const std::vector<std::string> inputs = test_inputs();
+        std::vector<kernel_results> expected;
+        set_active_isa(isa::scalar);
+        for (const std::string& s : inputs) {
+            expected.push_back(run_kernels(s));
+        }
+
+        const isa levels[] = {
+            isa::neon, isa::sse2, isa::ssse3, isa::sse4_2, isa::avx2, isa::avx512
+        };
+        for (isa level : levels) {
+            if (level > detected_isa())
+                continue;
+            set_active_isa(level);
+            for (std::size_t i = 0; i < inputs.size(); ++i) {
+                ASSERT_TRUE(expected[i] == run_kernels(inputs[i]))
+                    << "level: " << isa_name(level) << ", input: " << i;
+            }
+        }
+    }
+
+}
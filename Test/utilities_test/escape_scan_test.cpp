@@ -0,0 +1,198 @@
+//
+//  escape_scan_test.cpp
+//
+//  Created by agent on 10/18/26.
+//  Copyright 2026 agent
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#include "json/simd/escape_scan.hpp"
+#include "json/generator/generate.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <iterator>
+#include <random>
+
+
+namespace {
+
+    using json::simd::find_escape;
+    using json::simd::needs_escape;
+    using json::unicode::UTF_8_encoding_tag;
+    using json::unicode::UTF_16_encoding_tag;
+    using json::generator_internal::encode_string;
+
+
+    const char* find_escape_reference(const char* first, const char* last, bool escapeSolidus, bool escapeNonASCII)
+    {
+        while (first != last and not needs_escape(static_cast<unsigned char>(*first), escapeSolidus, escapeNonASCII)) {
+            ++first;
+        }
+        return first;
+    }
+
+
+    class EscapeScanTest : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        EscapeScanTest() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~EscapeScanTest() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+
+    TEST_F(EscapeScanTest, EveryByteAtEveryPosition)
+    {
+        // Place each byte value at each position of a buffer with plain ASCII,
+        // and at different alignments.
+        for (int pos = 0; pos < 40; ++pos) {
+            for (int ch = 0; ch < 256; ++ch) {
+                char buffer[48];
+                std::memset(buffer, 'a', sizeof(buffer));
+                buffer[pos] = static_cast<char>(ch);
+                for (int offset = 0; offset < 3; ++offset) {
+                    const char* first = buffer + offset;
+                    const char* last = buffer + sizeof(buffer);
+                    for (int flags = 0; flags < 4; ++flags) {
+                        bool solidus = (flags & 1) != 0;
+                        bool nonascii = (flags & 2) != 0;
+                        ASSERT_EQ(find_escape_reference(first, last, solidus, nonascii),
+                                  find_escape(first, last, solidus, nonascii))
+                            << "pos: " << pos << " ch: " << ch << " offset: " << offset << " flags: " << flags;
+                    }
+                }
+            }
+        }
+    }
+
+
+    TEST_F(EscapeScanTest, RandomStrings)
+    {
+        std::mt19937 gen(1);
+        std::uniform_int_distribution<int> length_dist(0, 200);
+        std::uniform_int_distribution<int> char_dist(0x20, 0x7E);
+        std::uniform_int_distribution<int> any_dist(0, 255);
+        for (int i = 0; i < 2000; ++i) {
+            std::string s(length_dist(gen), ' ');
+            for (char& c : s) {
+                c = static_cast<char>(char_dist(gen));
+            }
+            if (not s.empty() and (i % 2)) {
+                s[any_dist(gen) % s.size()] = static_cast<char>(any_dist(gen));
+            }
+            const char* first = s.data();
+            const char* last = first + s.size();
+            EXPECT_EQ(find_escape_reference(first, last, false, false), find_escape(first, last, false, false));
+            EXPECT_EQ(find_escape_reference(first, last, true, true), find_escape(first, last, true, true));
+        }
+    }
+
+
+    TEST_F(EscapeScanTest, EncodeStringFromPointer)
+    {
+        // The result of the scanning encoder (pointer input) shall equal the
+        // result of the character-wise encoder (iterator input).
+        const std::string inputs[] = {
+            "",
+            "plain ascii text which is longer than sixteen bytes",
+            "quote \" backslash \\ solidus / tab \t newline \n",
+            "control \x01\x02\x1F characters",
+            "\xC3\xA4\xC3\xB6\xC3\xBC non-ascii \xE2\x82\xAC and \xF0\x9D\x84\x9E"
+        };
+        for (const std::string& in : inputs) {
+            for (unsigned int options = 0; options < 2; ++options) {
+                std::string expected;
+                {
+                    std::string::const_iterator first = in.begin();
+                    std::back_insert_iterator<std::string> dest(expected);
+                    EXPECT_EQ(0, encode_string(first, in.end(), UTF_8_encoding_tag(), dest, UTF_8_encoding_tag(), options));
+                }
+                std::string result;
+                {
+                    const char* first = in.data();
+                    std::back_insert_iterator<std::string> dest(result);
+                    EXPECT_EQ(0, encode_string(first, in.data() + in.size(), UTF_8_encoding_tag(), dest, UTF_8_encoding_tag(), options));
+                }
+                EXPECT_EQ(expected, result);
+
+                std::string escaped_expected;
+                {
+                    std::string::const_iterator first = in.begin();
+                    std::back_insert_iterator<std::string> dest(escaped_expected);
+                    encode_string(first, in.end(), UTF_8_encoding_tag(), dest, json::unicode::escaped_unicode_encoding, options);
+                }
+                std::string escaped;
+                {
+                    const char* first = in.data();
+                    std::back_insert_iterator<std::string> dest(escaped);
+                    encode_string(first, in.data() + in.size(), UTF_8_encoding_tag(), dest, json::unicode::escaped_unicode_encoding, options);
+                }
+                EXPECT_EQ(escaped_expected, escaped);
+                for (char c : escaped) {
+                    EXPECT_TRUE(static_cast<unsigned char>(c) < 0x80u);
+                }
+
+                std::u16string utf16_expected;
+                {
+                    std::string::const_iterator first = in.begin();
+                    std::back_insert_iterator<std::u16string> dest(utf16_expected);
+                    encode_string(first, in.end(), UTF_8_encoding_tag(), dest, UTF_16_encoding_tag(), options);
+                }
+                std::u16string utf16;
+                {
+                    const char* first = in.data();
+                    std::back_insert_iterator<std::u16string> dest(utf16);
+                    encode_string(first, in.data() + in.size(), UTF_8_encoding_tag(), dest, UTF_16_encoding_tag(), options);
+                }
+                EXPECT_TRUE(utf16_expected == utf16);
+            }
+        }
+    }
+
+
+    TEST_F(EscapeScanTest, EncodeControlCharacters)
+    {
+        const std::string in = "\x01\x1F\x10";
+        std::string result;
+        const char* first = in.data();
+        std::back_insert_iterator<std::string> dest(result);
+        encode_string(first, in.data() + in.size(), UTF_8_encoding_tag(), dest, UTF_8_encoding_tag(), 0);
+        EXPECT_EQ(std::string("\\u0001\\u001F\\u0010"), result);
+    }
+
+}
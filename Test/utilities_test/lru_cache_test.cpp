@@ -0,0 +1,199 @@
+//
+//  lru_cache_test.cpp
+//  Test
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "json/utility/lru_cache.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+
+namespace {
+
+    using json::utility::lru_cache;
+    using json::utility::concurrent_lru_cache;
+
+
+    class lru_cache_test : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        lru_cache_test() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~lru_cache_test() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+#pragma mark -
+
+    TEST_F(lru_cache_test, FunctionCache)
+    {
+        int calls = 0;
+        lru_cache<int, int> cache([&calls](const int& k) { ++calls; return k * k; }, 3);
+        EXPECT_EQ(3u, cache.capacity());
+
+        EXPECT_EQ(4, cache(2));
+        EXPECT_EQ(9, cache(3));
+        EXPECT_EQ(4, cache(2));
+        EXPECT_EQ(2, calls);
+        EXPECT_EQ(2u, cache.size());
+
+        for (int i = 0; i < 100; ++i) {
+            EXPECT_EQ(i * i, cache(i));
+        }
+        EXPECT_EQ(3u, cache.size());
+    }
+
+
+    TEST_F(lru_cache_test, InsertFindErase)
+    {
+        lru_cache<int, std::string> cache(4);
+        EXPECT_TRUE(cache.empty());
+        EXPECT_TRUE(cache.find(1) == nullptr);
+
+        cache.insert(1, std::string("one"));
+        cache.insert(2, std::string("two"));
+        ASSERT_TRUE(cache.find(1) != nullptr);
+        EXPECT_EQ("one", *cache.find(1));
+
+        // Inserting an existing key assigns the value:
+        cache.insert(1, std::string("uno"));
+        EXPECT_EQ(2u, cache.size());
+        EXPECT_EQ("uno", *cache.find(1));
+
+        EXPECT_TRUE(cache.erase(1));
+        EXPECT_FALSE(cache.erase(1));
+        EXPECT_TRUE(cache.find(1) == nullptr);
+        EXPECT_EQ(1u, cache.size());
+
+        for (int i = 10; i < 20; ++i) {
+            cache.insert(i, std::to_string(i));
+        }
+        EXPECT_EQ(4u, cache.size());
+        int count = 0;
+        cache.for_each([&count](const int& k, const std::string& v) {
+            EXPECT_EQ(std::to_string(k), v);
+            ++count;
+        });
+        EXPECT_EQ(4, count);
+
+        cache.clear();
+        EXPECT_TRUE(cache.empty());
+        cache.insert(7, std::string("seven"));
+        EXPECT_EQ("seven", *cache.find(7));
+    }
+
+
+    TEST_F(lru_cache_test, RecentlyUsedRecordsSurvive)
+    {
+        // A record which is used repeatedly is not evicted by a scan of
+        // records which are used only once:
+        lru_cache<int, int> cache(4);
+        cache.insert(-1, -1);
+        for (int i = 0; i < 1000; ++i) {
+            ASSERT_TRUE(cache.find(-1) != nullptr) << "at " << i;
+            cache.insert(i, i);
+        }
+        EXPECT_EQ(4u, cache.size());
+    }
+
+
+    TEST_F(lru_cache_test, StringBufferLookup)
+    {
+        typedef lru_cache<std::string, int> cache_t;
+        cache_t cache(16);
+        cache.insert(std::string("alpha"), 1);
+        cache.insert(std::string("beta"), 2);
+
+        const char text[] = "xxalphabeta";
+        ASSERT_TRUE(cache.find(text + 2, 5) != nullptr);
+        EXPECT_EQ(1, *cache.find(text + 2, 5));
+        ASSERT_TRUE(cache.find(text + 7, 4) != nullptr);
+        EXPECT_EQ(2, *cache.find(text + 7, 4));
+        EXPECT_TRUE(cache.find(text + 2, 4) == nullptr);
+        EXPECT_TRUE(cache.erase(std::pair<const char*, std::size_t>(text + 7, 4)));
+        EXPECT_TRUE(cache.find(std::string("beta")) == nullptr);
+    }
+
+
+    TEST_F(lru_cache_test, ConcurrentCache)
+    {
+        typedef concurrent_lru_cache<int, int> cache_t;
+        std::atomic<int> calls(0);
+        cache_t cache([&calls](const int& k) { ++calls; return k + 1; }, 64, 4);
+        EXPECT_EQ(4u, cache.shard_count());
+        EXPECT_EQ(64u, cache.capacity());
+
+        const int Threads = 4;
+        const int N = 20000;
+        std::atomic<bool> correct(true);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < Threads; ++t) {
+            threads.push_back(std::thread([&, t]() {
+                for (int i = 0; i < N; ++i) {
+                    int k = (i * 7 + t) % 48;
+                    if (cache(k) != k + 1)
+                        correct = false;
+                    if (i % 100 == 0) {
+                        cache.insert(1000 + i, 1001 + i);
+                    }
+                }
+            }));
+        }
+        for (std::thread& t : threads)
+            t.join();
+
+        EXPECT_TRUE(correct.load());
+        EXPECT_LE(cache.size(), cache.capacity());
+        EXPECT_LT(calls.load(), Threads * N);
+        int v = 0;
+        if (cache.find(5, v)) {
+            EXPECT_EQ(6, v);
+        }
+        cache.clear();
+        EXPECT_EQ(0u, cache.size());
+        EXPECT_FALSE(cache.find(5, v));
+    }
+
+
+    TEST_F(lru_cache_test, ConcurrentCacheStringBufferLookup)
+    {
+        concurrent_lru_cache<std::string, int> cache(32);
+        cache.insert(std::string("key"), 42);
+        const char text[] = "a key";
+        int v = 0;
+        EXPECT_TRUE(cache.find(text + 2, 3, v));
+        EXPECT_EQ(42, v);
+        EXPECT_TRUE(cache.erase(std::string("key")));
+        EXPECT_FALSE(cache.find(text + 2, 3, v));
+    }
+
+}
@@ -0,0 +1,181 @@
+//
+//  mmap_arena_test.cpp
+//  Test
+//
+//  Created by agent on 10/18/26.
+//
+//
+
+#include "json/utility/mmap_arena.hpp"
+#include <gtest/gtest.h>
+
+#include <vector>
+#include <string>
+#include <new>
+#include <cstring>
+#include <cstdint>
+
+#if defined (JSON_UTILITY_HAS_MMAP_ARENA)
+
+namespace {
+
+    using json::utility::MmapArena;
+    using json::utility::arena_allocator;
+
+    template <typename T>
+    using MmapArenaAllocator = arena_allocator<T, MmapArena>;
+
+
+    class MmapArenaTest : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        MmapArenaTest() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~MmapArenaTest() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+#pragma mark -
+
+    TEST_F(MmapArenaTest, Allocate)
+    {
+        MmapArena arena;
+        EXPECT_EQ(size_t(MmapArena::kDefaultReserveSize), arena.reservedSize());
+        EXPECT_EQ(0, arena.numberAllocatedBlocks());
+        EXPECT_EQ(sizeof(MmapArena), arena.totalSize());
+
+        char* p0 = static_cast<char*>(arena.allocate(1));
+        char* p1 = static_cast<char*>(arena.allocate(100));
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p0) % alignof(std::max_align_t));
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p1) % alignof(std::max_align_t));
+        EXPECT_EQ(p0 + alignof(std::max_align_t), p1);
+        std::memset(p1, 'x', 100);
+        EXPECT_EQ(1, arena.numberAllocatedBlocks());
+        EXPECT_EQ(MmapArena::kCommitSize + sizeof(MmapArena), arena.totalSize());
+
+        // Allocations larger than the commit size are contiguous as well:
+        char* p2 = static_cast<char*>(arena.allocate(5 * MmapArena::kCommitSize));
+        std::memset(p2, 'y', 5 * MmapArena::kCommitSize);
+        const size_t a = alignof(std::max_align_t);
+        EXPECT_EQ(p1 + (100 + a - 1) / a * a, p2);
+        EXPECT_LE(6 * MmapArena::kCommitSize, arena.totalSize());
+        EXPECT_EQ('x', p1[99]);
+    }
+
+
+    TEST_F(MmapArenaTest, ReservedRangeExhausted)
+    {
+        MmapArena arena(4 * MmapArena::kCommitSize);
+        EXPECT_EQ(4 * MmapArena::kCommitSize, arena.reservedSize());
+        arena.allocate(3 * MmapArena::kCommitSize);
+        EXPECT_THROW(arena.allocate(2 * MmapArena::kCommitSize), std::bad_alloc);
+        // The arena is still usable:
+        char* p = static_cast<char*>(arena.allocate(MmapArena::kCommitSize - 64));
+        std::memset(p, 0, MmapArena::kCommitSize - 64);
+    }
+
+
+    TEST_F(MmapArenaTest, ResetReturnsPages)
+    {
+        MmapArena arena(64 * MmapArena::kCommitSize, true);
+        EXPECT_TRUE(arena.hugePages());
+        char* p0 = static_cast<char*>(arena.allocate(3 * MmapArena::kCommitSize));
+        std::memset(p0, 'a', 3 * MmapArena::kCommitSize);
+        const size_t totalSize = arena.totalSize();
+
+        arena.reset();
+        EXPECT_EQ(0, arena.bytesUsed());
+        EXPECT_EQ(totalSize, arena.totalSize());
+        // The memory is reused, and the pages returned to the system read
+        // as zero:
+        char* p1 = static_cast<char*>(arena.allocate(3 * MmapArena::kCommitSize));
+        EXPECT_EQ(p0, p1);
+        EXPECT_EQ(0, p1[0]);
+        EXPECT_EQ(0, p1[3 * MmapArena::kCommitSize - 1]);
+
+        // Retained bytes keep their pages:
+        std::memset(p1, 'b', 3 * MmapArena::kCommitSize);
+        arena.setRetainedBytes(MmapArena::kCommitSize);
+        arena.reset();
+        char* p2 = static_cast<char*>(arena.allocate(3 * MmapArena::kCommitSize));
+        EXPECT_EQ('b', p2[MmapArena::kCommitSize - 1]);
+        EXPECT_EQ(0, p2[MmapArena::kCommitSize]);
+
+        arena.clear();
+        EXPECT_EQ(0, arena.numberAllocatedBlocks());
+        EXPECT_EQ(sizeof(MmapArena), arena.totalSize());
+        char* p3 = static_cast<char*>(arena.allocate(16));
+        EXPECT_EQ(p0, p3);
+        EXPECT_EQ(0, p3[0]);
+
+        // clear() keeps the setting for subsequent resets:
+        EXPECT_EQ(static_cast<size_t>(MmapArena::kCommitSize), arena.retainedBytes());
+        char* p4 = static_cast<char*>(arena.allocate(2 * MmapArena::kCommitSize));
+        std::memset(p4, 'c', 2 * MmapArena::kCommitSize);
+        arena.reset();
+        char* p5 = static_cast<char*>(arena.allocate(2 * MmapArena::kCommitSize));
+        EXPECT_EQ('c', p5[MmapArena::kCommitSize - 1]);
+        EXPECT_EQ(0, p5[MmapArena::kCommitSize]);
+    }
+
+
+    TEST_F(MmapArenaTest, MarkAndRewind)
+    {
+        MmapArena arena;
+        arena.allocate(100);
+        MmapArena::Marker m = arena.mark();
+        const size_t bytesUsed = arena.bytesUsed();
+        char* p0 = static_cast<char*>(arena.allocate(16));
+        arena.allocate(3 * MmapArena::kCommitSize);
+
+        arena.rewind(m);
+        EXPECT_EQ(bytesUsed, arena.bytesUsed());
+        char* p1 = static_cast<char*>(arena.allocate(16));
+        EXPECT_EQ(p0, p1);
+    }
+
+
+    TEST_F(MmapArenaTest, ArenaAllocator)
+    {
+        typedef MmapArenaAllocator<char> char_allocator;
+        typedef std::basic_string<char, std::char_traits<char>, char_allocator> string;
+        typedef MmapArenaAllocator<string> string_allocator;
+
+        MmapArena arena;
+        {
+            std::vector<string, string_allocator> v((string_allocator(arena)));
+            for (int i = 0; i < 10000; ++i) {
+                v.emplace_back(100, static_cast<char>('a' + i % 26), char_allocator(arena));
+            }
+            EXPECT_EQ(10000, v.size());
+            EXPECT_EQ(std::string(100, 'z'), v[25].c_str());
+            EXPECT_LT(10000 * 100, arena.bytesUsed());
+        }
+        arena.reset();
+        EXPECT_EQ(0, arena.bytesUsed());
+    }
+
+}
+
+#endif  // JSON_UTILITY_HAS_MMAP_ARENA
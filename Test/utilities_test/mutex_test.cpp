@@ -0,0 +1,104 @@
+//
+//  mutex_test.cpp
+//  Test
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+#include "json/utility/mutex.hpp"
+
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <chrono>
+
+
+
+
+namespace {
+
+    using json::utility::mutex;
+
+    class mutex_test : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        mutex_test() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~mutex_test() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+    TEST_F(mutex_test, TryLock) {
+        mutex m;
+        EXPECT_TRUE(m.try_lock());
+        EXPECT_FALSE(m.try_lock());
+        m.unlock();
+        {
+            std::lock_guard<mutex> lock(m);
+            EXPECT_FALSE(m.try_lock());
+        }
+        EXPECT_TRUE(m.try_lock());
+        m.unlock();
+    }
+
+
+    TEST_F(mutex_test, MutualExclusion) {
+        // A non-atomic counter incremented by several threads:
+        const int N = 100000;
+        const int Threads = 4;
+        mutex m;
+        long counter = 0;
+        std::vector<std::thread> threads;
+        for (int i = 0; i < Threads; ++i) {
+            threads.push_back(std::thread([&]() {
+                for (int k = 0; k < N; ++k) {
+                    std::lock_guard<mutex> lock(m);
+                    ++counter;
+                }
+            }));
+        }
+        for (std::thread& t : threads)
+            t.join();
+        EXPECT_EQ(static_cast<long>(N) * Threads, counter);
+    }
+
+
+    TEST_F(mutex_test, LockBlocksUntilUnlocked) {
+        mutex m;
+        m.lock();
+        bool entered = false;
+        std::thread t([&]() {
+            std::lock_guard<mutex> lock(m);
+            entered = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        EXPECT_FALSE(entered);
+        m.unlock();
+        t.join();
+        EXPECT_TRUE(entered);
+    }
+
+}
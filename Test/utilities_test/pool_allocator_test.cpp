@@ -0,0 +1,217 @@
+//
+//  pool_allocator_test.cpp
+//  Test
+//
+//  Created by agent on 10/18/26.
+//
+//
+
+#include "json/utility/pool_allocator.hpp"
+#include "json/value/value.hpp"
+#include "json/parser/parse.hpp"
+#include "json/parser/value_generator.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <set>
+#include <thread>
+#include <cstring>
+
+
+namespace {
+
+    using json::utility::SlabPool;
+    using json::utility::pool_allocator;
+
+
+    class PoolAllocatorTest : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        PoolAllocatorTest() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~PoolAllocatorTest() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+#pragma mark -
+
+    TEST_F(PoolAllocatorTest, SizeClasses)
+    {
+        EXPECT_EQ(0, SlabPool::sizeClass(0));
+        EXPECT_EQ(size_t(SlabPool::kNumClasses - 1), SlabPool::sizeClass(SlabPool::kMaxSize));
+        EXPECT_EQ(size_t(SlabPool::kMaxSize), SlabPool::classSize(SlabPool::kNumClasses - 1));
+        for (size_t n = 1; n <= SlabPool::kMaxSize; ++n) {
+            const size_t c = SlabPool::sizeClass(n);
+            ASSERT_LT(c, size_t(SlabPool::kNumClasses));
+            ASSERT_LE(n, SlabPool::classSize(c)) << "size " << n;
+            if (c > 0) {
+                ASSERT_GT(n, SlabPool::classSize(c - 1)) << "size " << n;
+            }
+        }
+    }
+
+
+    TEST_F(PoolAllocatorTest, RecyclesNodes)
+    {
+        const int N = 10000;
+        std::vector<void*> v;
+        for (int i = 0; i < N; ++i) {
+            void* p = SlabPool::allocate(48);
+            std::memset(p, 0xab, 48);
+            v.push_back(p);
+        }
+        const size_t totalSize = SlabPool::totalSize();
+        std::set<void*> first(v.begin(), v.end());
+        EXPECT_EQ(N, first.size());
+
+        for (int round = 0; round < 10; ++round) {
+            for (void* p : v) {
+                SlabPool::deallocate(p, 48);
+            }
+            v.clear();
+            for (int i = 0; i < N; ++i) {
+                v.push_back(SlabPool::allocate(40));
+            }
+        }
+        // Nodes of the same size class have been reused:
+        EXPECT_EQ(totalSize, SlabPool::totalSize());
+        for (void* p : v) {
+            SlabPool::deallocate(p, 40);
+        }
+
+        // Large requests do not use the slabs:
+        void* p = SlabPool::allocate(SlabPool::kMaxSize + 1);
+        std::memset(p, 0, SlabPool::kMaxSize + 1);
+        SlabPool::deallocate(p, SlabPool::kMaxSize + 1);
+        EXPECT_EQ(totalSize, SlabPool::totalSize());
+    }
+
+
+    TEST_F(PoolAllocatorTest, ThreadCacheFlush)
+    {
+        const size_t c = SlabPool::sizeClass(256);
+        const int N = 1000;
+        std::vector<void*> v;
+        std::thread t([&v]() {
+            for (int i = 0; i < N; ++i) {
+                v.push_back(SlabPool::allocate(256));
+            }
+            for (void* p : v) {
+                SlabPool::deallocate(p, 256);
+            }
+            // The thread cache is returned when the thread exits.
+        });
+        t.join();
+        EXPECT_LE(size_t(N), SlabPool::centralFreeNodes(c));
+
+        SlabPool::flushThreadCache();
+        const size_t nodes = SlabPool::centralFreeNodes(c);
+        void* p = SlabPool::allocate(256);
+        EXPECT_GT(nodes, SlabPool::centralFreeNodes(c));
+        SlabPool::deallocate(p, 256);
+    }
+
+
+    TEST_F(PoolAllocatorTest, CrossThreadDeallocation)
+    {
+        // Nodes allocated by one thread and freed by another are recycled by
+        // the latter:
+        const int Rounds = 50;
+        const int N = 2000;
+        std::vector<std::vector<void*>> batches(Rounds);
+        std::thread producer([&batches]() {
+            for (int r = 0; r < Rounds; ++r) {
+                for (int i = 0; i < N; ++i) {
+                    void* p = SlabPool::allocate(24);
+                    std::memset(p, r, 24);
+                    batches[r].push_back(p);
+                }
+            }
+        });
+        producer.join();
+        const size_t totalSize = SlabPool::totalSize();
+
+        std::vector<std::thread> consumers;
+        for (int t = 0; t < 2; ++t) {
+            consumers.push_back(std::thread([&batches, t]() {
+                for (int r = t; r < Rounds; r += 2) {
+                    for (void* p : batches[r]) {
+                        SlabPool::deallocate(p, 24);
+                    }
+                    for (int i = 0; i < N; ++i) {
+                        SlabPool::deallocate(SlabPool::allocate(24), 24);
+                    }
+                }
+            }));
+        }
+        for (std::thread& t : consumers)
+            t.join();
+        EXPECT_EQ(totalSize, SlabPool::totalSize());
+    }
+
+
+    TEST_F(PoolAllocatorTest, MutableJsonValue)
+    {
+        typedef pool_allocator<void> allocator_t;
+        typedef json::value<allocator_t> Value;
+        typedef Value::object_type Object;
+        typedef Value::string_type String;
+
+        // pool_allocator is stateless, and not wrapped into a scoped allocator:
+        EXPECT_TRUE((std::is_same<pool_allocator<Value>, Value::array_type::allocator_type>::value));
+        EXPECT_TRUE(allocator_t() == pool_allocator<int>());
+
+        Value v(Value::emplace_object);
+        Object& o = v.as<Object>();
+        size_t totalSize = 0;
+        for (int round = 0; round < 20; ++round) {
+            for (int i = 0; i < 1000; ++i) {
+                o[std::to_string(i).c_str()] = Value(Value::emplace_string, std::string(i % 100, 'x').c_str());
+            }
+            for (int i = 0; i < 1000; i += 2) {
+                o.erase(std::to_string(i).c_str());
+            }
+            EXPECT_EQ(500, o.size());
+            for (int i = 1; i < 1000; i += 2) {
+                o[std::to_string(i).c_str()] = Value(Value::emplace_array);
+            }
+            o.clear();
+            if (round == 0)
+                totalSize = SlabPool::totalSize();
+        }
+        // Replacing and erasing members does not grow the memory:
+        EXPECT_EQ(totalSize, SlabPool::totalSize());
+
+        typedef json::value_generator<json::unicode::UTF_8_encoding_tag, allocator_t> SemanticActions;
+        json::parse_context<const char*, SemanticActions> ctx;
+        const std::string s = "{\"name\": \"abcdefghijklmnopqrstuvwxyz\", \"values\": [1, 2, 3]}";
+        const char* first = s.data();
+        ASSERT_TRUE(ctx.parse(first, s.data() + s.size()));
+        Value result = std::move(ctx.result());
+        ASSERT_TRUE(result.is_object());
+        EXPECT_EQ(String("abcdefghijklmnopqrstuvwxyz"), result.as<Object>()["name"].as<String>());
+    }
+
+}
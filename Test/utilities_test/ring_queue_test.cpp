@@ -0,0 +1,219 @@
+//
+//  ring_queue_test.cpp
+//  Test
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+#include "json/utility/ring_queue.hpp"
+#include "json/utility/syncqueue_streambuf.hpp"
+
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+    using json::utility::ring_queue;
+    using json::utility::basic_ring_queue_streambuf;
+
+
+    class ring_queue_test : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        ring_queue_test() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~ring_queue_test() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+#pragma mark -
+
+    TEST_F(ring_queue_test, Constructor)
+    {
+        typedef ring_queue<int>  queue_t;
+
+        queue_t q(4);
+        EXPECT_EQ(4u, q.capacity());
+        EXPECT_EQ(0u, q.size());
+        EXPECT_TRUE(q.empty());
+    }
+
+
+    TEST_F(ring_queue_test, PutGetUpToCapacity)
+    {
+        typedef ring_queue<int>  queue_t;
+        typedef std::pair<queue_t::result_type, queue_t::value_type> get_result_t;
+
+        queue_t q(3);
+        get_result_t r = q.get(0.01);
+        EXPECT_EQ(queue_t::TIMEOUT_NOTHING_OFFERED, r.first);
+
+        // The producer may put capacity() items ahead without blocking:
+        for (int lap = 0; lap < 5; ++lap) {
+            EXPECT_EQ(queue_t::OK, q.put(1, 0));
+            EXPECT_EQ(queue_t::OK, q.put(2, 0));
+            EXPECT_TRUE(q.try_put(3));
+            EXPECT_EQ(3u, q.size());
+            EXPECT_EQ(queue_t::TIMEOUT_NOT_DELIVERED, q.put(4, 0.01));
+            EXPECT_FALSE(q.try_put(4));
+
+            r = q.get(0);
+            EXPECT_EQ(queue_t::OK, r.first);
+            EXPECT_EQ(1, r.second);
+            EXPECT_EQ(2, q.get());
+            int v = 0;
+            EXPECT_TRUE(q.try_get(v));
+            EXPECT_EQ(3, v);
+            EXPECT_FALSE(q.try_get(v));
+            EXPECT_TRUE(q.empty());
+        }
+    }
+
+
+    TEST_F(ring_queue_test, MoveOnlyItems)
+    {
+        typedef ring_queue<std::unique_ptr<int> >  queue_t;
+
+        std::weak_ptr<int> observer;
+        {
+            queue_t q(2);
+            q.put(std::unique_ptr<int>(new int(7)));
+            std::unique_ptr<int> p = q.get();
+            ASSERT_TRUE(p != nullptr);
+            EXPECT_EQ(7, *p);
+        }
+        {
+            // Items left in the queue are destroyed with the queue:
+            std::shared_ptr<int> sp(new int(1));
+            observer = sp;
+            ring_queue<std::shared_ptr<int> > q(2);
+            q.put(std::move(sp));
+        }
+        EXPECT_TRUE(observer.expired());
+    }
+
+
+    TEST_F(ring_queue_test, ConcurrentOneProducerOneConsumer)
+    {
+        typedef ring_queue<int>  queue_t;
+        queue_t queue(8);
+
+        const int N = 200000;
+        std::thread producer([&]() {
+            for (int i = 0; i < N; ++i) {
+                queue.put(i);
+            }
+            queue.put(-1);
+        });
+
+        bool in_order = true;
+        int count = 0;
+        while (true) {
+            int v = queue.get();
+            if (v == -1)
+                break;
+            if (v != count)
+                in_order = false;
+            ++count;
+        }
+        producer.join();
+        EXPECT_TRUE(in_order);
+        EXPECT_EQ(N, count);
+        EXPECT_TRUE(queue.empty());
+    }
+
+
+    TEST_F(ring_queue_test, ConcurrentMultipleProducersOneConsumer)
+    {
+        // Items are (producer, sequence number) pairs. The items of each
+        // producer shall arrive in order, and none shall be lost.
+        typedef ring_queue<std::pair<int, int>, true>  queue_t;
+        queue_t queue(4);
+
+        const int N = 50000;
+        const int Producers = 4;
+        std::vector<std::thread> producers;
+        for (int p = 0; p < Producers; ++p) {
+            producers.push_back(std::thread([&queue, p]() {
+                for (int i = 0; i < N; ++i) {
+                    queue.put(std::make_pair(p, i));
+                }
+            }));
+        }
+
+        std::vector<int> next(Producers, 0);
+        bool in_order = true;
+        for (int k = 0; k < N * Producers; ++k) {
+            std::pair<int, int> item = queue.get();
+            if (item.second != next[item.first])
+                in_order = false;
+            next[item.first] = item.second + 1;
+        }
+        for (std::thread& t : producers)
+            t.join();
+        EXPECT_TRUE(in_order);
+        for (int p = 0; p < Producers; ++p) {
+            EXPECT_EQ(N, next[p]);
+        }
+        EXPECT_TRUE(queue.empty());
+    }
+
+
+    TEST_F(ring_queue_test, StreambufReadsBuffersInOrder)
+    {
+        typedef std::string                                 buffer_t;
+        typedef basic_ring_queue_streambuf<buffer_t, char>  stream_buffer_t;
+        typedef stream_buffer_t::queue_type                 queue_t;
+
+        queue_t queue(4);
+        std::string expected;
+        std::thread producer([&]() {
+            for (int i = 0; i < 1000; ++i) {
+                queue.put(std::string(1 + i % 37, static_cast<char>('a' + i % 26)));
+            }
+            // An empty buffer indicates EOF:
+            queue.put(std::string());
+        });
+        for (int i = 0; i < 1000; ++i) {
+            expected.append(1 + i % 37, static_cast<char>('a' + i % 26));
+        }
+
+        stream_buffer_t sbuffer(queue);
+        std::istreambuf_iterator<char> eos;
+        std::istreambuf_iterator<char> iit(&sbuffer);
+        std::string result(iit, eos);
+        producer.join();
+
+        EXPECT_FALSE(sbuffer.timeout_occured());
+        EXPECT_EQ(expected, result);
+    }
+
+}
@@ -0,0 +1,114 @@
+//
+//  string_hasher_test.cpp
+//  Test
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "json/utility/string_hasher.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <set>
+#include <cstdint>
+
+
+namespace {
+
+    using json::utility::string_hasher;
+
+
+    class string_hasher_test : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        string_hasher_test() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~string_hasher_test() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+#pragma mark -
+
+    TEST_F(string_hasher_test, ZeroTerminatedEqualsBuffer)
+    {
+        string_hasher<char> hasher;
+        std::string s;
+        for (int len = 0; len < 200; ++len) {
+            EXPECT_EQ(hasher(s.c_str()), hasher(s.data(), s.size())) << "length " << len;
+            s.push_back(static_cast<char>('a' + len % 26));
+        }
+
+        string_hasher<char16_t> hasher16;
+        const char16_t str16[] = u"Köln und Düsseldorf";
+        EXPECT_EQ(hasher16(str16), hasher16(str16, sizeof(str16) / sizeof(char16_t) - 1));
+    }
+
+
+    TEST_F(string_hasher_test, HashDependsOnAllBytes)
+    {
+        // Flipping any bit of strings of various lengths changes the hash:
+        string_hasher<char> hasher;
+        for (std::size_t len = 1; len < 130; ++len) {
+            std::string s(len, 'x');
+            const std::size_t h = hasher(s.data(), s.size());
+            for (std::size_t i = 0; i < len; ++i) {
+                for (int bit = 0; bit < 8; ++bit) {
+                    std::string t = s;
+                    t[i] = static_cast<char>(t[i] ^ (1 << bit));
+                    ASSERT_NE(h, hasher(t.data(), t.size())) << "length " << len << " byte " << i << " bit " << bit;
+                }
+            }
+            // A prefix hashes differently:
+            EXPECT_NE(h, hasher(s.data(), len - 1));
+        }
+    }
+
+
+    TEST_F(string_hasher_test, NoCollisionsForSimilarKeys)
+    {
+        string_hasher<char> hasher;
+        std::set<std::size_t> hashes;
+        const int N = 100000;
+        for (int i = 0; i < N; ++i) {
+            std::string key = "key_" + std::to_string(i);
+            hashes.insert(hasher(key.data(), key.size()));
+        }
+        EXPECT_EQ(static_cast<std::size_t>(N), hashes.size());
+    }
+
+
+    TEST_F(string_hasher_test, Seed)
+    {
+        const std::string s = "a somewhat longer key which spans several words";
+        string_hasher<char> h0;
+        string_hasher<char> h1(12345);
+        string_hasher<char> h2(12345);
+        EXPECT_EQ(json::utility::SEED, h0.seed());
+        EXPECT_NE(h0(s.c_str()), h1(s.c_str()));
+        EXPECT_EQ(h1(s.c_str()), h2(s.data(), s.size()));
+    }
+
+}
@@ -8,15 +8,14 @@
 
 #include <gtest/gtest.h>
 #include "json/utility/synchronous_queue.hpp"
-
-
-#include "json/objc/CFDataBuffer.hpp"
-#include "json/objc/mutex.hpp"
-#include "json/objc/semaphore.hpp"
-#include <dispatch/dispatch.h>
+#include "json/utility/mutex.hpp"
+#include "json/utility/semaphore.hpp"
 
 #include <iostream>
 #include <iomanip>
+#include <thread>
+#include <chrono>
+#include <cstdio>
 
 
 #include <fstream>
@@ -27,8 +26,8 @@
 namespace {
     
     using json::utility::synchronous_queue;
-    using json::objc::gcd::mutex;
-    using json::objc::gcd::semaphore;
+    using json::utility::mutex;
+    using json::utility::semaphore;
     
     
     
@@ -171,15 +170,14 @@ namespace {
         
         // Run one consumer and one producer concurrently:
         
-        dispatch_group_t group = dispatch_group_create();
-        dispatch_queue_t gc_queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+        semaphore group(0);
 
         double timeout = -1;
         
         
         // Producer:
-        __block bool producer_timeout_occured = false;
-        dispatch_group_async(group, gc_queue, ^{
+        bool producer_timeout_occured = false;
+        std::thread producer([&]() {
             put_result_t result;
             for (int i = 0; i <= 1000000; ++i) {
                 if (i != 1000000)
@@ -189,35 +187,37 @@ namespace {
                 if (result != queue_t::OK) {
                     producer_timeout_occured = true;
                     printf("producer timed out at count = %d\n", i);
-                    return;
+                    break;
                 }
             }
-            
+            group.signal();
         });
         
         // Consumer
-        __block bool consumer_timeout_occured = false;
-        dispatch_group_async(group, gc_queue, ^{
+        bool consumer_timeout_occured = false;
+        std::thread consumer([&]() {
             size_t count = 0;
             while (1) {
                 get_result_t result = qp->get(timeout);
                 if (result.first != queue_t::OK) {
                     consumer_timeout_occured = true;
-                    printf("consumer timed out at count = %lu\n", count);
-                    return;
+                    printf("consumer timed out at count = %lu\n", static_cast<unsigned long>(count));
+                    break;
                 } else {
                     ++count;
                     int v = result.second;
                     if (v == -1) {
-                        return; // finished.
+                        break; // finished.
                     }
                 }
             }
+            group.signal();
         });
         
         
-        bool completed = (0 == dispatch_group_wait(group, dispatch_time(DISPATCH_TIME_NOW, 20*NSEC_PER_SEC)));
-        dispatch_release(group);
+        bool completed = group.wait(20.0) and group.wait(20.0);
+        producer.join();
+        consumer.join();
         
         EXPECT_EQ(false, producer_timeout_occured);
         EXPECT_EQ(false, consumer_timeout_occured);
@@ -0,0 +1,155 @@
+//
+//  utility_semaphore_test.cpp
+//  Test
+//
+//  Created by agent on 10/18/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+#include "json/utility/semaphore.hpp"
+
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+
+
+
+
+namespace {
+
+    using json::utility::semaphore;
+
+    class utility_semaphore_test : public ::testing::Test {
+    protected:
+        // You can remove any or all of the following functions if its body
+        // is empty.
+
+        utility_semaphore_test() {
+            // You can do set-up work for each test here.
+        }
+
+        virtual ~utility_semaphore_test() {
+            // You can do clean-up work that doesn't throw exceptions here.
+        }
+
+        // If the constructor and destructor are not enough for setting up
+        // and cleaning up each test, you can define the following methods:
+
+        virtual void SetUp() {
+            // Code here will be called immediately after the constructor (right
+            // before each test).
+        }
+
+        virtual void TearDown() {
+            // Code here will be called immediately after each test (right
+            // before the destructor).
+        }
+
+        // Objects declared here can be used by all tests in the test case for Foo.
+    };
+
+
+#pragma mark -
+#pragma mark json::utility::semaphore
+
+    TEST_F(utility_semaphore_test, CrashTest) {
+
+        semaphore* sem_ptr = new semaphore(0);
+        semaphore started(0);
+
+        std::thread t1([sem_ptr, &started]() {
+            started.signal();
+            sem_ptr->wait();
+        });
+
+        std::thread t2([sem_ptr, &started]() {
+            started.signal();
+            sem_ptr->wait();
+        });
+
+        started.wait();
+        started.wait();
+        bool success = sem_ptr->wait(0.2);
+        EXPECT_FALSE(success);
+
+        // Destroying the semaphore resumes the waiting threads:
+        delete sem_ptr;
+        t1.join();
+        t2.join();
+    }
+
+
+    TEST_F(utility_semaphore_test, TimedWait) {
+        typedef std::chrono::steady_clock clock_type;
+        semaphore sem(0);
+
+        // A timeout of zero polls:
+        EXPECT_FALSE(sem.wait(0));
+
+        clock_type::time_point start = clock_type::now();
+        EXPECT_FALSE(sem.wait(0.05));
+        double elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+        EXPECT_GE(elapsed, 0.05);
+        EXPECT_LT(elapsed, 2.0);
+
+        sem.signal();
+        sem.signal();
+        EXPECT_TRUE(sem.wait(0));
+        EXPECT_TRUE(sem.wait(semaphore::wait_forever()));
+        EXPECT_FALSE(sem.try_wait());
+
+        semaphore sem2(2);
+        EXPECT_TRUE(sem2.wait());
+        EXPECT_TRUE(sem2.wait(0.0));
+        EXPECT_FALSE(sem2.wait(0.0));
+    }
+
+
+    TEST_F(utility_semaphore_test, TimedWaitSignaledConcurrently) {
+        semaphore sem(0);
+        std::thread t([&sem]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            sem.signal();
+        });
+        EXPECT_TRUE(sem.wait(10.0));
+        t.join();
+    }
+
+
+    TEST_F(utility_semaphore_test, ConcurrentSignalAndWait) {
+        // Every signal shall be consumed by exactly one wait:
+        const int N = 20000;
+        const int Threads = 4;
+        semaphore sem(0);
+        std::atomic<int> consumed(0);
+
+        std::vector<std::thread> consumers;
+        for (int i = 0; i < Threads; ++i) {
+            consumers.push_back(std::thread([&]() {
+                for (int k = 0; k < N; ++k) {
+                    sem.wait();
+                    ++consumed;
+                }
+            }));
+        }
+        std::vector<std::thread> producers;
+        for (int i = 0; i < Threads; ++i) {
+            producers.push_back(std::thread([&]() {
+                for (int k = 0; k < N; ++k) {
+                    sem.signal();
+                }
+            }));
+        }
+        for (std::thread& t : producers)
+            t.join();
+        for (std::thread& t : consumers)
+            t.join();
+        EXPECT_EQ(N * Threads, consumed.load());
+        EXPECT_FALSE(sem.try_wait());
+    }
+
+}